@@ -319,13 +319,8 @@ public:
   ArrayReductionOp(unsigned n)
     : Realm::ReductionOpUntyped(sizeof(typename ELEM_REDOP::LHS) * n,
                                 sizeof(typename ELEM_REDOP::RHS) * n,
-// TODO: This will break if we change how a reduction list entry is laid out
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-                                sizeof(ptr_t) +
-                                sizeof(typename ELEM_REDOP::RHS) * n,
-#else
-                                0,
-#endif
+                                list_entry_size(
+                                  sizeof(typename ELEM_REDOP::RHS) * n),
                                 true, true),
     N(n) {}
 
@@ -433,28 +428,6 @@ public:
       *rhs_ptr++ = ELEM_REDOP::identity;
   }
 
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-  virtual void apply_list_entry(void *lhs_ptr, const void *entry_ptr, size_t count,
-                                off_t ptr_offset, bool exclusive = false) const
-  {
-    // TODO: Implement this function
-    assert(false);
-  }
-
-  virtual void fold_list_entry(void *rhs_ptr, const void *entry_ptr, size_t count,
-                                off_t ptr_offset, bool exclusive = false) const
-  {
-    // TODO: Implement this function
-    assert(false);
-  }
-
-  virtual void get_list_pointers(unsigned *ptrs, const void *entry_ptr, size_t count) const
-  {
-    // TODO: Implement this function
-    assert(false);
-  }
-#endif
-
 private:
   unsigned N;
 
@@ -1348,6 +1348,36 @@ namespace Legion {
        */
       void wait_all_results(bool silence_warnings = false,
                             const char *warning_string = NULL); 
+      /**
+       * Wait for all the tasks in the index space launch to
+       * complete and then copy all of their results into one
+       * buffer without making a future for each point. Results
+       * are laid out in the order that a DomainPointIterator
+       * visits the launch domain (dimension 0 varies fastest)
+       * and every point must have returned exactly result_size
+       * bytes. Only future maps made by index space launches
+       * can be read this way, and only on the node that made 
+       * the launch.
+       * @param buffer room for result_size bytes for each point
+       * @param result_size the size of each point's result
+       * @param silence_warnings silience warnings for this blocking call
+       * @param warning_string a string to be reported with any warnings
+       */
+      void get_all_results(void *buffer, size_t result_size,
+                           bool silence_warnings = false,
+                           const char *warning_string = NULL);
+      /**
+       * Typed version of get_all_results where every point
+       * returned a value of type T. Named separately so that it
+       * cannot be confused with the untyped form above.
+       * @param results room for one T for each point
+       * @param silence_warnings silience warnings for this blocking call
+       * @param warning_string a string to be reported with any warnings
+       */
+      template<typename T>
+        inline void get_all_results_typed(T *results,
+                                          bool silence_warnings = false,
+                                          const char *warning_string = NULL);
     }; 
 
 
@@ -2166,6 +2196,8 @@ namespace Legion {
       friend class ReductionAccessor;
       template<typename, int, typename, typename>
       friend class UnsafeFieldAccessor;
+      template<typename, int, typename, bool>
+      friend class ListReductionAccessor;
       Realm::RegionInstance get_instance_info(PrivilegeMode mode, 
                                               FieldID fid, size_t field_size,
                                               void *realm_is, TypeTag type_tag,
@@ -2174,6 +2206,15 @@ namespace Legion {
                                               bool generic_accessor,
                                               bool check_field_size,
                                               ReductionOpID redop = 0) const;
+      Realm::RegionInstance get_list_instance_info(FieldID fid, 
+                                              size_t field_size,
+                                              ReductionOpID redop,
+                                              void *realm_is, TypeTag type_tag,
+                                              const char *warning_string,
+                                              bool silence_warnings,
+                                              FieldID &pointer_fid,
+                                              size_t &max_entries,
+                                              size_t *&next_entry) const;
       void fail_bounds_check(DomainPoint p, FieldID fid,
                              PrivilegeMode mode) const;
       void fail_bounds_check(Domain d, FieldID fid,
@@ -2336,6 +2377,44 @@ namespace Legion {
                         const char *warning_string = NULL) { }
     };
 
+    /**
+     * \class ListReductionAccessor
+     * A list reduction accessor records reductions into a reduction list
+     * instance instead of applying them. Each call to 'reduce' appends
+     * an entry with the point and the value to the list and the runtime
+     * applies all the entries when the list is reduced into its target.
+     * Lists have a fixed number of entries that is set by the mapper, so 
+     * 'reduce' returns false and records nothing once the list is full.
+     * Entries can be appended concurrently by all the tasks using the list.
+     *  - bool reduce(const Point<N,T>&, REDOP::RHS) const
+     *  - size_t capacity(void) const
+     */
+    template<typename REDOP, int N, typename COORD_T = coord_t,
+#ifdef BOUNDS_CHECKS
+             bool CHECK_BOUNDS = true>
+#else
+             bool CHECK_BOUNDS = false>
+#endif
+    class ListReductionAccessor {
+    public:
+      ListReductionAccessor(void) : next_entry(NULL), max_entries(0) { }
+      ListReductionAccessor(const PhysicalRegion &region, FieldID fid,
+                            ReductionOpID redop, bool silence_warnings = false,
+                            const char *warning_string = NULL);
+    public:
+      inline bool reduce(const Point<N,COORD_T> &p, 
+                         typename REDOP::RHS val) const;
+      inline size_t capacity(void) const { return max_entries; }
+    protected:
+      Realm::AffineAccessor<typename REDOP::RHS,1,coord_t> values;
+      Realm::AffineAccessor<Point<N,COORD_T>,1,coord_t> pointers;
+      size_t *next_entry;
+      size_t max_entries;
+      DomainT<N,COORD_T> bounds;
+      FieldID field;
+      PhysicalRegion field_region;
+    };
+
     /**
      * \class DeferredValue
      * A deferred value is a special helper class for handling return values 
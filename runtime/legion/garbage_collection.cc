@@ -1175,7 +1175,8 @@ namespace Legion {
         if (add)
           rez.serialize(done_event);
       }
-      runtime->send_did_remote_valid_update(target, rez);
+      // Removals have no done event so nobody can be waiting on them
+      runtime->send_did_remote_valid_update(target, rez, !add/*deferrable*/);
       if (add && (mutator != NULL))
         mutator->record_reference_mutation_effect(done_event);
     }
@@ -1204,7 +1205,8 @@ namespace Legion {
         if (add)
           rez.serialize(done_event);
       }
-      runtime->send_did_remote_gc_update(target, rez);
+      // Removals have no done event so nobody can be waiting on them
+      runtime->send_did_remote_gc_update(target, rez, !add/*deferrable*/);
       if (add && (mutator != NULL))
         mutator->record_reference_mutation_effect(done_event);
     }
@@ -2561,6 +2561,19 @@ namespace Legion {
         impl->wait_all_results(silence_warnings, warning_string);
     }
 
+    //--------------------------------------------------------------------------
+    void FutureMap::get_all_results(void *buffer, size_t result_size,
+                                    bool silence_warnings,
+                                    const char *warning_string)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(impl != NULL);
+#endif
+      impl->get_all_results(buffer, result_size, 
+                            silence_warnings, warning_string);
+    }
+
     /////////////////////////////////////////////////////////////
     // Physical Region 
     /////////////////////////////////////////////////////////////
@@ -2716,6 +2729,21 @@ namespace Legion {
                                      generic_accessor, check_field_size, redop);
     }
 
+    //--------------------------------------------------------------------------
+    Realm::RegionInstance PhysicalRegion::get_list_instance_info(FieldID fid,
+                              size_t field_size, ReductionOpID redop, 
+                              void *realm_is, TypeTag type_tag,
+                              const char *warning_string, bool silence_warnings,
+                              FieldID &pointer_fid, size_t &max_entries,
+                              size_t *&next_entry) const
+    //--------------------------------------------------------------------------
+    {
+      return impl->get_list_instance_info(fid, field_size, redop, realm_is,
+                                          type_tag, warning_string, 
+                                          silence_warnings, pointer_fid,
+                                          max_entries, next_entry);
+    }
+
     //--------------------------------------------------------------------------
     void PhysicalRegion::fail_bounds_check(DomainPoint p, FieldID fid,
                                            PrivilegeMode mode) const
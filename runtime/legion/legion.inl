@@ -5084,6 +5084,49 @@ namespace Legion {
       AffineBounds::Tester<1,T> bounds;
     };
 
+    //--------------------------------------------------------------------------
+    template<typename REDOP, int N, typename T, bool CB>
+    inline ListReductionAccessor<REDOP,N,T,CB>::ListReductionAccessor(
+                      const PhysicalRegion &region, FieldID fid,
+                      ReductionOpID redop, bool silence_warnings,
+                      const char *warning_string)
+      : field(fid), field_region(region)
+    //--------------------------------------------------------------------------
+    {
+      FieldID pointer_fid;
+      const Realm::RegionInstance instance = 
+        region.get_list_instance_info(fid, sizeof(typename REDOP::RHS), redop,
+            &bounds, Internal::NT_TemplateHelper::encode_tag<N,T>(),
+            warning_string, silence_warnings, pointer_fid, max_entries,
+            next_entry);
+      const Rect<1,coord_t> entries(0, max_entries - 1);
+      if (!Realm::AffineAccessor<typename REDOP::RHS,1,coord_t>::is_compatible(
+            instance, fid, entries))
+        region.report_incompatible_accessor("ListReductionAccessor",
+                                            instance, fid);
+      values = Realm::AffineAccessor<typename REDOP::RHS,1,coord_t>(
+          instance, fid, entries);
+      pointers = Realm::AffineAccessor<Point<N,T>,1,coord_t>(
+          instance, pointer_fid, entries);
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename REDOP, int N, typename T, bool CB>
+    inline bool ListReductionAccessor<REDOP,N,T,CB>::reduce(
+                      const Point<N,T> &p, typename REDOP::RHS val) const
+    //--------------------------------------------------------------------------
+    {
+      // Points outside the region would be dropped when the list is applied
+      if (CB && !bounds.contains(p))
+        field_region.fail_bounds_check(DomainPoint(p), field, REDUCE);
+      const size_t entry = __sync_fetch_and_add(next_entry, 1);
+      if (entry >= max_entries)
+        return false;
+      values[entry] = val;
+      pointers[entry] = p;
+      return true;
+    }
+
     // A hidden class for users that really know what they are doing
     /**
      * \class UnsafeFieldAccessor
@@ -8141,6 +8184,16 @@ namespace Legion {
       return f.get_result<T>(silence_warnings, warning_string);
     }
 
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline void FutureMap::get_all_results_typed(T *results,
+                                                 bool silence_warnings,
+                                                 const char *warning_string)
+    //--------------------------------------------------------------------------
+    {
+      get_all_results(results, sizeof(T), silence_warnings, warning_string);
+    }
+
     //--------------------------------------------------------------------------
     template<typename RT, typename PT, unsigned DIM>
     inline RT FutureMap::get_result(const PT point[DIM])
@@ -68,6 +68,71 @@ namespace Legion {
     {
     }
 
+    /////////////////////////////////////////////////////////////
+    // Logical User Summary
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    LogicalUserSummary::LogicalUserSummary(void)
+      : skipped_scans(0)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    void LogicalUserSummary::add_user(const LogicalUser &user)
+    //--------------------------------------------------------------------------
+    {
+      // Same classification as check_dependence_type
+      if (IS_READ_ONLY(user.usage))
+        read_fields |= user.field_mask;
+      else if (IS_REDUCE(user.usage))
+        reduce_fields[user.usage.redop] |= user.field_mask;
+      else
+        other_fields |= user.field_mask;
+    }
+
+    //--------------------------------------------------------------------------
+    void LogicalUserSummary::clear(void)
+    //--------------------------------------------------------------------------
+    {
+      read_fields.clear();
+      other_fields.clear();
+      reduce_fields.clear();
+      skipped_scans = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    bool LogicalUserSummary::may_interfere(const LogicalUser &user) const
+    //--------------------------------------------------------------------------
+    {
+      if (!(user.field_mask * other_fields))
+        return true;
+      if (IS_READ_ONLY(user.usage))
+      {
+        // Readers interfere with any reduction
+        for (LegionMap<ReductionOpID,FieldMask>::aligned::const_iterator it =
+              reduce_fields.begin(); it != reduce_fields.end(); it++)
+          if (!(user.field_mask * it->second))
+            return true;
+        return false;
+      }
+      else if (IS_REDUCE(user.usage))
+      {
+        // Reductions interfere with readers and other reduction ops
+        if (!(user.field_mask * read_fields))
+          return true;
+        for (LegionMap<ReductionOpID,FieldMask>::aligned::const_iterator it =
+              reduce_fields.begin(); it != reduce_fields.end(); it++)
+          if ((it->first != user.usage.redop) && 
+              !(user.field_mask * it->second))
+            return true;
+        return false;
+      }
+      // Everything else always has to check
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     PhysicalUser::PhysicalUser(void)
     //--------------------------------------------------------------------------
@@ -2477,6 +2542,7 @@ namespace Legion {
         }
         curr_epoch_users.clear();
       }
+      curr_epoch_summary.clear();
       if (!prev_epoch_users.empty())
       {
         for (LegionList<LogicalUser,PREV_LOGICAL_ALLOC>::track_aligned::
@@ -2505,6 +2571,38 @@ namespace Legion {
       projection_epochs.clear();
     } 
 
+    //--------------------------------------------------------------------------
+    void LogicalState::add_curr_epoch_user(const LogicalUser &user)
+    //--------------------------------------------------------------------------
+    {
+      curr_epoch_users.push_back(user);
+      curr_epoch_summary.add_user(user);
+    }
+
+    //--------------------------------------------------------------------------
+    void LogicalState::filter_committed_curr_epoch_users(void)
+    //--------------------------------------------------------------------------
+    {
+      // Users that skip the dependence scan never run down the timeouts
+      // of the users in the list, so this does the same pruning in one
+      // pass and rebuilds the summary while we're at it
+      curr_epoch_summary.clear();
+      for (LegionList<LogicalUser,CURR_LOGICAL_ALLOC>::track_aligned::iterator
+            it = curr_epoch_users.begin(); it != 
+            curr_epoch_users.end(); /*nothing*/)
+      {
+#ifndef LEGION_SPY
+        if (it->op->is_operation_committed(it->gen))
+        {
+          it = curr_epoch_users.erase(it);
+          continue;
+        }
+#endif
+        curr_epoch_summary.add_user(*it);
+        it++;
+      }
+    }
+
     //--------------------------------------------------------------------------
     void LogicalState::clear_deleted_state(const FieldMask &deleted_mask)
     //--------------------------------------------------------------------------
@@ -3973,8 +4071,7 @@ namespace Legion {
     }
 
     //--------------------------------------------------------------------------
-    void LogicalCloser::register_close_operations(
-               LegionList<LogicalUser,CURR_LOGICAL_ALLOC>::track_aligned &users)
+    void LogicalCloser::register_close_operations(LogicalState &state)
     //--------------------------------------------------------------------------
     {
       // No need to add mapping references, we did that in 
@@ -3985,20 +4082,20 @@ namespace Legion {
       {
         LogicalUser close_user(normal_close_op, normal_close_gen, 0/*idx*/, 
             RegionUsage(READ_WRITE, EXCLUSIVE, 0/*redop*/), normal_close_mask);
-        users.push_back(close_user);
+        state.add_curr_epoch_user(close_user);
       }
       if (read_only_close_op != NULL)
       {
         LogicalUser close_user(read_only_close_op, read_only_close_gen,0/*idx*/,
           RegionUsage(READ_WRITE, EXCLUSIVE, 0/*redop*/), read_only_close_mask);
-        users.push_back(close_user);
+        state.add_curr_epoch_user(close_user);
       }
       if (flush_only_close_op != NULL)
       {
         LogicalUser close_user(flush_only_close_op, 
                                flush_only_close_gen, 0/*idx*/,
          RegionUsage(READ_WRITE, EXCLUSIVE, 0/*redop*/), flush_only_close_mask);
-        users.push_back(close_user);
+        state.add_curr_epoch_user(close_user);
       }
     }
 
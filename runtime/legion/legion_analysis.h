@@ -71,6 +71,32 @@ namespace Legion {
       static const int TIMEOUT = LEGION_DEFAULT_LOGICAL_USER_TIMEOUT;
     };
 
+    /**
+     * \struct LogicalUserSummary
+     * Buckets the fields of the users in an epoch list by the kind
+     * of privilege they hold. Readers never depend on other readers
+     * and reductions never depend on reductions with the same operator,
+     * so a read-only or reduction user whose fields only overlap users
+     * in its own bucket has nothing to find in the list and can skip
+     * scanning it. Users pruned from the list are not removed from
+     * the summary until it is rebuilt, which only costs us the fast path.
+     */
+    struct LogicalUserSummary {
+    public:
+      LogicalUserSummary(void);
+    public:
+      void add_user(const LogicalUser &user);
+      void clear(void);
+      bool may_interfere(const LogicalUser &user) const;
+    public:
+      FieldMask read_fields;
+      // Anything that is neither read-only nor a reduction
+      FieldMask other_fields;
+      LegionMap<ReductionOpID,FieldMask>::aligned reduce_fields;
+      // Scans skipped since the list was last checked for committed users
+      unsigned skipped_scans;
+    };
+
     /**
      * \struct VersioningSet
      * A small helper class for tracking collections of 
@@ -616,6 +642,9 @@ namespace Legion {
       void clear_logical_users(void);
       void reset(void);
       void clear_deleted_state(const FieldMask &deleted_mask);
+    public:
+      void add_curr_epoch_user(const LogicalUser &user);
+      void filter_committed_curr_epoch_users(void);
     public:
       void advance_projection_epochs(const FieldMask &advance_mask);
       void capture_projection_epochs(FieldMask capture_mask,
@@ -633,6 +662,9 @@ namespace Legion {
                                                             curr_epoch_users;
       LegionList<LogicalUser,PREV_LOGICAL_ALLOC>::track_aligned 
                                                             prev_epoch_users;
+      // Summarizes the privileges of the current epoch users so 
+      // non-interfering users can skip the dependence scan
+      LogicalUserSummary curr_epoch_summary;
     public:
       // Fields which we know have been mutated below in the region tree
       FieldMask dirty_below;
@@ -755,8 +787,7 @@ namespace Legion {
              LegionList<LogicalUser,CURR_LOGICAL_ALLOC>::track_aligned &cusers,
              LegionList<LogicalUser,PREV_LOGICAL_ALLOC>::track_aligned &pusers);
       void update_state(LogicalState &state);
-      void register_close_operations(
-              LegionList<LogicalUser,CURR_LOGICAL_ALLOC>::track_aligned &users);
+      void register_close_operations(LogicalState &state);
     protected:
       void register_dependences(CloseOp *close_op, 
                                 const LogicalUser &close_user,
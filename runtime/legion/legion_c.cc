@@ -2687,6 +2687,16 @@ legion_future_map_wait_all_results(legion_future_map_t fm_)
   fm->wait_all_results();
 }
 
+void
+legion_future_map_get_all_results(legion_future_map_t fm_,
+                                  void *buffer,
+                                  size_t result_size)
+{
+  FutureMap *fm = CObjectWrapper::unwrap(fm_);
+
+  fm->get_all_results(buffer, result_size);
+}
+
 legion_future_t
 legion_future_map_get_future(legion_future_map_t fm_,
                              legion_domain_point_t dp_)
@@ -2278,6 +2278,14 @@ extern "C" {
   void
   legion_future_map_wait_all_results(legion_future_map_t handle);
 
+  /**
+   * @see Legion::FutureMap::get_all_results()
+   */
+  void
+  legion_future_map_get_all_results(legion_future_map_t handle,
+                                    void *buffer,
+                                    size_t result_size);
+
   /**
    * @return Caller takes ownership of return value.
    *
@@ -281,6 +281,13 @@
 #define LEGION_DEFAULT_MAX_MESSAGE_SIZE        (DEFAULT_MAX_MESSAGE_SIZE)
 #endif
 #endif
+// The longest time in microseconds that a reference counting update
+// that nobody waits on (reference removals and resource references)
+// can be held back waiting for more messages to the same node before
+// it is sent. Setting this to zero sends every message immediately.
+#ifndef LEGION_DEFAULT_MESSAGE_AGGREGATION_WINDOW
+#define LEGION_DEFAULT_MESSAGE_AGGREGATION_WINDOW 100
+#endif
 // Timeout before checking for whether a logical user
 // should be pruned from the logical region tree data strucutre
 // Making the value less than or equal to zero will
@@ -294,6 +301,12 @@
 #define LEGION_DEFAULT_LOGICAL_USER_TIMEOUT    (DEFAULT_LOGICAL_USER_TIMEOUT)
 #endif
 #endif
+// Number of current epoch users on a physical instance view
+// before the view starts indexing them by the child through
+// which they were registered. Smaller epochs are just scanned.
+#ifndef LEGION_DEFAULT_MIN_INDEXED_VIEW_USERS
+#define LEGION_DEFAULT_MIN_INDEXED_VIEW_USERS  64
+#endif
 // Number of events to place in each GC epoch
 // Large counts improve efficiency but add latency to
 // garbage collection.  Smaller count reduce efficiency
@@ -365,6 +378,39 @@
 #define LEGION_NON_REPLAYABLE_WARNING     5
 #endif
 
+// Maximum number of replayable templates kept for each trace
+#ifndef LEGION_MAX_TRACE_TEMPLATES
+#define LEGION_MAX_TRACE_TEMPLATES        16
+#endif
+
+// The number of bytes of profiling records that
+// each thread buffers before handing them off to
+// be written out in the background
+#ifndef LEGION_PROF_THREAD_BUFFER_SIZE
+#define LEGION_PROF_THREAD_BUFFER_SIZE    (1 << 20)
+#endif
+
+// Number of power-of-two buckets (in nanoseconds) in the wait
+// and hold time histograms kept for each lock site when
+// building with -DLEGION_LOCK_PROFILING
+#ifndef LEGION_LOCK_PROFILING_BUCKETS
+#define LEGION_LOCK_PROFILING_BUCKETS     32
+#endif
+
+// Maximum number of contended lock waits that each thread
+// keeps for the profiler's timelines when building with
+// -DLEGION_LOCK_PROFILING, later waits are only counted
+#ifndef LEGION_LOCK_PROFILING_MAX_WAITS
+#define LEGION_LOCK_PROFILING_MAX_WAITS   (1 << 20)
+#endif
+
+// Largest result in bytes that the future map of an index
+// space launch keeps in its dense result buffer, points with
+// larger results get a future of their own
+#ifndef LEGION_MAX_DENSE_FUTURE_RESULT_SIZE
+#define LEGION_MAX_DENSE_FUTURE_RESULT_SIZE   256
+#endif
+
 // Initial offset for library IDs
 // Controls how many IDs are available for dynamic use
 #ifndef LEGION_INITIAL_LIBRARY_ID_OFFSET
@@ -1134,6 +1180,8 @@ typedef enum legion_error_t {
   ERROR_DUPLICATE_VARIANT_REGISTRATION = 556,
   ERROR_ILLEGAL_IMPLICIT_TOP_LEVEL_TASK = 557,
   ERROR_ACCESSOR_COMPATIBILITY_CHECK = 558,
+  ERROR_INVALID_SPY_FILE = 559,
+  ERROR_FUTURE_MAP_GET_ALL_RESULTS = 560,
   
 
   LEGION_WARNING_FUTURE_NONLEAF = 1000,
@@ -1187,6 +1235,8 @@ typedef enum legion_error_t {
   LEGION_WARNING_EXTERNAL_GARBAGE_PRIORITY = 1095,
   LEGION_WARNING_MAPPER_INVALID_INSTANCE = 1096,
   LEGION_WARNING_NON_REPLAYABLE_COUNT_EXCEEDED = 1097,
+  LEGION_WARNING_PROFILER_SAMPLED_RECORDS = 1098,
+  LEGION_WARNING_LOCK_PROFILING_DROPPED_WAITS = 1099,
   
   
   LEGION_FATAL_MUST_EPOCH_NOADDRESS = 2000,
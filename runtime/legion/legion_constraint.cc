@@ -578,8 +578,9 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     SpecializedConstraint::SpecializedConstraint(SpecializedKind k,
-                                                 ReductionOpID r, bool no)
-      : kind(k), redop(r), no_access(no)
+                                                 ReductionOpID r, bool no,
+                                                 size_t entries)
+      : kind(k), redop(r), no_access(no), max_list_entries(entries)
     //--------------------------------------------------------------------------
     {
       if (redop != 0)
@@ -610,6 +611,10 @@ namespace Legion {
         return false;
       if (no_access && !other.no_access)
         return false;
+      // A list with fewer entries can't stand in for a longer one
+      if ((kind == REDUCTION_LIST_SPECIALIZE) && 
+          (max_list_entries < other.max_list_entries))
+        return false;
       return true;
     }
 
@@ -638,6 +643,7 @@ namespace Legion {
       SWAP_HELPER(SpecializedKind, kind)
       SWAP_HELPER(ReductionOpID, redop)
       SWAP_HELPER(bool, no_access)
+      SWAP_HELPER(size_t, max_list_entries)
     }
 
     //--------------------------------------------------------------------------
@@ -648,6 +654,8 @@ namespace Legion {
       if ((kind == REDUCTION_FOLD_SPECIALIZE) || 
           (kind == REDUCTION_LIST_SPECIALIZE))
         rez.serialize(redop);
+      if (kind == REDUCTION_LIST_SPECIALIZE)
+        rez.serialize(max_list_entries);
       rez.serialize<bool>(no_access);
     }
 
@@ -659,6 +667,8 @@ namespace Legion {
       if ((kind == REDUCTION_FOLD_SPECIALIZE) || 
           (kind == REDUCTION_LIST_SPECIALIZE))
         derez.deserialize(redop);
+      if (kind == REDUCTION_LIST_SPECIALIZE)
+        derez.deserialize(max_list_entries);
       derez.deserialize<bool>(no_access);
     }
 
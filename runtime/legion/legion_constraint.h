@@ -337,6 +337,9 @@ namespace Legion {
      * kinds of specializations here in the future. Note the default
      * constructor will fall back to the normal case so this
      * kind of constraint won't need to be set in the default case.
+     * Reduction-list instances hold up to max_list_entries entries,
+     * each a point of the region and a value to reduce into it, so
+     * they only need space for the points a task actually reduces to.
      */
     class SpecializedConstraint : 
       public LayoutConstraintBase<SpecializedConstraint> {
@@ -345,13 +348,16 @@ namespace Legion {
                                             SPECIALIZED_CONSTRAINT;
     public:
       SpecializedConstraint(SpecializedKind kind = NORMAL_SPECIALIZE,
-                            ReductionOpID redop = 0, bool no_access = false);
+                            ReductionOpID redop = 0, bool no_access = false,
+                            size_t max_list_entries = 0);
     public:
       bool entails(const SpecializedConstraint &other) const;
       bool conflicts(const SpecializedConstraint &other) const;
     public:
       inline SpecializedKind get_kind(void) const { return kind; }
       inline ReductionOpID get_reduction_op(void) const { return redop; }
+      inline size_t get_max_list_entries(void) const 
+        { return max_list_entries; }
     public:
       void swap(SpecializedConstraint &rhs);
       void serialize(Serializer &rez) const;
@@ -366,6 +372,7 @@ namespace Legion {
       SpecializedKind kind;
       ReductionOpID  redop;
       bool       no_access;
+      size_t     max_list_entries;
     };
 
     /**
@@ -1583,8 +1583,8 @@ namespace Legion {
                                                bool register_now)
       : ReductionManager(ctx, encode_reduction_list_did(did), owner_space, 
                          mem, inst, desc, cons, d, own_dom, node, 
-                         red, o, use_event, register_now, footprint), 
-        ptr_space(dom)
+                         red, o, use_event, footprint, register_now), 
+        ptr_space(dom), next_entry(0)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_LEGION
@@ -1607,7 +1607,7 @@ namespace Legion {
       : ReductionManager(NULL, 0, 0, NULL, PhysicalInstance::NO_INST,
                          NULL, rhs.pointer_constraint, NULL, false, NULL, 0, 
                          NULL, ApEvent::NO_AP_EVENT, 0, false),
-        ptr_space(Domain::NO_DOMAIN)
+        ptr_space(Domain::NO_DOMAIN), next_entry(0)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -1636,8 +1636,9 @@ namespace Legion {
         ListReductionManager::get_accessor(void) const
     //--------------------------------------------------------------------------
     {
-      // TODO: Implement this 
-      assert(false);
+#ifdef DEBUG_LEGION
+      assert(instance.exists());
+#endif
       return instance.get_accessor();
     }
 
@@ -1647,9 +1648,15 @@ namespace Legion {
         ListReductionManager::get_field_accessor(FieldID fid) const
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
-      return instance.get_accessor();
+#ifdef DEBUG_LEGION
+      assert(instance.exists());
+      assert(layout != NULL);
+#endif
+      const CopySrcDstField &info = layout->find_field_info(fid);
+      LegionRuntime::Accessor::RegionAccessor<
+        LegionRuntime::Accessor::AccessorType::Generic> temp = 
+                                                    instance.get_accessor();
+      return temp.get_untyped_field_accessor(info.field_id, info.size);
     }
 
     //--------------------------------------------------------------------------
@@ -1666,9 +1673,9 @@ namespace Legion {
     {
 #ifdef DEBUG_LEGION
       assert(instance.exists());
+      assert(layout != NULL);
 #endif
-      // TODO: implement this for list reduction instances
-      assert(false);
+      layout->compute_copy_offsets(reduce_mask, this, fields);
     }
 
     //--------------------------------------------------------------------------
@@ -1682,10 +1689,14 @@ namespace Legion {
     {
 #ifdef DEBUG_LEGION
       assert(instance.exists());
+      assert(src_fields.size() == 1);
 #endif
-      // TODO: use the "new" Realm interface for list instances
-      assert(false);
-      return ApEvent::NO_AP_EVENT;
+      // Replay every entry of the list, entries that point outside
+      // of the target get skipped so precision doesn't matter here
+      return dst->issue_list_reduction(op, src_fields, dst_fields, instance,
+                          get_pointer_field(src_fields[0].field_id),
+                          ptr_space.get_volume(), precondition, guard,
+                          trace_info, intersect, redop, reduction_fold);
     }
 
     //--------------------------------------------------------------------------
@@ -1950,7 +1961,18 @@ namespace Legion {
       }
       // Construct the realm layout each time since (realm will take ownership 
       // after every instance call, so we need a new one each time)
-      Realm::InstanceLayoutGeneric *realm_layout = 
+      // List instances are laid out over their entries instead of
+      // over the points of the instance domain
+      const size_t max_list_entries = 
+        (constraints.specialized_constraint.get_kind() == 
+         REDUCTION_LIST_SPECIALIZE) ?
+        constraints.specialized_constraint.get_max_list_entries() : 0;
+      const FieldID list_pointer_fid = (max_list_entries > 0) ?
+        ListReductionManager::get_pointer_field(
+            constraints.field_constraint.get_field_set()[0]) : 0;
+      Realm::InstanceLayoutGeneric *realm_layout = (max_list_entries > 0) ?
+        instance_domain->create_list_layout(realm_constraints,
+                                      max_list_entries, list_pointer_fid) :
         instance_domain->create_layout(realm_constraints, 
                                        constraints.ordering_constraint);
 #ifdef DEBUG_LEGION
@@ -2120,8 +2142,38 @@ namespace Legion {
           }
         case REDUCTION_LIST_SPECIALIZE:
           {
-            // TODO: implement this
-            assert(false);
+#ifdef DEBUG_LEGION
+            assert(field_sizes.size() == 1);
+            assert(max_list_entries > 0);
+#endif
+            ApUserEvent filled_and_ready = Runtime::create_ap_user_event();
+            result = new ListReductionManager(forest, did, local_space,
+                                              memory_manager,
+                                              instance, layout,
+                                              pointer_constraint,
+                                              instance_domain, own_domain,
+                                              ancestor, redop_id,
+                                              reduction_op, 
+                                Domain(Rect<1>(0, max_list_entries - 1)),
+                                              filled_and_ready,
+                                              instance_footprint,
+                                              true/*register now*/);
+            // Same as for fold instances, every entry starts out as
+            // the identity which also makes unused entries harmless
+            void *fill_buffer = malloc(reduction_op->sizeof_rhs);
+            reduction_op->init(fill_buffer, 1);
+            std::vector<CopySrcDstField> dsts;
+            {
+              const std::vector<FieldID> &fill_fields = 
+                constraints.field_constraint.get_field_set();
+              layout->compute_copy_offsets(fill_fields, result, dsts);
+            }
+            ApEvent filled = 
+              instance_domain->issue_list_fill(instance, max_list_entries,
+                                  dsts, fill_buffer, reduction_op->sizeof_rhs,
+                                  list_pointer_fid, ready);
+            free(fill_buffer);
+            Runtime::trigger_event(filled_and_ready, filled);
             break;
           }
         default:
@@ -2457,10 +2509,31 @@ namespace Legion {
           }
         case REDUCTION_LIST_SPECIALIZE:
           {
-            // TODO: implement list reduction instances
-            assert(false);
             redop_id = constraints.specialized_constraint.get_reduction_op();
             reduction_op = Runtime::get_reduction_op(redop_id);
+            if (constraints.specialized_constraint.get_max_list_entries() == 0)
+              REPORT_LEGION_ERROR(ERROR_UNSUPPORTED_LAYOUT_CONSTRAINT,
+                  "Illegal reduction list instance request with reduction "
+                  "operator %d that does not specify the maximum number "
+                  "of list entries", redop_id)
+            // Each entry in the list holds the point that it reduces to
+            // so a list can only hold the values of a single field
+            if (field_sizes.size() > 1)
+              REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                            "Illegal request for a reduction list instance "
+                            "containing multiple fields. Only a single field "
+                            "is permitted for reduction list instances.")
+            for (unsigned idx = 0; idx < field_sizes.size(); idx++)
+            {
+              if (field_sizes[idx] != reduction_op->sizeof_lhs)
+                REPORT_LEGION_ERROR(ERROR_UNSUPPORTED_LAYOUT_CONSTRAINT,
+                    "Illegal reduction instance request with field %d "
+                    "which has size %d but the LHS type of reduction "
+                    "operator %d is %d", field_set[idx], int(field_sizes[idx]),
+                    redop_id, int(reduction_op->sizeof_lhs))
+              // List entries hold values of the rhs of the reduction op
+              field_sizes[idx] = reduction_op->sizeof_rhs;
+            }
             break;
           }
         case VIRTUAL_SPECIALIZE:
@@ -384,7 +384,7 @@ namespace Legion {
                            IndexSpaceNode *inst_domain, bool own_domain,
                            RegionNode *node, ReductionOpID redop, 
                            const ReductionOp *op, Domain dom,
-                           ApEvent use_event,size_t fooprint,bool register_now);
+                           ApEvent use_event,size_t footprint,bool register_now);
       ListReductionManager(const ListReductionManager &rhs);
       virtual ~ListReductionManager(void);
     public:
@@ -407,8 +407,16 @@ namespace Legion {
           bool reduction_fold, bool precise_domain,
           PhysicalTraceInfo &trace_info, RegionTreeNode *intersect);
       virtual Domain get_pointer_space(void) const;
+    public:
+      // Tasks append entries by bumping this cursor, it only has
+      // meaning on the owner node where the instance can be mapped
+      inline size_t* get_next_entry(void) { return &next_entry; }
+      // Realm field holding the point of each entry in the list
+      static inline FieldID get_pointer_field(FieldID value_fid)
+        { return ~value_fid; }
     protected:
       const Domain ptr_space;
+      size_t next_entry;
     };
 
     /**
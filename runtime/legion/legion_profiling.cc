@@ -32,6 +32,136 @@ namespace Legion {
     // be thread safe no matter what Realm decides to do 
     __thread LegionProfInstance *thread_local_profiling_instance = NULL;
 
+#ifdef LEGION_LOCK_PROFILING
+    /////////////////////////////////////////////////////////////
+    // Lock Profiling 
+    /////////////////////////////////////////////////////////////
+
+    // Lock statistics are kept in per-thread tables that are only
+    // merged when the profiler is finalized. They can't be buffered
+    // in a LegionProfInstance like other records since handing those
+    // off takes LocalLocks which would then be profiled in turn.
+    struct LockSiteProfile {
+    public:
+      LockSiteProfile(const char *f, int l)
+        : file(f), line(l), acquires(0), exclusive(0), contended(0),
+          total_wait(0), total_hold(0)
+      {
+        memset(wait_hist, 0, sizeof(wait_hist));
+        memset(hold_hist, 0, sizeof(hold_hist));
+      }
+    public:
+      const char *file;
+      int line;
+      unsigned long long acquires, exclusive, contended;
+      unsigned long long total_wait, total_hold;
+      unsigned long long wait_hist[LEGION_LOCK_PROFILING_BUCKETS];
+      unsigned long long hold_hist[LEGION_LOCK_PROFILING_BUCKETS];
+    };
+
+    struct LockWaitRecord {
+    public:
+      unsigned site; // index in the thread's table
+      ProcID proc_id;
+      long long start, stop;
+    };
+
+    struct LockProfileTable {
+    public:
+      LockProfileTable(void) : next(NULL), busy(0), dropped_waits(0) { }
+    public:
+      LockProfileTable *next;
+      // Only ever contended by the profiler when it dumps the table
+      volatile int busy;
+      std::map<std::pair<const char*,int>,unsigned> site_indexes;
+      std::vector<LockSiteProfile> sites;
+      std::vector<LockWaitRecord> waits;
+      unsigned long long dropped_waits;
+    };
+
+    // Every table that has been made, threads only ever push on here
+    static LockProfileTable *volatile lock_profile_tables = NULL;
+    static __thread LockProfileTable *local_lock_profile = NULL;
+
+    //--------------------------------------------------------------------------
+    static inline unsigned lock_histogram_bucket(long long nanoseconds)
+    //--------------------------------------------------------------------------
+    {
+      // Bucket b holds times in [2^b, 2^(b+1)) with zero in bucket 0
+      if (nanoseconds <= 1)
+        return 0;
+      const unsigned bucket = 63 - __builtin_clzll(nanoseconds);
+      return (bucket < LEGION_LOCK_PROFILING_BUCKETS) ? bucket :
+        (LEGION_LOCK_PROFILING_BUCKETS - 1);
+    }
+
+    //--------------------------------------------------------------------------
+    void record_lock_hold(const char *file, int line, bool exclusive,
+                          bool contended, long long request,
+                          long long acquired, long long released)
+    //--------------------------------------------------------------------------
+    {
+      LockProfileTable *table = local_lock_profile;
+      if (table == NULL)
+      {
+        table = new LockProfileTable();
+        local_lock_profile = table;
+        LockProfileTable *head;
+        do {
+          head = lock_profile_tables;
+          table->next = head;
+        } while (!__sync_bool_compare_and_swap(&lock_profile_tables, 
+                                               head, table));
+      }
+      while (__sync_lock_test_and_set(&table->busy, 1) != 0)
+        continue;
+      const std::pair<const char*,int> key(file, line);
+      std::map<std::pair<const char*,int>,unsigned>::const_iterator finder =
+        table->site_indexes.find(key);
+      unsigned index;
+      if (finder == table->site_indexes.end())
+      {
+        index = table->sites.size();
+        table->sites.push_back(LockSiteProfile(file, line));
+        table->site_indexes[key] = index;
+      }
+      else
+        index = finder->second;
+      LockSiteProfile &site = table->sites[index];
+      const long long wait = acquired - request;
+      const long long hold = released - acquired;
+      site.acquires++;
+      if (exclusive)
+        site.exclusive++;
+      site.total_wait += wait;
+      site.total_hold += hold;
+      site.wait_hist[lock_histogram_bucket(wait)]++;
+      site.hold_hist[lock_histogram_bucket(hold)]++;
+      if (contended)
+      {
+        site.contended++;
+        // Contended acquires already waited on an event so the extra
+        // cost of finding the processor is in the noise
+        const Processor proc = Processor::get_executing_processor();
+        if (proc.exists())
+        {
+          if (table->waits.size() < LEGION_LOCK_PROFILING_MAX_WAITS)
+          {
+            LockWaitRecord record;
+            record.site = index;
+            record.proc_id = proc.id;
+            record.start = request;
+            record.stop = acquired;
+            table->waits.push_back(record);
+          }
+          else
+            table->dropped_waits++;
+        }
+      }
+      __sync_lock_release(&table->busy);
+    }
+#endif
+
     //--------------------------------------------------------------------------
     LegionProfMarker::LegionProfMarker(const char* _name)
       : name(_name), stopped(false)
@@ -60,14 +190,14 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     LegionProfInstance::LegionProfInstance(LegionProfiler *own)
-      : owner(own)
+      : footprint(0), sample_count(0), dropped_records(0), owner(own)
     //--------------------------------------------------------------------------
     {
     }
 
     //--------------------------------------------------------------------------
     LegionProfInstance::LegionProfInstance(const LegionProfInstance &rhs)
-      : owner(rhs.owner)
+      : footprint(0), sample_count(0), dropped_records(0), owner(rhs.owner)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -152,6 +282,19 @@ namespace Legion {
       owner->update_footprint(sizeof(SliceOwner), this);
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfInstance::register_trace_template(UniqueID op_id,
+                                               TraceID trace_id, unsigned kind)
+    //--------------------------------------------------------------------------
+    {
+      trace_templates.push_back(TraceTemplateInfo());
+      TraceTemplateInfo &info = trace_templates.back();
+      info.op_id = op_id;
+      info.trace_id = trace_id;
+      info.kind = kind;
+      owner->update_footprint(sizeof(TraceTemplateInfo), this);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfInstance::register_index_space_rect(IndexSpaceRectDesc
 							&_ispace_rect_desc)
@@ -667,6 +810,11 @@ namespace Legion {
       {
         serializer->serialize(*it);
       }
+      for (std::deque<TraceTemplateInfo>::const_iterator it = 
+            trace_templates.begin(); it != trace_templates.end(); it++)
+      {
+        serializer->serialize(*it);
+      }
       for (std::deque<TaskInfo>::const_iterator it = task_infos.begin();
             it != task_infos.end(); it++)
       {
@@ -817,6 +965,7 @@ namespace Legion {
       task_variants.clear();
       operation_instances.clear();
       multi_tasks.clear();
+      trace_templates.clear();
       task_infos.clear();
       gpu_task_infos.clear();
       ispace_rect_desc.clear();
@@ -903,6 +1052,16 @@ namespace Legion {
         if (t_curr >= t_stop)
           return diff;
       }
+      while (!trace_templates.empty())
+      {
+        TraceTemplateInfo &front = trace_templates.front();
+        serializer->serialize(front);
+        diff += sizeof(front);
+        trace_templates.pop_front();
+        const long long t_curr = Realm::Clock::current_time_in_microseconds();
+        if (t_curr >= t_stop)
+          return diff;
+      }
       while (!task_infos.empty())
       {
         TaskInfo &front = task_infos.front();
@@ -1153,6 +1312,49 @@ namespace Legion {
       return diff;
     }
 
+    //--------------------------------------------------------------------------
+    LegionProfInstance* LegionProfInstance::extract_records(void)
+    //--------------------------------------------------------------------------
+    {
+      LegionProfInstance *batch = new LegionProfInstance(owner);
+      batch->task_kinds.swap(task_kinds);
+      batch->task_variants.swap(task_variants);
+      batch->operation_instances.swap(operation_instances);
+      batch->multi_tasks.swap(multi_tasks);
+      batch->slice_owners.swap(slice_owners);
+      batch->trace_templates.swap(trace_templates);
+      batch->task_infos.swap(task_infos);
+      batch->gpu_task_infos.swap(gpu_task_infos);
+      batch->ispace_rect_desc.swap(ispace_rect_desc);
+      batch->ispace_point_desc.swap(ispace_point_desc);
+      batch->ispace_empty_desc.swap(ispace_empty_desc);
+      batch->field_desc.swap(field_desc);
+      batch->field_space_desc.swap(field_space_desc);
+      batch->index_part_desc.swap(index_part_desc);
+      batch->index_space_desc.swap(index_space_desc);
+      batch->index_subspace_desc.swap(index_subspace_desc);
+      batch->index_partition_desc.swap(index_partition_desc);
+      batch->lr_desc.swap(lr_desc);
+      batch->phy_inst_rdesc.swap(phy_inst_rdesc);
+      batch->phy_inst_layout_rdesc.swap(phy_inst_layout_rdesc);
+      batch->meta_infos.swap(meta_infos);
+      batch->copy_infos.swap(copy_infos);
+      batch->fill_infos.swap(fill_infos);
+      batch->inst_create_infos.swap(inst_create_infos);
+      batch->inst_usage_infos.swap(inst_usage_infos);
+      batch->inst_timeline_infos.swap(inst_timeline_infos);
+      batch->partition_infos.swap(partition_infos);
+      batch->message_infos.swap(message_infos);
+      batch->mapper_call_infos.swap(mapper_call_infos);
+      batch->runtime_call_infos.swap(runtime_call_infos);
+#ifdef LEGION_PROF_SELF_PROFILE
+      batch->prof_task_infos.swap(prof_task_infos);
+#endif
+      batch->footprint = footprint;
+      footprint = 0;
+      return batch;
+    }
+
     //--------------------------------------------------------------------------
     LegionProfiler::LegionProfiler(Processor target, const Machine &machine,
                                    Runtime *rt, unsigned num_meta_tasks,
@@ -1164,14 +1366,16 @@ namespace Legion {
                                    const char *prof_logfile,
                                    const size_t total_runtime_instances,
                                    const size_t footprint_threshold,
-                                   const size_t target_latency)
+                                   const size_t target_latency,
+                                   const bool sample)
       : runtime(rt), done_event(Runtime::create_rt_user_event()), 
         output_footprint_threshold(footprint_threshold), 
         output_target_latency(target_latency), target_proc(target), 
+        sampling(sample),
 #ifndef DEBUG_LEGION
         total_outstanding_requests(1/*start with guard*/),
 #endif
-        total_memory_footprint(0)
+        total_memory_footprint(0), sample_stride(1)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_LEGION
@@ -1277,7 +1481,7 @@ namespace Legion {
     LegionProfiler::LegionProfiler(const LegionProfiler &rhs)
       : runtime(NULL), done_event(RtUserEvent::NO_RT_USER_EVENT),
         output_footprint_threshold(0), output_target_latency(0), 
-        target_proc(rhs.target_proc)
+        target_proc(rhs.target_proc), sampling(false)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -1494,6 +1698,17 @@ namespace Legion {
       thread_local_profiling_instance->register_slice_owner(pid, id);
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfiler::register_trace_template(UniqueID op_id,
+                                               TraceID trace_id, unsigned kind)
+    //--------------------------------------------------------------------------
+    {
+      if (thread_local_profiling_instance == NULL)
+        create_thread_local_profiling_instance();
+      thread_local_profiling_instance->register_trace_template(op_id, 
+                                                               trace_id, kind);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfiler::add_task_request(Realm::ProfilingRequestSet &requests,
                                     TaskID tid, VariantID vid, SingleTask *task)
@@ -1899,7 +2114,8 @@ namespace Legion {
             response.get_measurement<
                   Realm::ProfilingMeasurements::OperationEventWaits>(waits);
             // Ignore anything that was predicated false for now
-            if (has_usage)
+            if (has_usage && 
+                sample_record(thread_local_profiling_instance))
               thread_local_profiling_instance->process_meta(info->id, 
                   info->op_id, timeline, usage, waits);
             break;
@@ -1921,7 +2137,8 @@ namespace Legion {
             Realm::ProfilingMeasurements::OperationEventWaits waits;
             response.get_measurement<
                   Realm::ProfilingMeasurements::OperationEventWaits>(waits);
-            if (has_usage)
+            if (has_usage && 
+                sample_record(thread_local_profiling_instance))
               thread_local_profiling_instance->process_message(info->op_id,
                   timeline, usage, waits);
             break;
@@ -2032,11 +2249,146 @@ namespace Legion {
 #endif
       if (!done_event.has_triggered())
         done_event.wait();
+      // Wait for any batches still being written in the background
+      RtEvent flushed;
+      {
+        AutoLock p_lock(profiler_lock);
+        if (!flush_events.empty())
+        {
+          flushed = Runtime::merge_events(flush_events);
+          flush_events.clear();
+        }
+      }
+      if (flushed.exists() && !flushed.has_triggered())
+        flushed.wait();
+      size_t dropped_records = 0;
       for (std::vector<LegionProfInstance*>::const_iterator it = 
             instances.begin(); it != instances.end(); it++) {
         (*it)->dump_state(serializer);
+        dropped_records += (*it)->dropped_records;
       }  
+#ifdef LEGION_LOCK_PROFILING
+      dump_lock_profiles();
+#endif
+      if (dropped_records > 0)
+        REPORT_LEGION_WARNING(LEGION_WARNING_PROFILER_SAMPLED_RECORDS,
+            "The profiler dropped %zd meta-task, message, mapper call, and "
+            "runtime call records by sampling to stay under its memory "
+            "footprint of %zd MB.", dropped_records, 
+            output_footprint_threshold >> 20)
+    }
+
+#ifdef LEGION_LOCK_PROFILING
+    //--------------------------------------------------------------------------
+    void LegionProfiler::dump_lock_profiles(void)
+    //--------------------------------------------------------------------------
+    {
+      // Merge the tables by site name since the same file name can have
+      // a different address in each translation unit, the site IDs are a
+      // hash of the name so they agree across nodes
+      std::map<std::string,LockSiteProfile> merged;
+      std::map<std::string,unsigned> site_ids;
+      // Serializing can take locks so only do it once no table is busy
+      std::vector<LegionProfInstance::LockWaitInfo> wait_infos;
+      unsigned long long dropped_waits = 0;
+      for (LockProfileTable *table = lock_profile_tables; 
+            table != NULL; table = table->next)
+      {
+        while (__sync_lock_test_and_set(&table->busy, 1) != 0)
+          continue;
+        std::vector<unsigned> table_ids(table->sites.size());
+        for (unsigned idx = 0; idx < table->sites.size(); idx++)
+        {
+          const LockSiteProfile &site = table->sites[idx];
+          std::stringstream ss;
+          ss << site.file << ":" << site.line;
+          const std::string name = ss.str();
+          std::map<std::string,LockSiteProfile>::iterator finder =
+            merged.find(name);
+          if (finder == merged.end())
+          {
+            finder = merged.insert(std::make_pair(name, 
+                  LockSiteProfile(site.file, site.line))).first;
+            // FNV-1a
+            unsigned hash = 2166136261U;
+            for (unsigned i = 0; i < name.size(); i++)
+              hash = (hash ^ (unsigned char)name[i]) * 16777619U;
+            site_ids[name] = hash;
+          }
+          LockSiteProfile &total = finder->second;
+          total.acquires += site.acquires;
+          total.exclusive += site.exclusive;
+          total.contended += site.contended;
+          total.total_wait += site.total_wait;
+          total.total_hold += site.total_hold;
+          for (unsigned b = 0; b < LEGION_LOCK_PROFILING_BUCKETS; b++)
+          {
+            total.wait_hist[b] += site.wait_hist[b];
+            total.hold_hist[b] += site.hold_hist[b];
+          }
+          table_ids[idx] = site_ids[name];
+        }
+        for (std::vector<LockWaitRecord>::const_iterator it = 
+              table->waits.begin(); it != table->waits.end(); it++)
+        {
+          wait_infos.push_back(LegionProfInstance::LockWaitInfo());
+          LegionProfInstance::LockWaitInfo &info = wait_infos.back();
+          info.site_id = table_ids[it->site];
+          info.proc_id = it->proc_id;
+          info.start = it->start;
+          info.stop = it->stop;
+        }
+        table->waits.clear();
+        dropped_waits += table->dropped_waits;
+        table->dropped_waits = 0;
+        __sync_lock_release(&table->busy);
+      }
+      for (std::vector<LegionProfInstance::LockWaitInfo>::const_iterator it =
+            wait_infos.begin(); it != wait_infos.end(); it++)
+        serializer->serialize(*it);
+      for (std::map<std::string,LockSiteProfile>::const_iterator it = 
+            merged.begin(); it != merged.end(); it++)
+      {
+        const unsigned site_id = site_ids[it->first];
+        LegionProfInstance::LockSiteDesc desc;
+        desc.site_id = site_id;
+        desc.name = it->first.c_str();
+        serializer->serialize(desc);
+        LegionProfInstance::LockStatsInfo stats;
+        stats.site_id = site_id;
+        stats.acquires = it->second.acquires;
+        stats.exclusive = it->second.exclusive;
+        stats.contended = it->second.contended;
+        stats.total_wait = it->second.total_wait;
+        stats.total_hold = it->second.total_hold;
+        serializer->serialize(stats);
+        for (unsigned b = 0; b < LEGION_LOCK_PROFILING_BUCKETS; b++)
+        {
+          LegionProfInstance::LockHistInfo hist;
+          hist.site_id = site_id;
+          hist.bucket = b;
+          if (it->second.wait_hist[b] > 0)
+          {
+            hist.kind = 0;
+            hist.count = it->second.wait_hist[b];
+            serializer->serialize(hist);
+          }
+          if (it->second.hold_hist[b] > 0)
+          {
+            hist.kind = 1;
+            hist.count = it->second.hold_hist[b];
+            serializer->serialize(hist);
+          }
+        }
+      }
+      if (dropped_waits > 0)
+        REPORT_LEGION_WARNING(LEGION_WARNING_LOCK_PROFILING_DROPPED_WAITS,
+            "Lock profiling dropped %llu contended lock waits from the "
+            "timelines after each thread recorded %d of them. These waits "
+            "are still included in the lock statistics.", dropped_waits,
+            LEGION_LOCK_PROFILING_MAX_WAITS)
     }
+#endif
 
     //--------------------------------------------------------------------------
     void LegionProfiler::record_instance_creation(PhysicalInstance inst,
@@ -2062,6 +2414,31 @@ namespace Legion {
       }
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfiler::record_message_channel(AddressSpaceID target,
+                            VirtualChannelKind kind, unsigned long long messages,
+                            unsigned long long active_messages,
+                            unsigned long long bytes)
+    //--------------------------------------------------------------------------
+    {
+      VIRTUAL_CHANNEL_DESCRIPTIONS(channel_names);
+      LegionProfDesc::MessageChannelDesc chan_desc;
+      chan_desc.source = runtime->address_space;
+      chan_desc.target = target;
+      chan_desc.kind = kind;
+      chan_desc.messages = messages;
+      chan_desc.active_messages = active_messages;
+      chan_desc.bytes = bytes;
+      chan_desc.name = channel_names[kind];
+      if (!serializer->is_thread_safe())
+      {
+        AutoLock p_lock(profiler_lock);
+        serializer->serialize(chan_desc);
+      }
+      else
+        serializer->serialize(chan_desc);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfiler::record_message(MessageKind kind, 
                                         unsigned long long start,
@@ -2071,6 +2448,8 @@ namespace Legion {
       Processor current = Processor::get_executing_processor();
       if (thread_local_profiling_instance == NULL)
         create_thread_local_profiling_instance();
+      if (!sample_record(thread_local_profiling_instance))
+        return;
       thread_local_profiling_instance->record_message(current, kind, 
                                                       start, stop);
     }
@@ -2097,6 +2476,8 @@ namespace Legion {
       Processor current = Processor::get_executing_processor();
       if (thread_local_profiling_instance == NULL)
         create_thread_local_profiling_instance();
+      if (!sample_record(thread_local_profiling_instance))
+        return;
       thread_local_profiling_instance->record_mapper_call(current, kind, uid, 
                                                    start, stop);
     }
@@ -2123,6 +2504,8 @@ namespace Legion {
       Processor current = Processor::get_executing_processor();
       if (thread_local_profiling_instance == NULL)
         create_thread_local_profiling_instance();
+      if (!sample_record(thread_local_profiling_instance))
+        return;
       thread_local_profiling_instance->record_runtime_call(current, kind, 
                                                            start, stop);
     }
@@ -2188,41 +2571,138 @@ namespace Legion {
     void LegionProfiler::update_footprint(size_t diff, LegionProfInstance *inst)
     //--------------------------------------------------------------------------
     {
-      size_t footprint = __sync_add_and_fetch(&total_memory_footprint, diff);
+      // Records are buffered in the thread-local instance without any
+      // synchronization until the buffer is full, at which point the whole
+      // batch is handed off to a meta-task to be written out
+      inst->footprint += diff;
+      if ((inst->footprint < LEGION_PROF_THREAD_BUFFER_SIZE) &&
+          (inst->footprint < output_footprint_threshold))
+        return;
+      LegionProfInstance *batch = inst->extract_records();
+      size_t batch_footprint = batch->footprint;
+      const size_t footprint = 
+        __sync_add_and_fetch(&total_memory_footprint, batch_footprint);
       if (footprint > output_footprint_threshold)
       {
-        // An important bit of logic here, if we're over the threshold then
-        // we want to have a little bit of a feedback loop so the more over
-        // the limit we are then the more time we give the profiler to dump
-        // out things to the output file. We'll try to make this continuous
-        // so there are no discontinuities in performance. If the threshold
-        // is zero we'll just choose an arbitrarily large scale factor to 
-        // ensure that things work properly.
-        double over_scale = output_footprint_threshold == 0 ? double(1 << 20) :
-                        double(footprint) / double(output_footprint_threshold);
-        // Let's actually make this quadratic so it's not just linear
-        if (output_footprint_threshold > 0)
-          over_scale *= over_scale;
-        if (!serializer->is_thread_safe())
+        if (sampling)
         {
-          // Need a lock to protect the serializer
-          AutoLock p_lock(profiler_lock);
-          diff = inst->dump_inter(serializer, over_scale);
+          // Rather than stalling this thread, start dropping more of the
+          // high-volume records until the writers catch up
+          const unsigned stride = sample_stride;
+          if (stride < (1U << 16))
+            __sync_bool_compare_and_swap(&sample_stride, stride, 2*stride);
         }
         else
-          diff = inst->dump_inter(serializer, over_scale);
+        {
+          // An important bit of logic here, if we're over the threshold then
+          // we want to have a little bit of a feedback loop so the more over
+          // the limit we are then the more time we give the profiler to dump
+          // out things to the output file. We'll try to make this continuous
+          // so there are no discontinuities in performance. If the threshold
+          // is zero we'll just choose an arbitrarily large scale factor to 
+          // ensure that things work properly.
+          double over_scale = output_footprint_threshold == 0 ? 
+            double(1 << 20) :
+            double(footprint) / double(output_footprint_threshold);
+          // Let's actually make this quadratic so it's not just linear
+          if (output_footprint_threshold > 0)
+            over_scale *= over_scale;
+          size_t dumped = 0;
+          if (!serializer->is_thread_safe())
+          {
+            // Need a lock to protect the serializer
+            AutoLock p_lock(profiler_lock);
+            dumped = batch->dump_inter(serializer, over_scale);
+          }
+          else
+            dumped = batch->dump_inter(serializer, over_scale);
+          if (dumped > batch_footprint)
+            dumped = batch_footprint;
+          batch_footprint -= dumped;
 #ifdef DEBUG_LEGION
 #ifndef NDEBUG
-        footprint = 
+          const size_t previous =
 #endif
 #endif
-          __sync_fetch_and_sub(&total_memory_footprint, diff);
+            __sync_fetch_and_sub(&total_memory_footprint, dumped);
 #ifdef DEBUG_LEGION
-        assert(footprint >= diff); // check for wrap-around
+          assert(previous >= dumped); // check for wrap-around
 #endif
+        }
+      }
+      if (batch_footprint == 0)
+      {
+        // Everything was already written out above
+        delete batch;
+        return;
+      }
+      // Write out whatever is left of the batch in the background
+      ProfilerFlushArgs args(this, batch, batch_footprint);
+      const RtEvent flushed = 
+        runtime->issue_runtime_meta_task(args, LG_LOW_PRIORITY);
+      AutoLock p_lock(profiler_lock);
+      // Prune any events for batches that are already done
+      if (flush_events.size() >= 32)
+      {
+        std::set<RtEvent> pending;
+        for (std::set<RtEvent>::const_iterator it = 
+              flush_events.begin(); it != flush_events.end(); it++)
+          if (!it->has_triggered())
+            pending.insert(*it);
+        flush_events.swap(pending);
+      }
+      flush_events.insert(flushed);
+    }
+
+    //--------------------------------------------------------------------------
+    bool LegionProfiler::sample_record(LegionProfInstance *inst)
+    //--------------------------------------------------------------------------
+    {
+      const unsigned stride = sample_stride;
+      if (stride == 1)
+        return true;
+      if ((++inst->sample_count % stride) == 0)
+        return true;
+      inst->dropped_records++;
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfiler::flush_batch(LegionProfInstance *batch, 
+                                     size_t batch_footprint)
+    //--------------------------------------------------------------------------
+    {
+      if (!serializer->is_thread_safe())
+      {
+        AutoLock p_lock(profiler_lock);
+        batch->dump_state(serializer);
+      }
+      else
+        batch->dump_state(serializer);
+      delete batch;
+      const size_t previous = 
+        __sync_fetch_and_sub(&total_memory_footprint, batch_footprint);
+#ifdef DEBUG_LEGION
+      assert(previous >= batch_footprint); // check for wrap-around
+#endif
+      // Once the writers have caught up we can start keeping more records
+      if (sampling && 
+          ((previous - batch_footprint) < (output_footprint_threshold / 2)))
+      {
+        const unsigned stride = sample_stride;
+        if (stride > 1)
+          __sync_bool_compare_and_swap(&sample_stride, stride, stride / 2);
       }
     }
 
+    //--------------------------------------------------------------------------
+    /*static*/ void LegionProfiler::handle_flush(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const ProfilerFlushArgs *fargs = (const ProfilerFlushArgs*)args;
+      fargs->profiler->flush_batch(fargs->batch, fargs->footprint);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfiler::create_thread_local_profiling_instance(void)
     //--------------------------------------------------------------------------
@@ -107,6 +107,13 @@ namespace Legion {
       struct MaxDimDesc {
 	unsigned max_dim;
       };
+      struct MessageChannelDesc {
+      public:
+        AddressSpaceID source, target;
+        unsigned kind;
+        unsigned long long messages, active_messages, bytes;
+        const char *name;
+      };
     };
 
     class LegionProfInstance {
@@ -138,6 +145,36 @@ namespace Legion {
         UniqueID parent_id;
         UniqueID op_id;
       };
+      struct TraceTemplateInfo {
+      public:
+        UniqueID op_id;
+        TraceID trace_id;
+        unsigned kind;
+      };
+      struct LockSiteDesc {
+      public:
+        unsigned site_id;
+        const char *name;
+      };
+      struct LockStatsInfo {
+      public:
+        unsigned site_id;
+        unsigned long long acquires, exclusive, contended;
+        unsigned long long total_wait, total_hold; // nanoseconds
+      };
+      struct LockHistInfo {
+      public:
+        unsigned site_id;
+        unsigned kind; // 0 for wait times, 1 for hold times
+        unsigned bucket;
+        unsigned long long count;
+      };
+      struct LockWaitInfo {
+      public:
+        unsigned site_id;
+        ProcID proc_id;
+        timestamp_t start, stop;
+      };
       struct WaitInfo {
       public:
         timestamp_t wait_start, wait_ready, wait_end;
@@ -321,6 +358,8 @@ namespace Legion {
       void register_operation(Operation *op);
       void register_multi_task(Operation *op, TaskID kind);
       void register_slice_owner(UniqueID pid, UniqueID id);
+      void register_trace_template(UniqueID op_id, TraceID trace_id,
+                                   unsigned kind);
       void register_index_space_rect(IndexSpaceRectDesc
 				     &ispace_rect_desc);
       void register_index_space_point(IndexSpacePointDesc
@@ -390,6 +429,14 @@ namespace Legion {
     public:
       void dump_state(LegionProfSerializer *serializer);
       size_t dump_inter(LegionProfSerializer *serializer, const double over);
+      // Move all the buffered records into a new instance so they can
+      // be written out by another thread
+      LegionProfInstance* extract_records(void);
+    public:
+      // These are only touched by the thread that owns this instance
+      size_t footprint;
+      unsigned sample_count;
+      size_t dropped_records;
     private:
       LegionProfiler *const owner;
       std::deque<TaskKind>          task_kinds;
@@ -397,6 +444,7 @@ namespace Legion {
       std::deque<OperationInstance> operation_instances;
       std::deque<MultiTask>         multi_tasks;
       std::deque<SliceOwner>        slice_owners;
+      std::deque<TraceTemplateInfo> trace_templates;
     private:
       std::deque<TaskInfo> task_infos;
       std::deque<GPUTaskInfo> gpu_task_infos;
@@ -451,6 +499,18 @@ namespace Legion {
         size_t id, id2;
         UniqueID op_id;
       };
+      struct ProfilerFlushArgs : public LgTaskArgs<ProfilerFlushArgs> {
+      public:
+        static const LgTaskID TASK_ID = LG_PROFILER_FLUSH_TASK_ID;
+      public:
+        ProfilerFlushArgs(LegionProfiler *p, LegionProfInstance *b, size_t f)
+          : LgTaskArgs<ProfilerFlushArgs>(0), profiler(p), 
+            batch(b), footprint(f) { }
+      public:
+        LegionProfiler *const profiler;
+        LegionProfInstance *const batch;
+        const size_t footprint;
+      };
     public:
       // Statically known information passed through the constructor
       // so that it can be deduplicated
@@ -463,7 +523,8 @@ namespace Legion {
                      const char *prof_logname,
                      const size_t total_runtime_instances,
                      const size_t footprint_threshold,
-                     const size_t target_latency);
+                     const size_t target_latency,
+                     const bool sampling);
       LegionProfiler(const LegionProfiler &rhs);
       virtual ~LegionProfiler(void);
     public:
@@ -480,6 +541,9 @@ namespace Legion {
       void register_operation(Operation *op);
       void register_multi_task(Operation *op, TaskID task_id);
       void register_slice_owner(UniqueID pid, UniqueID id);
+      // Traces
+      void register_trace_template(UniqueID op_id, TraceID trace_id,
+                                   unsigned kind);
     public:
       void add_task_request(Realm::ProfilingRequestSet &requests, 
                             TaskID tid, VariantID vid, SingleTask *task);
@@ -548,6 +612,11 @@ namespace Legion {
                                 unsigned int num_message_kinds);
       void record_message(MessageKind kind, timestamp_t start,
                           timestamp_t stop);
+      void record_message_channel(AddressSpaceID target, 
+                                  VirtualChannelKind kind,
+                                  unsigned long long messages,
+                                  unsigned long long active_messages,
+                                  unsigned long long bytes);
     public:
       void record_mapper_call_kinds(const char *const *const mapper_call_names,
                                     unsigned int num_mapper_call_kinds);
@@ -570,8 +639,14 @@ namespace Legion {
 #endif
     public:
       void update_footprint(size_t diff, LegionProfInstance *inst);
+      bool sample_record(LegionProfInstance *inst);
+      void flush_batch(LegionProfInstance *batch, size_t footprint);
+      static void handle_flush(const void *args);
     private:
       void create_thread_local_profiling_instance(void);
+#ifdef LEGION_LOCK_PROFILING
+      void dump_lock_profiles(void);
+#endif
     public:
       Runtime *const runtime;
       // Event to trigger once the profiling is actually done
@@ -582,10 +657,14 @@ namespace Legion {
       const long long output_target_latency;
       // Target processor on which to launch jobs
       const Processor target_proc;
+      // Whether to sample records rather than block when over the footprint
+      const bool sampling;
     private:
       LegionProfSerializer* serializer;
       mutable LocalLock profiler_lock;
       std::vector<LegionProfInstance*> instances;
+      // Events for batches of records being written in the background
+      std::set<RtEvent> flush_events;
 #ifdef DEBUG_LEGION
       unsigned total_outstanding_requests[LEGION_PROF_LAST];
 #else
@@ -594,6 +673,8 @@ namespace Legion {
     private:
       // For knowing when we need to start dumping early
       size_t total_memory_footprint;
+      // Keep one out of every sample_stride of the high-volume records
+      unsigned sample_stride;
     public:
       void record_index_space_point_desc(
           LegionProfInstance::IndexSpacePointDesc &i);
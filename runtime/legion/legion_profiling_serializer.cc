@@ -89,6 +89,21 @@ namespace Legion {
          << "max_dim:maxdim:" << sizeof(unsigned)
          << "}" << std::endl;
 
+      ss << "MessageChannelDesc {"
+         << "id:" << MESSAGE_CHANNEL_DESC_ID                         << delim
+         << "source:unsigned:"             << sizeof(AddressSpaceID) << delim
+         << "target:unsigned:"             << sizeof(AddressSpaceID) << delim
+         << "kind:unsigned:"               << sizeof(unsigned)       << delim
+         << "messages:unsigned long long:" << sizeof(unsigned long long)
+                                                                     << delim
+         << "active_messages:unsigned long long:" 
+                                           << sizeof(unsigned long long)
+                                                                     << delim
+         << "bytes:unsigned long long:"    << sizeof(unsigned long long)
+                                                                     << delim
+         << "name:string:" << "-1"
+         << "}" << std::endl;
+
       ss << "MemDesc {" 
          << "id:" << MEM_DESC_ID                               << delim
          << "mem_id:MemID:"                << sizeof(MemID)    << delim
@@ -218,6 +233,51 @@ namespace Legion {
          << "op_id:UniqueID:"     << sizeof(UniqueID)
          << "}" << std::endl;
 
+      ss << "TraceTemplateInfo {"
+         << "id:" << TRACE_TEMPLATE_INFO_ID           << delim
+         << "op_id:UniqueID:"     << sizeof(UniqueID) << delim
+         << "trace_id:TraceID:"   << sizeof(TraceID)  << delim
+         << "kind:unsigned:"      << sizeof(unsigned)
+         << "}" << std::endl;
+
+      ss << "LockSiteDesc {"
+         << "id:" << LOCK_SITE_DESC_ID              << delim
+         << "site_id:unsigned:" << sizeof(unsigned) << delim
+         << "name:string:" << "-1"
+         << "}" << std::endl;
+
+      ss << "LockStatsInfo {"
+         << "id:" << LOCK_STATS_INFO_ID                          << delim
+         << "site_id:unsigned:"     << sizeof(unsigned)           << delim
+         << "acquires:unsigned long long:" 
+                                    << sizeof(unsigned long long) << delim
+         << "exclusive:unsigned long long:" 
+                                    << sizeof(unsigned long long) << delim
+         << "contended:unsigned long long:" 
+                                    << sizeof(unsigned long long) << delim
+         << "total_wait:unsigned long long:" 
+                                    << sizeof(unsigned long long) << delim
+         << "total_hold:unsigned long long:" 
+                                    << sizeof(unsigned long long)
+         << "}" << std::endl;
+
+      ss << "LockHistInfo {"
+         << "id:" << LOCK_HIST_INFO_ID                           << delim
+         << "site_id:unsigned:"     << sizeof(unsigned)           << delim
+         << "kind:unsigned:"        << sizeof(unsigned)           << delim
+         << "bucket:unsigned:"      << sizeof(unsigned)           << delim
+         << "count:unsigned long long:" 
+                                    << sizeof(unsigned long long)
+         << "}" << std::endl;
+
+      ss << "LockWaitInfo {"
+         << "id:" << LOCK_WAIT_INFO_ID                    << delim
+         << "site_id:unsigned:"  << sizeof(unsigned)      << delim
+         << "proc_id:ProcID:"    << sizeof(ProcID)        << delim
+         << "start:timestamp_t:" << sizeof(timestamp_t)   << delim
+         << "stop:timestamp_t:"  << sizeof(timestamp_t)
+         << "}" << std::endl;
+
       ss << "TaskWaitInfo {"
          << "id:" << TASK_WAIT_INFO_ID                       << delim
          << "op_id:UniqueID:"         << sizeof(UniqueID)    << delim
@@ -453,6 +513,24 @@ namespace Legion {
 		sizeof(max_dim_desc.max_dim));
 
     }
+
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                            const LegionProfDesc::MessageChannelDesc& chan_desc)
+    //--------------------------------------------------------------------------
+    {
+      int ID = MESSAGE_CHANNEL_DESC_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(chan_desc.source), sizeof(chan_desc.source));
+      lp_fwrite(f, (char*)&(chan_desc.target), sizeof(chan_desc.target));
+      lp_fwrite(f, (char*)&(chan_desc.kind), sizeof(chan_desc.kind));
+      lp_fwrite(f, (char*)&(chan_desc.messages), sizeof(chan_desc.messages));
+      lp_fwrite(f, (char*)&(chan_desc.active_messages),
+                sizeof(chan_desc.active_messages));
+      lp_fwrite(f, (char*)&(chan_desc.bytes), sizeof(chan_desc.bytes));
+      lp_fwrite(f, chan_desc.name, strlen(chan_desc.name) + 1);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfBinarySerializer::serialize(
                                         const LegionProfDesc::MemDesc& mem_desc)
@@ -705,6 +783,74 @@ namespace Legion {
       lp_fwrite(f, (char*)&(slice_owner.op_id), sizeof(slice_owner.op_id));
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                        const LegionProfInstance::TraceTemplateInfo& trace_info)
+    //--------------------------------------------------------------------------
+    {
+      int ID = TRACE_TEMPLATE_INFO_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(trace_info.op_id), sizeof(trace_info.op_id));
+      lp_fwrite(f, (char*)&(trace_info.trace_id), sizeof(trace_info.trace_id));
+      lp_fwrite(f, (char*)&(trace_info.kind), sizeof(trace_info.kind));
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                              const LegionProfInstance::LockSiteDesc& site_desc)
+    //--------------------------------------------------------------------------
+    {
+      int ID = LOCK_SITE_DESC_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(site_desc.site_id), sizeof(site_desc.site_id));
+      lp_fwrite(f, site_desc.name, strlen(site_desc.name) + 1);
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                            const LegionProfInstance::LockStatsInfo& lock_stats)
+    //--------------------------------------------------------------------------
+    {
+      int ID = LOCK_STATS_INFO_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(lock_stats.site_id), sizeof(lock_stats.site_id));
+      lp_fwrite(f, (char*)&(lock_stats.acquires), sizeof(lock_stats.acquires));
+      lp_fwrite(f, (char*)&(lock_stats.exclusive), 
+                sizeof(lock_stats.exclusive));
+      lp_fwrite(f, (char*)&(lock_stats.contended), 
+                sizeof(lock_stats.contended));
+      lp_fwrite(f, (char*)&(lock_stats.total_wait), 
+                sizeof(lock_stats.total_wait));
+      lp_fwrite(f, (char*)&(lock_stats.total_hold), 
+                sizeof(lock_stats.total_hold));
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                              const LegionProfInstance::LockHistInfo& lock_hist)
+    //--------------------------------------------------------------------------
+    {
+      int ID = LOCK_HIST_INFO_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(lock_hist.site_id), sizeof(lock_hist.site_id));
+      lp_fwrite(f, (char*)&(lock_hist.kind), sizeof(lock_hist.kind));
+      lp_fwrite(f, (char*)&(lock_hist.bucket), sizeof(lock_hist.bucket));
+      lp_fwrite(f, (char*)&(lock_hist.count), sizeof(lock_hist.count));
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfBinarySerializer::serialize(
+                              const LegionProfInstance::LockWaitInfo& lock_wait)
+    //--------------------------------------------------------------------------
+    {
+      int ID = LOCK_WAIT_INFO_ID;
+      lp_fwrite(f, (char*)&ID, sizeof(ID));
+      lp_fwrite(f, (char*)&(lock_wait.site_id), sizeof(lock_wait.site_id));
+      lp_fwrite(f, (char*)&(lock_wait.proc_id), sizeof(lock_wait.proc_id));
+      lp_fwrite(f, (char*)&(lock_wait.start), sizeof(lock_wait.start));
+      lp_fwrite(f, (char*)&(lock_wait.stop), sizeof(lock_wait.stop));
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfBinarySerializer::serialize(
                                   const LegionProfInstance::WaitInfo wait_info, 
@@ -1405,6 +1551,17 @@ namespace Legion {
                      max_dim_desc.max_dim);
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                            const LegionProfDesc::MessageChannelDesc &chan_desc)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Message Channel Desc %d %d %u %llu %llu %llu %s",
+                     chan_desc.source, chan_desc.target, chan_desc.kind,
+                     chan_desc.messages, chan_desc.active_messages,
+                     chan_desc.bytes, chan_desc.name);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfASCIISerializer::serialize(
                                         const LegionProfDesc::MemDesc &mem_desc)
@@ -1467,6 +1624,54 @@ namespace Legion {
                       slice_owner.parent_id, slice_owner.op_id);
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                        const LegionProfInstance::TraceTemplateInfo& trace_info)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Trace Template %llu %u %u", trace_info.op_id,
+                      trace_info.trace_id, trace_info.kind);
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                              const LegionProfInstance::LockSiteDesc& site_desc)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Lock Site Desc %u %s", site_desc.site_id,
+                      site_desc.name);
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                            const LegionProfInstance::LockStatsInfo& lock_stats)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Lock Stats %u %llu %llu %llu %llu %llu",
+                      lock_stats.site_id, lock_stats.acquires, 
+                      lock_stats.exclusive, lock_stats.contended,
+                      lock_stats.total_wait, lock_stats.total_hold);
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                              const LegionProfInstance::LockHistInfo& lock_hist)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Lock Histogram %u %u %u %llu", lock_hist.site_id,
+                      lock_hist.kind, lock_hist.bucket, lock_hist.count);
+    }
+
+    //--------------------------------------------------------------------------
+    void LegionProfASCIISerializer::serialize(
+                              const LegionProfInstance::LockWaitInfo& lock_wait)
+    //--------------------------------------------------------------------------
+    {
+      log_prof.print("Prof Lock Wait Info %u " IDFMT " %llu %llu",
+                      lock_wait.site_id, lock_wait.proc_id, 
+                      lock_wait.start, lock_wait.stop);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfASCIISerializer::serialize(
                                   const LegionProfInstance::WaitInfo wait_info, 
@@ -52,6 +52,7 @@ namespace Legion {
       virtual void serialize(const LegionProfDesc::MemDesc&) = 0;
       virtual void serialize(const LegionProfDesc::ProcMemDesc&) = 0;
       virtual void serialize(const LegionProfDesc::MaxDimDesc&) = 0;
+      virtual void serialize(const LegionProfDesc::MessageChannelDesc&) = 0;
       virtual void serialize(const LegionProfInstance::IndexSpacePointDesc&) = 0;
       virtual void serialize(const LegionProfInstance::IndexSpaceRectDesc&) = 0;
       virtual void serialize(const LegionProfInstance::IndexSpaceEmptyDesc&) = 0;
@@ -69,6 +70,11 @@ namespace Legion {
       virtual void serialize(const LegionProfInstance::OperationInstance&) = 0;
       virtual void serialize(const LegionProfInstance::MultiTask&) = 0;
       virtual void serialize(const LegionProfInstance::SliceOwner&) = 0;
+      virtual void serialize(const LegionProfInstance::TraceTemplateInfo&) = 0;
+      virtual void serialize(const LegionProfInstance::LockSiteDesc&) = 0;
+      virtual void serialize(const LegionProfInstance::LockStatsInfo&) = 0;
+      virtual void serialize(const LegionProfInstance::LockHistInfo&) = 0;
+      virtual void serialize(const LegionProfInstance::LockWaitInfo&) = 0;
       virtual void serialize(const LegionProfInstance::WaitInfo,
                              const LegionProfInstance::TaskInfo&) = 0;
       virtual void serialize(const LegionProfInstance::WaitInfo,
@@ -111,6 +117,7 @@ namespace Legion {
       void serialize(const LegionProfDesc::MemDesc&);
       void serialize(const LegionProfDesc::ProcMemDesc&);
       void serialize(const LegionProfDesc::MaxDimDesc&);
+      void serialize(const LegionProfDesc::MessageChannelDesc&);
       void serialize(const LegionProfInstance::IndexSpacePointDesc&);
       void serialize(const LegionProfInstance::IndexSpaceRectDesc&);
       void serialize(const LegionProfInstance::IndexSpaceEmptyDesc&);
@@ -128,6 +135,11 @@ namespace Legion {
       void serialize(const LegionProfInstance::OperationInstance&);
       void serialize(const LegionProfInstance::MultiTask&);
       void serialize(const LegionProfInstance::SliceOwner&);
+      void serialize(const LegionProfInstance::TraceTemplateInfo&);
+      void serialize(const LegionProfInstance::LockSiteDesc&);
+      void serialize(const LegionProfInstance::LockStatsInfo&);
+      void serialize(const LegionProfInstance::LockHistInfo&);
+      void serialize(const LegionProfInstance::LockWaitInfo&);
       void serialize(const LegionProfInstance::WaitInfo,
                      const LegionProfInstance::TaskInfo&);
       void serialize(const LegionProfInstance::WaitInfo,
@@ -196,6 +208,12 @@ namespace Legion {
 	LOGICAL_REGION_ID,
 	PHYSICAL_INST_REGION_ID,
 	PHYSICAL_INST_LAYOUT_ID,
+        MESSAGE_CHANNEL_DESC_ID,
+        TRACE_TEMPLATE_INFO_ID,
+        LOCK_SITE_DESC_ID,
+        LOCK_STATS_INFO_ID,
+        LOCK_HIST_INFO_ID,
+        LOCK_WAIT_INFO_ID,
 #ifdef LEGION_PROF_SELF_PROFILE
         PROFTASK_INFO_ID
 #endif
@@ -219,6 +237,7 @@ namespace Legion {
       void serialize(const LegionProfDesc::MemDesc&);
       void serialize(const LegionProfDesc::ProcMemDesc&);
       void serialize(const LegionProfDesc::MaxDimDesc&);
+      void serialize(const LegionProfDesc::MessageChannelDesc&);
       void serialize(const LegionProfInstance::IndexSpacePointDesc&);
       void serialize(const LegionProfInstance::IndexSpaceRectDesc&);
       void serialize(const LegionProfInstance::IndexSpaceEmptyDesc&);
@@ -236,6 +255,11 @@ namespace Legion {
       void serialize(const LegionProfInstance::OperationInstance&);
       void serialize(const LegionProfInstance::MultiTask&);
       void serialize(const LegionProfInstance::SliceOwner&);
+      void serialize(const LegionProfInstance::TraceTemplateInfo&);
+      void serialize(const LegionProfInstance::LockSiteDesc&);
+      void serialize(const LegionProfInstance::LockStatsInfo&);
+      void serialize(const LegionProfInstance::LockHistInfo&);
+      void serialize(const LegionProfInstance::LockWaitInfo&);
       void serialize(const LegionProfInstance::WaitInfo,
                      const LegionProfInstance::TaskInfo&);
       void serialize(const LegionProfInstance::WaitInfo,
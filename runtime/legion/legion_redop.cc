@@ -163,6 +163,225 @@ namespace Legion {
       REGISTER_BUILTIN_REDOP(LEGION_REDOP_MIN_FLOAT32, MinReduction<float>);
       REGISTER_BUILTIN_REDOP(LEGION_REDOP_MIN_FLOAT64, MinReduction<double>);
     }
+
+    namespace BulkReduction {
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define LEGION_SIMD_REDUCTIONS
+#define LEGION_SIMD_INLINE inline __attribute__((always_inline))
+
+      // Element-wise operators written once for both scalars and GCC vector
+      // types, so that the vector loops and their scalar tails compute
+      // exactly what REDOP::apply<true>/fold<true> would.  'active' marks
+      // the lanes for which a non-exclusive update could change the target.
+      struct SumOp {
+        template<typename V> static LEGION_SIMD_INLINE
+          void combine(V &lhs, const V &rhs) { lhs = lhs + rhs; }
+        template<typename M, typename V> static LEGION_SIMD_INLINE
+          void active(M &mask, const V &lhs, const V &rhs) { mask = (rhs != 0); }
+      };
+
+      struct ProdOp {
+        template<typename V> static LEGION_SIMD_INLINE
+          void combine(V &lhs, const V &rhs) { lhs = lhs * rhs; }
+        template<typename M, typename V> static LEGION_SIMD_INLINE
+          void active(M &mask, const V &lhs, const V &rhs) { mask = (rhs != 1); }
+      };
+
+      struct MaxOp {
+        template<typename V> static LEGION_SIMD_INLINE
+          void combine(V &lhs, const V &rhs) { lhs = (rhs > lhs) ? rhs : lhs; }
+        template<typename M, typename V> static LEGION_SIMD_INLINE
+          void active(M &mask, const V &lhs, const V &rhs) { mask = (rhs > lhs); }
+      };
+
+      struct MinOp {
+        template<typename V> static LEGION_SIMD_INLINE
+          void combine(V &lhs, const V &rhs) { lhs = (rhs < lhs) ? rhs : lhs; }
+        template<typename M, typename V> static LEGION_SIMD_INLINE
+          void active(M &mask, const V &lhs, const V &rhs) { mask = (rhs < lhs); }
+      };
+
+      template<size_t BYTES> struct LaneMask;
+      template<> struct LaneMask<4> { typedef int32_t type; };
+      template<> struct LaneMask<8> { typedef int64_t type; };
+
+      template<typename T, int BYTES, typename OP>
+      static LEGION_SIMD_INLINE void exclusive_loop(T *lhs, const T *rhs,
+                                                    size_t count)
+      {
+        typedef T V __attribute__((vector_size(BYTES)));
+        // instances make no alignment promises beyond the element size
+        struct __attribute__((packed, may_alias)) U { V v; };
+        const size_t lanes = BYTES / sizeof(T);
+        size_t i = 0;
+        for ( ; (i + lanes) <= count; i += lanes)
+        {
+          V v = reinterpret_cast<U*>(lhs + i)->v;
+          OP::combine(v, reinterpret_cast<const U*>(rhs + i)->v);
+          reinterpret_cast<U*>(lhs + i)->v = v;
+        }
+        for ( ; i < count; i++)
+          OP::combine(lhs[i], rhs[i]);
+      }
+
+      // Other threads may be updating the target concurrently, so every
+      // change still has to go through the atomic REDOP::apply/fold<false>,
+      // but a whole vector of lanes that cannot change the target (a zero
+      // added to an integer, a value below the current maximum, ...) can be
+      // skipped without touching the target's cache lines exclusively.
+      template<typename REDOP, int BYTES, typename OP, bool FOLD>
+      static LEGION_SIMD_INLINE void shared_loop(typename REDOP::RHS *lhs,
+                                                 const typename REDOP::RHS *rhs,
+                                                 size_t count)
+      {
+        typedef typename REDOP::RHS T;
+        typedef T V __attribute__((vector_size(BYTES)));
+        typedef typename LaneMask<sizeof(T)>::type M
+          __attribute__((vector_size(BYTES)));
+        struct __attribute__((packed, may_alias)) U { V v; };
+        const size_t lanes = BYTES / sizeof(T);
+        for (size_t i = 0; i < count; i += lanes)
+        {
+          const size_t todo = std::min(lanes, count - i);
+          if (todo == lanes)
+          {
+            M mask;
+            OP::active(mask, reinterpret_cast<const U*>(lhs + i)->v,
+                       reinterpret_cast<const U*>(rhs + i)->v);
+            bool any = false;
+            for (size_t j = 0; j < lanes; j++)
+              if (mask[j])
+              {
+                any = true;
+                break;
+              }
+            if (!any)
+              continue;
+          }
+          for (size_t j = 0; j < todo; j++)
+          {
+            if (FOLD)
+              REDOP::template fold<false>(lhs[i+j], rhs[i+j]);
+            else
+              REDOP::template apply<false>(lhs[i+j], rhs[i+j]);
+          }
+        }
+      }
+
+#define LEGION_SIMD_VARIANT(name, isa, bytes)                               \
+      template<typename REDOP, typename OP, bool FOLD>                      \
+      __attribute__((target(isa)))                                          \
+      static void name(typename REDOP::RHS *lhs,                            \
+                       const typename REDOP::RHS *rhs,                      \
+                       size_t count, bool exclusive)                        \
+      {                                                                     \
+        if (exclusive)                                                      \
+          exclusive_loop<typename REDOP::RHS, bytes, OP>(lhs, rhs, count);  \
+        else                                                                \
+          shared_loop<REDOP, bytes, OP, FOLD>(lhs, rhs, count);             \
+      }
+
+      LEGION_SIMD_VARIANT(bulk_sse2, "sse2", 16)
+      LEGION_SIMD_VARIANT(bulk_avx2, "avx2", 32)
+      LEGION_SIMD_VARIANT(bulk_avx512, "avx512f", 64)
+
+#undef LEGION_SIMD_VARIANT
+
+      static int detect_vector_bytes(void)
+      {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+          return 64;
+        if (__builtin_cpu_supports("avx2"))
+          return 32;
+        return 16; // SSE2 is part of x86-64
+      }
+#endif
+
+      // below this many elements the per-element loop is just as good
+      static const size_t MIN_BULK_ELEMENTS = 16;
+
+      template<typename REDOP, typename OP, bool FOLD>
+      static bool bulk_reduce(typename REDOP::RHS *lhs,
+                              const typename REDOP::RHS *rhs,
+                              size_t count, bool exclusive, bool can_filter)
+      {
+#ifdef LEGION_SIMD_REDUCTIONS
+        if (count < MIN_BULK_ELEMENTS)
+          return false;
+        // without a filter the shared loop is the per-element loop
+        if (!exclusive && !can_filter)
+          return false;
+        static const int vector_bytes = detect_vector_bytes();
+        switch (vector_bytes)
+        {
+          case 64:
+            bulk_avx512<REDOP,OP,FOLD>(lhs, rhs, count, exclusive);
+            break;
+          case 32:
+            bulk_avx2<REDOP,OP,FOLD>(lhs, rhs, count, exclusive);
+            break;
+          default:
+            bulk_sse2<REDOP,OP,FOLD>(lhs, rhs, count, exclusive);
+            break;
+        }
+        return true;
+#else
+        return false;
+#endif
+      }
+
+    }; // namespace BulkReduction
   }; // namespace Internal
 }; // namespace Legion
 
+namespace Realm {
+
+  // lhs and rhs types are the same for all of these, so apply and fold
+  // share kernels; 'filter' says whether the non-exclusive kernels can
+  // skip lanes (not for floating point sums/products, where adding zero
+  // or multiplying by one can still change the sign of a zero)
+#define LEGION_BULK_KERNELS(REDOP, OP, filter)                             \
+  bool ReductionKernels<REDOP >::apply(REDOP::LHS *lhs,                     \
+                                       const REDOP::RHS *rhs,               \
+                                       size_t count, bool exclusive)        \
+  {                                                                         \
+    return Legion::Internal::BulkReduction::bulk_reduce<REDOP,              \
+      Legion::Internal::BulkReduction::OP, false>(lhs, rhs, count,          \
+                                                  exclusive, filter);       \
+  }                                                                         \
+  bool ReductionKernels<REDOP >::fold(REDOP::RHS *rhs1,                     \
+                                      const REDOP::RHS *rhs2,               \
+                                      size_t count, bool exclusive)         \
+  {                                                                         \
+    return Legion::Internal::BulkReduction::bulk_reduce<REDOP,              \
+      Legion::Internal::BulkReduction::OP, true>(rhs1, rhs2, count,         \
+                                                 exclusive, filter);        \
+  }
+
+  LEGION_BULK_KERNELS(Legion::SumReduction<int32_t>, SumOp, true)
+  LEGION_BULK_KERNELS(Legion::SumReduction<int64_t>, SumOp, true)
+  LEGION_BULK_KERNELS(Legion::SumReduction<uint32_t>, SumOp, true)
+  LEGION_BULK_KERNELS(Legion::SumReduction<uint64_t>, SumOp, true)
+  LEGION_BULK_KERNELS(Legion::SumReduction<float>, SumOp, false)
+  LEGION_BULK_KERNELS(Legion::SumReduction<double>, SumOp, false)
+  LEGION_BULK_KERNELS(Legion::ProdReduction<float>, ProdOp, false)
+  LEGION_BULK_KERNELS(Legion::ProdReduction<double>, ProdOp, false)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<int32_t>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<int64_t>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<uint32_t>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<uint64_t>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<float>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MaxReduction<double>, MaxOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<int32_t>, MinOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<int64_t>, MinOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<uint32_t>, MinOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<uint64_t>, MinOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<float>, MinOp, true)
+  LEGION_BULK_KERNELS(Legion::MinReduction<double>, MinOp, true)
+
+#undef LEGION_BULK_KERNELS
+
+}; // namespace Realm
+
@@ -17,6 +17,7 @@
 #define __LEGION_REDOP_H__
 
 #include <limits.h>
+#include "realm/redop.h"
 
 #ifdef LEGION_REDOP_HALF
 #include "half.h"
@@ -1095,6 +1096,47 @@ namespace Legion {
 
 }; // namespace Legion
 
+namespace Realm {
+
+  // Bulk kernels for the built-in reduction operators that map onto simple
+  // element-wise vector operations.  These are defined in legion_redop.cc,
+  // pick the widest vector extension the processor supports at runtime
+  // (SSE2/AVX2/AVX-512 on x86-64), and return false (i.e. leave the work
+  // to the per-element loop) for anything they do not handle.
+#define LEGION_REDOP_BULK_KERNELS(REDOP)                                   \
+  template<>                                                                \
+  struct ReductionKernels<REDOP > {                                         \
+    static bool apply(REDOP::LHS *lhs, const REDOP::RHS *rhs,               \
+                      size_t count, bool exclusive);                        \
+    static bool fold(REDOP::RHS *rhs1, const REDOP::RHS *rhs2,              \
+                     size_t count, bool exclusive);                         \
+  }
+
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<int32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<int64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<uint32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<uint64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<float>);
+  LEGION_REDOP_BULK_KERNELS(Legion::SumReduction<double>);
+  LEGION_REDOP_BULK_KERNELS(Legion::ProdReduction<float>);
+  LEGION_REDOP_BULK_KERNELS(Legion::ProdReduction<double>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<int32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<int64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<uint32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<uint64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<float>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MaxReduction<double>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<int32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<int64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<uint32_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<uint64_t>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<float>);
+  LEGION_REDOP_BULK_KERNELS(Legion::MinReduction<double>);
+
+#undef LEGION_REDOP_BULK_KERNELS
+
+}; // namespace Realm
+
 #include "legion_redop.inl"
 
 #endif // __LEGION_REDOP_H__
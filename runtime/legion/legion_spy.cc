@@ -19,8 +19,464 @@
 #include "legion/legion_spy.h"
 #include "legion/runtime.h"
 
+#include <pthread.h>
+
 namespace Legion {
   namespace Internal {
+    namespace LegionSpy {
+
+      // A binary Legion Spy log starts with two lines of text, the file
+      // type and the node that wrote it, followed by a sequence of blocks:
+      //   'F' <u32 id> <u32 length> <format string>
+      //   'C' <u64 thread> <u32 length> <records>
+      // Each record is a varint format id followed by the arguments in the
+      // order of the conversions in the format: signed integers are zigzag
+      // encoded varints, unsigned integers are varints, and strings are a
+      // varint length followed by the characters. A format is always
+      // defined before the first chunk that uses it.
+
+      enum BinaryArgKind {
+        BINARY_ARG_INT,
+        BINARY_ARG_LONG,
+        BINARY_ARG_LONG_LONG,
+        BINARY_ARG_SSIZE,
+        BINARY_ARG_UNSIGNED,
+        BINARY_ARG_UNSIGNED_LONG,
+        BINARY_ARG_UNSIGNED_LONG_LONG,
+        BINARY_ARG_SIZE,
+        BINARY_ARG_STRING,
+      };
+
+      struct BinaryFormat {
+      public:
+        BinaryFormat(unsigned id, const char *fmt);
+      public:
+        const unsigned id;
+        std::vector<BinaryArgKind> args;
+        bool has_strings;
+      };
+
+      struct BinaryBuffer {
+      public:
+        static const size_t DEFAULT_CAPACITY = 1 << 16;
+      public:
+        BinaryBuffer(void);
+      public:
+        const pthread_t thread;
+        char *data;
+        size_t used, capacity;
+        std::map<const char*,const BinaryFormat*> formats;
+      };
+
+      class BinaryLog {
+      public:
+        BinaryLog(FILE *f, AddressSpaceID node);
+        ~BinaryLog(void);
+      public:
+        const BinaryFormat* find_format(BinaryBuffer *buffer, const char *fmt);
+        BinaryBuffer* create_buffer(void);
+        void flush_buffer(BinaryBuffer *buffer);
+        void record(const char *fmt, va_list args);
+        void close(void);
+      protected:
+        void write_chunk(pthread_t thread, const char *data, size_t size);
+      protected:
+        FILE *const file;
+        LocalLock log_lock;
+        std::map<const char*,BinaryFormat*> formats;
+        std::vector<BinaryBuffer*> buffers;
+      };
+
+      static BinaryLog *binary_log = NULL;
+      static __thread BinaryBuffer *binary_buffer = NULL;
+
+      //------------------------------------------------------------------------
+      BinaryFormat::BinaryFormat(unsigned i, const char *fmt)
+        : id(i), has_strings(false)
+      //------------------------------------------------------------------------
+      {
+        for (const char *p = fmt; *p != '\0'; p++)
+        {
+          if (*p != '%')
+            continue;
+          p++;
+          if (*p == '%')
+            continue;
+          // Skip flags, field width, and precision
+          while ((*p != '\0') && (strchr("-+ #0123456789.", *p) != NULL))
+            p++;
+          int longs = 0;
+          bool sized = false;
+          while ((*p == 'l') || (*p == 'h') || (*p == 'z'))
+          {
+            if (*p == 'l')
+              longs++;
+            else if (*p == 'z')
+              sized = true;
+            p++;
+          }
+          switch (*p)
+          {
+            case 'd':
+            case 'i':
+            case 'c':
+              {
+                if (sized)
+                  args.push_back(BINARY_ARG_SSIZE);
+                else if (longs > 1)
+                  args.push_back(BINARY_ARG_LONG_LONG);
+                else if (longs == 1)
+                  args.push_back(BINARY_ARG_LONG);
+                else
+                  args.push_back(BINARY_ARG_INT);
+                break;
+              }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+              {
+                if (sized)
+                  args.push_back(BINARY_ARG_SIZE);
+                else if (longs > 1)
+                  args.push_back(BINARY_ARG_UNSIGNED_LONG_LONG);
+                else if (longs == 1)
+                  args.push_back(BINARY_ARG_UNSIGNED_LONG);
+                else
+                  args.push_back(BINARY_ARG_UNSIGNED);
+                break;
+              }
+            case 's':
+              {
+                args.push_back(BINARY_ARG_STRING);
+                has_strings = true;
+                break;
+              }
+            default:
+              // Legion Spy only logs integers and strings
+              assert(false);
+          }
+        }
+      }
+
+      //------------------------------------------------------------------------
+      BinaryBuffer::BinaryBuffer(void)
+        : thread(pthread_self()), 
+          data((char*)malloc(DEFAULT_CAPACITY)), used(0),
+          capacity(DEFAULT_CAPACITY)
+      //------------------------------------------------------------------------
+      {
+      }
+
+      //------------------------------------------------------------------------
+      BinaryLog::BinaryLog(FILE *f, AddressSpaceID node)
+        : file(f)
+      //------------------------------------------------------------------------
+      {
+        fprintf(file, "FileType: BinaryLegionSpy v: 1.0\n");
+        fprintf(file, "Node: %d\n", node);
+      }
+
+      //------------------------------------------------------------------------
+      BinaryLog::~BinaryLog(void)
+      //------------------------------------------------------------------------
+      {
+        for (std::map<const char*,BinaryFormat*>::const_iterator it = 
+              formats.begin(); it != formats.end(); it++)
+          delete it->second;
+        for (std::vector<BinaryBuffer*>::const_iterator it = 
+              buffers.begin(); it != buffers.end(); it++)
+        {
+          free((*it)->data);
+          delete (*it);
+        }
+      }
+
+      //------------------------------------------------------------------------
+      const BinaryFormat* BinaryLog::find_format(BinaryBuffer *buffer,
+                                                 const char *fmt)
+      //------------------------------------------------------------------------
+      {
+        // Format strings are literals, so we can look them up by pointer
+        std::map<const char*,const BinaryFormat*>::const_iterator finder = 
+          buffer->formats.find(fmt);
+        if (finder != buffer->formats.end())
+          return finder->second;
+        BinaryFormat *result = NULL;
+        {
+          AutoLock l_lock(log_lock);
+          std::map<const char*,BinaryFormat*>::const_iterator global_finder =
+            formats.find(fmt);
+          if (global_finder == formats.end())
+          {
+            result = new BinaryFormat(formats.size(), fmt);
+            formats[fmt] = result;
+            // Write out the definition before any record can use it
+            const unsigned length = strlen(fmt);
+            fputc('F', file);
+            fwrite(&result->id, sizeof(result->id), 1, file);
+            fwrite(&length, sizeof(length), 1, file);
+            fwrite(fmt, 1, length, file);
+          }
+          else
+            result = global_finder->second;
+        }
+        buffer->formats[fmt] = result;
+        return result;
+      }
+
+      //------------------------------------------------------------------------
+      BinaryBuffer* BinaryLog::create_buffer(void)
+      //------------------------------------------------------------------------
+      {
+        BinaryBuffer *result = new BinaryBuffer();
+        AutoLock l_lock(log_lock);
+        buffers.push_back(result);
+        return result;
+      }
+
+      //------------------------------------------------------------------------
+      void BinaryLog::flush_buffer(BinaryBuffer *buffer)
+      //------------------------------------------------------------------------
+      {
+        // Swap in an empty buffer before taking the lock since waiting
+        // for the lock can switch to another task on this same thread
+        char *data = buffer->data;
+        const size_t size = buffer->used;
+        buffer->data = (char*)malloc(buffer->capacity);
+        buffer->used = 0;
+        {
+          AutoLock l_lock(log_lock);
+          write_chunk(buffer->thread, data, size);
+        }
+        free(data);
+      }
+
+      //------------------------------------------------------------------------
+      void BinaryLog::write_chunk(pthread_t thread, const char *data,
+                                  size_t size)
+      //------------------------------------------------------------------------
+      {
+        if (size == 0)
+          return;
+        const unsigned long long thread_id = (unsigned long long)thread;
+        const unsigned length = size;
+        fputc('C', file);
+        fwrite(&thread_id, sizeof(thread_id), 1, file);
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(data, 1, size, file);
+      }
+
+      //------------------------------------------------------------------------
+      static inline char* encode_unsigned(char *ptr, unsigned long long value)
+      //------------------------------------------------------------------------
+      {
+        while (value >= 0x80)
+        {
+          *ptr++ = (char)(value | 0x80);
+          value >>= 7;
+        }
+        *ptr++ = (char)value;
+        return ptr;
+      }
+
+      //------------------------------------------------------------------------
+      static inline char* encode_signed(char *ptr, long long value)
+      //------------------------------------------------------------------------
+      {
+        return encode_unsigned(ptr, 
+            ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+      }
+
+      //------------------------------------------------------------------------
+      void BinaryLog::record(const char *fmt, va_list args)
+      //------------------------------------------------------------------------
+      {
+        if (binary_buffer == NULL)
+          binary_buffer = create_buffer();
+        const BinaryFormat *format = find_format(binary_buffer, fmt);
+        // Bound the size of the record so it never spans two chunks
+        size_t bound = 10 * (format->args.size() + 1);
+        if (format->has_strings)
+        {
+          va_list copy;
+          va_copy(copy, args);
+          for (std::vector<BinaryArgKind>::const_iterator it = 
+                format->args.begin(); it != format->args.end(); it++)
+          {
+            switch (*it)
+            {
+              case BINARY_ARG_INT:
+              case BINARY_ARG_UNSIGNED:
+                {
+                  va_arg(copy, int);
+                  break;
+                }
+              case BINARY_ARG_LONG:
+              case BINARY_ARG_UNSIGNED_LONG:
+                {
+                  va_arg(copy, long);
+                  break;
+                }
+              case BINARY_ARG_LONG_LONG:
+              case BINARY_ARG_UNSIGNED_LONG_LONG:
+                {
+                  va_arg(copy, long long);
+                  break;
+                }
+              case BINARY_ARG_SSIZE:
+              case BINARY_ARG_SIZE:
+                {
+                  va_arg(copy, size_t);
+                  break;
+                }
+              case BINARY_ARG_STRING:
+                {
+                  const char *str = va_arg(copy, const char*);
+                  bound += (str == NULL) ? 6 : strlen(str);
+                  break;
+                }
+            }
+          }
+          va_end(copy);
+        }
+        BinaryBuffer *buffer = binary_buffer;
+        while ((buffer->used + bound) > buffer->capacity)
+        {
+          if (buffer->used == 0)
+          {
+            buffer->capacity = bound;
+            buffer->data = (char*)realloc(buffer->data, bound);
+            break;
+          }
+          flush_buffer(buffer);
+        }
+        char *ptr = encode_unsigned(buffer->data + buffer->used, format->id);
+        for (std::vector<BinaryArgKind>::const_iterator it = 
+              format->args.begin(); it != format->args.end(); it++)
+        {
+          switch (*it)
+          {
+            case BINARY_ARG_INT:
+              {
+                ptr = encode_signed(ptr, va_arg(args, int));
+                break;
+              }
+            case BINARY_ARG_LONG:
+              {
+                ptr = encode_signed(ptr, va_arg(args, long));
+                break;
+              }
+            case BINARY_ARG_LONG_LONG:
+              {
+                ptr = encode_signed(ptr, va_arg(args, long long));
+                break;
+              }
+            case BINARY_ARG_SSIZE:
+              {
+                ptr = encode_signed(ptr, va_arg(args, ssize_t));
+                break;
+              }
+            case BINARY_ARG_UNSIGNED:
+              {
+                ptr = encode_unsigned(ptr, va_arg(args, unsigned));
+                break;
+              }
+            case BINARY_ARG_UNSIGNED_LONG:
+              {
+                ptr = encode_unsigned(ptr, va_arg(args, unsigned long));
+                break;
+              }
+            case BINARY_ARG_UNSIGNED_LONG_LONG:
+              {
+                ptr = encode_unsigned(ptr, va_arg(args, unsigned long long));
+                break;
+              }
+            case BINARY_ARG_SIZE:
+              {
+                ptr = encode_unsigned(ptr, va_arg(args, size_t));
+                break;
+              }
+            case BINARY_ARG_STRING:
+              {
+                const char *str = va_arg(args, const char*);
+                if (str == NULL)
+                  str = "(null)";
+                const size_t length = strlen(str);
+                ptr = encode_unsigned(ptr, length);
+                memcpy(ptr, str, length);
+                ptr += length;
+                break;
+              }
+          }
+        }
+        buffer->used = ptr - buffer->data;
+      }
+
+      //------------------------------------------------------------------------
+      void BinaryLog::close(void)
+      //------------------------------------------------------------------------
+      {
+        // Only called once all the threads have stopped logging
+        for (std::vector<BinaryBuffer*>::const_iterator it = 
+              buffers.begin(); it != buffers.end(); it++)
+        {
+          write_chunk((*it)->thread, (*it)->data, (*it)->used);
+          (*it)->used = 0;
+        }
+        fclose(file);
+      }
+
+      //------------------------------------------------------------------------
+      void log_record(const char *fmt, ...)
+      //------------------------------------------------------------------------
+      {
+        va_list args;
+        va_start(args, fmt);
+        if (binary_log != NULL)
+          binary_log->record(fmt, args);
+        else
+          log_spy.print().vprintf(fmt, args);
+        va_end(args);
+      }
+
+      //------------------------------------------------------------------------
+      void open_binary_log(const char *filename, AddressSpaceID node)
+      //------------------------------------------------------------------------
+      {
+        if (binary_log != NULL)
+          return;
+        // Replace a '%' in the name with the node number
+        std::string name(filename);
+        const size_t pct = name.find_first_of('%', 0);
+        if (pct != std::string::npos)
+        {
+          std::stringstream ss;
+          ss << name.substr(0, pct) << node << name.substr(pct + 1);
+          name = ss.str();
+        }
+        FILE *f = fopen(name.c_str(), "wb");
+        if (f == NULL)
+          REPORT_LEGION_ERROR(ERROR_INVALID_SPY_FILE,
+              "Unable to open Legion Spy logfile %s for writing!", 
+              name.c_str())
+        binary_log = new BinaryLog(f, node);
+        atexit(close_binary_log);
+      }
+
+      //------------------------------------------------------------------------
+      void close_binary_log(void)
+      //------------------------------------------------------------------------
+      {
+        if (binary_log == NULL)
+          return;
+        BinaryLog *log = binary_log;
+        binary_log = NULL;
+        log->close();
+        delete log;
+      }
+
+    }; // namespace LegionSpy
 
     //--------------------------------------------------------------------------
     TreeStateLogger::TreeStateLogger(void)
@@ -6915,6 +6915,9 @@ namespace Legion {
       future_map = FutureMap(new FutureMapImpl(ctx, this, runtime,
             runtime->get_available_distributed_id(),
             runtime->address_space));
+      // Legion Spy needs to see a future made for every point
+      future_map.impl->initialize_result_domain(index_domain,
+          index_domain.dense() && !runtime->legion_spy_enabled);
 #ifdef DEBUG_LEGION
       future_map.impl->add_valid_domain(index_domain);
 #endif
@@ -7611,10 +7614,7 @@ namespace Legion {
     //--------------------------------------------------------------------------
     {
       if (redop == 0)
-      {
-        Future f = future_map.impl->get_future(index_point);
-        f.impl->set_result(res, res_size, owned);
-      }
+        future_map.impl->set_point_result(index_point, res, res_size, owned);
       else
         fold_reduction_future(res, res_size, owned, true/*exclusive*/);
     }
@@ -7699,10 +7699,7 @@ namespace Legion {
       else
       {
         if (must_epoch == NULL)
-        {
-          Future f = future_map.get_future(point);
-          f.impl->set_result(result, result_size, owner);
-        }
+          future_map.impl->set_point_result(point, result, result_size, owner);
         else
           must_epoch->set_future(point, result, result_size, owner);
       }
@@ -7912,8 +7909,12 @@ namespace Legion {
           derez.deserialize(p);
           if (must_epoch == NULL)
           {
-            Future f = future_map.impl->get_future(p);
-            f.impl->unpack_future(derez);
+            DerezCheck z2(derez);
+            size_t size;
+            derez.deserialize(size);
+            future_map.impl->set_point_result(p, 
+                derez.get_current_pointer(), size, false/*owner*/);
+            derez.advance_pointer(size);
           }
           else
             must_epoch->unpack_future(p, derez);
@@ -8688,41 +8689,39 @@ namespace Legion {
     //--------------------------------------------------------------------------
     {
       DETAILED_PROFILER(runtime, SLICE_HANDLE_FUTURE_CALL);
+      // Non-deterministic reductions are always folded into our own
+      // reduction buffer first, even when we're local, so that the index
+      // owner only has to fold one value per slice instead of having 
+      // every point in the launch contend on its reduction buffer
+      if ((redop != 0) && !deterministic_redop)
+        fold_reduction_future(result, result_size, owner, false/*exclusive*/);
       // If we're remote, just handle it ourselves, otherwise pass
       // it back to the enclosing index owner
-      if (is_remote())
+      else if (is_remote())
       {
-        // Store the future result in our temporary futures unless we're 
-        // doing a non-deterministic reduction in which case we can eagerly
-        // fold this now into our reduction buffer
-        if ((redop == 0) || deterministic_redop)
+        // Store it in our temporary futures
+        if (owner)
         {
-          // Store it in our temporary futures
-          if (owner)
-          {
-            // Hold the lock to protect the data structure
-            AutoLock o_lock(op_lock);
+          // Hold the lock to protect the data structure
+          AutoLock o_lock(op_lock);
 #ifdef DEBUG_LEGION
-            assert(temporary_futures.find(point) == temporary_futures.end());
+          assert(temporary_futures.find(point) == temporary_futures.end());
 #endif
-            temporary_futures[point] = 
-              std::pair<void*,size_t>(const_cast<void*>(result),result_size);
-          }
-          else
-          {
-            void *copy = legion_malloc(FUTURE_RESULT_ALLOC, result_size);
-            memcpy(copy,result,result_size);
-            // Hold the lock to protect the data structure
-            AutoLock o_lock(op_lock);
+          temporary_futures[point] = 
+            std::pair<void*,size_t>(const_cast<void*>(result),result_size);
+        }
+        else
+        {
+          void *copy = legion_malloc(FUTURE_RESULT_ALLOC, result_size);
+          memcpy(copy,result,result_size);
+          // Hold the lock to protect the data structure
+          AutoLock o_lock(op_lock);
 #ifdef DEBUG_LEGION
-            assert(temporary_futures.find(point) == temporary_futures.end());
+          assert(temporary_futures.find(point) == temporary_futures.end());
 #endif
-            temporary_futures[point] = 
-              std::pair<void*,size_t>(copy,result_size);
-          }
+          temporary_futures[point] = 
+            std::pair<void*,size_t>(copy,result_size);
         }
-        else
-          fold_reduction_future(result, result_size, owner, false/*exclusive*/);
       }
       else
         index_owner->handle_future(point, result, result_size, owner);
@@ -9034,7 +9033,11 @@ namespace Legion {
       }
       else
       {
-        std::set<ApEvent> slice_postconditions;
+        // Fold our partial reduction into the index owner's buffer 
+        // before it can see that all of its points are complete
+        if ((redop != 0) && !deterministic_redop)
+          index_owner->fold_reduction_future(reduction_state, 
+              reduction_state_size, false/*owner*/, false/*exclusive*/);
         index_owner->return_slice_complete(points.size(), slice_postcondition);
       }
       complete_operation();
@@ -22,6 +22,13 @@
 #include "legion/legion_instances.h"
 #include "legion/legion_views.h"
 #include "legion/legion_context.h"
+#include "legion/legion_profiling.h"
+
+#include <unistd.h> // close for the temporary files of persistent traces
+
+#ifdef __linux__
+#include <link.h> // dl_iterate_phdr for the build id of persistent traces
+#endif
 
 namespace Legion {
   namespace Internal {
@@ -46,6 +53,92 @@ namespace Legion {
       return out;
     }
 
+    // 64-bit FNV-1a, used to key and to check persistent trace files,
+    // pass the previous hash to continue hashing more bytes
+    static inline uint64_t hash_persistent_bytes(const void *data, size_t size,
+                                    uint64_t hash = 0xcbf29ce484222325ULL)
+    {
+      const unsigned char *bytes = (const unsigned char*)data;
+      for (size_t idx = 0; idx < size; idx++)
+      {
+        hash ^= bytes[idx];
+        hash *= 0x100000001b3ULL;
+      }
+      return hash;
+    }
+
+    // Hash the contents of a file, returns false if it cannot be read
+    static bool hash_persistent_file(const char *path, uint64_t &hash)
+    {
+      FILE *f = fopen(path, "rb");
+      if (f == NULL)
+        return false;
+      char buffer[65536];
+      size_t bytes;
+      while ((bytes = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        hash = hash_persistent_bytes(buffer, bytes, hash);
+      const bool success = (ferror(f) == 0);
+      fclose(f);
+      return success;
+    }
+
+#ifdef __linux__
+    struct PersistentBuildID {
+    public:
+      PersistentBuildID(void) 
+        : hash(0xcbf29ce484222325ULL), num_objects(0), valid(true) { }
+    public:
+      uint64_t hash;
+      unsigned num_objects;
+      bool valid;
+    };
+
+    // Fold the GNU build id note of every loaded object into the hash,
+    // the files of objects that were linked without one are hashed instead
+    static int hash_persistent_build_ids(struct dl_phdr_info *info,
+                                         size_t size, void *arg)
+    {
+      PersistentBuildID *build = (PersistentBuildID*)arg;
+      // The first object is always the executable itself
+      const bool executable = (build->num_objects++ == 0);
+      bool found = false;
+      for (unsigned idx = 0; !found && (idx < info->dlpi_phnum); idx++)
+      {
+        const ElfW(Phdr) &phdr = info->dlpi_phdr[idx];
+        if (phdr.p_type != PT_NOTE)
+          continue;
+        const char *note = (const char*)(info->dlpi_addr + phdr.p_vaddr);
+        const char *const end = note + phdr.p_memsz;
+        while ((note + sizeof(ElfW(Nhdr))) <= end)
+        {
+          const ElfW(Nhdr) *header = (const ElfW(Nhdr)*)note;
+          const char *name = note + sizeof(ElfW(Nhdr));
+          const char *desc = name + ((header->n_namesz + 3) & ~3);
+          if (desc + header->n_descsz > end)
+            break;
+          if ((header->n_type == NT_GNU_BUILD_ID) && 
+              (header->n_namesz == 4) && (memcmp(name, "GNU", 4) == 0))
+          {
+            build->hash = hash_persistent_bytes(desc, header->n_descsz,
+                                                build->hash);
+            found = true;
+            break;
+          }
+          note = desc + ((header->n_descsz + 3) & ~3);
+        }
+      }
+      if (!found)
+      {
+        const char *path = executable ? "/proc/self/exe" : info->dlpi_name;
+        // Objects without a file (e.g. the vdso) come with the kernel
+        if ((path != NULL) && (path[0] != '\0') &&
+            !hash_persistent_file(path, build->hash))
+          build->valid = false;
+      }
+      return 0;
+    }
+#endif
+
     /////////////////////////////////////////////////////////////
     // LegionTrace 
     /////////////////////////////////////////////////////////////
@@ -481,6 +574,9 @@ namespace Legion {
       : LegionTrace(c, logical_only), tid(t), fixed(false), tracing(true)
     //--------------------------------------------------------------------------
     {
+      if ((physical_trace != NULL) && 
+          (physical_trace->runtime->trace_cache_directory != NULL))
+        physical_trace->load_persistent_templates(this);
     }
 
     //--------------------------------------------------------------------------
@@ -535,6 +631,70 @@ namespace Legion {
 #endif
     } 
 
+    //--------------------------------------------------------------------------
+    uint64_t DynamicTrace::get_structure_hash(void) const
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(fixed);
+#endif
+      // The trace is fixed as soon as it is ended but its structure
+      // is not known until the capture has been analyzed
+      if (tracing)
+        return 0;
+      Serializer rez;
+      pack_persistent_capture(rez);
+      return hash_persistent_bytes(rez.get_buffer(), rez.get_used_bytes());
+    }
+
+    //--------------------------------------------------------------------------
+    void DynamicTrace::pack_persistent_capture(Serializer &rez) const
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(fixed);
+      assert(!tracing);
+#endif
+      rez.serialize<size_t>(op_info.size());
+      for (std::vector<OperationInfo>::const_iterator it = op_info.begin();
+            it != op_info.end(); it++)
+      {
+        rez.serialize(it->kind);
+        rez.serialize(it->count);
+      }
+      rez.serialize<size_t>(dependences.size());
+      for (std::deque<LegionVector<DependenceRecord>::aligned>::const_iterator
+            it = dependences.begin(); it != dependences.end(); it++)
+      {
+        rez.serialize<size_t>(it->size());
+        for (LegionVector<DependenceRecord>::aligned::const_iterator dit =
+              it->begin(); dit != it->end(); dit++)
+        {
+          rez.serialize(dit->operation_idx);
+          rez.serialize(dit->prev_idx);
+          rez.serialize(dit->next_idx);
+          rez.serialize(dit->validates);
+          rez.serialize(dit->dtype);
+          rez.serialize(dit->dependent_mask);
+        }
+      }
+      rez.serialize<size_t>(aliased_children.size());
+      for (std::map<unsigned,LegionVector<AliasChildren>::aligned>::
+            const_iterator it = aliased_children.begin(); it != 
+            aliased_children.end(); it++)
+      {
+        rez.serialize(it->first);
+        rez.serialize<size_t>(it->second.size());
+        for (LegionVector<AliasChildren>::aligned::const_iterator ait = 
+              it->second.begin(); ait != it->second.end(); ait++)
+        {
+          rez.serialize(ait->req_index);
+          rez.serialize(ait->depth);
+          rez.serialize(ait->mask);
+        }
+      }
+    }
+
     //--------------------------------------------------------------------------
     bool DynamicTrace::handles_region_tree(RegionTreeID tid) const
     //--------------------------------------------------------------------------
@@ -1186,7 +1346,7 @@ namespace Legion {
 #endif
         RtEvent pending_deletion =
           local_trace->get_physical_trace()->fix_trace(
-              current_template, has_blocking_call);
+              current_template, this, has_blocking_call);
         if (pending_deletion.exists())
           execution_precondition = Runtime::merge_events(
               execution_precondition, ApEvent(pending_deletion));
@@ -1307,6 +1467,10 @@ namespace Legion {
         local_trace->get_physical_trace()->record_previous_template_completion(
             template_completion);
         local_trace->initialize_tracing_state();
+        // A template that cannot replay back-to-back needs its effects on
+        // the region tree made visible before we pick the next template
+        if (!current_template->is_idempotent())
+          local_trace->invalidate_trace_cache(this);
         replayed = true;
         return;
       }
@@ -1359,7 +1523,7 @@ namespace Legion {
 #endif
         RtEvent pending_deletion =
           local_trace->get_physical_trace()->fix_trace(
-              current_template, has_blocking_call);
+              current_template, this, has_blocking_call);
         if (pending_deletion.exists())
           execution_precondition = Runtime::merge_events(
               execution_precondition, ApEvent(pending_deletion));
@@ -1487,7 +1651,7 @@ namespace Legion {
 #endif
 
         if (physical_trace->get_current_template() == NULL)
-          physical_trace->check_template_preconditions();
+          physical_trace->check_template_preconditions(this);
 #ifdef DEBUG_LEGION
         assert(physical_trace->get_current_template() == NULL ||
                !physical_trace->get_current_template()->is_recording());
@@ -1507,8 +1671,12 @@ namespace Legion {
       if (physical_trace->get_current_template() != NULL)
       {
         if (!fence_registered)
+        {
           execution_precondition =
             parent_ctx->get_current_execution_fence_event();
+          physical_trace->record_template_event(this,
+                                                TRACE_TEMPLATE_RECURRENT);
+        }
         ApEvent fence_completion =
           recurrent ? physical_trace->get_previous_template_completion()
                     : get_completion_event();
@@ -1851,7 +2019,7 @@ namespace Legion {
     //--------------------------------------------------------------------------
     PhysicalTrace::PhysicalTrace(Runtime *rt, LegionTrace *lt)
       : runtime(rt), logical_trace(lt), current_template(NULL),
-        nonreplayable_count(0)
+        nonreplayable_count(0), persistent_structure_hash(0)
     //--------------------------------------------------------------------------
     {
       if (runtime->replay_on_cpus)
@@ -1870,7 +2038,7 @@ namespace Legion {
     //--------------------------------------------------------------------------
     PhysicalTrace::PhysicalTrace(const PhysicalTrace &rhs)
       : runtime(NULL), logical_trace(NULL), current_template(NULL),
-        nonreplayable_count(0)
+        nonreplayable_count(0), persistent_structure_hash(0)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -1896,8 +2064,8 @@ namespace Legion {
     }
 
     //--------------------------------------------------------------------------
-    RtEvent PhysicalTrace::fix_trace(
-                                  PhysicalTemplate *tpl, bool has_blocking_call)
+    RtEvent PhysicalTrace::fix_trace(PhysicalTemplate *tpl, Operation *op,
+                                     bool has_blocking_call)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_LEGION
@@ -1907,6 +2075,7 @@ namespace Legion {
       RtEvent pending_deletion = RtEvent::NO_RT_EVENT;
       if (!tpl->is_replayable())
       {
+        record_template_event(op, TRACE_TEMPLATE_DISCARDED);
         pending_deletion = tpl->defer_template_deletion();
         current_template = NULL;
         if (++nonreplayable_count > LEGION_NON_REPLAYABLE_WARNING)
@@ -1926,12 +2095,36 @@ namespace Legion {
         // Reset the nonreplayable count when we find a replayable template
         nonreplayable_count = 0;
         templates.push_back(tpl);
+        if (tpl->is_idempotent())
+        {
+          record_template_event(op, TRACE_TEMPLATE_RECORDED);
+          if (runtime->trace_cache_directory != NULL)
+            save_persistent_templates(tpl);
+        }
+        else
+        {
+          // The template moved the data to different instances (e.g. the 
+          // mapper changed some of its decisions) so it cannot replay right
+          // after itself, but we keep it as a variant for whenever its
+          // preconditions hold again and check them on the next iteration
+          record_template_event(op, TRACE_TEMPLATE_TRANSITION);
+          current_template = NULL;
+        }
+        // Drop the least recently used variant if we have too many, the
+        // most recently used ones are at the back of the list
+        if (templates.size() > LEGION_MAX_TRACE_TEMPLATES)
+        {
+          PhysicalTemplate *evicted = templates.front();
+          templates.erase(templates.begin());
+          record_template_event(op, TRACE_TEMPLATE_EVICTED);
+          pending_deletion = evicted->defer_template_deletion();
+        }
       }
       return pending_deletion;
     }
 
     //--------------------------------------------------------------------------
-    void PhysicalTrace::check_template_preconditions(void)
+    void PhysicalTrace::check_template_preconditions(Operation *op)
     //--------------------------------------------------------------------------
     {
       current_template = NULL;
@@ -1946,8 +2139,322 @@ namespace Legion {
           // the precondition
           nonreplayable_count = 0;
           current_template = *it;
+          // Move it to the back so the templates stay in the order in 
+          // which they were last used
+          templates.erase((it+1).base());
+          templates.push_back(current_template);
+          record_template_event(op, TRACE_TEMPLATE_HIT);
+          return;
+        }
+      if (persistent_templates.empty() || !validate_persistent_templates())
+      {
+        record_template_event(op, TRACE_TEMPLATE_MISS);
+        return;
+      }
+      // See if any of the templates from a previous run can be bound to
+      // the instances that are valid right now, we keep the ones that
+      // cannot around since they might match a later iteration
+      const ContextID ctx = logical_trace->ctx->get_context_id();
+      const ContextID top_ctx = 
+        logical_trace->ctx->find_top_context()->get_context_id();
+      for (std::vector<std::vector<char> >::iterator it =
+            persistent_templates.begin(); it != 
+            persistent_templates.end(); it++)
+      {
+        PhysicalTemplate *tpl = PhysicalTemplate::unpack_persistent_template(
+                                                    this, *it, ctx, top_ctx);
+        if (tpl == NULL)
+          continue;
+        if (!tpl->check_preconditions())
+        {
+          delete tpl;
+          continue;
+        }
+        tpl->persistent_buffer.swap(*it);
+        persistent_templates.erase(it);
+        nonreplayable_count = 0;
+        templates.push_back(tpl);
+        current_template = tpl;
+        record_template_event(op, TRACE_TEMPLATE_HIT);
+        return;
+      }
+      record_template_event(op, TRACE_TEMPLATE_MISS);
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalTrace::record_template_event(Operation *op,
+                                              TraceTemplateKind kind) const
+    //--------------------------------------------------------------------------
+    {
+      if (runtime->profiler != NULL)
+        runtime->profiler->register_trace_template(op->get_unique_op_id(),
+                                      logical_trace->get_trace_id(), kind);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ uint64_t PhysicalTrace::find_build_id(const char *directory)
+    //--------------------------------------------------------------------------
+    {
+#ifdef __linux__
+      PersistentBuildID build;
+      dl_iterate_phdr(hash_persistent_build_ids, &build);
+      if (build.valid && (build.num_objects > 0) && (build.hash != 0))
+        return build.hash;
+#endif
+      log_run.warning("Unable to identify the build of this program so no "
+                      "templates will be persisted in %s", directory);
+      return 0;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTrace::get_persistent_file(std::string &file_name)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(runtime->trace_cache_directory != NULL);
+#endif
+      // Only dynamic traces have a captured structure to save
+      if (!logical_trace->is_dynamic_trace())
+        return false;
+      // Templates name variants, processors and memories by ID which
+      // are only stable for the same build with the same variants
+      if (runtime->trace_cache_build_id == 0)
+        return false;
+      Serializer rez;
+      rez.serialize(runtime->trace_cache_build_id);
+      runtime->pack_registered_variants(rez);
+      // The same trace can issue different operations for different
+      // inputs so the arguments of the run are part of the key
+      for (int idx = 1; idx < runtime->input_args.argc; idx++)
+        rez.serialize(runtime->input_args.argv[idx],
+                      strlen(runtime->input_args.argv[idx]) + 1);
+      char buffer[128];
+      snprintf(buffer, sizeof(buffer), "/trace_%u_%u_%016llx_%u.lgt",
+               logical_trace->ctx->get_task()->task_id,
+               logical_trace->get_trace_id(), (unsigned long long)
+               hash_persistent_bytes(rez.get_buffer(), rez.get_used_bytes()),
+               runtime->address_space);
+      file_name = runtime->trace_cache_directory;
+      file_name += buffer;
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTrace::validate_persistent_templates(void)
+    //--------------------------------------------------------------------------
+    {
+      if (persistent_structure_hash == 0)
+        return true;
+      // The templates were recorded for the dependences captured by a
+      // previous run, they cannot be used until this run has captured
+      // the trace itself and we know that it issues the same operations
+      if (!logical_trace->is_fixed())
+        return false;
+      const uint64_t structure_hash = logical_trace->get_structure_hash();
+      if (structure_hash == 0)
+        return false;
+      if (structure_hash != persistent_structure_hash)
+      {
+        log_run.info("Discarding %zd persistent templates for trace %u from "
+                     "%s because the trace captured different dependences",
+                     persistent_templates.size(),
+                     logical_trace->get_trace_id(), persistent_file.c_str());
+        persistent_templates.clear();
+      }
+      persistent_structure_hash = 0;
+      return !persistent_templates.empty();
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalTrace::load_persistent_templates(DynamicTrace *trace)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(trace == logical_trace);
+      assert(!trace->is_fixed());
+      assert(persistent_file.empty());
+#endif
+      // The key is computed once so templates are saved under the same
+      // name even if more variants are registered later in the run
+      if (!get_persistent_file(persistent_file))
+        return;
+      FILE *f = fopen(persistent_file.c_str(), "rb");
+      if (f == NULL)
+        return;
+      std::vector<char> contents;
+      char buffer[4096];
+      size_t bytes;
+      while ((bytes = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        contents.insert(contents.end(), buffer, buffer + bytes);
+      fclose(f);
+      // The file ends with a hash of everything before it
+      if (contents.size() < sizeof(uint64_t))
+        return;
+      const size_t payload = contents.size() - sizeof(uint64_t);
+      uint64_t checksum;
+      memcpy(&checksum, &contents[payload], sizeof(checksum));
+      if (checksum != hash_persistent_bytes(&contents[0], payload))
+      {
+        log_run.warning("Ignoring corrupted persistent trace file %s",
+                        persistent_file.c_str());
+        return;
+      }
+      Deserializer derez(&contents[0], payload);
+      uint64_t magic;
+      derez.deserialize(magic);
+      size_t mask_size;
+      derez.deserialize(mask_size);
+      unsigned max_parallelism;
+      derez.deserialize(max_parallelism);
+      uint64_t build_id;
+      derez.deserialize(build_id);
+      // Templates are only compatible with the same build and settings
+      if ((magic != PERSISTENT_TEMPLATE_MAGIC) || 
+          (mask_size != sizeof(FieldMask)) ||
+          (max_parallelism != runtime->max_replay_parallelism) ||
+          (build_id != runtime->trace_cache_build_id))
+      {
+        log_run.info("Ignoring incompatible persistent trace file %s",
+                     persistent_file.c_str());
+        return;
+      }
+      // Only remember the structure of the capture that the templates
+      // were recorded for, the trace still captures its dependences on
+      // its first execution and the templates are checked against them
+      derez.deserialize(persistent_structure_hash);
+      size_t num_templates;
+      derez.deserialize(num_templates);
+      persistent_templates.resize(num_templates);
+      for (unsigned idx = 0; idx < num_templates; idx++)
+      {
+        size_t template_size;
+        derez.deserialize(template_size);
+        persistent_templates[idx].resize(template_size);
+        derez.deserialize(&persistent_templates[idx][0], template_size);
+      }
+      log_run.info("Loaded %zd persistent templates for trace %u from %s",
+                   num_templates, trace->get_trace_id(), 
+                   persistent_file.c_str());
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalTrace::save_persistent_templates(PhysicalTemplate *tpl)
+    //--------------------------------------------------------------------------
+    {
+      if (persistent_file.empty())
+        return;
+      // The structure is only known once the capture has been analyzed
+      const uint64_t structure_hash = logical_trace->get_structure_hash();
+      if (structure_hash == 0)
+        return;
+      // Drop the templates of the previous run if they do not match
+      validate_persistent_templates();
+      {
+        Serializer rez;
+        if (!tpl->pack_persistent_template(rez, 
+              logical_trace->ctx->get_context_id(),
+              logical_trace->ctx->find_top_context()->get_context_id()))
+        {
+          log_run.info("Template for trace %u cannot be persisted because "
+                       "it uses instances that it does not find valid",
+                       logical_trace->get_trace_id());
           return;
         }
+        const char *buffer = (const char*)rez.get_buffer();
+        tpl->persistent_buffer.assign(buffer, buffer + rez.get_used_bytes());
+      }
+      // Most recent templates first, followed by the ones from the
+      // previous run that we have not been able to use yet
+      std::vector<const std::vector<char>*> to_save;
+      for (std::vector<PhysicalTemplate*>::reverse_iterator it =
+            templates.rbegin(); it != templates.rend(); it++)
+        if (!(*it)->persistent_buffer.empty())
+          to_save.push_back(&(*it)->persistent_buffer);
+      for (std::vector<std::vector<char> >::const_iterator it =
+            persistent_templates.begin(); it != 
+            persistent_templates.end(); it++)
+        to_save.push_back(&(*it));
+      Serializer rez;
+      const uint64_t magic = PERSISTENT_TEMPLATE_MAGIC;
+      rez.serialize(magic);
+      rez.serialize<size_t>(sizeof(FieldMask));
+      rez.serialize(runtime->max_replay_parallelism);
+      rez.serialize(runtime->trace_cache_build_id);
+      rez.serialize(structure_hash);
+      std::vector<const std::vector<char>*> unique;
+      for (unsigned idx = 0; (idx < to_save.size()) && 
+            (unique.size() < MAX_PERSISTENT_TEMPLATES); idx++)
+      {
+        bool duplicate = false;
+        for (unsigned idx2 = 0; idx2 < unique.size(); idx2++)
+          if (*unique[idx2] == *to_save[idx])
+          {
+            duplicate = true;
+            break;
+          }
+        if (!duplicate)
+          unique.push_back(to_save[idx]);
+      }
+      rez.serialize<size_t>(unique.size());
+      for (unsigned idx = 0; idx < unique.size(); idx++)
+      {
+        rez.serialize<size_t>(unique[idx]->size());
+        rez.serialize(&(*unique[idx])[0], unique[idx]->size());
+      }
+      rez.serialize(hash_persistent_bytes(rez.get_buffer(), 
+                                          rez.get_used_bytes()));
+      // Writing the file can take a while so it is done by a meta-task,
+      // each save of this trace waits for the previous one so the file
+      // always ends up with the most recent templates
+      const char *buffer = (const char*)rez.get_buffer();
+      SavePersistentArgs args(new std::string(persistent_file),
+          new std::vector<char>(buffer, buffer + rez.get_used_bytes()));
+      last_persistent_save = runtime->issue_runtime_meta_task(args,
+          LG_LOW_PRIORITY, last_persistent_save);
+      log_run.info("Saving %zd templates for trace %u to %s", unique.size(),
+                   logical_trace->get_trace_id(), persistent_file.c_str());
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void PhysicalTrace::handle_save_persistent(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const SavePersistentArgs *pargs = (const SavePersistentArgs*)args;
+      const std::string &file_name = *(pargs->file_name);
+      const std::vector<char> &contents = *(pargs->contents);
+      // Write to a temporary file and rename it so that concurrent
+      // readers never see a partially written file, the temporary
+      // name is unique so that other processes sharing the cache
+      // directory cannot write to the same temporary file
+      std::vector<char> temp_name(file_name.begin(), file_name.end());
+      const char suffix[] = ".XXXXXX";
+      temp_name.insert(temp_name.end(), suffix, suffix + sizeof(suffix));
+      const int fd = mkstemp(&temp_name[0]);
+      FILE *f = (fd < 0) ? NULL : fdopen(fd, "wb");
+      if (f == NULL)
+      {
+        log_run.warning("Unable to create a temporary file for persistent "
+                        "trace file %s", file_name.c_str());
+        if (fd >= 0)
+        {
+          close(fd);
+          remove(&temp_name[0]);
+        }
+      }
+      else
+      {
+        const bool written = 
+          (fwrite(&contents[0], 1, contents.size(), f) == contents.size());
+        if ((fclose(f) != 0) || !written || 
+            (rename(&temp_name[0], file_name.c_str()) != 0))
+        {
+          log_run.warning("Unable to write persistent trace file %s",
+                          file_name.c_str());
+          remove(&temp_name[0]);
+        }
+      }
+      delete pargs->file_name;
+      delete pargs->contents;
     }
 
     //--------------------------------------------------------------------------
@@ -1978,8 +2485,10 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     PhysicalTemplate::PhysicalTemplate(PhysicalTrace *t, ApEvent fence_event)
-      : trace(t), recording(true), replayable(true), fence_completion_id(0),
-        replay_parallelism(implicit_runtime->max_replay_parallelism)
+      : trace(t), recording(true), replayable(true), idempotent(true),
+        fence_completion_id(0),
+        replay_parallelism(implicit_runtime->max_replay_parallelism),
+        slice_statistics(replay_parallelism)
     //--------------------------------------------------------------------------
     {
       events.push_back(fence_event);
@@ -1990,7 +2499,8 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     PhysicalTemplate::PhysicalTemplate(const PhysicalTemplate &rhs)
-      : trace(NULL), recording(true), replayable(true), fence_completion_id(0),
+      : trace(NULL), recording(true), replayable(true), idempotent(true),
+        fence_completion_id(0),
         replay_parallelism(1)
     //--------------------------------------------------------------------------
     {
@@ -2002,6 +2512,7 @@ namespace Legion {
     PhysicalTemplate::~PhysicalTemplate(void)
     //--------------------------------------------------------------------------
     {
+      report_slice_statistics();
       {
         AutoLock tpl_lock(template_lock);
         for (std::vector<Instruction*>::iterator it = instructions.begin();
@@ -2282,6 +2793,13 @@ namespace Legion {
         if (it->first->get_manager()->instance_domain->get_volume() > 0)
           return false;
       }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTemplate::check_idempotent(void) const
+    //--------------------------------------------------------------------------
+    {
       for (LegionMap<InstanceView*, FieldMask>::aligned::const_iterator it =
            previous_valid_views.begin(); it !=
            previous_valid_views.end(); ++it)
@@ -2326,6 +2844,7 @@ namespace Legion {
 #ifdef DEBUG_LEGION
       assert(slice_idx < slices.size());
 #endif
+      const long long start = Realm::Clock::current_time_in_nanoseconds();
       ApUserEvent fence = Runtime::create_ap_user_event();
       const std::vector<TraceLocalID> &tasks = slice_tasks[slice_idx];
       for (unsigned idx = 0; idx < tasks.size(); ++idx)
@@ -2335,6 +2854,13 @@ namespace Legion {
            it != instructions.end(); ++it)
         (*it)->execute();
       Runtime::trigger_event(fence);
+      const long long elapsed = 
+        Realm::Clock::current_time_in_nanoseconds() - start;
+      SliceStatistics &stats = slice_statistics[slice_idx];
+      stats.replays++;
+      stats.total_ns += elapsed;
+      if (elapsed > stats.max_ns)
+        stats.max_ns = elapsed;
     }
 
     //--------------------------------------------------------------------------
@@ -2361,6 +2887,7 @@ namespace Legion {
     {
       recording = false;
       replayable = !has_blocking_call && check_replayable();
+      idempotent = replayable && check_idempotent();
       if (outstanding_gc_events.size() > 0)
         for (std::map<InstanceView*, std::set<ApEvent> >::iterator it =
              outstanding_gc_events.begin(); it !=
@@ -2693,47 +3220,7 @@ namespace Legion {
       for (unsigned idx = 1; idx < instructions.size(); ++idx)
         slice_indices_by_inst[idx] = -1U;
 #endif
-      bool round_robin_for_tasks = false;
-
-      std::set<Processor> distinct_targets;
-      for (CachedMappings::iterator it = cached_mappings.begin(); it !=
-           cached_mappings.end(); ++it)
-        distinct_targets.insert(it->second.target_procs[0]);
-      round_robin_for_tasks = distinct_targets.size() < replay_parallelism;
-
-      unsigned next_slice_id = 0;
-      for (std::map<TraceLocalID, Operation*>::iterator it =
-           operations.begin(); it != operations.end(); ++it)
-      {
-        unsigned slice_index = -1U;
-        if (!round_robin_for_tasks &&
-            it->second->get_operation_kind() == Operation::TASK_OP_KIND)
-        {
-          CachedMappings::iterator finder = cached_mappings.find(it->first);
-#ifdef DEBUG_LEGION
-          assert(finder != cached_mappings.end());
-          assert(finder->second.target_procs.size() > 0);
-#endif
-          slice_index =
-            finder->second.target_procs[0].id % replay_parallelism;
-        }
-        else
-        {
-#ifdef DEBUG_LEGION
-          assert(slice_indices_by_owner.find(it->first) ==
-              slice_indices_by_owner.end());
-#endif
-          slice_index = next_slice_id;
-          next_slice_id = (next_slice_id + 1) % replay_parallelism;
-        }
-
-#ifdef DEBUG_LEGION
-        assert(slice_index != -1U);
-#endif
-        slice_indices_by_owner[it->first] = slice_index;
-        if (it->second->get_operation_kind() == Operation::TASK_OP_KIND)
-          slice_tasks[slice_index].push_back(it->first);
-      }
+      partition_replay_slices(gen, slice_indices_by_owner);
       for (unsigned idx = 1; idx < instructions.size(); ++idx)
       {
         Instruction *inst = instructions[idx];
@@ -2852,103 +3339,304 @@ namespace Legion {
     }
 
     //--------------------------------------------------------------------------
-    void PhysicalTemplate::transitive_reduction(void)
+    void PhysicalTemplate::partition_replay_slices(
+                                      const std::vector<unsigned> &gen,
+                      std::map<TraceLocalID, unsigned> &slice_indices_by_owner)
     //--------------------------------------------------------------------------
     {
-      // Transitive reduction inspired by Klaus Simon,
-      // "An improved algorithm for transitive closure on acyclic digraphs"
-
-      // First, build a DAG and find nodes with no incoming edges
-      std::vector<unsigned> topo_order;
-      topo_order.reserve(instructions.size());
-      std::vector<unsigned> inv_topo_order(events.size(), -1U);
-      std::vector<std::vector<unsigned> > incoming;
-      std::vector<std::vector<unsigned> > outgoing;
-      incoming.resize(events.size());
-      outgoing.resize(events.size());
-
-      for (std::map<unsigned, unsigned>::iterator it = frontiers.begin();
-           it != frontiers.end(); ++it)
+      // Instructions are replayed by the slice of the operation that owns
+      // them and every event that one slice produces for another needs
+      // an extra crossing event, so we partition the graph of operations
+      // connected by events with a streaming greedy heuristic that puts
+      // each operation in the slice holding most of its neighbors while
+      // keeping the number of instructions in each slice balanced
+      std::map<TraceLocalID, unsigned> owner_indices;
+      std::vector<TraceLocalID> owners;
+      std::vector<unsigned> inst_owners(instructions.size(), -1U);
+      std::vector<unsigned> weights;
+      for (unsigned idx = 1; idx < instructions.size(); ++idx)
       {
-        inv_topo_order[it->second] = topo_order.size();
-        topo_order.push_back(it->second);
+        const TraceLocalID &owner = instructions[idx]->owner;
+        std::map<TraceLocalID, unsigned>::const_iterator finder =
+          owner_indices.find(owner);
+        if (finder == owner_indices.end())
+        {
+          inst_owners[idx] = owners.size();
+          owner_indices[owner] = owners.size();
+          owners.push_back(owner);
+          weights.push_back(1);
+        }
+        else
+        {
+          inst_owners[idx] = finder->second;
+          weights[finder->second]++;
+        }
       }
-
-      std::map<TraceLocalID, Instruction*> term_insts;
-      for (unsigned idx = 0; idx < instructions.size(); ++idx)
+      std::vector<std::map<unsigned, unsigned> > neighbors(owners.size());
+      std::vector<unsigned> inputs;
+      for (unsigned idx = 1; idx < instructions.size(); ++idx)
       {
         Instruction *inst = instructions[idx];
+        inputs.clear();
         switch (inst->get_kind())
         {
-          // Pass these instructions as their events will be added later
-          case GET_TERM_EVENT :
-          case GET_OP_TERM_EVENT :
-            {
-              term_insts[inst->owner] = inst;
-              break;
-            }
-          case CREATE_AP_USER_EVENT :
+          case MERGE_EVENT :
             {
+              const std::set<unsigned> &rhs = inst->as_merge_event()->rhs;
+              inputs.insert(inputs.end(), rhs.begin(), rhs.end());
               break;
             }
           case TRIGGER_EVENT :
             {
-              TriggerEvent *trigger = inst->as_trigger_event();
-              incoming[trigger->lhs].push_back(trigger->rhs);
-              outgoing[trigger->rhs].push_back(trigger->lhs);
-              break;
-            }
-          case MERGE_EVENT :
-            {
-              MergeEvent *merge = inst->as_merge_event();
-              for (std::set<unsigned>::iterator it = merge->rhs.begin();
-                   it != merge->rhs.end(); ++it)
-              {
-                incoming[merge->lhs].push_back(*it);
-                outgoing[*it].push_back(merge->lhs);
-              }
+              inputs.push_back(inst->as_trigger_event()->rhs);
               break;
             }
           case ISSUE_COPY :
             {
-              IssueCopy *copy = inst->as_issue_copy();
-              incoming[copy->lhs].push_back(copy->precondition_idx);
-              outgoing[copy->precondition_idx].push_back(copy->lhs);
+              inputs.push_back(inst->as_issue_copy()->precondition_idx);
               break;
             }
           case ISSUE_FILL :
             {
-              IssueFill *fill = inst->as_issue_fill();
-              incoming[fill->lhs].push_back(fill->precondition_idx);
-              outgoing[fill->precondition_idx].push_back(fill->lhs);
-              break;
-            }
-          case SET_OP_SYNC_EVENT :
-            {
-              SetOpSyncEvent *sync = inst->as_set_op_sync_event();
-              inv_topo_order[sync->lhs] = topo_order.size();
-              topo_order.push_back(sync->lhs);
+              inputs.push_back(inst->as_issue_fill()->precondition_idx);
               break;
             }
-          case ASSIGN_FENCE_COMPLETION :
+          case COMPLETE_REPLAY :
             {
-              inv_topo_order[fence_completion_id] = topo_order.size();
-              topo_order.push_back(fence_completion_id);
+              inputs.push_back(inst->as_complete_replay()->rhs);
               break;
             }
-          case COMPLETE_REPLAY :
-            {
-              CompleteReplay *replay = inst->as_complete_replay();
-#ifdef DEBUG_LEGION
-              assert(term_insts.find(replay->owner) != term_insts.end());
-#endif
-              Instruction *term_inst = term_insts[replay->owner];
-              unsigned lhs = -1U;
-              switch (term_inst->get_kind())
-              {
-                case GET_TERM_EVENT :
-                  {
-                    GetTermEvent *term = term_inst->as_get_term_event();
+          default:
+            break;
+        }
+        const unsigned owner = inst_owners[idx];
+        for (std::vector<unsigned>::const_iterator it = inputs.begin();
+             it != inputs.end(); ++it)
+        {
+          const unsigned generator = gen[*it];
+          if (generator == 0)
+            continue;
+          const unsigned other = inst_owners[generator];
+          if (other == owner)
+            continue;
+          neighbors[owner][other]++;
+          neighbors[other][owner]++;
+        }
+      }
+      // Tasks stay with the slice for their target processor when there
+      // are enough distinct targets to spread them over all the slices
+      std::set<Processor> distinct_targets;
+      for (CachedMappings::iterator it = cached_mappings.begin(); it !=
+           cached_mappings.end(); ++it)
+        distinct_targets.insert(it->second.target_procs[0]);
+      const bool pin_tasks = distinct_targets.size() >= replay_parallelism;
+      std::vector<unsigned> owner_slices(owners.size(), -1U);
+      std::vector<unsigned> loads(replay_parallelism, 0);
+      unsigned total_weight = 0;
+      for (unsigned idx = 0; idx < owners.size(); ++idx)
+      {
+        total_weight += weights[idx];
+        if (!pin_tasks)
+          continue;
+        std::map<TraceLocalID, Operation*>::const_iterator op_finder =
+          operations.find(owners[idx]);
+        if ((op_finder == operations.end()) ||
+            (op_finder->second->get_operation_kind() != 
+             Operation::TASK_OP_KIND))
+          continue;
+        CachedMappings::const_iterator finder = 
+          cached_mappings.find(owners[idx]);
+#ifdef DEBUG_LEGION
+        assert(finder != cached_mappings.end());
+        assert(finder->second.target_procs.size() > 0);
+#endif
+        owner_slices[idx] = 
+          finder->second.target_procs[0].id % replay_parallelism;
+        loads[owner_slices[idx]] += weights[idx];
+      }
+      // Allow a little imbalance so neighbors can stay together
+      const double capacity = 
+        1.1 * double(total_weight) / double(replay_parallelism) + 1.0;
+      std::vector<unsigned> connections(replay_parallelism, 0);
+      for (unsigned idx = 0; idx < owners.size(); ++idx)
+      {
+        if (owner_slices[idx] != -1U)
+          continue;
+        for (unsigned slice = 0; slice < replay_parallelism; ++slice)
+          connections[slice] = 0;
+        for (std::map<unsigned, unsigned>::const_iterator it = 
+             neighbors[idx].begin(); it != neighbors[idx].end(); ++it)
+          if (owner_slices[it->first] != -1U)
+            connections[owner_slices[it->first]] += it->second;
+        unsigned best = 0;
+        double best_score = -1.0;
+        for (unsigned slice = 0; slice < replay_parallelism; ++slice)
+        {
+          const double score = double(connections[slice]) *
+            (1.0 - double(loads[slice]) / capacity);
+          if ((score > best_score) || 
+              ((score == best_score) && (loads[slice] < loads[best])))
+          {
+            best = slice;
+            best_score = score;
+          }
+        }
+        // Without any pull towards a slice with room left we just 
+        // keep the load balanced
+        if (best_score <= 0.0)
+          for (unsigned slice = 0; slice < replay_parallelism; ++slice)
+            if (loads[slice] < loads[best])
+              best = slice;
+        owner_slices[idx] = best;
+        loads[best] += weights[idx];
+      }
+      for (unsigned idx = 0; idx < owners.size(); ++idx)
+        slice_indices_by_owner[owners[idx]] = owner_slices[idx];
+      // Operations without any instructions still need a slice
+      for (std::map<TraceLocalID, Operation*>::iterator it =
+           operations.begin(); it != operations.end(); ++it)
+      {
+        std::map<TraceLocalID, unsigned>::const_iterator finder =
+          slice_indices_by_owner.find(it->first);
+        unsigned slice_index = -1U;
+        if (finder == slice_indices_by_owner.end())
+        {
+          slice_index = 0;
+          for (unsigned slice = 1; slice < replay_parallelism; ++slice)
+            if (loads[slice] < loads[slice_index])
+              slice_index = slice;
+          slice_indices_by_owner[it->first] = slice_index;
+        }
+        else
+          slice_index = finder->second;
+        if (it->second->get_operation_kind() == Operation::TASK_OP_KIND)
+          slice_tasks[slice_index].push_back(it->first);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalTemplate::report_slice_statistics(void) const
+    //--------------------------------------------------------------------------
+    {
+      if (!replayable || slices.empty() ||
+          (log_run.get_level() > Realm::Logger::LEVEL_INFO))
+        return;
+      size_t num_instructions = 0;
+      for (unsigned idx = 0; idx < slices.size(); ++idx)
+        num_instructions += slices[idx].size();
+      log_run.info("Template %p: %zd instructions in %zd slices "
+                   "with %zd crossing events", this, num_instructions,
+                   slices.size(), crossing_events.size());
+      for (unsigned idx = 0; idx < slices.size(); ++idx)
+      {
+        const SliceStatistics &stats = slice_statistics[idx];
+        log_run.info("  slice %d: %zd instructions, %zd tasks, %llu replays, "
+                     "%.3f us average, %.3f us max", idx, slices[idx].size(),
+                     slice_tasks[idx].size(), stats.replays,
+                     (stats.replays > 0) ? 
+                       1e-3 * stats.total_ns / stats.replays : 0.0,
+                     1e-3 * stats.max_ns);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void PhysicalTemplate::transitive_reduction(void)
+    //--------------------------------------------------------------------------
+    {
+      // Transitive reduction inspired by Klaus Simon,
+      // "An improved algorithm for transitive closure on acyclic digraphs"
+
+      // First, build a DAG and find nodes with no incoming edges
+      std::vector<unsigned> topo_order;
+      topo_order.reserve(instructions.size());
+      std::vector<unsigned> inv_topo_order(events.size(), -1U);
+      std::vector<std::vector<unsigned> > incoming;
+      std::vector<std::vector<unsigned> > outgoing;
+      incoming.resize(events.size());
+      outgoing.resize(events.size());
+
+      for (std::map<unsigned, unsigned>::iterator it = frontiers.begin();
+           it != frontiers.end(); ++it)
+      {
+        inv_topo_order[it->second] = topo_order.size();
+        topo_order.push_back(it->second);
+      }
+
+      std::map<TraceLocalID, Instruction*> term_insts;
+      for (unsigned idx = 0; idx < instructions.size(); ++idx)
+      {
+        Instruction *inst = instructions[idx];
+        switch (inst->get_kind())
+        {
+          // Pass these instructions as their events will be added later
+          case GET_TERM_EVENT :
+          case GET_OP_TERM_EVENT :
+            {
+              term_insts[inst->owner] = inst;
+              break;
+            }
+          case CREATE_AP_USER_EVENT :
+            {
+              break;
+            }
+          case TRIGGER_EVENT :
+            {
+              TriggerEvent *trigger = inst->as_trigger_event();
+              incoming[trigger->lhs].push_back(trigger->rhs);
+              outgoing[trigger->rhs].push_back(trigger->lhs);
+              break;
+            }
+          case MERGE_EVENT :
+            {
+              MergeEvent *merge = inst->as_merge_event();
+              for (std::set<unsigned>::iterator it = merge->rhs.begin();
+                   it != merge->rhs.end(); ++it)
+              {
+                incoming[merge->lhs].push_back(*it);
+                outgoing[*it].push_back(merge->lhs);
+              }
+              break;
+            }
+          case ISSUE_COPY :
+            {
+              IssueCopy *copy = inst->as_issue_copy();
+              incoming[copy->lhs].push_back(copy->precondition_idx);
+              outgoing[copy->precondition_idx].push_back(copy->lhs);
+              break;
+            }
+          case ISSUE_FILL :
+            {
+              IssueFill *fill = inst->as_issue_fill();
+              incoming[fill->lhs].push_back(fill->precondition_idx);
+              outgoing[fill->precondition_idx].push_back(fill->lhs);
+              break;
+            }
+          case SET_OP_SYNC_EVENT :
+            {
+              SetOpSyncEvent *sync = inst->as_set_op_sync_event();
+              inv_topo_order[sync->lhs] = topo_order.size();
+              topo_order.push_back(sync->lhs);
+              break;
+            }
+          case ASSIGN_FENCE_COMPLETION :
+            {
+              inv_topo_order[fence_completion_id] = topo_order.size();
+              topo_order.push_back(fence_completion_id);
+              break;
+            }
+          case COMPLETE_REPLAY :
+            {
+              CompleteReplay *replay = inst->as_complete_replay();
+#ifdef DEBUG_LEGION
+              assert(term_insts.find(replay->owner) != term_insts.end());
+#endif
+              Instruction *term_inst = term_insts[replay->owner];
+              unsigned lhs = -1U;
+              switch (term_inst->get_kind())
+              {
+                case GET_TERM_EVENT :
+                  {
+                    GetTermEvent *term = term_inst->as_get_term_event();
                     lhs = term->lhs;
                     break;
                   }
@@ -3458,6 +4146,886 @@ namespace Legion {
         std::cerr << "  " << (*it)->to_string() << std::endl;
     }
 
+    //--------------------------------------------------------------------------
+    bool PhysicalTemplate::pack_persistent_template(Serializer &rez,
+                                   ContextID ctx, ContextID top_ctx) const
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(!recording);
+      assert(replayable);
+#endif
+      // Instances are named by the views that were valid before the
+      // template ran so that a later run can find equivalent instances,
+      // we cannot persist templates that touch any other instances
+      std::map<PhysicalManager*,unsigned> manager_slots;
+      std::map<PhysicalInstance,unsigned> instance_slots;
+      rez.serialize<size_t>(previous_valid_views.size());
+      unsigned slot = 0;
+      for (LegionMap<InstanceView*, FieldMask>::aligned::const_iterator it =
+           previous_valid_views.begin(); it !=
+           previous_valid_views.end(); ++it, ++slot)
+      {
+        InstanceView *view = it->first;
+        LegionMap<InstanceView*, ContextID>::aligned::const_iterator
+          logical_finder = logical_contexts.find(view);
+        LegionMap<InstanceView*, ContextID>::aligned::const_iterator
+          physical_finder = physical_contexts.find(view);
+        // Regions created with returnable privileges keep their physical
+        // state in the top context rather than in the trace's context
+        if ((logical_finder == logical_contexts.end()) ||
+            (logical_finder->second != ctx) ||
+            (physical_finder == physical_contexts.end()) ||
+            ((physical_finder->second != ctx) &&
+             (physical_finder->second != top_ctx)) ||
+            !view->logical_node->is_region())
+          return false;
+        PhysicalManager *manager = view->get_manager();
+        // Several views can name the same instance
+        std::map<PhysicalManager*,unsigned>::const_iterator finder =
+          manager_slots.find(manager);
+        if (finder == manager_slots.end())
+        {
+          manager_slots[manager] = slot;
+          instance_slots[manager->get_instance()] = slot;
+          rez.serialize(slot);
+        }
+        else
+          rez.serialize(finder->second);
+        pack_persistent_node(rez, view->logical_node);
+        rez.serialize<bool>(physical_finder->second != ctx);
+        rez.serialize<bool>(view->is_reduction_view());
+        rez.serialize<ReductionOpID>(view->is_reduction_view() ?
+            view->as_reduction_view()->get_redop() : 0);
+        rez.serialize(manager->get_memory());
+        rez.serialize(manager->layout->allocated_fields);
+        rez.serialize(it->second);
+      }
+      rez.serialize<size_t>(previous_open_nodes.size());
+      for (LegionMap<std::pair<RegionTreeNode*, ContextID>,
+                     FieldMask>::aligned::const_iterator it =
+           previous_open_nodes.begin(); it !=
+           previous_open_nodes.end(); ++it)
+      {
+        if (it->first.second != ctx)
+          return false;
+        pack_persistent_node(rez, it->first.first);
+        rez.serialize(it->second);
+      }
+      rez.serialize<size_t>(previous_projections.size());
+      for (std::map<std::pair<RegionTreeNode*, ContextID>,
+           LegionMap<IndexSpaceNode*, FieldMask>::aligned>::const_iterator it =
+           previous_projections.begin(); it !=
+           previous_projections.end(); ++it)
+      {
+        if (it->first.second != ctx)
+          return false;
+        pack_persistent_node(rez, it->first.first);
+        rez.serialize<size_t>(it->second.size());
+        for (LegionMap<IndexSpaceNode*, FieldMask>::aligned::const_iterator
+             pit = it->second.begin(); pit != it->second.end(); ++pit)
+        {
+          rez.serialize(pit->first->handle);
+          rez.serialize(pit->second);
+        }
+      }
+      rez.serialize<size_t>(events.size());
+      rez.serialize<size_t>(operations.size());
+      for (std::map<TraceLocalID, Operation*>::const_iterator it =
+           operations.begin(); it != operations.end(); ++it)
+      {
+        rez.serialize(it->first.first);
+        rez.serialize(it->first.second);
+      }
+      rez.serialize<size_t>(frontiers.size());
+      for (std::map<unsigned, unsigned>::const_iterator it =
+           frontiers.begin(); it != frontiers.end(); ++it)
+      {
+        rez.serialize(it->first);
+        rez.serialize(it->second);
+      }
+      rez.serialize<size_t>(crossing_events.size());
+      for (std::map<unsigned, unsigned>::const_iterator it =
+           crossing_events.begin(); it != crossing_events.end(); ++it)
+      {
+        rez.serialize(it->first);
+        rez.serialize(it->second);
+      }
+#ifdef DEBUG_LEGION
+      assert(slices.size() == replay_parallelism);
+      assert(slice_tasks.size() == replay_parallelism);
+#endif
+      for (unsigned idx = 0; idx < replay_parallelism; ++idx)
+      {
+        const std::vector<TraceLocalID> &tasks = slice_tasks[idx];
+        rez.serialize<size_t>(tasks.size());
+        for (std::vector<TraceLocalID>::const_iterator it = tasks.begin();
+             it != tasks.end(); ++it)
+        {
+          rez.serialize(it->first);
+          rez.serialize(it->second);
+        }
+        const std::vector<Instruction*> &slice = slices[idx];
+        rez.serialize<size_t>(slice.size());
+        for (std::vector<Instruction*>::const_iterator it = slice.begin();
+             it != slice.end(); ++it)
+          if (!pack_persistent_instruction(*it, rez, instance_slots))
+            return false;
+      }
+      rez.serialize<size_t>(cached_mappings.size());
+      for (CachedMappings::const_iterator it = cached_mappings.begin();
+           it != cached_mappings.end(); ++it)
+      {
+        rez.serialize(it->first.first);
+        rez.serialize(it->first.second);
+        rez.serialize(it->second.chosen_variant);
+        rez.serialize(it->second.task_priority);
+        rez.serialize<bool>(it->second.postmap_task);
+        rez.serialize<size_t>(it->second.target_procs.size());
+        for (std::vector<Processor>::const_iterator pit =
+             it->second.target_procs.begin(); pit !=
+             it->second.target_procs.end(); ++pit)
+          rez.serialize(*pit);
+        rez.serialize<size_t>(it->second.physical_instances.size());
+        for (std::deque<InstanceSet>::const_iterator pit =
+             it->second.physical_instances.begin(); pit !=
+             it->second.physical_instances.end(); ++pit)
+          if (!pack_persistent_instances(rez, *pit, manager_slots))
+            return false;
+      }
+      rez.serialize<size_t>(dedup_summary_ops.size());
+      for (std::vector<SummaryOpInfo>::const_iterator it =
+           dedup_summary_ops.begin(); it != dedup_summary_ops.end(); ++it)
+      {
+        rez.serialize<size_t>(it->requirements.size());
+        for (unsigned idx = 0; idx < it->requirements.size(); ++idx)
+        {
+          ExternalTask::pack_region_requirement(it->requirements[idx], rez);
+          if (!pack_persistent_instances(rez, it->instances[idx],
+                                         manager_slots))
+            return false;
+          rez.serialize(it->parent_indices[idx]);
+        }
+      }
+      rez.serialize<size_t>(last_users.size());
+      for (std::map<InstanceAccess, UserInfos>::const_iterator it =
+           last_users.begin(); it != last_users.end(); ++it)
+      {
+        std::map<PhysicalInstance,unsigned>::const_iterator finder =
+          instance_slots.find(it->first.first);
+        if (finder == instance_slots.end())
+          return false;
+        rez.serialize(finder->second);
+        rez.serialize(it->first.second);
+        rez.serialize<size_t>(it->second.size());
+        for (UserInfos::const_iterator uit = it->second.begin();
+             uit != it->second.end(); ++uit)
+        {
+          rez.serialize<bool>(uit->read);
+          pack_persistent_node(rez, uit->node);
+          rez.serialize<size_t>(uit->users.size());
+          for (std::set<unsigned>::const_iterator vit = uit->users.begin();
+               vit != uit->users.end(); ++vit)
+            rez.serialize(*vit);
+        }
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ PhysicalTemplate* PhysicalTemplate::unpack_persistent_template(
+                                               PhysicalTrace *trace,
+                                               const std::vector<char> &buffer,
+                                               ContextID ctx, ContextID top_ctx)
+    //--------------------------------------------------------------------------
+    {
+      PhysicalTemplate *tpl = new PhysicalTemplate(trace,ApEvent::NO_AP_EVENT);
+      Deserializer derez(&buffer[0], buffer.size());
+      if (!tpl->bind_persistent_template(derez, ctx, top_ctx))
+      {
+        // Skip whatever was not needed to tell that it does not apply
+        derez.advance_pointer(derez.get_remaining_bytes());
+        delete tpl;
+        return NULL;
+      }
+      return tpl;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTemplate::bind_persistent_template(Deserializer &derez,
+                                           ContextID ctx, ContextID top_ctx)
+    //--------------------------------------------------------------------------
+    {
+      RegionTreeForest *forest = trace->runtime->forest;
+      // Bind each instance slot to a view of an equivalent instance
+      // that is valid in the current physical state of its region
+      size_t num_slots;
+      derez.deserialize(num_slots);
+      std::vector<PhysicalManager*> slots(num_slots, NULL);
+      std::set<PhysicalManager*> bound_managers;
+      for (unsigned idx = 0; idx < num_slots; ++idx)
+      {
+        unsigned manager_slot;
+        derez.deserialize(manager_slot);
+        RegionTreeNode *node = unpack_persistent_node(derez, forest);
+        bool top_physical;
+        derez.deserialize<bool>(top_physical);
+        const ContextID physical_ctx = top_physical ? top_ctx : ctx;
+        bool is_reduction;
+        derez.deserialize<bool>(is_reduction);
+        ReductionOpID redop;
+        derez.deserialize(redop);
+        Memory memory;
+        derez.deserialize(memory);
+        FieldMask allocated_fields, valid_fields;
+        derez.deserialize(allocated_fields);
+        derez.deserialize(valid_fields);
+        if ((node == NULL) || (manager_slot > idx))
+          return false;
+        PhysicalState *state = new PhysicalState(node, false);
+        VersionManager &manager = 
+          node->get_current_version_manager(physical_ctx);
+        manager.update_physical_state(state);
+        state->capture_state();
+        std::vector<InstanceView*> candidates;
+        if (is_reduction)
+        {
+          for (LegionMap<ReductionView*, FieldMask,
+                         VALID_VIEW_ALLOC>::track_aligned::iterator vit =
+               state->reduction_views.begin(); vit !=
+               state->reduction_views.end(); ++vit)
+            if (!(valid_fields - vit->second) &&
+                (vit->first->get_redop() == redop))
+              candidates.push_back(vit->first);
+        }
+        else
+        {
+          for (LegionMap<LogicalView*, FieldMask,
+                         VALID_VIEW_ALLOC>::track_aligned::iterator vit =
+               state->valid_views.begin(); vit !=
+               state->valid_views.end(); ++vit)
+            if (vit->first->is_materialized_view() &&
+                !(valid_fields - vit->second))
+              candidates.push_back(vit->first->as_instance_view());
+        }
+        delete state;
+        InstanceView *view = NULL;
+        for (std::vector<InstanceView*>::const_iterator it =
+             candidates.begin(); it != candidates.end(); ++it)
+        {
+          PhysicalManager *candidate = (*it)->get_manager();
+          if ((candidate->get_memory() != memory) ||
+              (candidate->layout->allocated_fields != allocated_fields))
+            continue;
+          // Slots that named the same instance must still do so and
+          // slots that named different instances must stay distinct
+          if (manager_slot == idx)
+          {
+            if (bound_managers.find(candidate) != bound_managers.end())
+              continue;
+          }
+          else if (candidate != slots[manager_slot])
+            continue;
+          view = *it;
+          break;
+        }
+        if (view == NULL)
+          return false;
+        slots[idx] = view->get_manager();
+        bound_managers.insert(slots[idx]);
+        previous_valid_views[view] = valid_fields;
+        logical_contexts[view] = ctx;
+        physical_contexts[view] = physical_ctx;
+      }
+      size_t num_open_nodes;
+      derez.deserialize(num_open_nodes);
+      for (unsigned idx = 0; idx < num_open_nodes; ++idx)
+      {
+        RegionTreeNode *node = unpack_persistent_node(derez, forest);
+        if (node == NULL)
+          return false;
+        derez.deserialize(
+            previous_open_nodes[std::pair<RegionTreeNode*,ContextID>(node,ctx)]);
+      }
+      size_t num_projections;
+      derez.deserialize(num_projections);
+      for (unsigned idx = 0; idx < num_projections; ++idx)
+      {
+        RegionTreeNode *node = unpack_persistent_node(derez, forest);
+        if (node == NULL)
+          return false;
+        LegionMap<IndexSpaceNode*, FieldMask>::aligned &projections =
+          previous_projections[std::pair<RegionTreeNode*,ContextID>(node,ctx)];
+        size_t num_spaces;
+        derez.deserialize(num_spaces);
+        // The projection spaces are found through the logical state
+        // since that is the only place they need to match
+        const LogicalState &state = node->get_logical_state(ctx);
+        for (unsigned sidx = 0; sidx < num_spaces; ++sidx)
+        {
+          IndexSpace handle;
+          derez.deserialize(handle);
+          IndexSpaceNode *space = NULL;
+          for (LegionList<FieldState>::aligned::const_iterator fit =
+               state.field_states.begin(); fit !=
+               state.field_states.end(); ++fit)
+            if ((fit->projection != 0) &&
+                (fit->projection_space->handle == handle))
+            {
+              space = fit->projection_space;
+              break;
+            }
+          if (space == NULL)
+            return false;
+          derez.deserialize(projections[space]);
+        }
+      }
+      size_t num_events;
+      derez.deserialize(num_events);
+      events.resize(num_events);
+      user_events.resize(num_events);
+      size_t num_operations;
+      derez.deserialize(num_operations);
+      for (unsigned idx = 0; idx < num_operations; ++idx)
+      {
+        TraceLocalID key;
+        derez.deserialize(key.first);
+        derez.deserialize(key.second);
+        operations[key] = NULL;
+      }
+      size_t num_frontiers;
+      derez.deserialize(num_frontiers);
+      for (unsigned idx = 0; idx < num_frontiers; ++idx)
+      {
+        unsigned from;
+        derez.deserialize(from);
+        derez.deserialize(frontiers[from]);
+      }
+      size_t num_crossing_events;
+      derez.deserialize(num_crossing_events);
+      for (unsigned idx = 0; idx < num_crossing_events; ++idx)
+      {
+        unsigned from;
+        derez.deserialize(from);
+        derez.deserialize(crossing_events[from]);
+      }
+      slices.resize(replay_parallelism);
+      slice_tasks.resize(replay_parallelism);
+      for (unsigned idx = 0; idx < replay_parallelism; ++idx)
+      {
+        size_t num_tasks;
+        derez.deserialize(num_tasks);
+        slice_tasks[idx].resize(num_tasks);
+        for (unsigned tidx = 0; tidx < num_tasks; ++tidx)
+        {
+          derez.deserialize(slice_tasks[idx][tidx].first);
+          derez.deserialize(slice_tasks[idx][tidx].second);
+        }
+        size_t num_instructions;
+        derez.deserialize(num_instructions);
+        for (unsigned iidx = 0; iidx < num_instructions; ++iidx)
+          if (!unpack_persistent_instruction(derez, forest, slots, slices[idx]))
+            return false;
+      }
+      size_t num_mappings;
+      derez.deserialize(num_mappings);
+      for (unsigned idx = 0; idx < num_mappings; ++idx)
+      {
+        TraceLocalID key;
+        derez.deserialize(key.first);
+        derez.deserialize(key.second);
+        CachedMapping &mapping = cached_mappings[key];
+        derez.deserialize(mapping.chosen_variant);
+        derez.deserialize(mapping.task_priority);
+        derez.deserialize<bool>(mapping.postmap_task);
+        size_t num_procs;
+        derez.deserialize(num_procs);
+        mapping.target_procs.resize(num_procs);
+        for (unsigned pidx = 0; pidx < num_procs; ++pidx)
+          derez.deserialize(mapping.target_procs[pidx]);
+        size_t num_instances;
+        derez.deserialize(num_instances);
+        mapping.physical_instances.resize(num_instances);
+        for (unsigned iidx = 0; iidx < num_instances; ++iidx)
+        {
+          InstanceSet &instances = mapping.physical_instances[iidx];
+          if (!unpack_persistent_instances(derez, instances, slots))
+          {
+            // No references were added for them so the destructor
+            // must not find any of them to release
+            instances.clear();
+            return false;
+          }
+          instances.add_valid_references(MAPPING_ACQUIRE_REF);
+        }
+      }
+      size_t num_summary_ops;
+      derez.deserialize(num_summary_ops);
+      dedup_summary_ops.resize(num_summary_ops);
+      for (unsigned idx = 0; idx < num_summary_ops; ++idx)
+      {
+        SummaryOpInfo &summary_op = dedup_summary_ops[idx];
+        size_t num_requirements;
+        derez.deserialize(num_requirements);
+        summary_op.requirements.resize(num_requirements);
+        summary_op.instances.resize(num_requirements);
+        summary_op.parent_indices.resize(num_requirements);
+        for (unsigned ridx = 0; ridx < num_requirements; ++ridx)
+        {
+          ExternalTask::unpack_region_requirement(
+              summary_op.requirements[ridx], derez);
+          if (!unpack_persistent_instances(derez, 
+                summary_op.instances[ridx], slots))
+            return false;
+          derez.deserialize(summary_op.parent_indices[ridx]);
+        }
+      }
+      size_t num_last_users;
+      derez.deserialize(num_last_users);
+      for (unsigned idx = 0; idx < num_last_users; ++idx)
+      {
+        unsigned slot, field;
+        derez.deserialize(slot);
+        derez.deserialize(field);
+        if (slot >= slots.size())
+          return false;
+        UserInfos &infos =
+          last_users[InstanceAccess(slots[slot]->get_instance(), field)];
+        size_t num_infos;
+        derez.deserialize(num_infos);
+        for (unsigned uidx = 0; uidx < num_infos; ++uidx)
+        {
+          bool read;
+          derez.deserialize<bool>(read);
+          RegionTreeNode *node = unpack_persistent_node(derez, forest);
+          if ((node == NULL) || !node->is_region())
+            return false;
+          size_t num_users;
+          derez.deserialize(num_users);
+#ifdef DEBUG_LEGION
+          assert(num_users > 0);
+#endif
+          unsigned user;
+          derez.deserialize(user);
+          infos.push_back(UserInfo(read, user, node->as_region_node()));
+          for (unsigned vidx = 1; vidx < num_users; ++vidx)
+          {
+            derez.deserialize(user);
+            infos.back().users.insert(user);
+          }
+        }
+      }
+      // Anything left over means the template was not the one we expected
+      if (derez.get_remaining_bytes() != 0)
+        return false;
+      event_map.clear();
+      recording = false;
+      replayable = true;
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTemplate::pack_persistent_instruction(Instruction *inst,
+                                                       Serializer &rez,
+                      const std::map<PhysicalInstance,unsigned> &slots) const
+    //--------------------------------------------------------------------------
+    {
+      const InstructionKind kind = inst->get_kind();
+      rez.serialize(kind);
+      rez.serialize(inst->owner.first);
+      rez.serialize(inst->owner.second);
+      switch (kind)
+      {
+        case GET_TERM_EVENT:
+          {
+            rez.serialize(inst->as_get_term_event()->lhs);
+            break;
+          }
+        case GET_OP_TERM_EVENT:
+          {
+            rez.serialize(inst->as_get_op_term_event()->lhs);
+            break;
+          }
+        case CREATE_AP_USER_EVENT:
+          {
+            rez.serialize(inst->as_create_ap_user_event()->lhs);
+            break;
+          }
+        case TRIGGER_EVENT:
+          {
+            TriggerEvent *trigger = inst->as_trigger_event();
+            rez.serialize(trigger->lhs);
+            rez.serialize(trigger->rhs);
+            break;
+          }
+        case MERGE_EVENT:
+          {
+            MergeEvent *merge = inst->as_merge_event();
+            rez.serialize(merge->lhs);
+            rez.serialize<size_t>(merge->rhs.size());
+            for (std::set<unsigned>::const_iterator it = merge->rhs.begin();
+                 it != merge->rhs.end(); ++it)
+              rez.serialize(*it);
+            break;
+          }
+        case ISSUE_COPY:
+          {
+            IssueCopy *copy = inst->as_issue_copy();
+            // Predicates are not stable across runs
+            if (copy->predicate_guard.exists())
+              return false;
+            rez.serialize(copy->lhs);
+            pack_persistent_node(rez, copy->node);
+            if (!pack_persistent_fields(rez, copy->src_fields, slots) ||
+                !pack_persistent_fields(rez, copy->dst_fields, slots))
+              return false;
+            rez.serialize(copy->precondition_idx);
+            rez.serialize<bool>(copy->intersect != NULL);
+            if (copy->intersect != NULL)
+              pack_persistent_node(rez, copy->intersect);
+            rez.serialize(copy->redop);
+            rez.serialize<bool>(copy->reduction_fold);
+            break;
+          }
+        case ISSUE_FILL:
+          {
+            IssueFill *fill = inst->as_issue_fill();
+            if (fill->predicate_guard.exists())
+              return false;
+            rez.serialize(fill->lhs);
+            pack_persistent_node(rez, fill->node);
+            if (!pack_persistent_fields(rez, fill->fields, slots))
+              return false;
+            rez.serialize(fill->fill_size);
+            rez.serialize(fill->fill_buffer, fill->fill_size);
+            rez.serialize(fill->precondition_idx);
+            rez.serialize<bool>(fill->intersect != NULL);
+            if (fill->intersect != NULL)
+              pack_persistent_node(rez, fill->intersect);
+            break;
+          }
+        case SET_OP_SYNC_EVENT:
+          {
+            rez.serialize(inst->as_set_op_sync_event()->lhs);
+            break;
+          }
+        case ASSIGN_FENCE_COMPLETION:
+          {
+            rez.serialize(inst->as_assignment_fence_completion()->lhs);
+            break;
+          }
+        case COMPLETE_REPLAY:
+          {
+            rez.serialize(inst->as_complete_replay()->rhs);
+            break;
+          }
+        default:
+          assert(false);
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    bool PhysicalTemplate::unpack_persistent_instruction(Deserializer &derez,
+                                                     RegionTreeForest *forest,
+                                     const std::vector<PhysicalManager*> &slots,
+                                            std::vector<Instruction*> &slice)
+    //--------------------------------------------------------------------------
+    {
+      InstructionKind kind;
+      derez.deserialize(kind);
+      TraceLocalID owner;
+      derez.deserialize(owner.first);
+      derez.deserialize(owner.second);
+      Instruction *inst = NULL;
+      switch (kind)
+      {
+        case GET_TERM_EVENT:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            inst = new GetTermEvent(*this, lhs, owner);
+            break;
+          }
+        case GET_OP_TERM_EVENT:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            inst = new GetOpTermEvent(*this, lhs, owner);
+            break;
+          }
+        case CREATE_AP_USER_EVENT:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            inst = new CreateApUserEvent(*this, lhs, owner);
+            break;
+          }
+        case TRIGGER_EVENT:
+          {
+            unsigned lhs, rhs;
+            derez.deserialize(lhs);
+            derez.deserialize(rhs);
+            inst = new TriggerEvent(*this, lhs, rhs, owner);
+            break;
+          }
+        case MERGE_EVENT:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            size_t num_rhs;
+            derez.deserialize(num_rhs);
+            std::set<unsigned> rhs;
+            for (unsigned idx = 0; idx < num_rhs; ++idx)
+            {
+              unsigned event;
+              derez.deserialize(event);
+              rhs.insert(event);
+            }
+            inst = new MergeEvent(*this, lhs, rhs, owner);
+            break;
+          }
+        case ISSUE_COPY:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            RegionTreeNode *node = unpack_persistent_node(derez, forest);
+            std::vector<CopySrcDstField> src_fields, dst_fields;
+            if (!unpack_persistent_fields(derez, src_fields, slots) ||
+                !unpack_persistent_fields(derez, dst_fields, slots))
+              return false;
+            unsigned precondition_idx;
+            derez.deserialize(precondition_idx);
+            bool has_intersect;
+            derez.deserialize<bool>(has_intersect);
+            RegionTreeNode *intersect = NULL;
+            if (has_intersect)
+            {
+              intersect = unpack_persistent_node(derez, forest);
+              if (intersect == NULL)
+                return false;
+            }
+            ReductionOpID redop;
+            derez.deserialize(redop);
+            bool reduction_fold;
+            derez.deserialize<bool>(reduction_fold);
+            if ((node == NULL) || !node->is_region())
+              return false;
+            inst = new IssueCopy(*this, lhs, node->as_region_node(), owner,
+                                 src_fields, dst_fields, precondition_idx,
+                                 PredEvent::NO_PRED_EVENT, intersect,
+                                 redop, reduction_fold);
+            break;
+          }
+        case ISSUE_FILL:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            RegionTreeNode *node = unpack_persistent_node(derez, forest);
+            std::vector<CopySrcDstField> fields;
+            if (!unpack_persistent_fields(derez, fields, slots))
+              return false;
+            size_t fill_size;
+            derez.deserialize(fill_size);
+            const void *fill_buffer = derez.get_current_pointer();
+            derez.advance_pointer(fill_size);
+            unsigned precondition_idx;
+            derez.deserialize(precondition_idx);
+            bool has_intersect;
+            derez.deserialize<bool>(has_intersect);
+            RegionTreeNode *intersect = NULL;
+            if (has_intersect)
+            {
+              intersect = unpack_persistent_node(derez, forest);
+              if (intersect == NULL)
+                return false;
+            }
+            if ((node == NULL) || !node->is_region())
+              return false;
+            inst = new IssueFill(*this, lhs, node->as_region_node(), owner,
+                                 fields, fill_buffer, fill_size,
+                                 precondition_idx, PredEvent::NO_PRED_EVENT,
+#ifdef LEGION_SPY
+                                 0,
+#endif
+                                 intersect);
+            break;
+          }
+        case SET_OP_SYNC_EVENT:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            inst = new SetOpSyncEvent(*this, lhs, owner);
+            break;
+          }
+        case ASSIGN_FENCE_COMPLETION:
+          {
+            unsigned lhs;
+            derez.deserialize(lhs);
+            inst = new AssignFenceCompletion(*this, lhs, owner);
+            break;
+          }
+        case COMPLETE_REPLAY:
+          {
+            unsigned rhs;
+            derez.deserialize(rhs);
+            inst = new CompleteReplay(*this, owner, rhs);
+            break;
+          }
+        default:
+          return false;
+      }
+      // Keep them in the instruction list too so they get deleted
+      instructions.push_back(inst);
+      slice.push_back(inst);
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ bool PhysicalTemplate::pack_persistent_fields(Serializer &rez,
+                                 const std::vector<CopySrcDstField> &fields,
+                               const std::map<PhysicalInstance,unsigned> &slots)
+    //--------------------------------------------------------------------------
+    {
+      rez.serialize<size_t>(fields.size());
+      for (std::vector<CopySrcDstField>::const_iterator it = fields.begin();
+           it != fields.end(); ++it)
+      {
+        std::map<PhysicalInstance,unsigned>::const_iterator finder =
+          slots.find(it->inst);
+        if ((finder == slots.end()) || (it->indirect_index != -1))
+          return false;
+        rez.serialize(finder->second);
+        rez.serialize(it->field_id);
+        rez.serialize(it->size);
+        rez.serialize(it->redop_id);
+        rez.serialize<bool>(it->red_fold);
+        rez.serialize(it->serdez_id);
+        rez.serialize(it->subfield_offset);
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ bool PhysicalTemplate::unpack_persistent_fields(
+                                     Deserializer &derez,
+                                     std::vector<CopySrcDstField> &fields,
+                                     const std::vector<PhysicalManager*> &slots)
+    //--------------------------------------------------------------------------
+    {
+      size_t num_fields;
+      derez.deserialize(num_fields);
+      fields.resize(num_fields);
+      for (unsigned idx = 0; idx < num_fields; ++idx)
+      {
+        CopySrcDstField &field = fields[idx];
+        unsigned slot;
+        derez.deserialize(slot);
+        if (slot >= slots.size())
+          return false;
+        field.inst = slots[slot]->get_instance();
+        derez.deserialize(field.field_id);
+        derez.deserialize(field.size);
+        derez.deserialize(field.redop_id);
+        derez.deserialize<bool>(field.red_fold);
+        derez.deserialize(field.serdez_id);
+        derez.deserialize(field.subfield_offset);
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ bool PhysicalTemplate::pack_persistent_instances(
+                               Serializer &rez, const InstanceSet &instances,
+                               const std::map<PhysicalManager*,unsigned> &slots)
+    //--------------------------------------------------------------------------
+    {
+      rez.serialize<size_t>(instances.size());
+      for (unsigned idx = 0; idx < instances.size(); ++idx)
+      {
+        const InstanceRef &ref = instances[idx];
+        if (ref.is_virtual_ref())
+          return false;
+        std::map<PhysicalManager*,unsigned>::const_iterator finder =
+          slots.find(ref.get_manager());
+        if (finder == slots.end())
+          return false;
+        rez.serialize(finder->second);
+        rez.serialize(ref.get_valid_fields());
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ bool PhysicalTemplate::unpack_persistent_instances(
+                                     Deserializer &derez,
+                                     InstanceSet &instances,
+                                     const std::vector<PhysicalManager*> &slots)
+    //--------------------------------------------------------------------------
+    {
+      size_t num_instances;
+      derez.deserialize(num_instances);
+      for (unsigned idx = 0; idx < num_instances; ++idx)
+      {
+        unsigned slot;
+        derez.deserialize(slot);
+        FieldMask valid_fields;
+        derez.deserialize(valid_fields);
+        if (slot >= slots.size())
+          return false;
+        instances.add_instance(InstanceRef(slots[slot], valid_fields));
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void PhysicalTemplate::pack_persistent_node(Serializer &rez,
+                                                         RegionTreeNode *node)
+    //--------------------------------------------------------------------------
+    {
+      if (node->is_region())
+      {
+        rez.serialize<bool>(true);
+        rez.serialize(node->as_region_node()->handle);
+      }
+      else
+      {
+        rez.serialize<bool>(false);
+        rez.serialize(node->as_partition_node()->handle);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ RegionTreeNode* PhysicalTemplate::unpack_persistent_node(
+                                Deserializer &derez, RegionTreeForest *forest)
+    //--------------------------------------------------------------------------
+    {
+      bool is_region;
+      derez.deserialize<bool>(is_region);
+      RegionTreeNode *node = NULL;
+      if (is_region)
+      {
+        LogicalRegion handle;
+        derez.deserialize(handle);
+        node = forest->find_local_node(handle);
+      }
+      else
+      {
+        LogicalPartition handle;
+        derez.deserialize(handle);
+        node = forest->find_local_node(handle);
+      }
+      // Nodes that do not exist yet in this run cannot be named by any of
+      // the views we bind to; the forest keeps the ones that do exist
+      // alive for as long as their regions so we need not hold a reference
+      if ((node != NULL) && node->remove_base_resource_ref(REGION_TREE_REF))
+      {
+        delete node;
+        return NULL;
+      }
+      return node;
+    }
+
     //--------------------------------------------------------------------------
     void PhysicalTemplate::record_mapper_output(SingleTask *task,
                                             const Mapper::MapTaskOutput &output,
@@ -3965,6 +5533,15 @@ namespace Legion {
       {
         ReductionView *reduction_view = view->as_reduction_view();
         PhysicalManager *manager = reduction_view->get_manager();
+        // Replays would have to rewind the list as well as refill it
+        if (manager->is_list_manager())
+          REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                        "Illegal use of reduction list instance " IDFMT
+                        " in a physical trace by operation %s (UID %lld). "
+                        "Reduction list instances cannot be traced, use a "
+                        "reduction fold instance instead.",
+                        manager->get_instance().id, op->get_logging_name(),
+                        op->get_unique_op_id())
         LayoutDescription *const layout = manager->layout;
         const ReductionOp *reduction_op =
           Runtime::get_reduction_op(reduction_view->get_redop());
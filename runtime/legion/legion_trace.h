@@ -85,6 +85,10 @@ namespace Legion {
       virtual StaticTrace* as_static_trace(void) = 0;
       virtual DynamicTrace* as_dynamic_trace(void) = 0;
       virtual TraceID get_trace_id(void) const = 0;
+      // Hash of the captured operations and their dependences that keys
+      // physical templates persisted across runs, zero if not supported
+      // or if the capture of the trace has not been analyzed yet
+      virtual uint64_t get_structure_hash(void) const = 0;
     public:
       virtual bool is_fixed(void) const = 0;
       virtual bool handles_region_tree(RegionTreeID tid) const = 0;
@@ -169,6 +173,7 @@ namespace Legion {
       virtual StaticTrace* as_static_trace(void) { return this; }
       virtual DynamicTrace* as_dynamic_trace(void) { return NULL; }
       virtual TraceID get_trace_id(void) const { return 0; }
+      virtual uint64_t get_structure_hash(void) const { return 0; }
     public:
       virtual bool is_fixed(void) const;
       virtual bool handles_region_tree(RegionTreeID tid) const;
@@ -214,6 +219,8 @@ namespace Legion {
       public:
         OperationInfo(Operation *op)
           : kind(op->get_operation_kind()), count(op->get_region_count()) { }
+        OperationInfo(Operation::OpKind k, unsigned c)
+          : kind(k), count(c) { }
       public:
         Operation::OpKind kind;
         unsigned count;
@@ -230,6 +237,7 @@ namespace Legion {
       virtual StaticTrace* as_static_trace(void) { return NULL; }
       virtual DynamicTrace* as_dynamic_trace(void) { return this; }
       virtual TraceID get_trace_id(void) const { return tid; }
+      virtual uint64_t get_structure_hash(void) const;
     public:
       // Called by task execution thread
       virtual bool is_fixed(void) const { return fixed; }
@@ -237,6 +245,10 @@ namespace Legion {
     public:
       // Called by analysis thread
       void end_trace_capture(void);
+    public:
+      // Captured dependences, their hash identifies the structure that
+      // persistent physical templates were recorded for
+      void pack_persistent_capture(Serializer &rez) const;
     public:
       virtual void record_static_dependences(Operation *op,
                           const std::vector<StaticDependence> *dependences);
@@ -461,6 +473,22 @@ namespace Legion {
      * analysis for series of operations in a given task's context.
      */
     class PhysicalTrace {
+    public:
+      // Bound on the number of templates kept in a persistent trace file
+      static const unsigned MAX_PERSISTENT_TEMPLATES = 8;
+      // Leading word of persistent trace files ("LGTRACE2")
+      static const uint64_t PERSISTENT_TEMPLATE_MAGIC = 0x4c47545241434532ULL;
+    public:
+      struct SavePersistentArgs : public LgTaskArgs<SavePersistentArgs> {
+      public:
+        static const LgTaskID TASK_ID = LG_SAVE_PERSISTENT_TRACE_ID;
+      public:
+        SavePersistentArgs(std::string *f, std::vector<char> *c)
+          : LgTaskArgs<SavePersistentArgs>(0), file_name(f), contents(c) { }
+      public:
+        std::string *file_name;
+        std::vector<char> *contents;
+      };
     public:
       PhysicalTrace(Runtime *runtime, LegionTrace *logical_trace);
       PhysicalTrace(const PhysicalTrace &rhs);
@@ -469,7 +497,7 @@ namespace Legion {
       PhysicalTrace& operator=(const PhysicalTrace &rhs);
     public:
       void clear_cached_template(void) { current_template = NULL; }
-      void check_template_preconditions(void);
+      void check_template_preconditions(Operation *op);
     public:
       PhysicalTemplate* get_current_template(void) { return current_template; }
       bool has_any_templates(void) const { return templates.size() > 0; }
@@ -480,9 +508,21 @@ namespace Legion {
         { return previous_template_completion; }
     public:
       PhysicalTemplate* start_new_template(ApEvent fence_event);
-      RtEvent fix_trace(PhysicalTemplate *tpl, bool has_blocking_call);
+      RtEvent fix_trace(PhysicalTemplate *tpl, Operation *op,
+                        bool has_blocking_call);
     public:
       void initialize_template(ApEvent fence_completion, bool recurrent);
+      void record_template_event(Operation *op, TraceTemplateKind kind) const;
+    public:
+      // Templates persisted in the directory given by -lg:trace_cache
+      void load_persistent_templates(DynamicTrace *trace);
+      // Identifies the executable and its loaded libraries, zero if unknown
+      static uint64_t find_build_id(const char *directory);
+      static void handle_save_persistent(const void *args);
+    protected:
+      bool get_persistent_file(std::string &file_name);
+      bool validate_persistent_templates(void);
+      void save_persistent_templates(PhysicalTemplate *tpl);
     public:
       Runtime * const runtime;
       const LegionTrace *logical_trace;
@@ -491,6 +531,16 @@ namespace Legion {
       PhysicalTemplate* current_template;
       std::vector<PhysicalTemplate*> templates;
       unsigned nonreplayable_count;
+    private:
+      // Serialized templates from a previous run that have not yet
+      // been bound to the instances of this run
+      std::vector<std::vector<char> > persistent_templates;
+      // Hash of the dependences the persistent templates were recorded
+      // for, zero once they have been checked against this run's capture
+      uint64_t persistent_structure_hash;
+      std::string persistent_file;
+      // Saves of the same file are done in the background and in order
+      RtEvent last_persistent_save;
     public:
       std::vector<Processor> replay_targets;
       ApEvent previous_template_completion;
@@ -555,6 +605,7 @@ namespace Legion {
     public:
       bool check_preconditions(void);
       bool check_replayable(void) const;
+      bool check_idempotent(void) const;
       void register_operation(Operation *op);
       void execute_all(void);
       void execute_slice(unsigned slice_idx);
@@ -568,10 +619,43 @@ namespace Legion {
       void transitive_reduction(void);
       void propagate_copies(std::vector<unsigned> &gen);
       void prepare_parallel_replay(const std::vector<unsigned> &gen);
+      void partition_replay_slices(const std::vector<unsigned> &gen,
+                 std::map<TraceLocalID, unsigned> &slice_indices_by_owner);
       void push_complete_replays();
       void generate_summary_operations(void);
       void dump_template(void);
       void dump_instructions(const std::vector<Instruction*> &instructions);
+      void report_slice_statistics(void) const;
+    public:
+      bool pack_persistent_template(Serializer &rez, ContextID ctx,
+                                    ContextID top_ctx) const;
+      static PhysicalTemplate* unpack_persistent_template(PhysicalTrace *trace,
+                                       const std::vector<char> &buffer,
+                                       ContextID ctx, ContextID top_ctx);
+    private:
+      bool bind_persistent_template(Deserializer &derez, ContextID ctx,
+                                    ContextID top_ctx);
+      bool pack_persistent_instruction(Instruction *inst, Serializer &rez,
+                 const std::map<PhysicalInstance,unsigned> &slots) const;
+      bool unpack_persistent_instruction(Deserializer &derez,
+                                         RegionTreeForest *forest,
+                            const std::vector<PhysicalManager*> &slots,
+                                         std::vector<Instruction*> &slice);
+      static bool pack_persistent_fields(Serializer &rez,
+                              const std::vector<CopySrcDstField> &fields,
+                              const std::map<PhysicalInstance,unsigned> &slots);
+      static bool unpack_persistent_fields(Deserializer &derez,
+                              std::vector<CopySrcDstField> &fields,
+                              const std::vector<PhysicalManager*> &slots);
+      static bool pack_persistent_instances(Serializer &rez,
+                              const InstanceSet &instances,
+                              const std::map<PhysicalManager*,unsigned> &slots);
+      static bool unpack_persistent_instances(Deserializer &derez,
+                              InstanceSet &instances,
+                              const std::vector<PhysicalManager*> &slots);
+      static void pack_persistent_node(Serializer &rez, RegionTreeNode *node);
+      static RegionTreeNode* unpack_persistent_node(Deserializer &derez,
+                                                   RegionTreeForest *forest);
     public:
 #ifdef LEGION_SPY
       void set_fence_uid(UniqueID fence_uid) { prev_fence_uid = fence_uid; }
@@ -581,6 +665,7 @@ namespace Legion {
       inline bool is_recording(void) const { return recording; }
       inline bool is_replaying(void) const { return !recording; }
       inline bool is_replayable(void) const { return replayable; }
+      inline bool is_idempotent(void) const { return idempotent; }
     protected:
       static std::string view_to_string(const InstanceView *view);
       static std::string view_to_string(const FillView *view);
@@ -686,6 +771,9 @@ namespace Legion {
       PhysicalTrace *trace;
       volatile bool recording;
       bool replayable;
+      // Whether the template leaves behind the instances it needs to 
+      // replay again, only these templates can be replayed back-to-back
+      bool idempotent;
       mutable LocalLock template_lock;
       const unsigned fence_completion_id;
       const unsigned replay_parallelism;
@@ -696,6 +784,17 @@ namespace Legion {
       std::vector<Instruction*> instructions;
       std::vector<std::vector<Instruction*> > slices;
       std::vector<std::vector<TraceLocalID> > slice_tasks;
+      // Each slice is only ever replayed by one meta-task at a time
+      // so these are updated without holding the template lock
+      struct SliceStatistics {
+      public:
+        SliceStatistics(void) : replays(0), total_ns(0), max_ns(0) { }
+      public:
+        unsigned long long replays;
+        long long total_ns;
+        long long max_ns;
+      };
+      std::vector<SliceStatistics> slice_statistics;
       std::map<TraceLocalID, unsigned> task_entries;
       typedef std::pair<PhysicalInstance, unsigned> InstanceAccess;
       struct UserInfo {
@@ -724,6 +823,8 @@ namespace Legion {
       };
       std::vector<SummaryOpInfo> dedup_summary_ops;
       std::map<unsigned, unsigned> frontiers;
+      // The serialized form of this template once it has been persisted
+      std::vector<char> persistent_buffer;
 #ifdef LEGION_SPY
       UniqueID prev_fence_uid;
 #endif
@@ -278,6 +278,17 @@ namespace Legion {
       DEP_PART_ASSOCIATION = 14, // create an association
     };
 
+    // What happened to a trace's templates, reported to the profiler
+    enum TraceTemplateKind {
+      TRACE_TEMPLATE_HIT = 0, // a template matched the preconditions
+      TRACE_TEMPLATE_RECURRENT = 1, // the last template replayed again
+      TRACE_TEMPLATE_MISS = 2, // no template matched the preconditions
+      TRACE_TEMPLATE_RECORDED = 3, // recorded a template that can recur
+      TRACE_TEMPLATE_TRANSITION = 4, // recorded a template that cannot recur
+      TRACE_TEMPLATE_DISCARDED = 5, // recorded a template that cannot replay
+      TRACE_TEMPLATE_EVICTED = 6, // dropped the least recently used template
+    };
+
     // Enumeration of Legion runtime tasks
     enum LgTaskID {
       LG_SCHEDULER_ID,
@@ -357,8 +368,12 @@ namespace Legion {
       LG_REMOTE_PHYSICAL_RESPONSE_TASK_ID,
       LG_REPLAY_SLICE_ID,
       LG_DELETE_TEMPLATE_ID,
-      LG_MESSAGE_ID, // These two must be the last two
+      LG_SAVE_PERSISTENT_TRACE_ID,
+      LG_FLUSH_MESSAGES_TASK_ID,
+      // Tasks after this point are neither counted for shutdown nor profiled
+      LG_MESSAGE_ID,
       LG_RETRY_SHUTDOWN_TASK_ID,
+      LG_PROFILER_FLUSH_TASK_ID,
       LG_LAST_TASK_ID, // This one should always be last
     }; 
 
@@ -443,8 +458,11 @@ namespace Legion {
         "Remote Physical Context Response",                       \
         "Replay Physical Trace",                                  \
         "Delete Physical Template",                               \
+        "Save Persistent Trace",                                  \
+        "Flush Aggregated Messages",                              \
         "Remote Message",                                         \
         "Retry Shutdown",                                         \
+        "Profiler Flush",                                         \
       };
 
     enum MappingCallKind {
@@ -613,6 +631,27 @@ namespace Legion {
       MAX_NUM_VIRTUAL_CHANNELS = 17, // this one must be last
     };
 
+#define VIRTUAL_CHANNEL_DESCRIPTIONS(name)                       \
+      const char *name[MAX_NUM_VIRTUAL_CHANNELS] = {             \
+        "Default",                                               \
+        "Index Space",                                           \
+        "Field Space",                                           \
+        "Logical Tree",                                          \
+        "Mapper",                                                \
+        "Semantic Info",                                         \
+        "Layout Constraint",                                     \
+        "Context",                                               \
+        "Manager",                                               \
+        "View",                                                  \
+        "Update",                                                \
+        "Variant",                                               \
+        "Version",                                               \
+        "Version Manager",                                       \
+        "Analysis",                                              \
+        "Future",                                                \
+        "Reference",                                             \
+      };
+
     enum MessageKind {
       TASK_MESSAGE,
       STEAL_MESSAGE,
@@ -1376,6 +1415,13 @@ namespace Legion {
     // Use this global variable to track if we're an
     // implicit top-level task that needs to do external waits
     extern __thread bool implicit_top_level_task;
+#ifdef LEGION_LOCK_PROFILING
+    // Record one hold of a LocalLock by the AutoLock created at
+    // file:line, all times are in nanoseconds
+    void record_lock_hold(const char *file, int line, bool exclusive,
+                          bool contended, long long request,
+                          long long acquired, long long released);
+#endif
 
     /**
      * \class LgTaskArgs
@@ -1482,6 +1528,7 @@ namespace Legion {
     struct EscapedCopy;
     struct GenericUser;
     struct LogicalUser;
+    struct LogicalUserSummary;
     struct PhysicalUser;
     struct LogicalTraceInfo;
     struct PhysicalTraceInfo;
@@ -2061,9 +2108,21 @@ namespace Legion {
     // the object goes out of scope
     class AutoLock { 
     public:
+#ifdef LEGION_LOCK_PROFILING
+      // The site that creates the AutoLock is the "lock class" that
+      // lock profiling aggregates its statistics by
+      inline AutoLock(LocalLock &r, int mode = 0, bool excl = true,
+                      const char *file = __builtin_FILE(),
+                      int line = __builtin_LINE())
+        : local_lock(r), previous(Internal::local_lock_list), 
+          exclusive(excl), held(true), site_file(file), site_line(line),
+          request_time(Realm::Clock::current_time_in_nanoseconds()),
+          contended(false)
+#else
       inline AutoLock(LocalLock &r, int mode = 0, bool excl = true)
         : local_lock(r), previous(Internal::local_lock_list), 
           exclusive(excl), held(true)
+#endif
       {
 #ifdef DEBUG_REENTRANT_LOCKS
         if (previous != NULL)
@@ -2074,6 +2133,9 @@ namespace Legion {
           RtEvent ready = local_lock.wrlock();
           while (ready.exists())
           {
+#ifdef LEGION_LOCK_PROFILING
+            contended = true;
+#endif
             ready.wait();
             ready = local_lock.wrlock();
           }
@@ -2083,15 +2145,24 @@ namespace Legion {
           RtEvent ready = local_lock.rdlock();
           while (ready.exists())
           {
+#ifdef LEGION_LOCK_PROFILING
+            contended = true;
+#endif
             ready.wait();
             ready = local_lock.rdlock();
           }
         }
         Internal::local_lock_list = this;
+#ifdef LEGION_LOCK_PROFILING
+        acquire_time = Realm::Clock::current_time_in_nanoseconds();
+#endif
       }
     public:
       inline AutoLock(const AutoLock &rhs)
         : local_lock(rhs.local_lock), previous(NULL), exclusive(false)
+#ifdef LEGION_LOCK_PROFILING
+          , site_file(NULL), site_line(0)
+#endif
       {
         // should never be called
         assert(false);
@@ -2104,6 +2175,10 @@ namespace Legion {
 #endif
         local_lock.unlock();
         Internal::local_lock_list = previous;
+#ifdef LEGION_LOCK_PROFILING
+        if (held)
+          record_hold();
+#endif
       }
     public:
       inline AutoLock& operator=(const AutoLock &rhs)
@@ -2122,6 +2197,9 @@ namespace Legion {
         local_lock.unlock(); 
         Internal::local_lock_list = previous;
         held = false; 
+#ifdef LEGION_LOCK_PROFILING
+        record_hold();
+#endif
       }
       inline void reacquire(void)
       {
@@ -2132,12 +2210,19 @@ namespace Legion {
 #ifdef DEBUG_REENTRANT_LOCKS
         if (previous != NULL)
           previous->check_for_reentrant_locks(&local_lock);
+#endif
+#ifdef LEGION_LOCK_PROFILING
+        request_time = Realm::Clock::current_time_in_nanoseconds();
+        contended = false;
 #endif
         if (exclusive)
         {
           RtEvent ready = local_lock.wrlock();
           while (ready.exists())
           {
+#ifdef LEGION_LOCK_PROFILING
+            contended = true;
+#endif
             ready.wait();
             ready = local_lock.wrlock();
           }
@@ -2147,12 +2232,18 @@ namespace Legion {
           RtEvent ready = local_lock.rdlock();
           while (ready.exists())
           {
+#ifdef LEGION_LOCK_PROFILING
+            contended = true;
+#endif
             ready.wait();
             ready = local_lock.rdlock();
           }
         }
         Internal::local_lock_list = this;
         held = true;
+#ifdef LEGION_LOCK_PROFILING
+        acquire_time = Realm::Clock::current_time_in_nanoseconds();
+#endif
       }
     public:
       inline void advise_sleep_entry(Realm::UserEvent guard) const
@@ -2176,12 +2267,27 @@ namespace Legion {
         if (previous != NULL)
           previous->check_for_reentrant_locks(to_acquire);
       }
+#endif
+#ifdef LEGION_LOCK_PROFILING
+    private:
+      inline void record_hold(void) const
+      {
+        Internal::record_lock_hold(site_file, site_line, exclusive, 
+            contended, request_time, acquire_time,
+            Realm::Clock::current_time_in_nanoseconds());
+      }
 #endif
     private:
       LocalLock &local_lock;
       AutoLock *const previous;
       const bool exclusive;
       bool held;
+#ifdef LEGION_LOCK_PROFILING
+      const char *const site_file;
+      const int site_line;
+      long long request_time, acquire_time;
+      bool contended;
+#endif
     };
     
     // Special method that we need here for waiting on events
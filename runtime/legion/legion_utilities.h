@@ -614,6 +614,8 @@ namespace Legion {
     {
       while ((index + 4) > total_bytes)
         resize();
+      // Clear the padding so equal values always serialize to equal bytes
+      memset(buffer+index, 0, 4);
       *((bool*)buffer+index) = element;
       index += 4;
 #ifdef DEBUG_LEGION
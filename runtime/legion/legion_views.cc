@@ -26,6 +26,8 @@
 #include "legion/legion_trace.h"
 #include "legion/legion_context.h"
 
+#include <algorithm>
+
 namespace Legion {
   namespace Internal {
 
@@ -211,7 +213,8 @@ namespace Legion {
       : InstanceView(ctx, encode_materialized_did(did, par == NULL), own_addr, 
                      log_own, node, own_ctx, register_now), 
         manager(man), parent(par), 
-        disjoint_children(node->are_all_children_disjoint())
+        disjoint_children(node->are_all_children_disjoint()),
+        current_child_entries(0), current_child_rebuild(0)
     //--------------------------------------------------------------------------
     {
       // Otherwise the instance lock will get filled in when we are unpacked
@@ -2106,6 +2109,142 @@ namespace Legion {
         (*event_users.users.multi_users)[user] = user_mask;
         event_users.user_mask |= user_mask;
       }
+      index_current_user(user, term_event, user_mask);
+    }
+
+    //--------------------------------------------------------------------------
+    void MaterializedView::index_current_user(PhysicalUser *user,
+                                              ApEvent term_event,
+                                              const FieldMask &user_mask)
+    //--------------------------------------------------------------------------
+    {
+      // Must be called while holding the lock
+      if (current_child_users.empty())
+      {
+        // Small epochs are cheap enough to scan without an index
+        if (current_epoch_users.size() >= MIN_INDEXED_USERS)
+          rebuild_current_child_users();
+        return;
+      }
+      ChildUsers &child_users = current_child_users[user->child];
+      child_users.user_mask |= user_mask;
+      if (user->child != INVALID_COLOR)
+        current_child_mask |= user_mask;
+      if (!child_users.events.insert(term_event).second)
+        return;
+      // Users are filtered out of the current epoch without updating
+      // the index, so once it has doubled in size since the last time
+      // we rebuilt it then rebuild it from the current epoch users
+      if (++current_child_entries > current_child_rebuild)
+        rebuild_current_child_users();
+    }
+
+    //--------------------------------------------------------------------------
+    void MaterializedView::rebuild_current_child_users(void)
+    //--------------------------------------------------------------------------
+    {
+      // Must be called while holding the lock
+      current_child_users.clear();
+      current_child_mask.clear();
+      current_child_entries = 0;
+      if (current_epoch_users.size() < MIN_INDEXED_USERS)
+        return;
+      for (LegionMap<ApEvent,EventUsers>::aligned::const_iterator cit = 
+           current_epoch_users.begin(); cit != current_epoch_users.end(); cit++)
+      {
+        const EventUsers &event_users = cit->second;
+        if (event_users.single)
+        {
+          const PhysicalUser *user = event_users.users.single_user;
+          ChildUsers &child_users = current_child_users[user->child];
+          child_users.user_mask |= event_users.user_mask;
+          if (user->child != INVALID_COLOR)
+            current_child_mask |= event_users.user_mask;
+          if (child_users.events.insert(cit->first).second)
+            current_child_entries++;
+        }
+        else
+        {
+          for (LegionMap<PhysicalUser*,FieldMask>::aligned::const_iterator 
+                it = event_users.users.multi_users->begin(); it !=
+                event_users.users.multi_users->end(); it++)
+          {
+            ChildUsers &child_users = current_child_users[it->first->child];
+            child_users.user_mask |= it->second;
+            if (it->first->child != INVALID_COLOR)
+              current_child_mask |= it->second;
+            if (child_users.events.insert(cit->first).second)
+              current_child_entries++;
+          }
+        }
+      }
+      current_child_rebuild = 2 * current_child_entries + MIN_INDEXED_USERS;
+    }
+
+    //--------------------------------------------------------------------------
+    bool MaterializedView::find_current_candidates(const FieldMask &user_mask,
+                                                 const LegionColor child_color,
+                                               std::vector<ApEvent> &candidates,
+                                                 FieldMask &skipped_mask) const
+    //--------------------------------------------------------------------------
+    {
+      // Caller must be holding the lock
+      // Users from this level can interfere with anything so they
+      // always have to look at all the current epoch users
+      if ((child_color == INVALID_COLOR) || current_child_users.empty())
+        return false;
+      FieldMask skipped;
+      if (disjoint_children)
+      {
+        // Users from any child are either from the same child and
+        // therefore already analyzed, or from a disjoint child, so 
+        // only the users registered at this level matter
+        skipped = current_child_mask & user_mask;
+        LegionMap<LegionColor,ChildUsers>::aligned::const_iterator finder =
+          current_child_users.find(INVALID_COLOR);
+        if ((finder != current_child_users.end()) &&
+            !(finder->second.user_mask * user_mask))
+          candidates.insert(candidates.end(), finder->second.events.begin(),
+                            finder->second.events.end());
+      }
+      else
+      {
+        unsigned contributors = 0;
+        for (LegionMap<LegionColor,ChildUsers>::aligned::const_iterator it =
+              current_child_users.begin(); it != 
+              current_child_users.end(); it++)
+        {
+          const FieldMask overlap = it->second.user_mask & user_mask;
+          if (!overlap)
+            continue;
+          // Same tests as has_local_precondition but for all the
+          // users registered through this child at once
+          if ((it->first == child_color) || ((it->first != INVALID_COLOR) &&
+                logical_node->are_children_disjoint(child_color, it->first)))
+          {
+            skipped |= overlap;
+            continue;
+          }
+          candidates.insert(candidates.end(), it->second.events.begin(),
+                            it->second.events.end());
+          contributors++;
+        }
+        // Events can have users from more than one child
+        if (contributors > 1)
+        {
+          std::sort(candidates.begin(), candidates.end());
+          candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                           candidates.end());
+        }
+      }
+      // If we're not pruning anything then just scan everything
+      if (candidates.size() >= current_epoch_users.size())
+      {
+        candidates.clear();
+        return false;
+      }
+      skipped_mask = skipped;
+      return true;
     }
 
     //--------------------------------------------------------------------------
@@ -2667,61 +2806,113 @@ namespace Legion {
     //--------------------------------------------------------------------------
     {
       // Caller must be holding the lock
-      for (LegionMap<ApEvent,EventUsers>::aligned::const_iterator cit = 
-           current_epoch_users.begin(); cit != current_epoch_users.end(); cit++)
+      std::vector<ApEvent> candidates;
+      FieldMask skipped_mask;
+      if (find_current_candidates(user_mask, child_color, 
+                                  candidates, skipped_mask))
       {
-        if (cit->first == term_event)
-          continue;
-#if !defined(LEGION_SPY) && !defined(EVENT_GRAPH_TRACE)
-        // We're about to do a bunch of expensive tests, 
-        // so first do something cheap to see if we can 
-        // skip all the tests.
-        if (!trace_info.recording && cit->first.has_triggered_faultignorant())
+        // The users we skipped can never be preconditions
+        if (TRACK_DOM && !!skipped_mask)
         {
-          dead_events.insert(cit->first);
-          continue;
+          observed |= skipped_mask;
+          non_dominated |= skipped_mask;
         }
-        if (!trace_info.recording &&
-            preconditions.find(cit->first) != preconditions.end())
-          continue;
+        for (std::vector<ApEvent>::const_iterator it = 
+              candidates.begin(); it != candidates.end(); it++)
+        {
+          LegionMap<ApEvent,EventUsers>::aligned::const_iterator finder = 
+            current_epoch_users.find(*it);
+          // Might have been filtered since it was indexed
+          if (finder == current_epoch_users.end())
+            continue;
+          find_current_event_preconditions<TRACK_DOM>(finder->first,
+              finder->second, user_mask, usage, child_color, origin_node,
+              term_event, op_id, index, preconditions, dead_events,
+              filter_events, observed, non_dominated, trace_info);
+        }
+      }
+      else
+      {
+        for (LegionMap<ApEvent,EventUsers>::aligned::const_iterator cit = 
+             current_epoch_users.begin(); cit != 
+             current_epoch_users.end(); cit++)
+          find_current_event_preconditions<TRACK_DOM>(cit->first,
+              cit->second, user_mask, usage, child_color, origin_node,
+              term_event, op_id, index, preconditions, dead_events,
+              filter_events, observed, non_dominated, trace_info);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    template<bool TRACK_DOM>
+    void MaterializedView::find_current_event_preconditions(ApEvent event,
+                                                 const EventUsers &event_users,
+                                                 const FieldMask &user_mask,
+                                                 const RegionUsage &usage,
+                                                 const LegionColor child_color,
+                                                 RegionNode *origin_node,
+                                                 ApEvent term_event,
+                                                 const UniqueID op_id,
+                                                 const unsigned index,
+                                               std::set<ApEvent> &preconditions,
+                                               std::set<ApEvent> &dead_events,
+                           LegionMap<ApEvent,FieldMask>::aligned &filter_events,
+                                                 FieldMask &observed,
+                                                 FieldMask &non_dominated,
+                                                 PhysicalTraceInfo &trace_info)
+    //--------------------------------------------------------------------------
+    {
+      // Caller must be holding the lock
+      if (event == term_event)
+        return;
+#if !defined(LEGION_SPY) && !defined(EVENT_GRAPH_TRACE)
+      // We're about to do a bunch of expensive tests, 
+      // so first do something cheap to see if we can 
+      // skip all the tests.
+      if (!trace_info.recording && event.has_triggered_faultignorant())
+      {
+        dead_events.insert(event);
+        return;
+      }
+      if (!trace_info.recording &&
+          preconditions.find(event) != preconditions.end())
+        return;
 #endif
-        const EventUsers &event_users = cit->second;
-        const FieldMask overlap = event_users.user_mask & user_mask;
-        if (!overlap)
-          continue;
+      const FieldMask overlap = event_users.user_mask & user_mask;
+      if (!overlap)
+        return;
+      else if (TRACK_DOM)
+        observed |= overlap;
+      if (event_users.single)
+      {
+        if (has_local_precondition(event_users.users.single_user, usage,
+                                   child_color, op_id, index, origin_node))
+        {
+          preconditions.insert(event);
+          if (TRACK_DOM)
+            filter_events[event] = overlap;
+        }
         else if (TRACK_DOM)
-          observed |= overlap;
-        if (event_users.single)
+          non_dominated |= overlap;
+      }
+      else
+      {
+        for (LegionMap<PhysicalUser*,FieldMask>::aligned::const_iterator 
+              it = event_users.users.multi_users->begin(); it !=
+              event_users.users.multi_users->end(); it++)
         {
-          if (has_local_precondition(event_users.users.single_user, usage,
-                                     child_color, op_id, index, origin_node))
+          const FieldMask user_overlap = user_mask & it->second;
+          if (!user_overlap)
+            continue;
+          if (has_local_precondition(it->first, usage, child_color, 
+                                     op_id, index, origin_node))
           {
-            preconditions.insert(cit->first);
+            preconditions.insert(event);
             if (TRACK_DOM)
-              filter_events[cit->first] = overlap;
+              filter_events[event] |= user_overlap;
           }
           else if (TRACK_DOM)
-            non_dominated |= overlap;
-        }
-        else
-        {
-          for (LegionMap<PhysicalUser*,FieldMask>::aligned::const_iterator 
-                it = event_users.users.multi_users->begin(); it !=
-                event_users.users.multi_users->end(); it++)
-          {
-            const FieldMask user_overlap = user_mask & it->second;
-            if (!user_overlap)
-              continue;
-            if (has_local_precondition(it->first, usage, child_color, 
-                                       op_id, index, origin_node))
-            {
-              preconditions.insert(cit->first);
-              if (TRACK_DOM)
-                filter_events[cit->first] |= user_overlap;
-            }
-            else if (TRACK_DOM)
-              non_dominated |= user_overlap;
-          }
+            non_dominated |= user_overlap;
         }
       }
     }
@@ -2803,72 +2994,123 @@ namespace Legion {
     //--------------------------------------------------------------------------
     {
       // Caller must be holding the lock
-      for (LegionMap<ApEvent,EventUsers>::aligned::const_iterator cit = 
-           current_epoch_users.begin(); cit != current_epoch_users.end(); cit++)
+      std::vector<ApEvent> candidates;
+      FieldMask skipped_mask;
+      if (find_current_candidates(user_mask, child_color, 
+                                  candidates, skipped_mask))
       {
-#if !defined(LEGION_SPY) && !defined(EVENT_GRAPH_TRACE)
-        // We're about to do a bunch of expensive tests, 
-        // so first do something cheap to see if we can 
-        // skip all the tests.
-        if (!trace_info.recording && cit->first.has_triggered_faultignorant())
+        // The users we skipped can never be preconditions
+        if (TRACK_DOM && !!skipped_mask)
         {
-          dead_events.insert(cit->first);
-          continue;
+          observed |= skipped_mask;
+          non_dominated |= skipped_mask;
         }
-#endif
-        const EventUsers &event_users = cit->second;
-        FieldMask overlap = event_users.user_mask & user_mask;
-        if (!overlap)
-          continue;
-        LegionMap<ApEvent,FieldMask>::aligned::iterator finder = 
-          preconditions.find(cit->first);
-#ifndef LEGION_SPY
-        if (!trace_info.recording && finder != preconditions.end())
+        for (std::vector<ApEvent>::const_iterator it = 
+              candidates.begin(); it != candidates.end(); it++)
         {
-          overlap -= finder->second;
-          if (!overlap)
+          LegionMap<ApEvent,EventUsers>::aligned::const_iterator finder = 
+            current_epoch_users.find(*it);
+          // Might have been filtered since it was indexed
+          if (finder == current_epoch_users.end())
             continue;
+          find_current_event_preconditions<TRACK_DOM>(finder->first,
+              finder->second, user_mask, usage, child_color, origin_node,
+              op_id, index, preconditions, dead_events, filter_events,
+              observed, non_dominated, trace_info);
         }
+      }
+      else
+      {
+        for (LegionMap<ApEvent,EventUsers>::aligned::const_iterator cit = 
+             current_epoch_users.begin(); cit != 
+             current_epoch_users.end(); cit++)
+          find_current_event_preconditions<TRACK_DOM>(cit->first,
+              cit->second, user_mask, usage, child_color, origin_node,
+              op_id, index, preconditions, dead_events, filter_events,
+              observed, non_dominated, trace_info);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    template<bool TRACK_DOM>
+    void MaterializedView::find_current_event_preconditions(ApEvent event,
+                                                 const EventUsers &event_users,
+                                                 const FieldMask &user_mask,
+                                                 const RegionUsage &usage,
+                                                 const LegionColor child_color,
+                                                 RegionNode *origin_node,
+                                                 const UniqueID op_id,
+                                                 const unsigned index,
+                           LegionMap<ApEvent,FieldMask>::aligned &preconditions,
+                                                 std::set<ApEvent> &dead_events,
+                           LegionMap<ApEvent,FieldMask>::aligned &filter_events,
+                                                 FieldMask &observed,
+                                                 FieldMask &non_dominated,
+                                                 PhysicalTraceInfo &trace_info)
+    //--------------------------------------------------------------------------
+    {
+      // Caller must be holding the lock
+#if !defined(LEGION_SPY) && !defined(EVENT_GRAPH_TRACE)
+      // We're about to do a bunch of expensive tests, 
+      // so first do something cheap to see if we can 
+      // skip all the tests.
+      if (!trace_info.recording && event.has_triggered_faultignorant())
+      {
+        dead_events.insert(event);
+        return;
+      }
 #endif
-        if (TRACK_DOM)
-          observed |= overlap;
-        if (event_users.single)
+      FieldMask overlap = event_users.user_mask & user_mask;
+      if (!overlap)
+        return;
+      LegionMap<ApEvent,FieldMask>::aligned::iterator finder = 
+        preconditions.find(event);
+#ifndef LEGION_SPY
+      if (!trace_info.recording && finder != preconditions.end())
+      {
+        overlap -= finder->second;
+        if (!overlap)
+          return;
+      }
+#endif
+      if (TRACK_DOM)
+        observed |= overlap;
+      if (event_users.single)
+      {
+        if (has_local_precondition(event_users.users.single_user, usage,
+                                   child_color, op_id, index, origin_node))
         {
-          if (has_local_precondition(event_users.users.single_user, usage,
-                                     child_color, op_id, index, origin_node))
+          if (finder == preconditions.end())
+            preconditions[event] = overlap;
+          else
+            finder->second |= overlap;
+          if (TRACK_DOM)
+            filter_events[event] = overlap;
+        }
+        else if (TRACK_DOM)
+          non_dominated |= overlap;
+      }
+      else
+      {
+        for (LegionMap<PhysicalUser*,FieldMask>::aligned::const_iterator 
+              it = event_users.users.multi_users->begin(); it !=
+              event_users.users.multi_users->end(); it++)
+        {
+          const FieldMask user_overlap = user_mask & it->second;
+          if (!user_overlap)
+            continue;
+          if (has_local_precondition(it->first, usage, child_color, 
+                                     op_id, index, origin_node))
           {
             if (finder == preconditions.end())
-              preconditions[cit->first] = overlap;
+              preconditions[event] = user_overlap;
             else
-              finder->second |= overlap;
+              finder->second |= user_overlap;
             if (TRACK_DOM)
-              filter_events[cit->first] = overlap;
+              filter_events[event] |= user_overlap;
           }
           else if (TRACK_DOM)
-            non_dominated |= overlap;
-        }
-        else
-        {
-          for (LegionMap<PhysicalUser*,FieldMask>::aligned::const_iterator 
-                it = event_users.users.multi_users->begin(); it !=
-                event_users.users.multi_users->end(); it++)
-          {
-            const FieldMask user_overlap = user_mask & it->second;
-            if (!user_overlap)
-              continue;
-            if (has_local_precondition(it->first, usage, child_color, 
-                                       op_id, index, origin_node))
-            {
-              if (finder == preconditions.end())
-                preconditions[cit->first] = user_overlap;
-              else
-                finder->second |= user_overlap;
-              if (TRACK_DOM)
-                filter_events[cit->first] |= user_overlap;
-            }
-            else if (TRACK_DOM)
-              non_dominated |= user_overlap;
-          }
+            non_dominated |= user_overlap;
         }
       }
     }
@@ -3691,6 +3933,7 @@ namespace Legion {
               FieldMask &new_mask = local[new_user];
               derez.deserialize(new_mask);
               current_users.user_mask |= new_mask;
+              index_current_user(new_user, current_event, new_mask);
             }
           }
           else
@@ -3701,6 +3944,8 @@ namespace Legion {
               current_users.users.single_user = 
                 PhysicalUser::unpack_user(derez, true/*add ref*/, forest);
               derez.deserialize(current_users.user_mask);
+              index_current_user(current_users.users.single_user,
+                                 current_event, current_users.user_mask);
             }
             else
             {
@@ -3716,6 +3961,7 @@ namespace Legion {
                 FieldMask &new_mask = local[new_user];
                 derez.deserialize(new_mask);
                 current_users.user_mask |= new_mask;
+                index_current_user(new_user, current_event, new_mask);
               }
             }
             // Didn't have it before so update the collect events
@@ -7863,10 +8109,12 @@ namespace Legion {
             logical_ctx, physical_ctx, target, red_mask,
             logical_ctx, physical_ctx);
       }
-      ApEvent reduce_post = target->logical_node->issue_copy(op, 
-                             src_fields, dst_fields, reduce_pre, 
-                             predicate_guard, trace_info, intersect,
-                             manager->redop, fold);
+      ApEvent reduce_post = manager->issue_reduction(op, 
+                                             src_fields, dst_fields,
+                                             target->logical_node, reduce_pre,
+                                             predicate_guard,
+                                             fold, false/*precise*/,
+                                             trace_info, intersect);
       // No need to add the user to the destination as that will
       // be handled by the caller using the reduce post event we return
       add_copy_user(manager->redop, reduce_post, versions,
@@ -8569,6 +8817,12 @@ namespace Legion {
 #ifdef DEBUG_LEGION
       assert(redop == manager->redop);
 #endif
+      // Entries can only be appended to lists by tasks
+      if (manager->is_list_manager())
+        REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                      "Illegal request to reduce into reduction list "
+                      "instance " IDFMT ". Reduction list instances can "
+                      "only be reduced from.", manager->get_instance().id)
       // Get the destination fields for this copy
       if (across_helper == NULL)
         manager->find_field_offsets(reduce_mask, dst_fields);
@@ -239,6 +239,8 @@ namespace Legion {
                              public LegionHeapify<MaterializedView> {
     public:
       static const AllocationType alloc_type = MATERIALIZED_VIEW_ALLOC;
+      static const size_t MIN_INDEXED_USERS = 
+        LEGION_DEFAULT_MIN_INDEXED_VIEW_USERS;
     public:
       struct DeferMaterializedViewArgs : 
         public LgTaskArgs<DeferMaterializedViewArgs> {
@@ -277,6 +279,13 @@ namespace Legion {
         } users;
         bool single;
       };
+      // The current epoch users registered through a particular child
+      // along with a conservative summary of the fields that they use
+      struct ChildUsers {
+      public:
+        FieldMask user_mask;
+        std::set<ApEvent> events;
+      };
     public:
       MaterializedView(RegionTreeForest *ctx, DistributedID did,
                        AddressSpaceID owner_proc, 
@@ -563,6 +572,45 @@ namespace Legion {
       void filter_previous_user(ApEvent user_event, 
                                 const FieldMask &filter_mask);
     protected:
+      void index_current_user(PhysicalUser *user, ApEvent term_event,
+                              const FieldMask &user_mask);
+      void rebuild_current_child_users(void);
+      bool find_current_candidates(const FieldMask &user_mask,
+                                   const LegionColor child_color,
+                                   std::vector<ApEvent> &candidates,
+                                   FieldMask &skipped_mask) const;
+    protected:
+      template<bool TRACK_DOM>
+      void find_current_event_preconditions(ApEvent event,
+                                      const EventUsers &event_users,
+                                      const FieldMask &user_mask,
+                                      const RegionUsage &usage,
+                                      const LegionColor child_color,
+                                      RegionNode *origin_node,
+                                      ApEvent term_event,
+                                      const UniqueID op_id,
+                                      const unsigned index,
+                                      std::set<ApEvent> &preconditions,
+                                      std::set<ApEvent> &dead_events,
+                  LegionMap<ApEvent,FieldMask>::aligned &filter_events,
+                                      FieldMask &observed, 
+                                      FieldMask &non_dominated,
+                                      PhysicalTraceInfo &trace_info);
+      template<bool TRACK_DOM>
+      void find_current_event_preconditions(ApEvent event,
+                                      const EventUsers &event_users,
+                                      const FieldMask &user_mask,
+                                      const RegionUsage &usage,
+                                      const LegionColor child_color,
+                                      RegionNode *origin_node,
+                                      const UniqueID op_id,
+                                      const unsigned index,
+                  LegionMap<ApEvent,FieldMask>::aligned &preconditions,
+                                      std::set<ApEvent> &dead_events,
+                  LegionMap<ApEvent,FieldMask>::aligned &filter_events,
+                                      FieldMask &observed, 
+                                      FieldMask &non_dominated,
+                                      PhysicalTraceInfo &trace_info);
       template<bool TRACK_DOM>
       void find_current_preconditions(const FieldMask &user_mask,
                                       const RegionUsage &usage,
@@ -698,6 +746,19 @@ namespace Legion {
       // the view tree that less frequently filter their sub-users.
       LegionMap<ApEvent,EventUsers>::aligned current_epoch_users;
       LegionMap<ApEvent,EventUsers>::aligned previous_epoch_users;
+      // Index of the current epoch users by the child color through
+      // which they were registered. Users coming up from a child only
+      // have to look at users from children they might interfere with,
+      // which for index launches over a disjoint partition is just the
+      // users registered at this level. The index is only built once
+      // the current epoch has MIN_INDEXED_USERS users. Entries are
+      // removed lazily: the index may name events that have since been
+      // filtered, so it is only ever used to prune the scan of
+      // current_epoch_users, and it is rebuilt once enough stale
+      // entries have accumulated.
+      LegionMap<LegionColor,ChildUsers>::aligned current_child_users;
+      FieldMask current_child_mask; // all users with a valid child color
+      size_t current_child_entries, current_child_rebuild;
       // Also keep a set of events for which we have outstanding
       // garbage collection meta-tasks so we don't launch more than one
       // We need this even though we have the data structures above because
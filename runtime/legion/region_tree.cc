@@ -2658,6 +2658,14 @@ namespace Legion {
         assert(!dst_ref.is_virtual_ref());
 #endif
         PhysicalManager *dst_manager = dst_ref.get_manager();
+        // Copies only know how to move dense data
+        if (dst_manager->is_list_manager())
+          REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                        "Illegal use of reduction list instance " IDFMT
+                        " as the destination of a copy in operation %s "
+                        "(UID %lld). Copies cannot reduce into reduction "
+                        "list instances.", dst_manager->get_instance().id,
+                        op->get_logging_name(), op->get_unique_op_id())
         FieldMask dst_valid = dst_ref.get_valid_fields();
         const bool fold = dst_manager->is_reduction_manager();
         // Iterate over all the fields and find the ones for this target
@@ -2673,6 +2681,13 @@ namespace Legion {
             assert(!src_ref.is_virtual_ref());
 #endif
             PhysicalManager *src_manager = src_ref.get_manager();
+            if (src_manager->is_list_manager())
+              REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                        "Illegal use of reduction list instance " IDFMT
+                        " as the source of a copy in operation %s "
+                        "(UID %lld). Copies cannot read from reduction "
+                        "list instances.", src_manager->get_instance().id,
+                        op->get_logging_name(), op->get_unique_op_id())
             if (src_manager->is_reduction_manager())
             {
               FieldMask src_mask;
@@ -9676,7 +9691,7 @@ namespace Legion {
           // and filter the current and previous epochs
           closer.update_state(state);
           // Now we can add the close operations to the current epoch
-          closer.register_close_operations(state.curr_epoch_users);
+          closer.register_close_operations(state);
         }
         // See if we have any open_only fields to merge
         if (!arrived || proj_info.is_projecting())
@@ -9761,12 +9776,26 @@ namespace Legion {
       // already traced because we need to pick up dependences on 
       // any dynamic open, advance, or close operations that we need to do
       // Now that we registered any close operation, do our analysis
-      FieldMask dominator_mask = 
+      FieldMask dominator_mask;
+      if (state.curr_epoch_summary.may_interfere(user))
+        dominator_mask = 
              perform_dependence_checks<CURR_LOGICAL_ALLOC,
                        true/*record*/,false/*has skip*/,true/*track dom*/>(
                           user, state.curr_epoch_users, user.field_mask, 
                           open_below, arrived/*validates*/ && 
                                         !proj_info.is_projecting());
+      else
+      {
+        // Fast path: everyone in the current epoch that overlaps us is
+        // a reader (or the same reduction) like us, so the scan could 
+        // find no dependences and, since we neither write nor observe a
+        // dependence, no dominated fields either. We do need to prune
+        // the list now and then since the scan is what times out users.
+        if (!user.op->is_tracing() && 
+            (++state.curr_epoch_summary.skipped_scans >= 
+             unsigned(LogicalUser::TIMEOUT)))
+          state.filter_committed_curr_epoch_users();
+      }
       FieldMask non_dominated_mask = user.field_mask - dominator_mask;
       // For the fields that weren't dominated, we have to check
       // those fields against the previous epoch's users
@@ -9977,7 +10006,7 @@ namespace Legion {
                 open_mask/*doesn't matter*/, false/*validates*/);
       open->end_dependence_analysis();
       // Now add this to the current list
-      state.curr_epoch_users.push_back(open_user);
+      state.add_curr_epoch_user(open_user);
     }
 
     //--------------------------------------------------------------------------
@@ -10030,7 +10059,7 @@ namespace Legion {
       // Update our list of advance operations
       advances[advance] = advance_user;
       // Add it to the list of current epoch users even if we're tracing 
-      state.curr_epoch_users.push_back(advance_user);
+      state.add_curr_epoch_user(advance_user);
     }
 
     //--------------------------------------------------------------------------
@@ -10047,7 +10076,7 @@ namespace Legion {
         // Record a mapping reference on this operation
         user.op->add_mapping_reference(user.gen);
         // Add ourselves to the current epoch
-        state.curr_epoch_users.push_back(user);
+        state.add_curr_epoch_user(user);
       }
     }
 
@@ -11421,6 +11450,8 @@ namespace Legion {
                                                  const FieldMask &field_mask)
     //--------------------------------------------------------------------------
     {
+      // Rebuild the summary from the users that remain
+      state.curr_epoch_summary.clear();
       for (LegionList<LogicalUser,CURR_LOGICAL_ALLOC>::track_aligned::iterator 
             it = state.curr_epoch_users.begin(); it !=
             state.curr_epoch_users.end(); /*nothing*/)
@@ -11453,6 +11484,7 @@ namespace Legion {
         }
         else
         {
+          state.curr_epoch_summary.add_user(*it);
           it++;
           continue;
         }
@@ -11465,7 +11497,10 @@ namespace Legion {
           it = state.curr_epoch_users.erase(it); // empty so erase it
         }
         else
+        {
+          state.curr_epoch_summary.add_user(*it);
           it++; // not empty so keep going
+        }
       }
     }
 
@@ -11719,7 +11754,7 @@ namespace Legion {
             // and filter the current and previous epochs
             closer.update_state(state);
             // Now we can add the close operations to the current epoch
-            closer.register_close_operations(state.curr_epoch_users);
+            closer.register_close_operations(state);
           }
           // Perform our checks on dependences
           FieldMask dominator_mask = 
@@ -14489,6 +14524,63 @@ namespace Legion {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    ApEvent RegionNode::issue_list_reduction(Operation *op,
+                        const std::vector<CopySrcDstField> &src_fields,
+                        const std::vector<CopySrcDstField> &dst_fields,
+                        PhysicalInstance list, FieldID pointer_fid,
+                        size_t max_entries, ApEvent precondition,
+                        PredEvent predicate_guard, 
+                        PhysicalTraceInfo &trace_info,
+                        RegionTreeNode *intersect, ReductionOpID redop,
+                        bool reduction_fold)
+    //--------------------------------------------------------------------------
+    {
+      // Templates only know how to replay dense copies and fills
+      if (trace_info.recording)
+        REPORT_LEGION_ERROR(ERROR_ILLEGAL_REDUCTION_REQUEST,
+                      "Illegal use of reduction list instance " IDFMT
+                      " in a physical trace by operation %s (UID %lld). "
+                      "Reduction list instances cannot be traced, use a "
+                      "reduction fold instance instead.", list.id,
+                      op->get_logging_name(), op->get_unique_op_id())
+      ApEvent result = row_source->issue_list_reduction(op, src_fields,
+          dst_fields, list, pointer_fid, max_entries, precondition, 
+          predicate_guard, 
+          (intersect == NULL) ? NULL : intersect->get_row_source(),
+          redop, reduction_fold);
+#ifdef LEGION_SPY
+      ApEvent copy_pre = precondition;
+      if ((op != NULL) && op->has_execution_fence_event())
+        copy_pre = Runtime::merge_events(copy_pre,
+                                         op->get_execution_fence_event());
+      LegionSpy::log_copy_events(op->get_unique_op_id(), handle, copy_pre,
+                                 result);
+      for (unsigned idx = 0; idx < src_fields.size(); idx++)
+        LegionSpy::log_copy_field(result, src_fields[idx].field_id,
+                                  src_fields[idx].inst_event,
+                                  dst_fields[idx].field_id,
+                                  dst_fields[idx].inst_event, redop);
+      if (intersect != NULL)
+      {
+        if (intersect->is_region())
+        {
+          RegionNode *node = intersect->as_region_node();
+          LegionSpy::log_copy_intersect(result, 1, node->handle.index_space.id,
+              node->handle.field_space.id, node->handle.tree_id);
+        }
+        else
+        {
+          PartitionNode *node = intersect->as_partition_node();
+          LegionSpy::log_copy_intersect(result, 0,
+              node->handle.index_partition.id,
+              node->handle.field_space.id, node->handle.tree_id);
+        }
+      }
+#endif
+      return result;
+    }
+
     //--------------------------------------------------------------------------
     bool RegionNode::are_children_disjoint(const LegionColor c1, 
                                            const LegionColor c2)
@@ -16521,6 +16613,24 @@ namespace Legion {
                                 intersect);
     }
 
+    //--------------------------------------------------------------------------
+    ApEvent PartitionNode::issue_list_reduction(Operation *op,
+                        const std::vector<CopySrcDstField> &src_fields,
+                        const std::vector<CopySrcDstField> &dst_fields,
+                        PhysicalInstance list, FieldID pointer_fid,
+                        size_t max_entries, ApEvent precondition,
+                        PredEvent predicate_guard, 
+                        PhysicalTraceInfo &trace_info,
+                        RegionTreeNode *intersect, ReductionOpID redop,
+                        bool reduction_fold)
+    //--------------------------------------------------------------------------
+    {
+      return parent->issue_list_reduction(op, src_fields, dst_fields, list,
+                                pointer_fid, max_entries, precondition,
+                                predicate_guard, trace_info, intersect,
+                                redop, reduction_fold);
+    }
+
     //--------------------------------------------------------------------------
     bool PartitionNode::are_children_disjoint(const LegionColor c1, 
                                               const LegionColor c2)
@@ -1003,6 +1003,24 @@ namespace Legion {
                   ApEvent precondition, PredEvent predicate_guard,
                   PhysicalTraceInfo &trace_info,
                   IndexTreeNode *intersect = NULL) = 0;
+    public:
+      // Reduction list instances are 1-D lists of entries that each
+      // hold a point in this index space and a value to reduce into it
+      virtual Realm::InstanceLayoutGeneric* create_list_layout(
+                           const Realm::InstanceLayoutConstraints &ilc,
+                           size_t max_entries, FieldID pointer_fid) = 0;
+      virtual ApEvent issue_list_fill(PhysicalInstance list,
+                           size_t max_entries,
+                           const std::vector<CopySrcDstField> &value_fields,
+                           const void *identity, size_t identity_size,
+                           FieldID pointer_fid, ApEvent precondition) = 0;
+      virtual ApEvent issue_list_reduction(Operation *op,
+                  const std::vector<CopySrcDstField> &src_fields,
+                  const std::vector<CopySrcDstField> &dst_fields,
+                  PhysicalInstance list, FieldID pointer_fid,
+                  size_t max_entries, ApEvent precondition,
+                  PredEvent predicate_guard, IndexTreeNode *intersect,
+                  ReductionOpID redop, bool reduction_fold) = 0;
     public:
       virtual Realm::InstanceLayoutGeneric* create_layout(
                            const Realm::InstanceLayoutConstraints &ilc,
@@ -1247,6 +1265,22 @@ namespace Legion {
                   ApEvent precondition, PredEvent predicate_guard,
                   PhysicalTraceInfo &trace_info,
                   IndexTreeNode *intersect = NULL);
+    public:
+      virtual Realm::InstanceLayoutGeneric* create_list_layout(
+                           const Realm::InstanceLayoutConstraints &ilc,
+                           size_t max_entries, FieldID pointer_fid);
+      virtual ApEvent issue_list_fill(PhysicalInstance list,
+                           size_t max_entries,
+                           const std::vector<CopySrcDstField> &value_fields,
+                           const void *identity, size_t identity_size,
+                           FieldID pointer_fid, ApEvent precondition);
+      virtual ApEvent issue_list_reduction(Operation *op,
+                  const std::vector<CopySrcDstField> &src_fields,
+                  const std::vector<CopySrcDstField> &dst_fields,
+                  PhysicalInstance list, FieldID pointer_fid,
+                  size_t max_entries, ApEvent precondition,
+                  PredEvent predicate_guard, IndexTreeNode *intersect,
+                  ReductionOpID redop, bool reduction_fold);
     public:
       virtual Realm::InstanceLayoutGeneric* create_layout(
                            const Realm::InstanceLayoutConstraints &ilc,
@@ -2446,6 +2480,14 @@ namespace Legion {
 #endif
                   PhysicalTraceInfo &trace_info,
                   RegionTreeNode *intersect = NULL) = 0;
+      virtual ApEvent issue_list_reduction(Operation *op,
+                  const std::vector<CopySrcDstField> &src_fields,
+                  const std::vector<CopySrcDstField> &dst_fields,
+                  PhysicalInstance list, FieldID pointer_fid,
+                  size_t max_entries, ApEvent precondition,
+                  PredEvent predicate_guard, PhysicalTraceInfo &trace_info,
+                  RegionTreeNode *intersect, ReductionOpID redop,
+                  bool reduction_fold) = 0;
     public:
       virtual bool are_children_disjoint(const LegionColor c1, 
                                          const LegionColor c2) = 0;
@@ -2597,6 +2639,14 @@ namespace Legion {
 #endif
                   PhysicalTraceInfo &trace_info,
                   RegionTreeNode *intersect = NULL);
+      virtual ApEvent issue_list_reduction(Operation *op,
+                  const std::vector<CopySrcDstField> &src_fields,
+                  const std::vector<CopySrcDstField> &dst_fields,
+                  PhysicalInstance list, FieldID pointer_fid,
+                  size_t max_entries, ApEvent precondition,
+                  PredEvent predicate_guard, PhysicalTraceInfo &trace_info,
+                  RegionTreeNode *intersect, ReductionOpID redop,
+                  bool reduction_fold);
     public:
       virtual bool are_children_disjoint(const LegionColor c1, 
                                          const LegionColor c2);
@@ -2811,6 +2861,14 @@ namespace Legion {
 #endif
                   PhysicalTraceInfo &trace_info,
                   RegionTreeNode *intersect = NULL);
+      virtual ApEvent issue_list_reduction(Operation *op,
+                  const std::vector<CopySrcDstField> &src_fields,
+                  const std::vector<CopySrcDstField> &dst_fields,
+                  PhysicalInstance list, FieldID pointer_fid,
+                  size_t max_entries, ApEvent precondition,
+                  PredEvent predicate_guard, PhysicalTraceInfo &trace_info,
+                  RegionTreeNode *intersect, ReductionOpID redop,
+                  bool reduction_fold);
     public:
       virtual bool are_children_disjoint(const LegionColor c1, 
                                          const LegionColor c2);
@@ -2831,6 +2831,164 @@ namespace Legion {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    Realm::InstanceLayoutGeneric* IndexSpaceNodeT<DIM,T>::create_list_layout(
+                                    const Realm::InstanceLayoutConstraints &ilc,
+                                    size_t max_entries, FieldID pointer_fid)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(max_entries > 0);
+      assert(ilc.field_groups.size() == 1);
+#endif
+      // Keep each entry's point next to its value since tasks append
+      // whole entries and the list is replayed one entry at a time
+      Realm::InstanceLayoutConstraints list_ilc = ilc;
+      Realm::InstanceLayoutConstraints::FieldInfo pointer_info;
+      pointer_info.field_id = pointer_fid;
+      pointer_info.offset = -1;
+      pointer_info.size = sizeof(Realm::Point<DIM,T>);
+      pointer_info.alignment = sizeof(T);
+      list_ilc.field_groups[0].push_back(pointer_info);
+      const Realm::IndexSpace<1,coord_t> list_space(
+          Realm::Rect<1,coord_t>(0, max_entries - 1));
+      int dim_order[1] = { 0 };
+      return Realm::InstanceLayoutGeneric::choose_instance_layout(list_space,
+                                                          list_ilc, dim_order);
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    ApEvent IndexSpaceNodeT<DIM,T>::issue_list_fill(PhysicalInstance list,
+                              size_t max_entries,
+                              const std::vector<CopySrcDstField> &value_fields,
+                              const void *identity, size_t identity_size,
+                              FieldID pointer_fid, ApEvent precondition)
+    //--------------------------------------------------------------------------
+    {
+      DETAILED_PROFILER(context->runtime, REALM_ISSUE_FILL_CALL);
+      if (index_space_ready.exists())
+        precondition = Runtime::merge_events(precondition, index_space_ready);
+      Realm::IndexSpace<DIM,T> local_space;
+      get_realm_index_space(local_space, true/*tight*/);
+      // Entries that are never appended hold the identity and point at
+      // the first point of our bounds, so replaying them changes nothing
+      const Realm::Point<DIM,T> first = local_space.bounds.lo;
+      const Realm::IndexSpace<1,coord_t> list_space(
+          Realm::Rect<1,coord_t>(0, max_entries - 1));
+      std::vector<Realm::CopySrcDstField> dsts(value_fields.size());
+      for (unsigned idx = 0; idx < value_fields.size(); idx++)
+        dsts[idx] = value_fields[idx];
+      Realm::ProfilingRequestSet requests;
+      const ApEvent values_filled(list_space.fill(dsts, requests, 
+                                  identity, identity_size, precondition));
+      std::vector<Realm::CopySrcDstField> pointer_dsts(1);
+      pointer_dsts[0].set_field(list, pointer_fid, sizeof(first));
+      const ApEvent pointers_filled(list_space.fill(pointer_dsts, requests,
+                                    &first, sizeof(first), precondition));
+      return Runtime::merge_events(values_filled, pointers_filled);
+    }
+
+    //--------------------------------------------------------------------------
+    template<int DIM, typename T>
+    ApEvent IndexSpaceNodeT<DIM,T>::issue_list_reduction(Operation *op,
+                        const std::vector<CopySrcDstField> &src_fields,
+                        const std::vector<CopySrcDstField> &dst_fields,
+                        PhysicalInstance list, FieldID pointer_fid,
+                        size_t max_entries, ApEvent precondition,
+                        PredEvent predicate_guard, IndexTreeNode *intersect,
+                        ReductionOpID redop, bool reduction_fold)
+    //--------------------------------------------------------------------------
+    {
+      DETAILED_PROFILER(context->runtime, REALM_ISSUE_COPY_CALL);
+#ifdef DEBUG_LEGION
+      assert(src_fields.size() == dst_fields.size());
+#endif
+      if ((op != NULL) && op->has_execution_fence_event())
+        precondition = Runtime::merge_events(precondition,
+                        op->get_execution_fence_event());
+      // The whole list is replayed, but only entries whose points are in
+      // the target space get applied, Realm skips the rest of them
+      Realm::IndexSpace<DIM,T> target_space;
+      if ((intersect == NULL) || (intersect == this))
+      {
+        if (index_space_ready.exists())
+          precondition = Runtime::merge_events(precondition, index_space_ready);
+        get_realm_index_space(target_space, true/*tight*/);
+      }
+      else
+      {
+        const bool intersects = intersect->is_index_space_node() ?
+          intersects_with(intersect->as_index_space_node()) :
+          intersects_with(intersect->as_index_part_node());
+        if (!intersects)
+        {
+#ifdef LEGION_SPY
+          ApUserEvent new_result = Runtime::create_ap_user_event();
+          Runtime::trigger_event(new_result);
+          return new_result;
+#else
+          return ApEvent::NO_AP_EVENT;
+#endif
+        }
+        AutoLock n_lock(node_lock,1,false/*exclusive*/);
+        typename std::map<IndexTreeNode*,IntersectInfo>::const_iterator 
+          finder = intersections.find(intersect);
+#ifdef DEBUG_LEGION
+        assert(finder != intersections.end());
+#endif
+        target_space = finder->second.intersection;
+      }
+      // Have to protect against misspeculation
+      if (predicate_guard.exists())
+        precondition = Runtime::merge_events(precondition,
+                                             ApEvent(predicate_guard));
+      const Realm::IndexSpace<1,coord_t> list_space(
+          Realm::Rect<1,coord_t>(0, max_entries - 1));
+      // Each field can live in a different target instance, so each
+      // one gets its own scatter-reduce copy
+      std::set<ApEvent> reduce_events;
+      for (unsigned idx = 0; idx < src_fields.size(); idx++)
+      {
+        typename Realm::CopyIndirection<1,coord_t>::template 
+          Unstructured<DIM,T> indirect;
+        indirect.field_id = pointer_fid;
+        indirect.inst = list;
+        indirect.oor_possible = true;
+        indirect.spaces.push_back(target_space);
+        indirect.insts.push_back(dst_fields[idx].inst);
+        std::vector<Realm::CopySrcDstField> srcs(1, src_fields[idx]);
+        std::vector<Realm::CopySrcDstField> dsts(1);
+        dsts[0].set_indirect(0, dst_fields[idx].field_id, 
+            dst_fields[idx].size, dst_fields[idx].subfield_offset);
+        dsts[0].set_redop(redop, reduction_fold);
+        std::vector<const typename 
+          Realm::CopyIndirection<1,coord_t>::Base*> indirects(1, &indirect);
+        Realm::ProfilingRequestSet requests;
+        if (op != NULL)
+          op->add_copy_profiling_request(requests);
+        if (context->runtime->profiler != NULL)
+          context->runtime->profiler->add_copy_request(requests, op);
+        if (predicate_guard.exists())
+          reduce_events.insert(Runtime::ignorefaults(list_space.copy(srcs,
+                  dsts, indirects, requests, precondition)));
+        else
+          reduce_events.insert(ApEvent(list_space.copy(srcs, dsts, 
+                  indirects, requests, precondition)));
+      }
+      ApEvent result = Runtime::merge_events(reduce_events);
+#ifdef LEGION_SPY
+      if (!result.exists())
+      {
+        ApUserEvent new_result = Runtime::create_ap_user_event();
+        Runtime::trigger_event(new_result);
+        result = new_result;
+      }
+#endif
+      return result;
+    }
+
     //--------------------------------------------------------------------------
     template<int DIM, typename T>
     Realm::InstanceLayoutGeneric* IndexSpaceNodeT<DIM,T>::create_layout(
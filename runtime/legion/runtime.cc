@@ -782,7 +782,9 @@ namespace Legion {
       : DistributedCollectable(rt, 
           LEGION_DISTRIBUTED_HELP_ENCODE(did, FUTURE_MAP_DC),  owner_space), 
         context(ctx), op(o), op_gen(o->get_generation()),
-        ready_event(o->get_completion_event()), valid(true)
+        ready_event(o->get_completion_event()), valid(true),
+        futures_complete(false), dense_storage(false), dense_result_size(0),
+        dense_results(NULL)
     //--------------------------------------------------------------------------
     {
 #ifdef LEGION_GC
@@ -799,7 +801,9 @@ namespace Legion {
           LEGION_DISTRIBUTED_HELP_ENCODE(did, FUTURE_MAP_DC), 
           owner_space, register_now), 
         context(ctx), op(NULL), op_gen(0),
-        ready_event(ApEvent::NO_AP_EVENT), valid(!is_owner())
+        ready_event(ApEvent::NO_AP_EVENT), valid(!is_owner()),
+        futures_complete(false), dense_storage(false), dense_result_size(0),
+        dense_results(NULL)
     //--------------------------------------------------------------------------
     {
 #ifdef LEGION_GC
@@ -823,6 +827,8 @@ namespace Legion {
     //--------------------------------------------------------------------------
     {
       futures.clear();
+      if (dense_results != NULL)
+        free(dense_results);
     }
 
     //--------------------------------------------------------------------------
@@ -939,6 +945,15 @@ namespace Legion {
                                                   futures.find(point);
             if (finder != futures.end())
               return finder->second;
+            // See if its result is already in our dense buffer
+            size_t index;
+            if (find_dense_index(point, index) && 
+                !dense_present.empty() && dense_present[index])
+            {
+              result = materialize_dense_future(index);
+              futures[point] = result;
+              return result;
+            }
             if (allow_empty)
               return Future();
             // Otherwise we need a future from the context to use for
@@ -1000,10 +1015,18 @@ namespace Legion {
             context->get_task_name(),
             context->get_unique_id(),
             (warning_string == NULL) ? "" : warning_string)
+      // Wait on the event that indicates the entire task has finished
+      if (valid)
+        wait_for_ready();
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureMapImpl::wait_for_ready(void) const
+    //--------------------------------------------------------------------------
+    {
       if (op != NULL && Internal::implicit_context != NULL)
         Internal::implicit_context->record_blocking_call();
-      // Wait on the event that indicates the entire task has finished
-      if (valid && !ready_event.has_triggered())
+      if (!ready_event.has_triggered())
       {
         if (context != NULL)
         {
@@ -1030,6 +1053,8 @@ namespace Legion {
       {
         runtime->help_complete_future(it->second);
       }
+      // Futures made from the dense buffer after this are complete
+      futures_complete = true;
     }
 
     //--------------------------------------------------------------------------
@@ -1049,32 +1074,38 @@ namespace Legion {
         if (restart)
           result = true;
       }
+      // Nobody has a future for the results in the dense buffer
+      // so we can just forget about them
+      if (!dense_present.empty())
+        memset(&dense_present.front(), 0, dense_present.size());
+      futures_complete = false;
       return result;
     }
 
     //--------------------------------------------------------------------------
     void FutureMapImpl::get_all_futures(
-                                     std::map<DomainPoint,Future> &others) const
+                                           std::map<DomainPoint,Future> &others)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_LEGION
       assert(is_owner());
       assert(valid);
 #endif
-      if (op != NULL && Internal::implicit_context != NULL)
-        Internal::implicit_context->record_blocking_call();
-      if (!ready_event.has_triggered())
+      wait_for_ready();
+      AutoLock gc(gc_lock);
+      // Make futures for any results still only in the dense buffer
+      if (!dense_present.empty())
       {
-        if (context != NULL)
+        size_t index = 0;
+        for (Domain::DomainPointIterator itr(result_domain); 
+              itr; itr++, index++)
         {
-          context->begin_task_wait(false/*from runtime*/);
-          ready_event.wait();
-          context->end_task_wait();
+          if (!dense_present[index] || 
+              (futures.find(itr.p) != futures.end()))
+            continue;
+          futures[itr.p] = materialize_dense_future(index);
         }
-        else
-          ready_event.wait();
       }
-      // No need for the lock since the map should be fixed at this point
       others = futures;
     }
 
@@ -1092,6 +1123,176 @@ namespace Legion {
       valid = true;
     }
 
+    //--------------------------------------------------------------------------
+    void FutureMapImpl::initialize_result_domain(const Domain &domain, 
+                                                 bool dense)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(is_owner());
+      assert(!dense || domain.dense());
+#endif
+      result_domain = domain;
+      dense_storage = dense && (domain.get_volume() > 0);
+    }
+
+    //--------------------------------------------------------------------------
+    bool FutureMapImpl::find_dense_index(const DomainPoint &point,
+                                         size_t &index) const
+    //--------------------------------------------------------------------------
+    {
+      if (!dense_storage || (point.get_dim() != result_domain.get_dim()))
+        return false;
+      const DomainPoint lo = result_domain.lo();
+      const DomainPoint hi = result_domain.hi();
+      // Dimension 0 varies fastest like the DomainPointIterator
+      size_t stride = 1;
+      index = 0;
+      for (int dim = 0; dim < point.get_dim(); dim++)
+      {
+        if ((point[dim] < lo[dim]) || (point[dim] > hi[dim]))
+          return false;
+        index += (point[dim] - lo[dim]) * stride;
+        stride *= (hi[dim] - lo[dim] + 1);
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    Future FutureMapImpl::materialize_dense_future(size_t index)
+    //--------------------------------------------------------------------------
+    {
+      // Must be holding the gc lock
+      // Once the operation is complete it can be recycled so the
+      // future can't name it as its producer, it won't need one 
+      // anyway since we're going to complete it right away
+      Future result = futures_complete ?
+        Future(new FutureImpl(runtime, true/*register*/,
+              runtime->get_available_distributed_id(), 
+              runtime->address_space)) : runtime->help_create_future(op);
+      result.impl->set_result(dense_results + index * dense_result_size,
+                              dense_result_size, false/*own*/);
+      if (futures_complete)
+        runtime->help_complete_future(result);
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureMapImpl::set_point_result(const DomainPoint &point,
+                                         const void *result,
+                                         size_t result_size, bool owner)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_LEGION
+      assert(is_owner());
+      assert(valid);
+#endif
+      size_t index;
+      if (find_dense_index(point, index) && 
+          (result_size <= LEGION_MAX_DENSE_FUTURE_RESULT_SIZE))
+      {
+        // Common case: the buffer exists and nobody has made a future
+        // for this point, every point has its own slot so we only 
+        // need to keep out anyone making futures from the buffer
+        {
+          AutoLock gc(gc_lock,1,false/*exclusive*/);
+          if (!dense_present.empty() && (result_size == dense_result_size)
+              && (futures.find(point) == futures.end()))
+          {
+            if (!futures_complete)
+            {
+              memcpy(dense_results + index * dense_result_size,
+                     result, result_size);
+              dense_present[index] = 1;
+            }
+            if (owner)
+              free(const_cast<void*>(result));
+            return;
+          }
+        }
+        AutoLock gc(gc_lock);
+        // The first result decides the size of the slots
+        if (dense_present.empty())
+        {
+          dense_result_size = result_size;
+          dense_results = (char*)malloc(result_domain.get_volume() * 
+                                        dense_result_size);
+          dense_present.resize(result_domain.get_volume(), 0);
+        }
+        if ((result_size == dense_result_size) &&
+            (futures.find(point) == futures.end()))
+        {
+          if (!futures_complete)
+          {
+            memcpy(dense_results + index * dense_result_size,
+                   result, result_size);
+            dense_present[index] = 1;
+          }
+          if (owner)
+            free(const_cast<void*>(result));
+          return;
+        }
+      }
+      // Otherwise the result goes in a future of its own 
+      Future f = get_future(point);
+      f.impl->set_result(result, result_size, owner);
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureMapImpl::get_all_results(void *buffer, size_t result_size,
+                                        bool silence_warnings,
+                                        const char *warning_string)
+    //--------------------------------------------------------------------------
+    {
+      if (!is_owner() || !result_domain.exists())
+        REPORT_LEGION_ERROR(ERROR_FUTURE_MAP_GET_ALL_RESULTS,
+            "Bulk reads of future map results are only supported for "
+            "future maps made by index space task launches on the node "
+            "that launched them")
+      if (runtime->runtime_warnings && !silence_warnings && 
+          (context != NULL) && !context->is_leaf_context())
+        REPORT_LEGION_WARNING(LEGION_WARNING_WAITING_ALL_FUTURES, 
+            "Waiting for all futures in a future map in "
+            "non-leaf task %s (UID %lld) is a violation of Legion's deferred "
+            "execution model best practices. You may notice a severe "
+            "performance degredation. Warning string: %s", 
+            context->get_task_name(),
+            context->get_unique_id(),
+            (warning_string == NULL) ? "" : warning_string)
+      wait_for_ready();
+      char *target = (char*)buffer;
+      // Nothing can be added to the buffer once the launch is complete
+      // so we only need to keep out anyone making futures from it
+      AutoLock gc(gc_lock,1,false/*exclusive*/);
+      size_t index = 0;
+      for (Domain::DomainPointIterator itr(result_domain); itr; 
+            itr++, index++, target += result_size)
+      {
+        const void *result = NULL;
+        size_t size = 0;
+        if (!dense_present.empty() && dense_present[index])
+        {
+          result = dense_results + index * dense_result_size;
+          size = dense_result_size;
+        }
+        else
+        {
+          std::map<DomainPoint,Future>::const_iterator finder = 
+            futures.find(itr.p);
+          if (finder != futures.end())
+          {
+            size = finder->second.impl->get_untyped_size();
+            result = finder->second.impl->get_untyped_result(true);
+          }
+        }
+        if (size != result_size)
+          REPORT_LEGION_ERROR(ERROR_FUTURE_MAP_GET_ALL_RESULTS,
+              "Point task returned %zd bytes but a bulk read of its "
+              "future map expected %zd bytes", size, result_size)
+        memcpy(target, result, result_size);
+      }
+    }
+
 #ifdef DEBUG_LEGION
     //--------------------------------------------------------------------------
     void FutureMapImpl::add_valid_domain(const Domain &d)
@@ -1662,7 +1863,8 @@ namespace Legion {
                                               bool silence_warnings, 
                                               bool generic_accessor,
                                               bool check_field_size,
-                                              ReductionOpID redop)
+                                              ReductionOpID redop,
+                                         ListReductionManager **list_manager)
     //--------------------------------------------------------------------------
     { 
       // Check the privilege mode first
@@ -1817,6 +2019,14 @@ namespace Legion {
                             fid, field_size, actual_size, 
                             context->get_task_name(), context->get_unique_id())
           }
+          // Lists hold entries rather than points of the region so
+          // only list accessors know how to use them and vice versa
+          if (manager->is_list_manager() != (list_manager != NULL))
+            report_incompatible_accessor((list_manager != NULL) ?
+                "ListReductionAccessor" : "field accessor", 
+                manager->get_instance(), fid);
+          if (list_manager != NULL)
+            *list_manager = manager->as_list_manager();
           return manager->get_instance();
         }
       }
@@ -1826,6 +2036,34 @@ namespace Legion {
       return PhysicalInstance::NO_INST;
     } 
 
+    //--------------------------------------------------------------------------
+    PhysicalInstance PhysicalRegionImpl::get_list_instance_info(FieldID fid,
+                                     size_t field_size, ReductionOpID redop,
+                                     void *realm_is, TypeTag type_tag,
+                                     const char *warning_string,
+                                     bool silence_warnings,
+                                     FieldID &pointer_fid, size_t &max_entries,
+                                     size_t *&next_entry)
+    //--------------------------------------------------------------------------
+    {
+      ListReductionManager *manager = NULL;
+      const PhysicalInstance result = get_instance_info(REDUCE, fid,
+          field_size, realm_is, type_tag, warning_string, silence_warnings,
+          false/*generic accessor*/, false/*check field size*/, redop, 
+          &manager);
+#ifdef DEBUG_LEGION
+      assert(manager != NULL);
+#endif
+      // The cursor for appending to the list only lives on the owner
+      // node which is the only place the list can be appended to
+      if (!manager->is_owner())
+        report_incompatible_accessor("ListReductionAccessor", result, fid);
+      pointer_fid = ListReductionManager::get_pointer_field(fid);
+      max_entries = manager->get_pointer_space().get_volume();
+      next_entry = manager->get_next_entry();
+      return result;
+    }
+
     //--------------------------------------------------------------------------
     void PhysicalRegionImpl::fail_bounds_check(DomainPoint p, FieldID fid,
                                                PrivilegeMode mode)
@@ -3400,7 +3638,7 @@ namespace Legion {
         {
           for (std::vector<PhysicalManager*>::const_iterator it = 
                 to_remove.begin(); it != to_remove.end(); it++)
-            current_instances.erase(*it);
+            erase_instance(*it);
         }
       }
       for (std::map<PhysicalManager*,RtEvent>::const_iterator it = 
@@ -3441,7 +3679,7 @@ namespace Legion {
 #endif
       // Make it valid to start since we know when we were created
       // that we were made valid to begin with
-      InstanceInfo &info = current_instances[manager];
+      InstanceInfo &info = insert_instance(manager);
       info.instance_size = inst_size;
     }
 
@@ -3453,7 +3691,7 @@ namespace Legion {
  #ifdef DEBUG_LEGION
       assert(current_instances.find(manager) != current_instances.end());
 #endif     
-      current_instances.erase(manager);
+      erase_instance(manager);
     }
 
     //--------------------------------------------------------------------------
@@ -3511,7 +3749,7 @@ namespace Legion {
 #endif
           Runtime::trigger_event(info.deferred_collect);
           // Now we can delete our entry because it has been deleted
-          current_instances.erase(finder);
+          erase_instance(manager);
           remove_reference = true;
         }
         else if (finder->second.current_state == PENDING_ACQUIRE_STATE)
@@ -3527,7 +3765,7 @@ namespace Legion {
           // currently allow the mappers to reuse them
           perform_deletion = true;
           remove_reference = true;
-          current_instances.erase(finder);
+          erase_instance(manager);
         }
         else // didn't collect it yet
           info.current_state = COLLECTABLE_STATE;
@@ -4094,7 +4332,7 @@ namespace Legion {
         {
           for (std::vector<PhysicalManager*>::const_iterator it = 
                 to_remove.begin(); it != to_remove.end(); it++)
-            current_instances.erase(*it);
+            erase_instance(*it);
         }
       }
       for (std::map<PhysicalManager*,std::pair<RtEvent,bool> >::
@@ -4753,7 +4991,7 @@ namespace Legion {
             std::map<PhysicalManager*,InstanceInfo>::const_iterator finder = 
               current_instances.find(manager);
             if (finder == current_instances.end())
-              current_instances[manager] = InstanceInfo();
+              insert_instance(manager);
             if (created && min_priority)
             {
               std::pair<MapperID,Processor> key(mapper_id,processor);
@@ -4790,7 +5028,7 @@ namespace Legion {
             std::map<PhysicalManager*,InstanceInfo>::const_iterator finder = 
               current_instances.find(manager);
             if (finder == current_instances.end())
-              current_instances[manager] = InstanceInfo();
+              insert_instance(manager);
             if (min_priority)
             {
               InstanceInfo &info = current_instances[manager];
@@ -5021,25 +5259,8 @@ namespace Legion {
                                 bool tight_region_bounds, bool remote)
     //--------------------------------------------------------------------------
     {
-      // Hold the lock while iterating here
       std::deque<PhysicalManager*> candidates;
-      {
-        AutoLock m_lock(manager_lock, 1, false/*exclusive*/);
-        for (std::map<PhysicalManager*,InstanceInfo>::const_iterator it = 
-              current_instances.begin(); it != current_instances.end(); it++)
-        {
-          // Skip it if has already been collected
-          if (it->second.current_state == PENDING_COLLECTED_STATE)
-            continue;
-          // Skip any unattached external instances too
-          if (it->second.unattached_external)
-            continue;
-          if (!it->first->meets_region_tree(regions))
-            continue;
-          it->first->add_base_resource_ref(MEMORY_MANAGER_REF);
-          candidates.push_back(it->first);
-        }
-      }
+      find_candidate_instances(regions, false/*valid only*/, candidates);
       // If we have any candidates check their constraints
       bool found = false;
       if (!candidates.empty())
@@ -5074,25 +5295,8 @@ namespace Legion {
                                       bool tight_region_bounds, bool remote)
     //--------------------------------------------------------------------------
     {
-      // Hold the lock while iterating here
       std::deque<PhysicalManager*> candidates;
-      {
-        AutoLock m_lock(manager_lock, 1, false/*exclusive*/);
-        for (std::map<PhysicalManager*,InstanceInfo>::const_iterator it = 
-              current_instances.begin(); it != current_instances.end(); it++)
-        {
-          // Skip it if has already been collected
-          if (it->second.current_state == PENDING_COLLECTED_STATE)
-            continue;
-          // Skip any unattached external instances too
-          if (it->second.unattached_external)
-            continue;
-          if (!it->first->meets_region_tree(regions))
-            continue;
-          it->first->add_base_resource_ref(MEMORY_MANAGER_REF);
-          candidates.push_back(it->first);
-        }
-      }
+      find_candidate_instances(regions, false/*valid only*/, candidates);
       // If we have any candidates check their constraints
       bool found = false;
       if (!candidates.empty())
@@ -5128,23 +5332,8 @@ namespace Legion {
                                      bool tight_region_bounds, bool remote)
     //--------------------------------------------------------------------------
     {
-      // Hold the lock while iterating here
       std::deque<PhysicalManager*> candidates;
-      {
-        AutoLock m_lock(manager_lock, 1, false/*exclusive*/);
-        for (std::map<PhysicalManager*,InstanceInfo>::const_iterator it = 
-              current_instances.begin(); it != current_instances.end(); it++)
-        {
-          // Only consider ones that are currently valid
-          if (it->second.current_state != VALID_STATE)
-            continue;
-          // Skip any unattached external instances too
-          if (it->second.unattached_external)
-            continue;
-          it->first->add_base_resource_ref(MEMORY_MANAGER_REF);
-          candidates.push_back(it->first);
-        }
-      }
+      find_candidate_instances(regions, true/*valid only*/, candidates);
       // If we have any candidates check their constraints
       bool found = false;
       if (!candidates.empty())
@@ -5180,23 +5369,8 @@ namespace Legion {
                                      bool tight_region_bounds, bool remote)
     //--------------------------------------------------------------------------
     {
-      // Hold the lock while iterating here
       std::deque<PhysicalManager*> candidates;
-      {
-        AutoLock m_lock(manager_lock, 1, false/*exclusive*/);
-        for (std::map<PhysicalManager*,InstanceInfo>::const_iterator it = 
-              current_instances.begin(); it != current_instances.end(); it++)
-        {
-          // Only consider ones that are currently valid
-          if (it->second.current_state != VALID_STATE)
-            continue;
-          // Skip any unattached external instances too
-          if (it->second.unattached_external)
-            continue;
-          it->first->add_base_resource_ref(MEMORY_MANAGER_REF);
-          candidates.push_back(it->first);
-        }
-      }
+      find_candidate_instances(regions, true/*valid only*/, candidates);
       // If we have any candidates check their constraints
       bool found = false;
       if (!candidates.empty())
@@ -5224,6 +5398,89 @@ namespace Legion {
       return found;
     }
 
+    //--------------------------------------------------------------------------
+    void MemoryManager::find_candidate_instances(
+                                     const std::vector<LogicalRegion> &regions,
+                                     bool valid_only,
+                                     std::deque<PhysicalManager*> &candidates)
+    //--------------------------------------------------------------------------
+    {
+      // An instance can only satisfy a request if its region is the same
+      // as or an ancestor of all the requested regions, so we only need to
+      // look at the instances for the ancestors of the first region
+      std::vector<RegionNode*> ancestors;
+      if (!regions.empty())
+      {
+        RegionNode *node = runtime->forest->get_node(regions.front());
+        ancestors.push_back(node);
+        while (node->parent != NULL)
+        {
+          node = node->parent->parent;
+          ancestors.push_back(node);
+        }
+      }
+      // Hold the lock while iterating here
+      AutoLock m_lock(manager_lock, 1, false/*exclusive*/);
+      if (ancestors.empty())
+      {
+        for (std::map<PhysicalManager*,InstanceInfo>::const_iterator it = 
+              current_instances.begin(); it != current_instances.end(); it++)
+        {
+          if (valid_only)
+          {
+            // Only consider ones that are currently valid
+            if (it->second.current_state != VALID_STATE)
+              continue;
+          }
+          // Skip it if has already been collected
+          else if (it->second.current_state == PENDING_COLLECTED_STATE)
+            continue;
+          // Skip any unattached external instances too
+          if (it->second.unattached_external)
+            continue;
+          it->first->add_base_resource_ref(MEMORY_MANAGER_REF);
+          candidates.push_back(it->first);
+        }
+        return;
+      }
+      // Walk from the requested region up to the root so that we
+      // will consider the most tightly fitting instances first
+      for (std::vector<RegionNode*>::const_iterator rit = 
+            ancestors.begin(); rit != ancestors.end(); rit++)
+      {
+        std::map<RegionNode*,std::set<PhysicalManager*> >::const_iterator
+          region_finder = region_instances.find(*rit);
+        if (region_finder == region_instances.end())
+          continue;
+        for (std::set<PhysicalManager*>::const_iterator it = 
+              region_finder->second.begin(); it != 
+              region_finder->second.end(); it++)
+        {
+          std::map<PhysicalManager*,InstanceInfo>::const_iterator finder = 
+            current_instances.find(*it);
+#ifdef DEBUG_LEGION
+          assert(finder != current_instances.end());
+#endif
+          if (valid_only)
+          {
+            // Only consider ones that are currently valid
+            if (finder->second.current_state != VALID_STATE)
+              continue;
+          }
+          // Skip it if has already been collected
+          else if (finder->second.current_state == PENDING_COLLECTED_STATE)
+            continue;
+          // Skip any unattached external instances too
+          if (finder->second.unattached_external)
+            continue;
+          if (!(*it)->meets_region_tree(regions))
+            continue;
+          (*it)->add_base_resource_ref(MEMORY_MANAGER_REF);
+          candidates.push_back(*it);
+        }
+      }
+    }
+
     //--------------------------------------------------------------------------
     void MemoryManager::release_candidate_references(
                            const std::deque<PhysicalManager*> &candidates) const
@@ -5237,6 +5494,31 @@ namespace Legion {
       }
     }
 
+    //--------------------------------------------------------------------------
+    MemoryManager::InstanceInfo& MemoryManager::insert_instance(
+                                                      PhysicalManager *manager)
+    //--------------------------------------------------------------------------
+    {
+      region_instances[manager->region_node].insert(manager);
+      return current_instances[manager];
+    }
+
+    //--------------------------------------------------------------------------
+    void MemoryManager::erase_instance(PhysicalManager *manager)
+    //--------------------------------------------------------------------------
+    {
+      std::map<RegionNode*,std::set<PhysicalManager*> >::iterator finder = 
+        region_instances.find(manager->region_node);
+#ifdef DEBUG_LEGION
+      assert(finder != region_instances.end());
+      assert(finder->second.find(manager) != finder->second.end());
+#endif
+      finder->second.erase(manager);
+      if (finder->second.empty())
+        region_instances.erase(finder);
+      current_instances.erase(manager);
+    }
+
     //--------------------------------------------------------------------------
     RtEvent MemoryManager::acquire_allocation_privilege(void)
     //--------------------------------------------------------------------------
@@ -5360,7 +5642,7 @@ namespace Legion {
 #ifdef DEBUG_LEGION
         assert(current_instances.find(manager) == current_instances.end());
 #endif
-        InstanceInfo &info = current_instances[manager];
+        InstanceInfo &info = insert_instance(manager);
         if (early_valid)
           info.current_state = VALID_STATE;
         info.min_priority = priority;
@@ -5415,7 +5697,7 @@ namespace Legion {
 #ifdef DEBUG_LEGION
         assert(current_instances.find(manager) == current_instances.end());
 #endif
-        InstanceInfo &info = current_instances[manager];
+        InstanceInfo &info = insert_instance(manager);
         info.instance_size = instance_size;
         info.unattached_external = true;
       }
@@ -5492,7 +5774,7 @@ namespace Legion {
           {
             for (std::map<PhysicalManager*,RtEvent>::const_iterator it = 
                   to_delete.begin(); it != to_delete.end(); it++)
-              current_instances.erase(it->first);
+              erase_instance(it->first);
           }
         }
         else
@@ -5586,7 +5868,7 @@ namespace Legion {
           manager->add_base_resource_ref(MEMORY_MANAGER_REF);
         }
         else // Reference will flow out
-          current_instances.erase(finder);
+          erase_instance(manager);
       }
       // Perform the deletion contingent on references being removed
       manager->perform_deletion(deferred_collect);
@@ -5601,11 +5883,14 @@ namespace Legion {
     /////////////////////////////////////////////////////////////
 
     //--------------------------------------------------------------------------
-    VirtualChannel::VirtualChannel(VirtualChannelKind kind, 
-        AddressSpaceID local_address_space, 
-        size_t max_message_size, LegionProfiler *prof)
+    VirtualChannel::VirtualChannel(VirtualChannelKind k, 
+        AddressSpaceID local_address_space, size_t max_message_size, 
+        unsigned window, LegionProfiler *prof)
       : sending_buffer((char*)malloc(max_message_size)), 
-        sending_buffer_size(max_message_size), partial_messages(0),
+        sending_buffer_size(max_message_size), kind(k),
+        aggregation_window(window), held_since(-1), flush_pending(false),
+        total_messages(0),
+        total_active_messages(0), total_bytes(0), partial_messages(0),
         observed_recent(true), profiler(prof)
     //--------------------------------------------------------------------------
     //
@@ -5647,7 +5932,8 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     VirtualChannel::VirtualChannel(const VirtualChannel &rhs)
-      : sending_buffer(NULL), sending_buffer_size(0), profiler(NULL)
+      : sending_buffer(NULL), sending_buffer_size(0), kind(rhs.kind),
+        aggregation_window(0), profiler(NULL)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -5667,7 +5953,7 @@ namespace Legion {
     //--------------------------------------------------------------------------
     void VirtualChannel::package_message(Serializer &rez, MessageKind k,
                          bool flush, Runtime *runtime, Processor target, 
-                         bool response, bool shutdown)
+                         bool response, bool shutdown, bool deferrable)
     //--------------------------------------------------------------------------
     {
       // First check to see if the message fits in the current buffer    
@@ -5678,6 +5964,8 @@ namespace Legion {
         sizeof(k) + sizeof(implicit_provenance) + sizeof(buffer_size);
       // Need to hold the lock when manipulating the buffer
       AutoLock s_lock(send_lock);
+      total_messages++;
+      total_bytes += header_size + buffer_size;
       if ((sending_index+header_size+buffer_size) > sending_buffer_size)
       {
         // Make sure we can at least get the meta-data into the buffer
@@ -5725,10 +6013,62 @@ namespace Legion {
         memcpy(sending_buffer+sending_index,buffer,buffer_size); 
         sending_index += buffer_size;
       }
+      // Hold back flushes of small messages that nobody is waiting on
+      // so that storms of them go out in as few active messages as
+      // possible. Any other flush of this channel or a full buffer
+      // sends the held messages along with it, and during a storm the
+      // first message held after the aggregation window has passed
+      // sends them all. Otherwise they wait for a low priority flush
+      // task that sends whatever is held once the utility processor
+      // has nothing more important to do.
+      if (flush && deferrable && !partial && (aggregation_window > 0))
+      {
+#ifdef DEBUG_LEGION
+        assert(!response && !shutdown);
+#endif
+        const long long now = Realm::Clock::current_time_in_microseconds();
+        if (held_since < 0)
+          held_since = now;
+        if ((now - held_since) < aggregation_window)
+        {
+          if (!flush_pending)
+          {
+            FlushMessagesArgs args(this, target);
+            runtime->issue_runtime_meta_task(args, LG_LOW_PRIORITY);
+            flush_pending = true;
+          }
+          return;
+        }
+      }
       if (flush)
         send_message(true/*complete*/, runtime, target, response, shutdown);
     }
 
+    //--------------------------------------------------------------------------
+    void VirtualChannel::flush_aggregated_messages(Runtime *runtime,
+                                                   Processor target)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock s_lock(send_lock);
+#ifdef DEBUG_LEGION
+      assert(flush_pending);
+#endif
+      flush_pending = false;
+      // Someone else might have already sent them for us
+      if (packaged_messages > 0)
+        send_message(true/*complete*/, runtime, target, 
+                     false/*response*/, false/*shutdown*/);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void VirtualChannel::handle_flush_messages(Runtime *runtime,
+                                                          const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const FlushMessagesArgs *fargs = (const FlushMessagesArgs*)args;
+      fargs->channel->flush_aggregated_messages(runtime, fargs->target);
+    }
+
     //--------------------------------------------------------------------------
     void VirtualChannel::send_message(bool complete, Runtime *runtime,
                                  Processor target, bool response, bool shutdown)
@@ -5752,6 +6092,7 @@ namespace Legion {
       *((MessageHeader*)(sending_buffer + base_size)) = header;
       *((unsigned*)(sending_buffer + base_size + sizeof(header))) = 
                                                             packaged_messages;
+      total_active_messages++;
       // Send the message directly there, don't go through the
       // runtime interface to avoid being counted, still include
       // a profiling request though if necessary in order to 
@@ -5778,6 +6119,8 @@ namespace Legion {
       else
         header = FULL_MESSAGE;
       packaged_messages = 0;
+      // Anything that was held back has gone out now
+      held_since = -1;
     }
 
     //--------------------------------------------------------------------------
@@ -5822,6 +6165,18 @@ namespace Legion {
       }
     }
 
+    //--------------------------------------------------------------------------
+    void VirtualChannel::record_statistics(LegionProfiler *profiler,
+                                           AddressSpaceID target) const
+    //--------------------------------------------------------------------------
+    {
+      AutoLock s_lock(send_lock);
+      if (total_messages == 0)
+        return;
+      profiler->record_message_channel(target, kind, total_messages,
+                                       total_active_messages, total_bytes);
+    }
+
     //--------------------------------------------------------------------------
     void VirtualChannel::process_message(const void *args, size_t arglen,
                          Runtime *runtime, AddressSpaceID remote_address_space)
@@ -6767,7 +7122,8 @@ namespace Legion {
       for (unsigned idx = 0; idx < MAX_NUM_VIRTUAL_CHANNELS; idx++)
       {
         new (channels+idx) VirtualChannel((VirtualChannelKind)idx,
-            rt->address_space, max_message_size, runtime->profiler);
+            rt->address_space, max_message_size, 
+            runtime->message_aggregation_window, runtime->profiler);
       }
     }
 
@@ -6802,11 +7158,12 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     void MessageManager::send_message(Serializer &rez, MessageKind kind,
-           VirtualChannelKind channel, bool flush, bool response, bool shutdown)
+                                  VirtualChannelKind channel, bool flush, 
+                                  bool response, bool shutdown, bool deferrable)
     //--------------------------------------------------------------------------
     {
       channels[channel].package_message(rez, kind, flush, runtime, 
-                                        target, response, shutdown);
+                                        target, response, shutdown, deferrable);
     }
 
     //--------------------------------------------------------------------------
@@ -6831,6 +7188,14 @@ namespace Legion {
         channels[idx].confirm_shutdown(shutdown_manager, phase_one);
     }
 
+    //--------------------------------------------------------------------------
+    void MessageManager::record_statistics(LegionProfiler *profiler) const
+    //--------------------------------------------------------------------------
+    {
+      for (unsigned idx = 0; idx < MAX_NUM_VIRTUAL_CHANNELS; idx++)
+        channels[idx].record_statistics(profiler, remote_address_space);
+    }
+
     /////////////////////////////////////////////////////////////
     // Shutdown Manager 
     /////////////////////////////////////////////////////////////
@@ -9087,6 +9452,7 @@ namespace Legion {
         initial_tasks_to_schedule(config.initial_tasks_to_schedule),
         initial_meta_task_vector_width(config.initial_meta_task_vector_width),
         max_message_size(config.max_message_size),
+        message_aggregation_window(config.message_aggregation_window),
         gc_epoch_size(config.gc_epoch_size),
         max_local_fields(config.max_local_fields),
         max_replay_parallelism(config.max_replay_parallelism),
@@ -9116,6 +9482,9 @@ namespace Legion {
         enable_test_mapper(config.enable_test_mapper),
         legion_ldb_enabled(config.legion_ldb_enabled),
         replay_file(config.replay_file),
+        trace_cache_directory(config.trace_cache_directory),
+        trace_cache_build_id((config.trace_cache_directory == NULL) ? 0 :
+            PhysicalTrace::find_build_id(config.trace_cache_directory)),
 #ifdef DEBUG_LEGION
         logging_region_tree_state(config.logging_region_tree_state),
         verbose_logging(config.verbose_logging),
@@ -9285,6 +9654,7 @@ namespace Legion {
         initial_tasks_to_schedule(rhs.initial_tasks_to_schedule),
         initial_meta_task_vector_width(rhs.initial_meta_task_vector_width),
         max_message_size(rhs.max_message_size),
+        message_aggregation_window(rhs.message_aggregation_window),
         gc_epoch_size(rhs.gc_epoch_size), 
         max_local_fields(rhs.max_local_fields),
         max_replay_parallelism(rhs.max_replay_parallelism),
@@ -9310,6 +9680,8 @@ namespace Legion {
         enable_test_mapper(rhs.enable_test_mapper),
         legion_ldb_enabled(rhs.legion_ldb_enabled),
         replay_file(rhs.replay_file),
+        trace_cache_directory(rhs.trace_cache_directory),
+        trace_cache_build_id(rhs.trace_cache_build_id),
 #ifdef DEBUG_LEGION
         logging_region_tree_state(rhs.logging_region_tree_state),
         verbose_logging(rhs.verbose_logging),
@@ -9772,7 +10144,8 @@ namespace Legion {
                                     config.prof_logfile,
                                     total_address_spaces,
                                     config.prof_footprint_threshold,
-                                    config.prof_target_latency);
+                                    config.prof_target_latency,
+                                    config.prof_sampling);
       LG_MESSAGE_DESCRIPTIONS(lg_message_descriptions);
       profiler->record_message_kinds(lg_message_descriptions, LAST_SEND_KIND);
       MAPPER_CALL_NAMES(lg_mapper_calls);
@@ -10177,7 +10550,12 @@ namespace Legion {
            memory_managers.begin(); it != memory_managers.end(); it++)
         it->second->finalize();
       if (profiler != NULL)
+      {
+        for (unsigned idx = 0; idx < LEGION_MAX_NUM_NODES; idx++)
+          if (message_managers[idx] != NULL)
+            message_managers[idx]->record_statistics(profiler);
         profiler->finalize();
+      }
     }
     
     //--------------------------------------------------------------------------
@@ -13237,6 +13615,37 @@ namespace Legion {
       return owner->find_variant_impl(variant_id, can_fail);
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::pack_registered_variants(Serializer &rez)
+    //--------------------------------------------------------------------------
+    {
+      // Sort them so the result does not depend on the registration order
+      std::map<std::pair<TaskID,VariantID>,VariantImpl*> variants;
+      {
+        AutoLock tv_lock(task_variant_lock,1,false/*exclusive*/);
+        for (std::deque<VariantImpl*>::const_iterator it = 
+              variant_table.begin(); it != variant_table.end(); it++)
+          variants[std::pair<TaskID,VariantID>((*it)->owner->task_id,
+                                               (*it)->vid)] = *it;
+      }
+      rez.serialize<size_t>(variants.size());
+      for (std::map<std::pair<TaskID,VariantID>,VariantImpl*>::const_iterator
+            it = variants.begin(); it != variants.end(); it++)
+      {
+        rez.serialize(it->first.first);
+        rez.serialize(it->first.second);
+        const char *name = it->second->get_name();
+        if (name != NULL)
+          rez.serialize(name, strlen(name) + 1);
+        else
+          rez.serialize<char>('\0');
+        rez.serialize<bool>(it->second->is_leaf());
+        rez.serialize<bool>(it->second->is_inner());
+        rez.serialize<bool>(it->second->is_idempotent());
+        rez.serialize<bool>(it->second->returns_value());
+      }
+    }
+
     //--------------------------------------------------------------------------
     ReductionOpID Runtime::generate_dynamic_reduction_id(void)
     //--------------------------------------------------------------------------
@@ -14330,20 +14739,24 @@ namespace Legion {
 
     //--------------------------------------------------------------------------
     void Runtime::send_did_remote_valid_update(AddressSpaceID target,
-                                               Serializer &rez)
+                                           Serializer &rez, bool deferrable)
     //--------------------------------------------------------------------------
     {
       find_messenger(target)->send_message(rez, DISTRIBUTED_VALID_UPDATE,
-                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/);
+                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/,
+                                    false/*response*/, false/*shutdown*/,
+                                    deferrable);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::send_did_remote_gc_update(AddressSpaceID target,
-                                            Serializer &rez)
+                                            Serializer &rez, bool deferrable)
     //--------------------------------------------------------------------------
     {
       find_messenger(target)->send_message(rez, DISTRIBUTED_GC_UPDATE,
-                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/);
+                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/,
+                                    false/*response*/, false/*shutdown*/,
+                                    deferrable);
     }
 
     //--------------------------------------------------------------------------
@@ -14351,8 +14764,11 @@ namespace Legion {
                                                   Serializer &rez)
     //--------------------------------------------------------------------------
     {
+      // Nobody ever waits on resource reference updates
       find_messenger(target)->send_message(rez, DISTRIBUTED_RESOURCE_UPDATE,
-                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/);
+                                    REFERENCE_VIRTUAL_CHANNEL, true/*flush*/,
+                                    false/*response*/, false/*shutdown*/,
+                                    true/*deferrable*/);
     }
 
     //--------------------------------------------------------------------------
@@ -19500,7 +19916,16 @@ namespace Legion {
         perform_slow_config_checks(config);
       // Configure legion spy if necessary
       if (config.legion_spy_enabled)
+      {
+        if (config.spy_logfile != NULL)
+        {
+          Machine::ProcessorQuery local_procs(Machine::get_machine());
+          local_procs.local_address_space();
+          LegionSpy::open_binary_log(config.spy_logfile,
+                                     local_procs.first().address_space());
+        }
         LegionSpy::log_legion_spy_config();
+      }
       // Configure MPI Interoperability
       const std::vector<MPILegionHandshake> &pending_handshakes =
         get_pending_handshake_table();
@@ -19726,18 +20151,29 @@ namespace Legion {
         BOOL_ARG("-lg:no_trace_optimization",config.no_trace_optimization);
         BOOL_ARG("-lg:no_fence_elision",config.no_fence_elision);
         BOOL_ARG("-lg:replay_on_cpus",config.replay_on_cpus);
+        if (!strcmp(argv[i],"-lg:trace_cache"))
+        {
+          config.trace_cache_directory = argv[++i];
+          continue;
+        }
         BOOL_ARG("-lg:disjointness",config.verify_disjointness);
         INT_ARG("-lg:window", config.initial_task_window_size);
         INT_ARG("-lg:hysteresis", config.initial_task_window_hysteresis);
         INT_ARG("-lg:sched", config.initial_tasks_to_schedule);
         INT_ARG("-lg:vector", config.initial_meta_task_vector_width);
         INT_ARG("-lg:message",config.max_message_size);
+        INT_ARG("-lg:aggregate",config.message_aggregation_window);
         INT_ARG("-lg:epoch", config.gc_epoch_size);
         INT_ARG("-lg:local", config.max_local_fields);
         INT_ARG("-lg:parallel_replay", config.max_replay_parallelism);
         if (!strcmp(argv[i],"-lg:no_dyn"))
           config.dynamic_independence_tests = false;
         BOOL_ARG("-lg:spy",config.legion_spy_enabled);
+        if (!strcmp(argv[i],"-lg:spy_logfile"))
+        {
+          config.spy_logfile = argv[++i];
+          continue;
+        }
         BOOL_ARG("-lg:test",config.enable_test_mapper);
         INT_ARG("-lg:delay", config.delay_start);
         if (!strcmp(argv[i],"-lg:replay"))
@@ -19789,6 +20225,7 @@ namespace Legion {
           continue;
         }
         INT_ARG("-lg:prof_latency",config.prof_target_latency);
+        BOOL_ARG("-lg:prof_sample",config.prof_sampling);
 
         BOOL_ARG("-lg:debug_ok",config.slow_config_ok);
         
@@ -21452,6 +21889,16 @@ namespace Legion {
             PhysicalTemplate::handle_delete_template(args);
             break;
           }
+        case LG_SAVE_PERSISTENT_TRACE_ID:
+          {
+            PhysicalTrace::handle_save_persistent(args);
+            break;
+          }
+        case LG_FLUSH_MESSAGES_TASK_ID:
+          {
+            VirtualChannel::handle_flush_messages(runtime, args);
+            break;
+          }
         case LG_RETRY_SHUTDOWN_TASK_ID:
           {
             const ShutdownManager::RetryShutdownArgs *shutdown_args = 
@@ -21460,6 +21907,11 @@ namespace Legion {
                                                shutdown_args->phase);
             break;
           }
+        case LG_PROFILER_FLUSH_TASK_ID:
+          {
+            LegionProfiler::handle_flush(args);
+            break;
+          }
         default:
           assert(false); // should never get here
       }
@@ -315,8 +315,23 @@ namespace Legion {
       void complete_all_futures(void);
       bool reset_all_futures(void);
     public:
-      void get_all_futures(std::map<DomainPoint,Future> &futures) const;
+      void get_all_futures(std::map<DomainPoint,Future> &futures);
       void set_all_futures(const std::map<DomainPoint,Future> &futures);
+    public:
+      // Index space launches record their launch domain so results can 
+      // be read in bulk, and over dense domains they keep fixed-size 
+      // results in one buffer and only make a Future for a point when 
+      // someone asks for it
+      void initialize_result_domain(const Domain &domain, bool dense);
+      void set_point_result(const DomainPoint &point, const void *result,
+                            size_t result_size, bool owner);
+      void get_all_results(void *buffer, size_t result_size,
+                           bool silence_warnings = true,
+                           const char *warning_string = NULL);
+    protected:
+      void wait_for_ready(void) const;
+      bool find_dense_index(const DomainPoint &point, size_t &index) const;
+      Future materialize_dense_future(size_t index);
 #ifdef DEBUG_LEGION
     public:
       void add_valid_domain(const Domain &d);
@@ -337,6 +352,16 @@ namespace Legion {
       ApEvent ready_event;
       std::map<DomainPoint,Future> futures;
       bool valid;
+      bool futures_complete;
+    private:
+      // Launch domain and the dense result buffer with one slot of
+      // dense_result_size bytes per point, the slots are linearized
+      // in the order that a DomainPointIterator visits the domain
+      Domain result_domain;
+      bool dense_storage;
+      size_t dense_result_size;
+      char *dense_results;
+      std::vector<unsigned char> dense_present;
 #ifdef DEBUG_LEGION
     private:
       std::vector<Domain> valid_domains;
@@ -414,7 +439,16 @@ namespace Legion {
                                          bool silence_warnings, 
                                          bool generic_accessor,
                                          bool check_field_size,
-                                         ReductionOpID redop);
+                                         ReductionOpID redop,
+                                   ListReductionManager **list_manager = NULL);
+      PhysicalInstance get_list_instance_info(FieldID fid, size_t field_size,
+                                         ReductionOpID redop,
+                                         void *realm_is, TypeTag type_tag,
+                                         const char *warning_string,
+                                         bool silence_warnings,
+                                         FieldID &pointer_fid,
+                                         size_t &max_entries,
+                                         size_t *&next_entry);
       void fail_bounds_check(DomainPoint p, FieldID fid, PrivilegeMode mode);
       void fail_bounds_check(Domain d, FieldID fid, PrivilegeMode mode);
       void report_incompatible_accessor(const char *accessor_kind,
@@ -837,8 +871,15 @@ namespace Legion {
                                     const std::vector<LogicalRegion> &regions,
                                     MappingInstance &result, bool acquire, 
                                     bool tight_region_bounds, bool remote);
+      void find_candidate_instances(const std::vector<LogicalRegion> &regions,
+                                    bool valid_only,
+                                    std::deque<PhysicalManager*> &candidates);
       void release_candidate_references(const std::deque<PhysicalManager*>
                                                         &candidates) const;
+    protected:
+      // These must be called while holding the manager lock
+      InstanceInfo& insert_instance(PhysicalManager *manager);
+      void erase_instance(PhysicalManager *manager);
     protected:
       // We serialize all allocation attempts in a memory in order to 
       // ensure find_and_create calls will remain atomic
@@ -874,6 +915,10 @@ namespace Legion {
       // It is only valid on the owner node
       LegionMap<PhysicalManager*,InstanceInfo,
                 MEMORY_INSTANCES_ALLOC>::tracked current_instances;
+      // An index of current_instances by the region node of each instance
+      // so that lookups only need to consider instances for regions that
+      // are ancestors of the regions being requested
+      std::map<RegionNode*,std::set<PhysicalManager*> > region_instances;
       // Keep track of outstanding requuests for allocations which 
       // will be tried in the order that they arrive
       std::deque<RtUserEvent> pending_allocation_attempts;
@@ -895,9 +940,20 @@ namespace Legion {
         PARTIAL_MESSAGE,
         FINAL_MESSAGE,
       };
+      struct FlushMessagesArgs : public LgTaskArgs<FlushMessagesArgs> {
+      public:
+        static const LgTaskID TASK_ID = LG_FLUSH_MESSAGES_TASK_ID;
+      public:
+        FlushMessagesArgs(VirtualChannel *c, Processor t)
+          : LgTaskArgs<FlushMessagesArgs>(0), channel(c), target(t) { }
+      public:
+        VirtualChannel *const channel;
+        const Processor target;
+      };
     public:
       VirtualChannel(VirtualChannelKind kind,AddressSpaceID local_address_space,
-                     size_t max_message_size, LegionProfiler *profiler);
+                     size_t max_message_size, unsigned aggregation_window,
+                     LegionProfiler *profiler);
       VirtualChannel(const VirtualChannel &rhs);
       ~VirtualChannel(void);
     public:
@@ -905,11 +961,16 @@ namespace Legion {
     public:
       void package_message(Serializer &rez, MessageKind k, bool flush,
                            Runtime *runtime, Processor target, 
-                           bool response, bool shutdown);
+                           bool response, bool shutdown, bool deferrable);
       void process_message(const void *args, size_t arglen, 
                         Runtime *runtime, AddressSpaceID remote_address_space);
       void confirm_shutdown(ShutdownManager *shutdown_manager, bool phase_one);
+      void record_statistics(LegionProfiler *profiler, 
+                             AddressSpaceID target) const;
+    public:
+      static void handle_flush_messages(Runtime *runtime, const void *args);
     private:
+      void flush_aggregated_messages(Runtime *runtime, Processor target);
       void send_message(bool complete, Runtime *runtime, 
                         Processor target, bool response, bool shutdown);
       bool handle_messages(unsigned num_messages, Runtime *runtime, 
@@ -926,6 +987,18 @@ namespace Legion {
       MessageHeader header;
       unsigned packaged_messages;
       bool partial;
+      // State for holding back deferrable messages, they go out with
+      // the next send on this channel, or once the aggregation window
+      // after the first of them has passed when another is held, or
+      // when the low priority flush task for them runs
+      const VirtualChannelKind kind;
+      const long long aggregation_window;
+      long long held_since;
+      bool flush_pending;
+      // Statistics for the profiler
+      unsigned long long total_messages;
+      unsigned long long total_active_messages;
+      unsigned long long total_bytes;
       // State for receiving messages
       // No lock for receiving messages since we know
       // that they are ordered
@@ -969,10 +1042,12 @@ namespace Legion {
     public:
       void send_message(Serializer &rez, MessageKind kind, 
                         VirtualChannelKind channel, bool flush, 
-                        bool response = false, bool shutdown = false);
+                        bool response = false, bool shutdown = false,
+                        bool deferrable = false);
       void receive_message(const void *args, size_t arglen);
       void confirm_shutdown(ShutdownManager *shutdown_manager,
                             bool phase_one);
+      void record_statistics(LegionProfiler *profiler) const;
     public:
       const AddressSpaceID remote_address_space;
     public:
@@ -1463,6 +1538,8 @@ namespace Legion {
             initial_meta_task_vector_width(
                 LEGION_DEFAULT_META_TASK_VECTOR_WIDTH),
             max_message_size(LEGION_DEFAULT_MAX_MESSAGE_SIZE),
+            message_aggregation_window(
+                LEGION_DEFAULT_MESSAGE_AGGREGATION_WINDOW),
             gc_epoch_size(LEGION_DEFAULT_GC_EPOCH_SIZE),
             max_local_fields(LEGION_DEFAULT_LOCAL_FIELDS),
             max_replay_parallelism(LEGION_DEFAULT_MAX_REPLAY_PARALLELISM),
@@ -1489,9 +1566,11 @@ namespace Legion {
 #endif
             dynamic_independence_tests(true),
             legion_spy_enabled(false),
+            spy_logfile(NULL),
             enable_test_mapper(false),
             legion_ldb_enabled(false),
             replay_file(NULL),
+            trace_cache_directory(NULL),
             slow_config_ok(false),
 #ifdef DEBUG_LEGION
             logging_region_tree_state(false),
@@ -1504,7 +1583,8 @@ namespace Legion {
             serializer_type("binary"),
             prof_logfile(NULL),
             prof_footprint_threshold(128 << 20),
-            prof_target_latency(100) { }
+            prof_target_latency(100),
+            prof_sampling(false) { }
       public:
         int delay_start;
         mutable int legion_collective_radix;
@@ -1517,6 +1597,7 @@ namespace Legion {
         unsigned initial_tasks_to_schedule;
         unsigned initial_meta_task_vector_width;
         unsigned max_message_size;
+        unsigned message_aggregation_window;
         unsigned gc_epoch_size;
         unsigned max_local_fields;
         unsigned max_replay_parallelism;
@@ -1540,9 +1621,11 @@ namespace Legion {
         bool unsafe_mapper;
         bool dynamic_independence_tests;
         bool legion_spy_enabled;
+        const char *spy_logfile;
         bool enable_test_mapper;
         bool legion_ldb_enabled;
         const char* replay_file;
+        const char* trace_cache_directory;
         bool slow_config_ok;
 #ifdef DEBUG_LEGION
         bool logging_region_tree_state;
@@ -1557,6 +1640,7 @@ namespace Legion {
         const char *prof_logfile;
         size_t prof_footprint_threshold;
         size_t prof_target_latency;
+        bool prof_sampling;
       public:
         void configure_collective_settings(int total_spaces) const;
       };
@@ -1659,6 +1743,7 @@ namespace Legion {
       const unsigned initial_tasks_to_schedule;
       const unsigned initial_meta_task_vector_width;
       const unsigned max_message_size;
+      const unsigned message_aggregation_window;
       const unsigned gc_epoch_size;
       const unsigned max_local_fields;
       const unsigned max_replay_parallelism;
@@ -1685,6 +1770,8 @@ namespace Legion {
       const bool enable_test_mapper;
       const bool legion_ldb_enabled;
       const char*const replay_file;
+      const char*const trace_cache_directory;
+      const uint64_t trace_cache_build_id;
 #ifdef DEBUG_LEGION
       const bool logging_region_tree_state;
       const bool verbose_logging;
@@ -2177,6 +2264,8 @@ namespace Legion {
       TaskImpl* find_task_impl(TaskID task_id);
       VariantImpl* find_variant_impl(TaskID task_id, VariantID variant_id,
                                      bool can_fail = false);
+      // Identifies the registered variants for persistent traces
+      void pack_registered_variants(Serializer &rez);
     public:
       ReductionOpID generate_dynamic_reduction_id(void);
       ReductionOpID generate_library_reduction_ids(const char *name, 
@@ -2265,8 +2354,10 @@ namespace Legion {
       void send_slice_remote_complete(Processor target, Serializer &rez);
       void send_slice_remote_commit(Processor target, Serializer &rez);
       void send_did_remote_registration(AddressSpaceID target, Serializer &rez);
-      void send_did_remote_valid_update(AddressSpaceID target, Serializer &rez);
-      void send_did_remote_gc_update(AddressSpaceID target, Serializer &rez);
+      void send_did_remote_valid_update(AddressSpaceID target, Serializer &rez,
+                                        bool deferrable = false);
+      void send_did_remote_gc_update(AddressSpaceID target, Serializer &rez,
+                                     bool deferrable = false);
       void send_did_remote_resource_update(AddressSpaceID target,
                                            Serializer &rez);
       void send_did_remote_invalidate(AddressSpaceID target, Serializer &rez);
@@ -2049,11 +2049,12 @@ namespace Legion {
                          "This machine is really messed up!", target_proc.id);
         assert(false);
       }
-      // Figure out the memory with the highest-bandwidth
+      // Figure out the memory with the highest-bandwidth, using the
+      // lowest latency to break ties (e.g. between NUMA domains)
       Memory best_memory = Memory::NO_MEMORY;
-      unsigned best_bandwidth = 0;
+      unsigned best_bandwidth = 0, best_latency = 0;
       Memory best_rdma_memory = Memory::NO_MEMORY;
-      unsigned best_rdma_bandwidth = 0;
+      unsigned best_rdma_bandwidth = 0, best_rdma_latency = 0;
       std::vector<Machine::ProcessorMemoryAffinity> affinity(1);
       for (Machine::MemoryQuery::iterator it = visible_memories.begin();
             it != visible_memories.end(); it++)
@@ -2062,15 +2063,21 @@ namespace Legion {
         machine.get_proc_mem_affinity(affinity, target_proc, *it,
 				      false /*not just local affinities*/);
         assert(affinity.size() == 1);
-        if (!best_memory.exists() || (affinity[0].bandwidth > best_bandwidth)) {
+        if (!best_memory.exists() || (affinity[0].bandwidth > best_bandwidth) ||
+            ((affinity[0].bandwidth == best_bandwidth) &&
+             (affinity[0].latency < best_latency))) {
           best_memory = *it;
           best_bandwidth = affinity[0].bandwidth;
+          best_latency = affinity[0].latency;
         }
         if ((it->kind() == Memory::REGDMA_MEM) &&
 	    (!best_rdma_memory.exists() ||
-	     (affinity[0].bandwidth > best_rdma_bandwidth))) {
+	     (affinity[0].bandwidth > best_rdma_bandwidth) ||
+             ((affinity[0].bandwidth == best_rdma_bandwidth) &&
+              (affinity[0].latency < best_rdma_latency)))) {
           best_rdma_memory = *it;
           best_rdma_bandwidth = affinity[0].bandwidth;
+          best_rdma_latency = affinity[0].latency;
         }
       }
       assert(best_memory.exists());
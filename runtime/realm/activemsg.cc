@@ -76,6 +76,11 @@ static const void *ignore_gasnet_warning2 __attribute__((unused)) = (void *)_gas
 #include "realm/timers.h"
 #include "realm/logging.h"
 
+#ifndef USE_GASNET
+#include "realm/shm_transport.h"
+#include <sched.h>
+#endif
+
 #define NO_DEBUG_AMREQUESTS
 
 enum { MSGID_LONG_EXTENSION = 253,
@@ -2929,12 +2934,19 @@ extern void record_message(NodeID source, bool sent_reply)
 
 #else // defined USE_GASNET
 
+// without GASNet, messages can still be passed between processes on the
+//  same machine with the shared-memory transport (-ll:shm)
+
 void enqueue_message(NodeID target, int msgid,
 		     const void *args, size_t arg_size,
 		     const void *payload, size_t payload_size,
 		     int payload_mode, void *dstptr)
 {
-  assert(0 && "compiled without USE_GASNET - active messages not available!");
+  assert(Realm::SharedMemoryTransport::is_active() &&
+	 "compiled without USE_GASNET - active messages require -ll:shm");
+  Realm::SharedMemoryTransport::send(target, msgid, args, arg_size,
+				     payload, payload_size, payload_mode,
+				     dstptr);
 }
 
 void enqueue_message(NodeID target, int msgid,
@@ -2943,7 +2955,16 @@ void enqueue_message(NodeID target, int msgid,
 		     off_t line_stride, size_t line_count,
 		     int payload_mode, void *dstptr)
 {
-  assert(0 && "compiled without USE_GASNET - active messages not available!");
+  // gather the lines into a contiguous buffer that the transport can free
+  size_t payload_size = line_size * line_count;
+  void *buffer = malloc(payload_size);
+  assert(buffer != 0);
+  TwoDPayload(payload, line_size, line_count, line_stride,
+	      payload_mode).copy_data(buffer);
+  if(payload_mode == PAYLOAD_FREE)
+    free(const_cast<void *>(payload));
+  enqueue_message(target, msgid, args, arg_size,
+		  buffer, payload_size, PAYLOAD_FREE, dstptr);
 }
 
 void enqueue_message(NodeID target, int msgid,
@@ -2951,17 +2972,24 @@ void enqueue_message(NodeID target, int msgid,
 		     const SpanList& spans, size_t payload_size,
 		     int payload_mode, void *dstptr)
 {
-  assert(0 && "compiled without USE_GASNET - active messages not available!");
+  void *buffer = malloc(payload_size);
+  assert(buffer != 0);
+  SpanPayload(spans, payload_size, payload_mode).copy_data(buffer);
+  enqueue_message(target, msgid, args, arg_size,
+		  buffer, payload_size, PAYLOAD_FREE, dstptr);
 }
 
 void do_some_polling(void)
 {
-  assert(0 && "compiled without USE_GASNET - active messages not available!");
+  assert(Realm::SharedMemoryTransport::is_active() &&
+	 "compiled without USE_GASNET - active messages require -ll:shm");
+  if(!Realm::SharedMemoryTransport::poll())
+    sched_yield();
 }
 
 size_t get_lmb_size(NodeID target_node)
 {
-  return 0;
+  return Realm::SharedMemoryTransport::max_payload_size();
 }
 
 void record_message(NodeID source, bool sent_reply)
@@ -2999,19 +3027,24 @@ void init_endpoints(int gasnet_mem_size,
 		    Realm::CoreReservationSet& crs,
 		    std::vector<std::string>& cmdline)
 {
-  // nothing to do without GASNet
+  activemsg_handler_table.construct_handler_table();
+
+  Realm::SharedMemoryTransport::init(crs, cmdline);
 }
 
 void start_polling_threads(int)
 {
+  Realm::SharedMemoryTransport::start_polling_threads();
 }
 
-void start_handler_threads(int, Realm::CoreReservationSet&, size_t)
+void start_handler_threads(int count, Realm::CoreReservationSet&, size_t stack_size)
 {
+  Realm::SharedMemoryTransport::start_handler_threads(count, stack_size);
 }
 
 void stop_activemsg_threads(void)
 {
+  Realm::SharedMemoryTransport::stop_threads();
 }
 
 #endif
@@ -299,19 +299,29 @@ namespace Realm {
   template <int N, typename T, typename FT>
   void ByFieldOperation<N,T,FT>::execute(void)
   {
-    for(size_t i = 0; i < subspaces.size(); i++)
-      SparsityMapImpl<N,T>::lookup(subspaces[i])->set_contributor_count(field_data.size());
-
+    // large instances are split into chunks so that several workers can
+    //  scan them - each chunk contributes separately to every subspace
+    std::vector<std::vector<IndexSpace<N,T> > > chunks(field_data.size());
+    size_t total_chunks = 0;
     for(size_t i = 0; i < field_data.size(); i++) {
-      ByFieldMicroOp<N,T,FT> *uop = new ByFieldMicroOp<N,T,FT>(parent,
-							       field_data[i].index_space,
-							       field_data[i].inst,
-							       field_data[i].field_offset);
-      for(size_t j = 0; j < colors.size(); j++)
-	uop->add_sparsity_output(colors[j], subspaces[j]);
-      //uop.set_value_set(colors);
-      uop->dispatch(this, true /* ok to run in this thread */);
+      split_field_data_space(field_data[i].index_space, chunks[i]);
+      total_chunks += chunks[i].size();
     }
+
+    for(size_t i = 0; i < subspaces.size(); i++)
+      SparsityMapImpl<N,T>::lookup(subspaces[i])->set_contributor_count(total_chunks);
+
+    for(size_t i = 0; i < field_data.size(); i++)
+      for(size_t k = 0; k < chunks[i].size(); k++) {
+	ByFieldMicroOp<N,T,FT> *uop = new ByFieldMicroOp<N,T,FT>(parent,
+								 chunks[i][k],
+								 field_data[i].inst,
+								 field_data[i].field_offset);
+	for(size_t j = 0; j < colors.size(); j++)
+	  uop->add_sparsity_output(colors[j], subspaces[j]);
+	//uop.set_value_set(colors);
+	uop->dispatch(this, true /* ok to run in this thread */);
+      }
   }
 
   template <int N, typename T, typename FT>
@@ -167,6 +167,13 @@ namespace Realm {
     // for now, one access for the whole instance
     AffineAccessor<Point<N,T>,N2,T2> a_data(inst, field_offset);
 
+    // pointers are tested against the parent space in batches so that a
+    //  sparse parent is walked once per batch instead of once per point
+    static const size_t BATCH_SIZE = 256;
+    Point<N,T> ptrs[BATCH_SIZE];
+    bool in_parent[BATCH_SIZE];
+    BatchedContainmentTester<N,T> parent_tester(parent_space);
+
     // double iteration - use the instance's space first, since it's probably smaller
     for(IndexSpaceIterator<N2,T2> it(inst_space); it.valid; it.step()) {
       for(size_t i = 0; i < sources.size(); i++) {
@@ -174,17 +181,25 @@ namespace Realm {
 	  BM **bmpp = 0;
 
 	  // iterate over each point in the source and see if it points into the parent space	  
-	  for(PointInRectIterator<N2,T2> pir(it2.rect); pir.valid; pir.step()) {
-	    Point<N,T> ptr = a_data.read(pir.p);
+	  PointInRectIterator<N2,T2> pir(it2.rect);
+	  while(pir.valid) {
+	    size_t count = 0;
+	    while(pir.valid && (count < BATCH_SIZE)) {
+	      ptrs[count++] = a_data.read(pir.p);
+	      pir.step();
+	    }
+	    parent_tester.test(ptrs, count, in_parent);
 
-	    if(parent_space.contains(ptr)) {
+	    for(size_t j = 0; j < count; j++) {
+	      if(!in_parent[j]) continue;
+	      const Point<N,T>& ptr = ptrs[j];
               // optional filter
               if(!diff_rhss.empty())
                 if(diff_rhss[i].contains(ptr)) {
                   //std::cout << "point " << ptr << " filtered!\n";
                   continue;
                 }
-	      //std::cout << "image " << i << "(" << sources[i] << ") -> " << pir.p << " -> " << ptr << std::endl;
+	      //std::cout << "image " << i << "(" << sources[i] << ") -> " << ptr << std::endl;
 	      if(!bmpp) bmpp = &bitmasks[i];
 	      if(!*bmpp) *bmpp = new BM;
 	      (*bmpp)->add_point(ptr);
@@ -524,40 +539,62 @@ namespace Realm {
 
       uop->dispatch(this, true /* ok to run in this thread */);
     } else {
-      // launch full cross-product of image micro ops right away
-      for(size_t i = 0; i < sources.size(); i++)
-	SparsityMapImpl<N,T>::lookup(images[i])->set_contributor_count(ptr_data.size() +
-								       range_data.size());
-
+      // launch full cross-product of image micro ops right away, with large
+      //  instances split into chunks
+      std::vector<std::vector<IndexSpace<N2,T2> > > chunks(ptr_data.size() +
+							    range_data.size());
+      size_t total_chunks = 0;
       for(size_t i = 0; i < ptr_data.size(); i++) {
-	ImageMicroOp<N,T,N2,T2> *uop = new ImageMicroOp<N,T,N2,T2>(parent,
-								   ptr_data[i].index_space,
-								   ptr_data[i].inst,
-								   ptr_data[i].field_offset,
-								   false /*ptrs*/);
-	for(size_t j = 0; j < sources.size(); j++)
-          if(diff_rhss.empty())
-	    uop->add_sparsity_output(sources[j], images[j]);
-          else
-	    uop->add_sparsity_output_with_difference(sources[j], diff_rhss[j], images[j]);
-
-	uop->dispatch(this, true /* ok to run in this thread */);
+	split_field_data_space(ptr_data[i].index_space, chunks[i]);
+	total_chunks += chunks[i].size();
       }
-
       for(size_t i = 0; i < range_data.size(); i++) {
-	ImageMicroOp<N,T,N2,T2> *uop = new ImageMicroOp<N,T,N2,T2>(parent,
-								   range_data[i].index_space,
-								   range_data[i].inst,
-								   range_data[i].field_offset,
-								   true /*ranges*/);
-	for(size_t j = 0; j < sources.size(); j++)
-          if(diff_rhss.empty())
-	    uop->add_sparsity_output(sources[j], images[j]);
-          else
-	    uop->add_sparsity_output_with_difference(sources[j], diff_rhss[j], images[j]);
-
-	uop->dispatch(this, true /* ok to run in this thread */);
+	split_field_data_space(range_data[i].index_space, chunks[i + ptr_data.size()]);
+	total_chunks += chunks[i + ptr_data.size()].size();
+      }
+
+      for(size_t i = 0; i < sources.size(); i++)
+	SparsityMapImpl<N,T>::lookup(images[i])->set_contributor_count(total_chunks);
+
+      std::vector<int> all_sources(sources.size());
+      for(size_t j = 0; j < sources.size(); j++)
+	all_sources[j] = j;
+
+      for(size_t i = 0; i < ptr_data.size(); i++)
+	dispatch_micro_ops(chunks[i], ptr_data[i].inst, ptr_data[i].field_offset,
+			   false /*ptrs*/, all_sources.begin(), all_sources.end());
+
+      for(size_t i = 0; i < range_data.size(); i++)
+	dispatch_micro_ops(chunks[i + ptr_data.size()], range_data[i].inst,
+			   range_data[i].field_offset,
+			   true /*ranges*/, all_sources.begin(), all_sources.end());
+    }
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  template <typename IT>
+  void ImageOperation<N,T,N2,T2>::dispatch_micro_ops(const std::vector<IndexSpace<N2,T2> >& chunks,
+						     RegionInstance inst,
+						     size_t field_offset,
+						     bool is_ranged,
+						     IT first_source, IT last_source)
+  {
+    // one micro op per chunk of the field data, each contributing to every
+    //  image (the sparsity maps merge the contributions)
+    for(size_t i = 0; i < chunks.size(); i++) {
+      ImageMicroOp<N,T,N2,T2> *uop = new ImageMicroOp<N,T,N2,T2>(parent,
+								 chunks[i],
+								 inst,
+								 field_offset,
+								 is_ranged);
+      for(IT it = first_source; it != last_source; ++it) {
+	int j = *it;
+	if(diff_rhss.empty())
+	  uop->add_sparsity_output(sources[j], images[j]);
+	else
+	  uop->add_sparsity_output_with_difference(sources[j], diff_rhss[j], images[j]);
       }
+      uop->dispatch(this, true /* ok to run in this thread */);
     }
   }
 
@@ -570,6 +607,16 @@ namespace Realm {
     //  right away (and then delete it)
     std::vector<std::set<int> > overlaps_by_field_data(ptr_data.size() +
 						       range_data.size());
+
+    // large field data instances are handled as several chunks, each of
+    //  which contributes separately to every image it overlaps
+    std::vector<std::vector<IndexSpace<N2,T2> > > chunks(ptr_data.size() +
+							  range_data.size());
+    for(size_t i = 0; i < ptr_data.size(); i++)
+      split_field_data_space(ptr_data[i].index_space, chunks[i]);
+    for(size_t i = 0; i < range_data.size(); i++)
+      split_field_data_space(range_data[i].index_space, chunks[i + ptr_data.size()]);
+
     for(size_t i = 0; i < sources.size(); i++) {
       std::set<int> overlaps_by_source;
 
@@ -577,7 +624,12 @@ namespace Realm {
 
       log_part.info() << overlaps_by_source.size() << " overlaps for source " << i;
 
-      SparsityMapImpl<N,T>::lookup(images[i])->set_contributor_count(overlaps_by_source.size());
+      size_t contributors = 0;
+      for(std::set<int>::const_iterator it = overlaps_by_source.begin();
+	  it != overlaps_by_source.end();
+	  it++)
+	contributors += chunks[*it].size();
+      SparsityMapImpl<N,T>::lookup(images[i])->set_contributor_count(contributors);
 
       // now scatter these values into the overlaps_by_field_data
       for(std::set<int>::const_iterator it = overlaps_by_source.begin();
@@ -589,46 +641,19 @@ namespace Realm {
 
     for(size_t i = 0; i < ptr_data.size(); i++) {
       const std::set<int>& overlaps = overlaps_by_field_data[i];
-      size_t n = overlaps.size();
-      if(n == 0) continue;
+      if(overlaps.empty()) continue;
 
-      ImageMicroOp<N,T,N2,T2> *uop = new ImageMicroOp<N,T,N2,T2>(parent,
-								 ptr_data[i].index_space,
-								 ptr_data[i].inst,
-								 ptr_data[i].field_offset,
-								 false /*ptrs*/);
-      for(std::set<int>::const_iterator it = overlaps.begin();
-	  it != overlaps.end();
-	  it++) {
-	int j = *it;
-        if(diff_rhss.empty())
-	  uop->add_sparsity_output(sources[j], images[j]);
-        else
-	  uop->add_sparsity_output_with_difference(sources[j], diff_rhss[j], images[j]);
-      }
-      uop->dispatch(this, true /* ok to run in this thread */);
+      dispatch_micro_ops(chunks[i], ptr_data[i].inst, ptr_data[i].field_offset,
+			 false /*ptrs*/, overlaps.begin(), overlaps.end());
     }
 
     for(size_t i = 0; i < range_data.size(); i++) {
       const std::set<int>& overlaps = overlaps_by_field_data[i + ptr_data.size()];
-      size_t n = overlaps.size();
-      if(n == 0) continue;
+      if(overlaps.empty()) continue;
 
-      ImageMicroOp<N,T,N2,T2> *uop = new ImageMicroOp<N,T,N2,T2>(parent,
-								 range_data[i].index_space,
-								 range_data[i].inst,
-								 range_data[i].field_offset,
-								 true /*ranges*/);
-      for(std::set<int>::const_iterator it = overlaps.begin();
-	  it != overlaps.end();
-	  it++) {
-	int j = *it;
-        if(diff_rhss.empty())
-	  uop->add_sparsity_output(sources[j], images[j]);
-        else
-	  uop->add_sparsity_output_with_difference(sources[j], diff_rhss[j], images[j]);
-      }
-      uop->dispatch(this, true /* ok to run in this thread */);
+      dispatch_micro_ops(chunks[i + ptr_data.size()], range_data[i].inst,
+			 range_data[i].field_offset,
+			 true /*ranges*/, overlaps.begin(), overlaps.end());
     }
   }
 
@@ -106,6 +106,13 @@ namespace Realm {
     virtual void set_overlap_tester(void *tester);
 
   protected:
+    // creates a micro op for each chunk of a field data instance that
+    //  contributes to the images of the given sources
+    template <typename IT>
+    void dispatch_micro_ops(const std::vector<IndexSpace<N2,T2> >& chunks,
+			    RegionInstance inst, size_t field_offset,
+			    bool is_ranged, IT first_source, IT last_source);
+
     IndexSpace<N,T> parent;
     std::vector<FieldDataDescriptor<IndexSpace<N2,T2>,Point<N,T> > > ptr_data;
     std::vector<FieldDataDescriptor<IndexSpace<N2,T2>,Rect<N,T> > > range_data;
@@ -48,6 +48,12 @@ namespace Realm {
     int cfg_max_rects_in_approximation = 32;
     size_t cfg_max_bytes_per_packet = 2048;//32768;
     bool cfg_worker_threads_sleep = true;
+    // sparsity maps with at least this many entries are stored as a bitmap
+    //  if that's both smaller and no slower to iterate (0 disables)
+    int cfg_bitmap_min_entries = 64;
+    // field data instances with at least twice this many points are split
+    //  into chunks handled by separate workers (0 disables)
+    size_t cfg_min_chunk_volume = 65536;
   };
 
   // TODO: C++11 has type_traits and std::make_unsigned
@@ -117,7 +123,9 @@ namespace Realm {
 	it != entries.end();
 	it++) {
       for(int i = 0; i < N; i++)
-	lo_volume[i] += it->bounds.intersection(lo_half[i]).volume();
+	lo_volume[i] += (it->bitmap ?
+			   it->bitmap->count(lo_half[i]) :
+			   it->bounds.intersection(lo_half[i]).volume());
     }
     // now compute how many subspaces would fall in each half and the 
     //  inefficiency of the split
@@ -784,6 +792,8 @@ namespace Realm {
     cp.add_option_int("-dp:workers", DeppartConfig::cfg_num_partitioning_workers);
     cp.add_option_bool("-dp:noisectopt", DeppartConfig::cfg_disable_intersection_optimization);
     cp.add_option_int("-dp:sleep", DeppartConfig::cfg_worker_threads_sleep);
+    cp.add_option_int("-dp:bitmap", DeppartConfig::cfg_bitmap_min_entries);
+    cp.add_option_int("-dp:chunk", DeppartConfig::cfg_min_chunk_volume);
 
     cp.parse_command_line(cmdline);
   }
@@ -77,6 +77,31 @@ namespace Realm {
   };
 
 
+  // tests batches of points for containment in an index space - for a sparse
+  //  space the points are sorted so that each sparsity map entry is visited
+  //  once per batch rather than once per point
+  template <int N, typename T>
+  class BatchedContainmentTester {
+  public:
+    BatchedContainmentTester(const IndexSpace<N,T>& _space);
+
+    // sets results[i] to whether points[i] is in the space
+    void test(const Point<N,T> *points, size_t count, bool *results);
+
+  protected:
+    IndexSpace<N,T> space;
+    std::vector<size_t> order;  // scratch space, reused across batches
+  };
+
+  // splits the index space of a field data instance into pieces that can be
+  //  handled by separate micro-ops (and therefore separate partitioning
+  //  workers) - returns just the original space if it's too small to be worth
+  //  splitting or there's only one worker
+  template <int N, typename T>
+  void split_field_data_space(const IndexSpace<N,T>& space,
+			      std::vector<IndexSpace<N,T> >& pieces);
+
+
   /////////////////////////////////////////////////////////////////////////
 
   class AsyncMicroOp : public Operation::AsyncWorkItem {
@@ -19,10 +19,133 @@
 
 // this is a nop, but it's for the benefit of IDEs trying to parse this file
 #include "realm/deppart/partitions.h"
+#include "realm/deppart/deppart_config.h"
+
+#include <algorithm>
 
 
 namespace Realm {
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class BatchedContainmentTester<N,T>
+  //
+
+  namespace {
+    // orders point indices by the first coordinate of the points
+    template <int N, typename T>
+    struct PointIndexByX {
+      PointIndexByX(const Point<N,T> *_points) : points(_points) {}
+      bool operator()(size_t a, size_t b) const
+      { return points[a][0] < points[b][0]; }
+      const Point<N,T> *points;
+    };
+
+    // compares a point index against an x coordinate for lower_bound
+    template <int N, typename T>
+    struct PointIndexBelowX {
+      PointIndexBelowX(const Point<N,T> *_points) : points(_points) {}
+      bool operator()(size_t a, T x) const
+      { return points[a][0] < x; }
+      const Point<N,T> *points;
+    };
+  };
+
+  template <int N, typename T>
+  inline BatchedContainmentTester<N,T>::BatchedContainmentTester(const IndexSpace<N,T>& _space)
+    : space(_space)
+  {}
+
+  template <int N, typename T>
+  inline void BatchedContainmentTester<N,T>::test(const Point<N,T> *points,
+						  size_t count, bool *results)
+  {
+    if(space.dense()) {
+      for(size_t i = 0; i < count; i++)
+	results[i] = space.bounds.contains(points[i]);
+      return;
+    }
+
+    const std::vector<SparsityMapEntry<N,T> >& entries = space.sparsity.impl()->get_entries();
+
+    // a 1-D space already does a binary search per point, which wins when
+    //  there are more entries than points
+    if((N == 1) && (entries.size() >= count)) {
+      for(size_t i = 0; i < count; i++)
+	results[i] = space.contains(points[i]);
+      return;
+    }
+
+    order.clear();
+    for(size_t i = 0; i < count; i++) {
+      results[i] = false;
+      if(space.bounds.contains(points[i]))
+	order.push_back(i);
+    }
+    if(order.empty())
+      return;
+    std::sort(order.begin(), order.end(), PointIndexByX<N,T>(points));
+
+    // each entry only needs to look at the points that fall in its x range
+    for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = entries.begin();
+	it != entries.end();
+	++it) {
+      std::vector<size_t>::const_iterator it2 = std::lower_bound(order.begin(),
+								 order.end(),
+								 it->bounds.lo[0],
+								 PointIndexBelowX<N,T>(points));
+      for(; (it2 != order.end()) && (points[*it2][0] <= it->bounds.hi[0]); ++it2) {
+	size_t idx = *it2;
+	if(results[idx] || !it->bounds.contains(points[idx])) continue;
+	if(it->sparsity.exists()) {
+	  assert(0);
+	} else if(it->bitmap != 0) {
+	  results[idx] = it->bitmap->contains(points[idx]);
+	} else
+	  results[idx] = true;
+      }
+    }
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // split_field_data_space
+  //
+
+  template <int N, typename T>
+  inline void split_field_data_space(const IndexSpace<N,T>& space,
+				     std::vector<IndexSpace<N,T> >& pieces)
+  {
+    size_t num_pieces = 1;
+    if((DeppartConfig::cfg_num_partitioning_workers > 1) &&
+       (DeppartConfig::cfg_min_chunk_volume > 0) &&
+       !space.bounds.empty())
+      num_pieces = std::min(size_t(DeppartConfig::cfg_num_partitioning_workers),
+			    space.bounds.volume() / DeppartConfig::cfg_min_chunk_volume);
+    if(num_pieces <= 1) {
+      pieces.push_back(space);
+      return;
+    }
+
+    // cut along the longest dimension - the pieces share the original
+    //  sparsity map and just have narrower bounds
+    int dim = 0;
+    for(int i = 1; i < N; i++)
+      if((space.bounds.hi[i] - space.bounds.lo[i]) >
+	 (space.bounds.hi[dim] - space.bounds.lo[dim]))
+	dim = i;
+    size_t extent = size_t(space.bounds.hi[dim] - space.bounds.lo[dim]) + 1;
+    num_pieces = std::min(num_pieces, extent);
+    for(size_t i = 0; i < num_pieces; i++) {
+      Rect<N,T> r = space.bounds;
+      r.lo[dim] = space.bounds.lo[dim] + T((extent * i) / num_pieces);
+      r.hi[dim] = space.bounds.lo[dim] + T((extent * (i + 1)) / num_pieces) - 1;
+      pieces.push_back(IndexSpace<N,T>(r, space.sparsity));
+    }
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class PartitioningMicroOp
@@ -120,20 +120,42 @@ namespace Realm {
     // for now, one access for the whole instance
     AffineAccessor<Point<N2,T2>,N,T> a_data(inst, field_offset);
 
+    // pointers are tested against each target in batches so that a sparse
+    //  target is walked once per batch instead of once per point
+    static const size_t BATCH_SIZE = 256;
+    Point<N,T> srcs[BATCH_SIZE];
+    Point<N2,T2> ptrs[BATCH_SIZE];
+    bool in_target[BATCH_SIZE];
+    std::vector<BatchedContainmentTester<N2,T2> > testers;
+    testers.reserve(targets.size());
+    for(size_t i = 0; i < targets.size(); i++)
+      testers.push_back(BatchedContainmentTester<N2,T2>(targets[i]));
+
     // double iteration - use the instance's space first, since it's probably smaller
     for(IndexSpaceIterator<N,T> it(inst_space); it.valid; it.step()) {
       for(IndexSpaceIterator<N,T> it2(parent_space, it.rect); it2.valid; it2.step()) {
 	// now iterate over each point
-	for(PointInRectIterator<N,T> pir(it2.rect); pir.valid; pir.step()) {
-	  // fetch the pointer and test it against every possible target (ugh)
-	  Point<N2,T2> ptr = a_data.read(pir.p);
+	PointInRectIterator<N,T> pir(it2.rect);
+	while(pir.valid) {
+	  // fetch a batch of pointers and test them against every possible
+	  //  target (ugh)
+	  size_t count = 0;
+	  while(pir.valid && (count < BATCH_SIZE)) {
+	    srcs[count] = pir.p;
+	    ptrs[count++] = a_data.read(pir.p);
+	    pir.step();
+	  }
 
-	  for(size_t i = 0; i < targets.size(); i++)
-	    if(targets[i].contains(ptr)) {
-	      BM *&bmp = bitmasks[i];
-	      if(!bmp) bmp = new BM;
-	      bmp->add_point(pir.p);
-	    }
+	  for(size_t i = 0; i < targets.size(); i++) {
+	    testers[i].test(ptrs, count, in_target);
+	    BM **bmpp = 0;
+	    for(size_t j = 0; j < count; j++)
+	      if(in_target[j]) {
+		if(!bmpp) bmpp = &bitmasks[i];
+		if(!*bmpp) *bmpp = new BM;
+		(*bmpp)->add_point(srcs[j]);
+	      }
+	  }
 	}
       }
     }
@@ -388,31 +410,71 @@ namespace Realm {
 
       uop->dispatch(this, true /* ok to run in this thread */);
     } else {
-      for(size_t i = 0; i < preimages.size(); i++)
-	SparsityMapImpl<N,T>::lookup(preimages[i])->set_contributor_count(ptr_data.size() +
-									  range_data.size());
-
+      // every chunk of every instance contributes to every preimage
+      size_t total_chunks = 0;
       for(size_t i = 0; i < ptr_data.size(); i++) {
-	PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									 ptr_data[i].index_space,
-									 ptr_data[i].inst,
-									 ptr_data[i].field_offset,
-									 false /*ptrs*/);
-	for(size_t j = 0; j < targets.size(); j++)
-	  uop->add_sparsity_output(targets[j], preimages[j]);
-	uop->dispatch(this, true /* ok to run in this thread */);
+	std::vector<IndexSpace<N,T> > chunks;
+	split_field_data_space(ptr_data[i].index_space, chunks);
+	total_chunks += chunks.size();
       }
-
       for(size_t i = 0; i < range_data.size(); i++) {
-	PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									 range_data[i].index_space,
-									 range_data[i].inst,
-									 range_data[i].field_offset,
-									 true /*ranges*/);
-	for(size_t j = 0; j < targets.size(); j++)
-	  uop->add_sparsity_output(targets[j], preimages[j]);
-	uop->dispatch(this, true /* ok to run in this thread */);
+	std::vector<IndexSpace<N,T> > chunks;
+	split_field_data_space(range_data[i].index_space, chunks);
+	total_chunks += chunks.size();
       }
+      contrib_counts.resize(preimages.size(), 0);
+
+      for(size_t i = 0; i < preimages.size(); i++)
+	SparsityMapImpl<N,T>::lookup(preimages[i])->set_contributor_count(total_chunks);
+
+      std::set<int> all_targets;
+      for(size_t j = 0; j < targets.size(); j++)
+	all_targets.insert(j);
+
+      for(size_t i = 0; i < ptr_data.size() + range_data.size(); i++)
+	dispatch_micro_ops(i, all_targets, true /* ok to run in this thread */);
+    }
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void PreimageOperation<N,T,N2,T2>::dispatch_micro_ops(size_t index,
+							const std::set<int>& overlaps,
+							bool inline_ok)
+  {
+    bool is_ranged = (index >= ptr_data.size());
+    IndexSpace<N,T> inst_space;
+    RegionInstance inst;
+    size_t field_offset;
+    if(!is_ranged) {
+      inst_space = ptr_data[index].index_space;
+      inst = ptr_data[index].inst;
+      field_offset = ptr_data[index].field_offset;
+    } else {
+      size_t rel_index = index - ptr_data.size();
+      assert(rel_index < range_data.size());
+      inst_space = range_data[rel_index].index_space;
+      inst = range_data[rel_index].inst;
+      field_offset = range_data[rel_index].field_offset;
+    }
+
+    // large instances are split into chunks, each of which contributes
+    //  separately to the preimages of the overlapping targets
+    std::vector<IndexSpace<N,T> > chunks;
+    split_field_data_space(inst_space, chunks);
+    for(size_t i = 0; i < chunks.size(); i++) {
+      PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
+								       chunks[i],
+								       inst,
+								       field_offset,
+								       is_ranged);
+      for(std::set<int>::const_iterator it = overlaps.begin();
+	  it != overlaps.end();
+	  it++) {
+	int j = *it;
+	__sync_fetch_and_add(&contrib_counts[j], 1);
+	uop->add_sparsity_output(targets[j], preimages[j]);
+      }
+      uop->dispatch(this, inline_ok);
     }
   }
 
@@ -435,39 +497,11 @@ namespace Realm {
       // see which of the targets this image overlaps
       std::set<int> overlaps;
       overlap_tester->test_overlap(rects, count, overlaps);
-      if((size_t)index < ptr_data.size()) {
+      if((size_t)index < ptr_data.size())
 	log_part.info() << "image of ptr_data[" << index << "] overlaps " << overlaps.size() << " targets";
-	PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									 ptr_data[index].index_space,
-									 ptr_data[index].inst,
-									 ptr_data[index].field_offset,
-									 false /*ptrs*/);
-	for(std::set<int>::const_iterator it2 = overlaps.begin();
-	    it2 != overlaps.end();
-	    it2++) {
-	  int j = *it2;
-	  __sync_fetch_and_add(&contrib_counts[j], 1);
-	  uop->add_sparsity_output(targets[j], preimages[j]);
-	}
-	uop->dispatch(this, false /* do not run in this thread */);
-      } else {
-	size_t rel_index = index - ptr_data.size();
-	assert(rel_index < range_data.size());
-	log_part.info() << "image of range_data[" << rel_index << "] overlaps " << overlaps.size() << " targets";
-	PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									 range_data[rel_index].index_space,
-									 range_data[rel_index].inst,
-									 range_data[rel_index].field_offset,
-									 true /*ranges*/);
-	for(std::set<int>::const_iterator it2 = overlaps.begin();
-	    it2 != overlaps.end();
-	    it2++) {
-	  int j = *it2;
-	  __sync_fetch_and_add(&contrib_counts[j], 1);
-	  uop->add_sparsity_output(targets[j], preimages[j]);
-	}
-	uop->dispatch(this, false /* do not run in this thread */);
-      }
+      else
+	log_part.info() << "image of range_data[" << (index - ptr_data.size()) << "] overlaps " << overlaps.size() << " targets";
+      dispatch_micro_ops(index, overlaps, false /* do not run in this thread */);
 
       // if these were the last sparse images, we can now set the contributor counts
       int v = __sync_sub_and_fetch(&remaining_sparse_images, 1);
@@ -503,39 +537,11 @@ namespace Realm {
 	// see which of the targets that image overlaps
 	std::set<int> overlaps;
 	overlap_tester->test_overlap(&it->second[0], it->second.size(), overlaps);
-	if(idx < ptr_data.size()) {
+	if(idx < ptr_data.size())
 	  log_part.info() << "image of ptr_data[" << idx << "] overlaps " << overlaps.size() << " targets";
-	  PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									   ptr_data[idx].index_space,
-									   ptr_data[idx].inst,
-									   ptr_data[idx].field_offset,
-									   false /*ptrs*/);
-	  for(std::set<int>::const_iterator it2 = overlaps.begin();
-	      it2 != overlaps.end();
-	      it2++) {
-	    int j = *it2;
-	    __sync_fetch_and_add(&contrib_counts[j], 1);
-	    uop->add_sparsity_output(targets[j], preimages[j]);
-	  }
-	  uop->dispatch(this, true /* ok to run in this thread */);
-	} else {
-	  size_t rel_index = idx - ptr_data.size();
-	  assert(rel_index < range_data.size());
-	  log_part.info() << "image of range_data[" << rel_index << "] overlaps " << overlaps.size() << " targets";
-	  PreimageMicroOp<N,T,N2,T2> *uop = new PreimageMicroOp<N,T,N2,T2>(parent,
-									   range_data[rel_index].index_space,
-									   range_data[rel_index].inst,
-									   range_data[rel_index].field_offset,
-									   true /*ranges*/);
-	  for(std::set<int>::const_iterator it2 = overlaps.begin();
-	      it2 != overlaps.end();
-	      it2++) {
-	    int j = *it2;
-	    __sync_fetch_and_add(&contrib_counts[j], 1);
-	    uop->add_sparsity_output(targets[j], preimages[j]);
-	  }
-	  uop->dispatch(this, true /* ok to run in this thread */);
-	}
+	else
+	  log_part.info() << "image of range_data[" << (idx - ptr_data.size()) << "] overlaps " << overlaps.size() << " targets";
+	dispatch_micro_ops(idx, overlaps, true /* ok to run in this thread */);
       }
 
       // if these were the last sparse images, we can now set the contributor counts
@@ -101,6 +101,11 @@ namespace Realm {
 
   protected:
     static ActiveMessageHandlerReg<ApproxImageResponseMessage<PreimageOperation<N,T,N2,T2> > > areg;
+
+    // creates a micro op for each chunk of the 'index'th field data instance
+    //  that contributes to the preimages of the overlapping targets
+    void dispatch_micro_ops(size_t index, const std::set<int>& overlaps,
+			    bool inline_ok);
     
     IndexSpace<N,T> parent;
     std::vector<FieldDataDescriptor<IndexSpace<N,T>,Point<N2,T2> > > ptr_data;
@@ -999,8 +999,13 @@ namespace Realm {
 	  if(isect.empty())
 	    continue;
 	  assert(!it2->sparsity.exists());
-	  assert(it2->bitmap == 0);
-	  bitmask.add_rect(isect);
+	  if(it2->bitmap != 0) {
+	    size_t pos = it2->bitmap->index_of(isect.lo);
+	    Rect<N,T> run;
+	    while(it2->bitmap->next_run(isect, pos, run))
+	      bitmask.add_rect(run);
+	  } else
+	    bitmask.add_rect(isect);
 	}
       }
     }
@@ -1362,8 +1367,13 @@ namespace Realm {
 	if(isect.empty())
 	  continue;
 	assert(!it->sparsity.exists());
-	assert(it->bitmap == 0);
-	todo.push_back(isect);
+	if(it->bitmap != 0) {
+	  size_t pos = it->bitmap->index_of(isect.lo);
+	  Rect<N,T> run;
+	  while(it->bitmap->next_run(isect, pos, run))
+	    todo.push_back(run);
+	} else
+	  todo.push_back(isect);
       }
     }
 
@@ -33,6 +33,11 @@ namespace Realm {
     // module-level globals
 
     FragmentAssembler fragment_assembler;
+
+    // producing one run from a bitmap costs about this many times as much as
+    //  producing one rect from a rect list (3-4x in the coloring test in
+    //  test/realm/deppart.cc)
+    const size_t BITMAP_RUN_COST = 3;
   };
 
   ////////////////////////////////////////////////////////////////////////
@@ -203,9 +208,24 @@ namespace Realm {
 	    it2++) {
 	  if(!it2->bounds.overlaps(isect)) continue;
 	  // TODO: handle further sparsity in either side
-	  assert(!it1->sparsity.exists() && (it1->bitmap == 0) &&
-		 !it2->sparsity.exists() && (it2->bitmap == 0));
-	  return true;
+	  assert(!it1->sparsity.exists() && !it2->sparsity.exists());
+	  Rect<N,T> isect2 = it2->bounds.intersection(isect);
+	  if(it1->bitmap != 0) {
+	    if(it2->bitmap != 0) {
+	      // walk the runs of one bitmap and probe the other
+	      size_t pos = it1->bitmap->index_of(isect2.lo);
+	      Rect<N,T> run;
+	      while(it1->bitmap->next_run(isect2, pos, run))
+		if(it2->bitmap->contains_any(run))
+		  return true;
+	    } else {
+	      if(it1->bitmap->contains_any(isect2))
+		return true;
+	    }
+	  } else {
+	    if((it2->bitmap == 0) || it2->bitmap->contains_any(isect2))
+	      return true;
+	  }
 	}
       }
     }
@@ -226,6 +246,15 @@ namespace Realm {
     , sizeof_precise(0)
   {}
 
+  template <int N, typename T>
+  SparsityMapImpl<N,T>::~SparsityMapImpl(void)
+  {
+    for(typename std::vector<SparsityMapEntry<N,T> >::iterator it = this->entries.begin();
+	it != this->entries.end();
+	it++)
+      delete it->bitmap;
+  }
+
   template <int N, typename T>
   inline /*static*/ SparsityMapImpl<N,T> *SparsityMapImpl<N,T>::lookup(SparsityMap<N,T> sparsity)
   {
@@ -546,6 +575,40 @@ namespace Realm {
     }
   }
 
+  template <int N, typename T>
+  void SparsityMapImpl<N,T>::contribute_bitmap_words(const Rect<N,T>& bounds,
+						     size_t first_word,
+						     const unsigned long long *data,
+						     size_t count, bool last)
+  {
+    // only the owner sends bitmaps, in reply to our request for the data
+    assert(NodeID(ID(me).sparsity_creator_node()) != my_node_id);
+
+    {
+      AutoHSLLock al(mutex);
+
+      if(this->entries.empty()) {
+	this->entries.resize(1);
+	this->entries[0].bounds = bounds;
+	this->entries[0].sparsity.id = 0;
+	this->entries[0].bitmap = new HierarchicalBitMap<N,T>(bounds);
+      }
+      assert((this->entries.size() == 1) && (this->entries[0].bitmap != 0));
+
+      if(count > 0) {
+	// message payloads need not be aligned for 64-bit loads
+	std::vector<unsigned long long> words(count);
+	memcpy(&words[0], data, count * sizeof(unsigned long long));
+	this->entries[0].bitmap->set_words(first_word, &words[0], count);
+      }
+    }
+
+    if(last) {
+      assert(precise_requested);
+      finalize();
+    }
+  }
+
   // adds a microop as a waiter for valid sparsity map data - returns true
   //  if the uop is added to the list (i.e. will be getting a callback at some point),
   //  or false if the sparsity map became valid before this call (i.e. no callback)
@@ -648,16 +711,54 @@ namespace Realm {
       int seq_id = fragment_assembler.get_sequence_id();
       int seq_count = 0;
 
-      // scan the entry list, sending bitmaps first and making a list of rects
+      // a bitmap is only ever the single entry of a map, and it's sent as
+      //  is - it's smaller than the rects it replaced, and usually much
+      //  smaller than its runs
+      if((this->entries.size() == 1) && (this->entries[0].bitmap != 0)) {
+	const SparsityMapEntry<N,T>& e = this->entries[0];
+	const unsigned long long *wdata = e.bitmap->get_words();
+	size_t first = 0;
+	size_t remaining = e.bitmap->num_words();
+	const size_t max_to_send = std::max(size_t(1),
+					    (DeppartConfig::cfg_max_bytes_per_packet /
+					     sizeof(unsigned long long)));
+	// send partial messages first
+	while(remaining > max_to_send) {
+	  size_t bytes = max_to_send * sizeof(unsigned long long);
+	  ActiveMessage<RemoteSparsityBitmap> amsg(requestor, bytes);
+	  amsg->sparsity = me;
+	  amsg->bounds = e.bounds;
+	  amsg->first_word = first;
+	  amsg->sequence_id = seq_id;
+	  amsg->sequence_count = 0;
+	  amsg.add_payload(wdata + first, bytes, PAYLOAD_COPY);
+	  amsg.commit();
+
+	  seq_count++;
+	  remaining -= max_to_send;
+	  first += max_to_send;
+	}
+
+	// final message includes the count of all messages (including this one!)
+	size_t bytes = remaining * sizeof(unsigned long long);
+	ActiveMessage<RemoteSparsityBitmap> amsg(requestor, bytes);
+	amsg->sparsity = me;
+	amsg->bounds = e.bounds;
+	amsg->first_word = first;
+	amsg->sequence_id = seq_id;
+	amsg->sequence_count = seq_count + 1;
+	amsg.add_payload(wdata + first, bytes, PAYLOAD_COPY);
+	amsg.commit();
+	return;
+      }
+
+      // otherwise make a list of rects
       std::vector<Rect<N,T> > rects;
       for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = this->entries.begin();
 	  it != this->entries.end();
 	  it++) {
-	if(it->bitmap) {
-	  // TODO: send bitmap
-	  assert(0);
-	}
-	else if(it->sparsity.exists()) {
+	assert(it->bitmap == 0);
+	if(it->sparsity.exists()) {
 	  // TODO: ?
 	  assert(0);
 	} else {
@@ -775,6 +876,64 @@ namespace Realm {
     // std::cout << " ]]]\n";
   }
 
+  template <int N, typename T>
+  void SparsityMapImpl<N,T>::convert_to_bitmap(void)
+  {
+    // a finalized 1-D list is sorted with no adjacent entries, so each entry
+    //  is already a maximal run and a bitmap could only iterate more slowly
+    if(N == 1)
+      return;
+
+    Rect<N,T> bbox = this->entries[0].bounds;
+    for(size_t i = 1; i < this->entries.size(); i++)
+      bbox = bbox.union_bbox(this->entries[i].bounds);
+
+    // compare sizes in floating point - a sparse bounding box's volume may
+    //  not even fit in a size_t
+    double bitmap_bytes = 1.0 / 8;
+    for(int i = 0; i < N; i++)
+      bitmap_bytes *= double(bbox.hi[i] - bbox.lo[i]) + 1;
+    size_t list_bytes = this->entries.size() * sizeof(SparsityMapEntry<N,T>);
+    if(bitmap_bytes >= list_bytes)
+      return;
+
+    HierarchicalBitMap<N,T> *bitmap = new HierarchicalBitMap<N,T>(bbox);
+    for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = this->entries.begin();
+	it != this->entries.end();
+	it++) {
+      assert(!it->sparsity.exists() && (it->bitmap == 0));
+      bitmap->set_rect(it->bounds);
+    }
+
+    // a full scan of the bitmap reads each summary word and then pays
+    //  BITMAP_RUN_COST per run, while the list costs one per entry - the
+    //  bitmap only wins if enough entries are pieces of longer dimension-0
+    //  runs (stop counting runs as soon as it's lost)
+    size_t list_cost = this->entries.size();
+    size_t bitmap_cost = (bitmap->num_words() + 63) >> 6;
+    {
+      size_t pos = 0;
+      Rect<N,T> run;
+      while((bitmap_cost <= list_cost) && bitmap->next_run(bbox, pos, run))
+	bitmap_cost += BITMAP_RUN_COST;
+    }
+    if(bitmap_cost > list_cost) {
+      log_part.info() << "bitmap rejected: " << me << " entries=" << this->entries.size()
+		      << " bounds=" << bbox << " (too many runs)";
+      delete bitmap;
+      return;
+    }
+
+    log_part.info() << "bitmap conversion: " << me << " entries=" << this->entries.size()
+		    << " bounds=" << bbox << " bytes=" << list_bytes
+		    << "->" << bitmap->bytes_used();
+
+    this->entries.resize(1);
+    this->entries[0].bounds = bbox;
+    this->entries[0].sparsity.id = 0;
+    this->entries[0].bitmap = bitmap;
+  }
+
   template <int N, typename T>
   void SparsityMapImpl<N,T>::finalize(void)
   {
@@ -805,6 +964,13 @@ namespace Realm {
       this->approx_valid = true;
     }
 
+    // heavily fragmented maps may be cheaper to store and to iterate as a
+    //  bitmap over their bounding box (maps received as a bitmap already are)
+    if((DeppartConfig::cfg_bitmap_min_entries > 0) &&
+       (this->entries.size() >= size_t(DeppartConfig::cfg_bitmap_min_entries)) &&
+       (this->entries[0].bitmap == 0))
+      convert_to_bitmap();
+
 #ifdef DEBUG_PARTITIONING
     std::cout << "finalizing " << this << ", " << this->entries.size() << " entries" << std::endl;
     for(size_t i = 0; i < this->entries.size(); i++)
@@ -878,6 +1044,8 @@ namespace Realm {
   template <int N, typename T>
   /*static*/ ActiveMessageHandlerReg<typename SparsityMapImpl<N,T>::RemoteSparsityContrib> SparsityMapImpl<N,T>::remote_sparsity_contrib_reg;
   template <int N, typename T>
+  /*static*/ ActiveMessageHandlerReg<typename SparsityMapImpl<N,T>::RemoteSparsityBitmap> SparsityMapImpl<N,T>::remote_sparsity_bitmap_reg;
+  template <int N, typename T>
   /*static*/ ActiveMessageHandlerReg<typename SparsityMapImpl<N,T>::SetContribCountMessage> SparsityMapImpl<N,T>::set_contrib_count_msg_reg;
 
 
@@ -969,6 +1137,29 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SparsityMapImpl<N,T>::RemoteSparsityBitmap
+
+  template <int N, typename T>
+  inline /*static*/ void SparsityMapImpl<N,T>::RemoteSparsityBitmap::handle_message(NodeID sender,
+										    const SparsityMapImpl<N,T>::RemoteSparsityBitmap &msg,
+										    const void *data, size_t datalen)
+  {
+    log_part.info() << "received remote bitmap: sparsity=" << msg.sparsity << " first=" << msg.first_word << " len=" << datalen;
+    size_t count = datalen / sizeof(unsigned long long);
+    assert((datalen % sizeof(unsigned long long)) == 0);
+    bool last_fragment = fragment_assembler.add_fragment(sender,
+							 msg.sequence_id,
+							 msg.sequence_count);
+    SparsityMapImpl<N,T>::lookup(msg.sparsity)->contribute_bitmap_words(msg.bounds,
+									msg.first_word,
+									(const unsigned long long *)data,
+									count,
+									last_fragment);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class SparsityMapImpl<N,T>::SetContribCountMessage
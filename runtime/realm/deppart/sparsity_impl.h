@@ -33,6 +33,7 @@ namespace Realm {
   class SparsityMapImpl : public SparsityMapPublicImpl<N,T> {
   public:
     SparsityMapImpl(SparsityMap<N,T> _me);
+    ~SparsityMapImpl(void);
 
     // actual implementation - SparsityMapPublicImpl's version just calls this one
     Event make_valid(bool precise = true);
@@ -80,6 +81,18 @@ namespace Realm {
 				 const void *data, size_t datalen);
     };
 
+    // a piece of the words of a bitmap entry - sent in place of its runs
+    struct RemoteSparsityBitmap {
+      SparsityMap<N,T> sparsity;
+      Rect<N,T> bounds;
+      size_t first_word;
+      size_t sequence_id, sequence_count;
+
+      static void handle_message(NodeID sender,
+				 const RemoteSparsityBitmap &msg,
+				 const void *data, size_t datalen);
+    };
+
     struct SetContribCountMessage {
       SparsityMap<N,T> sparsity;
       size_t count;
@@ -92,8 +105,18 @@ namespace Realm {
   protected:
     void finalize(void);
 
+    // replaces a fragmented entry list with a single bitmap entry if the
+    //  bitmap needs less storage and is not expected to be slower to iterate
+    void convert_to_bitmap(void);
+
+    // adds bitmap words received from the owner to our (single) entry
+    void contribute_bitmap_words(const Rect<N,T>& bounds, size_t first_word,
+				 const unsigned long long *data, size_t count,
+				 bool last);
+
     static ActiveMessageHandlerReg<RemoteSparsityRequest> remote_sparsity_request_reg;
     static ActiveMessageHandlerReg<RemoteSparsityContrib> remote_sparsity_contrib_reg;
+    static ActiveMessageHandlerReg<RemoteSparsityBitmap> remote_sparsity_bitmap_reg;
     static ActiveMessageHandlerReg<SetContribCountMessage> set_contrib_count_msg_reg;
 
     int remaining_contributor_count;
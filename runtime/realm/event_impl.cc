@@ -34,8 +34,79 @@ namespace Realm {
   //  out the stack
   namespace ThreadLocal {
     __thread EventWaiter::EventWaiterList *nested_wake_list = 0;
+    // waiters claimed from an owner's local waiter queue are handed over as
+    //  (first, last) chains instead - see wake_waiter_chain below
+    __thread std::vector<std::pair<EventWaiter *, EventWaiter *> > *nested_wake_chains = 0;
   };
 
+  // wakes the waiters from 'first' to 'last' claimed from an owner's local
+  //  waiter queue - a push that swung the tail just before the queue was
+  //  claimed may not have linked itself in yet, so wait for each link
+  static void wake_waiter_chain(EventWaiter *first, EventWaiter *last,
+				bool poisoned)
+  {
+    EventWaiter *pos = first;
+    while(pos) {
+      EventWaiter *next = 0;
+      if(pos != last)
+	while((next = *static_cast<EventWaiter * volatile *>(&pos->ew_list_link.next)) == 0)
+	  Thread::yield();
+      pos->ew_list_link.next = 0;
+      pos->event_triggered(poisoned);
+      pos = next;
+    }
+  }
+
+  // wakes everything in 'to_wake' and in the chain from 'first' to 'last' (if
+  //  any) - a call made while another is already waking waiters hands them
+  //  to that one instead of recursing
+  static void wake_local_waiters(EventWaiter::EventWaiterList& to_wake,
+				 EventWaiter *first, EventWaiter *last,
+				 bool poisoned)
+  {
+    if(poisoned) {
+      wake_waiter_chain(first, last, true /*poisoned*/);
+      while(!to_wake.empty()) {
+	EventWaiter *ew = to_wake.pop_front();
+	ew->event_triggered(true /*poisoned*/);
+      }
+      return;
+    }
+
+    if(ThreadLocal::nested_wake_list != 0) {
+      // append our waiters for caller to handle rather than recursing
+      ThreadLocal::nested_wake_list->absorb_append(to_wake);
+      if(first)
+	ThreadLocal::nested_wake_chains->push_back(std::make_pair(first, last));
+      return;
+    }
+
+    std::vector<std::pair<EventWaiter *, EventWaiter *> > chains;
+    size_t next_chain = 0;
+    ThreadLocal::nested_wake_list = &to_wake;  // avoid recursion
+    ThreadLocal::nested_wake_chains = &chains;
+    while(true) {
+      if(first) {
+	wake_waiter_chain(first, last, false /*!poisoned*/);
+	first = 0;
+      } else if(!to_wake.empty()) {
+	EventWaiter *ew = to_wake.pop_front();
+	ew->event_triggered(false /*!poisoned*/);
+      } else if(next_chain < chains.size()) {
+	first = chains[next_chain].first;
+	last = chains[next_chain].second;
+	// start over once everything handed to us so far has been taken
+	if(++next_chain == chains.size()) {
+	  chains.clear();
+	  next_chain = 0;
+	}
+      } else
+	break;
+    }
+    ThreadLocal::nested_wake_list = 0;
+    ThreadLocal::nested_wake_chains = 0;
+  }
+
 #if 0
   ////////////////////////////////////////////////////////////////////////
   //
@@ -553,7 +624,9 @@ namespace Realm {
 
     Event e = search_from;
     while(true) {
-      EventWaiter *waiters_head = 0;
+      // the current generation may have waiters in both the locked list and
+      //  the owner's lock-free queue
+      EventWaiter *waiters_heads[2] = { 0, 0 };
 
       ID id(e);
       if(id.is_event()) {
@@ -567,11 +640,12 @@ namespace Realm {
 	    assert(0);
 	  } else if((gen + 1) == id.event_generation()) {
 	    // current generation
-	    waiters_head = impl->current_local_waiters.head.next;
+	    waiters_heads[0] = impl->current_local_waiters.head.next;
+	    waiters_heads[1] = impl->local_waiter_queue_head();
 	  } else {
 	    std::map<EventImpl::gen_t, EventWaiter::EventWaiterList>::const_iterator it = impl->future_local_waiters.find(id.event_generation());
 	    if(it != impl->future_local_waiters.end())
-	      waiters_head = it->second.head.next;
+	      waiters_heads[0] = it->second.head.next;
 	  }
 	}
       } else if(id.is_barrier()) {
@@ -584,7 +658,8 @@ namespace Realm {
       // record all of these event waiters as seen before traversing, so that we find the
       //  shortest possible path
       int count = 0;
-      for(EventWaiter *pos = waiters_head; pos; pos = pos->ew_list_link.next) {
+      for(int h = 0; h < 2; h++)
+      for(EventWaiter *pos = waiters_heads[h]; pos; pos = pos->ew_list_link.next) {
 	Event e2 = pos->get_finish_event();
 	if(!e2.exists()) continue;
 	if(e2 == target) {
@@ -879,10 +954,23 @@ namespace Realm {
   // class GenEventImpl
   //
 
+  static inline uintptr_t waiter_tail_tag(EventImpl::gen_t gen)
+  {
+    return (uintptr_t(gen) << GenEventImpl::WAITER_TAIL_TAG_SHIFT);
+  }
+
+  static inline EventWaiter *waiter_tail_ptr(uintptr_t val)
+  {
+    return reinterpret_cast<EventWaiter *>(val & ((uintptr_t(1) << GenEventImpl::WAITER_TAIL_TAG_SHIFT) - 1));
+  }
+
   GenEventImpl::GenEventImpl(void)
     : generation(0)
     , gen_subscribed(0)
     , num_poisoned_generations(0)
+    , local_waiter_tail(waiter_tail_tag(1))
+    , local_waiter_head(0)
+    , has_remote_waiters(false)
     , merger(this)
   {
     next_free = 0;
@@ -896,6 +984,7 @@ namespace Realm {
 #ifdef DEBUG_REALM
     AutoHSLLock a(mutex);
     if(!current_local_waiters.empty() ||
+       (local_waiter_queue_head() != 0) ||
        !future_local_waiters.empty() ||
        !remote_waiters.empty()) {
       log_event.fatal() << "Event " << me << " destroyed with"
@@ -923,6 +1012,9 @@ namespace Realm {
     me = _me;
     owner = _init_owner;
     generation.store(0);
+    local_waiter_tail.store(waiter_tail_tag(1));
+    local_waiter_head.store(0);
+    has_remote_waiters.store(false);
     gen_subscribed = 0;
     next_free = 0;
     num_poisoned_generations.store(0);
@@ -1250,6 +1342,24 @@ namespace Realm {
       // no early check here as the caller will generally have tried has_triggered()
       //  before allocating its EventWaiter object
 
+      // the owner needs no lock: it never has future waiters, poison
+      //  information is valid for any generation we've seen, and waiters for
+      //  the current generation go on the lock-free queue - a failed push
+      //  means trigger() has retargeted the queue, which it does only after
+      //  updating the generation, so the next time around we'll see it
+      if(owner == my_node_id) {
+	while(true) {
+	  gen_t cur_gen = generation.load_acquire();
+	  if(needed_gen <= cur_gen) {
+	    waiter->event_triggered(is_generation_poisoned(needed_gen));
+	    return true;
+	  }
+	  assert(needed_gen == (cur_gen + 1));
+	  if(push_local_waiter(needed_gen, waiter))
+	    return true;
+	}
+      }
+
       bool trigger_now = false;
       bool trigger_poisoned = false;
 
@@ -1282,13 +1392,12 @@ namespace Realm {
 	      // yes, put in the current waiter list
 	      current_local_waiters.push_back(waiter);
 	    } else {
-	      // no, put it in an appropriate future waiter list - only allowed for non-owners
-	      assert(owner != my_node_id);
+	      // no, put it in an appropriate future waiter list
 	      future_local_waiters[needed_gen].push_back(waiter);
 	    }
 
 	    // do we need to subscribe to this event?
-	    if((owner != my_node_id) && (gen_subscribed < needed_gen)) {
+	    if(gen_subscribed < needed_gen) {
 	      previous_subscribe_gen = gen_subscribed;
 	      gen_subscribed = needed_gen;
 	      subscribe_owner = owner;
@@ -1310,6 +1419,37 @@ namespace Realm {
       return true;  // waiter is always either enqueued or triggered right now
     }
 
+    bool GenEventImpl::push_local_waiter(gen_t needed_gen, EventWaiter *waiter)
+    {
+      uintptr_t tag = waiter_tail_tag(needed_gen);
+      uintptr_t waiter_val = reinterpret_cast<uintptr_t>(waiter);
+      assert((waiter_val >> WAITER_TAIL_TAG_SHIFT) == 0);
+
+      // we'll be the new end of the queue
+      waiter->ew_list_link.next = 0;
+
+      uintptr_t old_val = local_waiter_tail.load_acquire();
+      do {
+	// wrong generation?
+	if((old_val & ~((uintptr_t(1) << WAITER_TAIL_TAG_SHIFT) - 1)) != tag)
+	  return false;
+      } while(!local_waiter_tail.compare_exchange(old_val, tag | waiter_val));
+
+      // now link in behind the old tail - if trigger() has already claimed
+      //  the queue, it waits for this before it wakes the old tail
+      EventWaiter *prev = waiter_tail_ptr(old_val);
+      if(prev)
+	*static_cast<EventWaiter * volatile *>(&prev->ew_list_link.next) = waiter;
+      else
+	local_waiter_head.store_release(waiter);
+      return true;
+    }
+
+    EventWaiter *GenEventImpl::local_waiter_queue_head(void) const
+    {
+      return local_waiter_head.load_acquire();
+    }
+
     inline bool GenEventImpl::is_generation_poisoned(gen_t gen) const
     {
       // common case: no poisoned generations
@@ -1381,6 +1521,11 @@ namespace Realm {
       } else {
 	AutoHSLLock a(impl->mutex);
 
+	// a trigger on this (owner) node doesn't take the mutex unless it sees
+	//  this flag, so it has to be visible before we look at the generation
+	impl->has_remote_waiters.store(true);
+	__sync_synchronize();
+
 	// look at the previously-subscribed generation from the requestor - we'll send
 	//  a trigger message if anything newer has triggered
 	EventImpl::gen_t cur_gen = impl->generation.load();
@@ -1540,24 +1685,7 @@ namespace Realm {
 	  it != to_wake.end();
 	  it++) {
 	bool poisoned = is_generation_poisoned(it->first);
-	if(!poisoned) {
-	  if(ThreadLocal::nested_wake_list != 0) {
-	    // append our waiters for caller to handle rather than recursing
-	    ThreadLocal::nested_wake_list->absorb_append(it->second);
-	  } else {
-	    ThreadLocal::nested_wake_list = &(it->second);  // avoid recursion
-	    while(!it->second.empty()) {
-	      EventWaiter *w = it->second.pop_front();
-	      w->event_triggered(false /*!poisoned*/);
-	    }
-	    ThreadLocal::nested_wake_list = 0;
-	  }
-	} else {
-	  while(!it->second.empty()) {
-	    EventWaiter *w = it->second.pop_front();
-	    w->event_triggered(true /*poisoned*/);
-	  }
-	}
+	wake_local_waiters(it->second, 0, 0, poisoned);
       }
     }
   }
@@ -1640,7 +1768,7 @@ namespace Realm {
 	poisoned = _poisoned;
 
         // Need to hold the lock to avoid the race
-        AutoHSLLock(cv.mutex);
+        AutoHSLLock al(cv.mutex);
 	signalled = true;
 	cv.signal();
       }
@@ -1694,47 +1822,73 @@ namespace Realm {
 #endif
 
       EventWaiter::EventWaiterList to_wake;
+      // (on the owner) the waiters claimed from the local waiter queue
+      EventWaiter *claimed_first = 0;
+      EventWaiter *claimed_last = 0;
 
       if(my_node_id == owner) {
-	// we own this event
+	// we own this event - nobody else changes the generation, the poisoned
+	//  generation list or the waiter queue here, so none of this needs the
+	//  mutex unless remote nodes have subscribed
 
 	NodeSet to_update;
-	gen_t update_gen;
-	bool free_event = false;
-
-	{
-	  AutoHSLLock a(mutex);
+	gen_t update_gen = gen_triggered;
 
-	  // must always be the next generation
-	  assert(gen_triggered == (generation.load() + 1));
+	// must always be the next generation
+	assert(gen_triggered == (generation.load() + 1));
 
-	  to_wake.swap(current_local_waiters);
-	  assert(future_local_waiters.empty()); // no future waiters here
+	// update poisoned generation list
+	bool max_poisons = false;
+	if(poisoned) {
+	  if(!poisoned_generations)
+	    poisoned_generations = new gen_t[POISONED_GENERATION_LIMIT];
+	  int npg_cached = num_poisoned_generations.load();
+	  assert(npg_cached < POISONED_GENERATION_LIMIT);
+	  poisoned_generations[npg_cached] = gen_triggered;
+	  num_poisoned_generations.store_release(npg_cached + 1);
+	  if((npg_cached + 1) == POISONED_GENERATION_LIMIT)
+	    max_poisons = true;
+	}
 
-	  to_update.swap(remote_waiters);
-	  update_gen = gen_triggered;
-
-	  // update poisoned generation list
-	  bool max_poisons = false;
-	  if(poisoned) {
-	    if(!poisoned_generations)
-	      poisoned_generations = new gen_t[POISONED_GENERATION_LIMIT];
-	    int npg_cached = num_poisoned_generations.load();
-	    assert(npg_cached < POISONED_GENERATION_LIMIT);
-	    poisoned_generations[npg_cached] = gen_triggered;
-	    num_poisoned_generations.store_release(npg_cached + 1);
-	    if((npg_cached + 1) == POISONED_GENERATION_LIMIT)
-	      max_poisons = true;
+	// update generation next, with a synchronization to make sure poisoned
+	//  generation list is valid to any observer of this update
+	generation.store_release(gen_triggered);
+
+	// now claim the waiters, retargeting the queue to the next generation -
+	//  any push that fails after this will see the new generation (the
+	//  exchange is also a full barrier, which orders the generation update
+	//  before the check of has_remote_waiters below)
+	claimed_last = waiter_tail_ptr(local_waiter_tail.exchange(waiter_tail_tag(gen_triggered + 1)));
+	if(claimed_last) {
+	  // the push that found the queue empty may not have set the head yet
+	  while((claimed_first = local_waiter_head.load_acquire()) == 0)
+	    Thread::yield();
+	  // nobody can push for the next generation until the event has been
+	  //  freed and reallocated below, so the head can be reset here
+	  local_waiter_head.store(0);
+	  // a lone waiter (the common case in long dependence chains) is
+	  //  cheaper to hand around in the list
+	  if(claimed_first == claimed_last) {
+	    to_wake.push_back(claimed_first);
+	    claimed_first = claimed_last = 0;
 	  }
+	}
 
-	  // update generation last, with a synchronization to make sure poisoned generation
-	  // list is valid to any observer of this update
-	  generation.store_release(gen_triggered);
+	// we'll free the event unless it's maxed out on poisoned generations
+	//  or generation count
+	bool free_event = ((gen_triggered < ((1U << ID::EVENT_GENERATION_WIDTH) - 1)) &&
+			   !max_poisons);
+
+	// a remote subscription sets has_remote_waiters before it looks at the
+	//  generation, and we look at the flag after updating the generation, so
+	//  either it sees our update or we see its flag (and the mutex orders the
+	//  rest)
+	if(has_remote_waiters.load() || merger.is_active()) {
+	  AutoHSLLock a(mutex);
+
+	  to_update.swap(remote_waiters);
+	  has_remote_waiters.store(false);
 
-	  // we'll free the event unless it's maxed out on poisoned generations
-	  //  or generation count
-	  free_event = ((gen_triggered < ((1U << ID::EVENT_GENERATION_WIDTH) - 1)) &&
-			!max_poisons);
 	  // special case: if the merger is still active, defer the
 	  //  re-insertion until all the preconditions have triggered
 	  if(free_event && merger.is_active()) {
@@ -1832,26 +1986,8 @@ namespace Realm {
       }
 
       // finally, trigger any local waiters
-      if(!to_wake.empty()) {
-	if(!poisoned) {
-	  if(ThreadLocal::nested_wake_list != 0) {
-	    // append our waiters for caller to handle rather than recursing
-	    ThreadLocal::nested_wake_list->absorb_append(to_wake);
-	  } else {
-	    ThreadLocal::nested_wake_list = &to_wake;  // avoid recursion
-	    while(!to_wake.empty()) {
-	      EventWaiter *ew = to_wake.pop_front();
-	      ew->event_triggered(false /*!poisoned*/);
-	    }
-	    ThreadLocal::nested_wake_list = 0;
-	  }
-	} else {
-	  while(!to_wake.empty()) {
-	    EventWaiter *ew = to_wake.pop_front();
-	    ew->event_triggered(true /*poisoned*/);
-	  }
-	}
-      }
+      if(!to_wake.empty() || claimed_first)
+	wake_local_waiters(to_wake, claimed_first, claimed_last, poisoned);
     }
 
     void GenEventImpl::perform_delayed_free_list_insertion(void)
@@ -2358,24 +2494,7 @@ static void *bytedup(const void *data, size_t datalen)
 
 	// notify local waiters first
 	if(!local_notifications.empty()) {
-	  if(!POISON_FIXME) {
-	    if(ThreadLocal::nested_wake_list != 0) {
-	      // append our waiters for caller to handle rather than recursing
-	      ThreadLocal::nested_wake_list->absorb_append(local_notifications);
-	    } else {
-	      ThreadLocal::nested_wake_list = &local_notifications;  // avoid recursion
-	      while(!local_notifications.empty()) {
-		EventWaiter *ew = local_notifications.pop_front();
-		ew->event_triggered(false /*!poisoned*/);
-	      }
-	      ThreadLocal::nested_wake_list = 0;
-	    }
-	  } else {
-	    while(!local_notifications.empty()) {
-	      EventWaiter *ew = local_notifications.pop_front();
-	      ew->event_triggered(true /*poisoned*/);
-	    }
-	  }
+	  wake_local_waiters(local_notifications, 0, 0, POISON_FIXME);
 	}
 
 	// now do remote notifications
@@ -2687,26 +2806,8 @@ static void *bytedup(const void *data, size_t datalen)
       }
 
       // with lock released, perform any local notifications
-      if(!local_notifications.empty()) {
-	if(!POISON_FIXME) {
-	  if(ThreadLocal::nested_wake_list != 0) {
-	    // append our waiters for caller to handle rather than recursing
-	    ThreadLocal::nested_wake_list->absorb_append(local_notifications);
-	  } else {
-	    ThreadLocal::nested_wake_list = &local_notifications;  // avoid recursion
-	    while(!local_notifications.empty()) {
-	      EventWaiter *ew = local_notifications.pop_front();
-	      ew->event_triggered(false /*!poisoned*/);
-	    }
-	    ThreadLocal::nested_wake_list = 0;
-	  }
-	} else {
-	  while(!local_notifications.empty()) {
-	    EventWaiter *ew = local_notifications.pop_front();
-	    ew->event_triggered(true /*poisoned*/);
-	  }
-	}
-      }
+      if(!local_notifications.empty())
+	wake_local_waiters(local_notifications, 0, 0, POISON_FIXME);
     }
 
     bool BarrierImpl::get_result(gen_t result_gen, void *value, size_t value_size)
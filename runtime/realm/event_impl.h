@@ -184,6 +184,34 @@ namespace Realm {
       atomic<int> num_poisoned_generations;
       bool has_local_triggers;
 
+      // on the owner node, local waiters for the current generation are kept
+      //  in a lock-free queue linked through ew_list_link.next - the tail word
+      //  holds the last waiter, and its upper bits are a tag holding the
+      //  (truncated) generation the queue is collecting waiters for, so that
+      //  trigger() can claim the queue and retarget it to the next generation
+      //  in one exchange, and a waiter that arrives too late fails its push
+      //  and sees the new generation instead
+      // a push links itself behind the old tail (or into the head if the
+      //  queue was empty) just after it swings the tail, so trigger() may
+      //  briefly wait for those links when it walks the queue
+      // (a stale push could only succeed if the same event triggered 2^16
+      //  times between a waiter's read of the generation and its push)
+      atomic<uintptr_t> local_waiter_tail;
+      atomic<EventWaiter *> local_waiter_head;
+      static const int WAITER_TAIL_TAG_SHIFT = 48;
+
+      // returns false if the queue is not collecting waiters for 'needed_gen'
+      bool push_local_waiter(gen_t needed_gen, EventWaiter *waiter);
+
+      // first waiter in the queue, for debugging dumps
+      EventWaiter *local_waiter_queue_head(void) const;
+
+      // set (with the mutex held) by a remote subscription before it looks at
+      //  the generation, and checked by the owner's trigger() after it has
+      //  updated the generation - trigger() only takes the mutex if it's set
+      //  (or if a merger may still be using the event)
+      atomic<bool> has_remote_waiters;
+
       bool is_generation_poisoned(gen_t gen) const; // helper function - linear search
 
       // this is only manipulated when the event is "idle"
@@ -195,10 +223,10 @@ namespace Realm {
       // everything below here protected by this mutex
       GASNetHSL mutex;
 
-      // local waiters are tracked by generation - an easily-accessed list is used
-      //  for the "current" generation, whereas a map-by-generation-id is used for
-      //  "future" generations (i.e. ones ahead of what we've heard about if we're
-      //  not the owner)
+      // on non-owner nodes, local waiters are tracked by generation - an
+      //  easily-accessed list is used for the "current" generation, whereas a
+      //  map-by-generation-id is used for "future" generations (i.e. ones ahead
+      //  of what we've heard about)
       EventWaiter::EventWaiterList current_local_waiters;
       std::map<gen_t, EventWaiter::EventWaiterList> future_local_waiters;
 
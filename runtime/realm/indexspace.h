@@ -86,17 +86,31 @@ namespace Realm {
   template <int N, typename T = int> struct IndexSpaceIterator;
   template <int N, typename T = int> class SparsityMap;
 
+  class IndirectionInfo;
+
   template <int N, typename T = int>
   class CopyIndirection {
   public:
     class Base {
-      IndexSpace<N,T> target;
+    public:
+      virtual ~Base(void) {}
+
+      // builds the (type-erased) description of this indirection that the
+      //  transfer engine uses for copies over index space 'is'
+      virtual IndirectionInfo *create_info(const IndexSpace<N,T>& is) const = 0;
     };
 
+    // each point p of the copy domain is mapped to the range of points
+    //  [(transform * p + offset_lo) / divisor, (transform * p + offset_hi) / divisor]
+    //  (a single point if the offsets are equal), which must lie in one of
+    //  'spaces' - the points of all the ranges, in domain order, are paired
+    //  with the points of the copy domain
     template <int N2, typename T2 = int>
     class Affine : public CopyIndirection<N,T>::Base {
     public:
-      Matrix<N,N2,T2> transform;
+      virtual IndirectionInfo *create_info(const IndexSpace<N,T>& is) const;
+
+      Matrix<N2,N,T2> transform;
       Point<N2,T2> offset_lo, offset_hi;
       Point<N2,T2> divisor;
       std::vector<IndexSpace<N2,T2> > spaces;
@@ -106,10 +120,19 @@ namespace Realm {
     template <int N2, typename T2 = int>
     class Unstructured : public CopyIndirection<N,T>::Base {
     public:
+      Unstructured(void);
+
+      virtual IndirectionInfo *create_info(const IndexSpace<N,T>& is) const;
+
+      // the field holds a Point<N2,T2> for each point of the copy domain, or
+      //  a Rect<N2,T2> if 'is_ranges' is set (paired up as for Affine)
       FieldID field_id;
       RegionInstance inst;
       bool is_ranges;
       size_t subfield_offset;
+      // if set, points whose target lies in none of 'spaces' are skipped
+      //  instead of failing the copy (point indirections only)
+      bool oor_possible;
       std::vector<IndexSpace<N2,T2> > spaces;
       std::vector<RegionInstance> insts;
     };
@@ -552,6 +575,7 @@ namespace Realm {
     // for iterating over SparsityMap's
     SparsityMapPublicImpl<N,T> *s_impl;
     size_t cur_entry;
+    size_t cur_bitpos;  // cursor within a bitmap entry
 
     IndexSpaceIterator(void);
     IndexSpaceIterator(const IndexSpace<N,T>& _space);
@@ -510,9 +510,8 @@ namespace Realm {
       if(e.sparsity.exists()) {
 	assert(0);
       }
-      if(e.bitmap != 0) {
-	assert(0);
-      }
+      if(e.bitmap != 0)
+	return e.bitmap->contains(p);
       return true;
     } else {
       for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = entries.begin();
@@ -522,7 +521,8 @@ namespace Realm {
 	if(it->sparsity.exists()) {
 	  assert(0);
 	} else if(it->bitmap != 0) {
-	  assert(0);
+	  if(it->bitmap->contains(p))
+	    return true;
 	} else {
 	  return true;
 	}
@@ -566,7 +566,8 @@ namespace Realm {
 	if(it->sparsity.exists()) {
 	  assert(0);
 	} else if(it->bitmap != 0) {
-	  assert(0);
+	  if(it->bitmap->contains_any(r))
+	    return true;
 	} else {
 	  return true;
 	}
@@ -620,7 +621,7 @@ namespace Realm {
       if(it->sparsity.exists()) {
 	assert(0);
       } else if(it->bitmap != 0) {
-	assert(0);
+	total += it->bitmap->count(isect);
       } else {
 	total += isect.volume();
       }
@@ -1072,9 +1073,16 @@ namespace Realm {
 	rect = restriction.intersection(e.bounds);
 	if(!rect.empty()) {
 	  assert(!e.sparsity.exists());
-	  assert(e.bitmap == 0);
-	  valid = true;
-	  return;
+	  if(e.bitmap == 0) {
+	    valid = true;
+	    return;
+	  }
+	  // a bitmap entry yields its runs of points, if it has any
+	  cur_bitpos = e.bitmap->index_of(rect.lo);
+	  if(e.bitmap->next_run(rect, cur_bitpos, rect)) {
+	    valid = true;
+	    return;
+	  }
 	}
 	cur_entry++;
       }
@@ -1112,9 +1120,16 @@ namespace Realm {
 	rect = restriction.intersection(e.bounds);
 	if(!rect.empty()) {
 	  assert(!e.sparsity.exists());
-	  assert(e.bitmap == 0);
-	  valid = true;
-	  return;
+	  if(e.bitmap == 0) {
+	    valid = true;
+	    return;
+	  }
+	  // a bitmap entry yields its runs of points, if it has any
+	  cur_bitpos = e.bitmap->index_of(rect.lo);
+	  if(e.bitmap->next_run(rect, cur_bitpos, rect)) {
+	    valid = true;
+	    return;
+	  }
 	}
 	cur_entry++;
       }
@@ -1135,10 +1150,16 @@ namespace Realm {
       return false;
     }
 
-    // TODO: handle iteration within a sparsity entry
+    const std::vector<SparsityMapEntry<N,T> >& entries = s_impl->get_entries();
+
+    // a bitmap entry may have more runs within our restriction
+    if(entries[cur_entry].bitmap != 0) {
+      const SparsityMapEntry<N,T>& e = entries[cur_entry];
+      if(e.bitmap->next_run(restriction.intersection(e.bounds), cur_bitpos, rect))
+	return true;
+    }
 
     // move onto the next sparsity entry (that overlaps our restriction)
-    const std::vector<SparsityMapEntry<N,T> >& entries = s_impl->get_entries();
     for(cur_entry++; cur_entry < entries.size(); cur_entry++) {
       const SparsityMapEntry<N,T>& e = entries[cur_entry];
       rect = restriction.intersection(e.bounds);
@@ -1152,7 +1173,11 @@ namespace Realm {
       }
 
       assert(!e.sparsity.exists());
-      assert(e.bitmap == 0);
+      if(e.bitmap != 0) {
+	cur_bitpos = e.bitmap->index_of(rect.lo);
+	if(!e.bitmap->next_run(rect, cur_bitpos, rect))
+	  continue;
+      }
       return true;
     }
 
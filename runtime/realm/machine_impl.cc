@@ -366,6 +366,8 @@ namespace Realm {
     MachineImpl *machine_singleton = 0;
 
   MachineImpl::MachineImpl(void)
+    : affinity_index(0)
+    , defer_invalidation(false)
   {
     assert(machine_singleton == 0);
     machine_singleton = this;
@@ -376,6 +378,11 @@ namespace Realm {
     assert(machine_singleton == this);
     machine_singleton = 0;
     delete_map_contents(nodeinfos);
+    delete affinity_index.load();
+    for(std::vector<const MachineAffinityIndex *>::const_iterator it = retired_indices.begin();
+	it != retired_indices.end();
+	++it)
+      delete *it;
   }
 
 #ifndef REALM_SKIP_INTERNODE_AFFINITIES
@@ -429,6 +436,9 @@ namespace Realm {
     {
       AutoHSLLock al(mutex);
 
+      // the affinities below invalidate the query caches once, at the end
+      defer_invalidation = true;
+
       assert(node_id <= max_node_id);
       Node& n = get_runtime()->nodes[node_id];
 
@@ -627,6 +637,9 @@ namespace Realm {
       }
 
       assert(ok && (fbd.bytes_left() == 0));
+
+      defer_invalidation = false;
+      invalidate_query_caches();
     }
 
     void MachineImpl::get_all_memories(std::set<Memory>& mset) const
@@ -740,9 +753,9 @@ namespace Realm {
     // Return the set of memories visible from a processor
     void MachineImpl::get_visible_memories(Processor p, std::set<Memory>& mset, bool local_only) const
     {
+#ifdef USE_OLD_AFFINITIES
       // TODO: consider using a reader/writer lock here instead
       AutoHSLLock al(mutex);
-#ifdef USE_OLD_AFFINITIES
       for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it = proc_mem_affinities.begin();
 	  it != proc_mem_affinities.end();
 	  it++) {
@@ -751,17 +764,14 @@ namespace Realm {
 	  mset.insert((*it).m);
       }
 #else
-      const MachineNodeInfo *ni = get_nodeinfo(p);
-      if(!ni) return;
-      std::map<Processor, MachineProcInfo *>::const_iterator it = ni->procs.find(p);
-      if(it == ni->procs.end()) return;
-      const std::map<Memory, Machine::ProcessorMemoryAffinity *>& pmas = (local_only ?
-									    it->second->pmas.local :
-									    it->second->pmas.all);
-      for(std::map<Memory, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.begin();
-	  it2 != pmas.end();
+      const MachineAffinityIndex *idx = get_affinity_index();
+      std::map<Processor, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_proc.find(p);
+      if(it == idx->pmas_by_proc.end()) return;
+      for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+	  it2 != it->second.end();
 	  ++it2)
-	mset.insert(it2->first);
+	if(!local_only || is_local_affinity(*it2))
+	  mset.insert(it2->m);
 #endif
     }
 
@@ -769,9 +779,9 @@ namespace Realm {
     void MachineImpl::get_visible_memories(Memory m, std::set<Memory>& mset,
 					   bool local_only) const
     {
+#ifdef USE_OLD_AFFINITIES
       // TODO: consider using a reader/writer lock here instead
       AutoHSLLock al(mutex);
-#ifdef USE_OLD_AFFINITIES
       for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it = mem_mem_affinities.begin();
 	  it != mem_mem_affinities.end();
 	  it++) {
@@ -784,28 +794,25 @@ namespace Realm {
 	  mset.insert((*it).m1);
       }
 #else
-      const MachineNodeInfo *ni = get_nodeinfo(m);
-      if(!ni) return;
-      std::map<Memory, MachineMemInfo *>::const_iterator it = ni->mems.find(m);
-      if(it == ni->mems.end()) return;
+      const MachineAffinityIndex *idx = get_affinity_index();
       // handle both directions for now
       {
-	const std::map<Memory, Machine::MemoryMemoryAffinity *>& mmas = (local_only ?
-									   it->second->mmas_out.local :
-  									   it->second->mmas_out.all);
-	for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.begin();
-	    it2 != mmas.end();
-	    ++it2)
-	  mset.insert(it2->first);
+	std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >::const_iterator it = idx->mmas_by_src.find(m);
+	if(it != idx->mmas_by_src.end())
+	  for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = it->second.begin();
+	      it2 != it->second.end();
+	      ++it2)
+	    if(!local_only || is_local_affinity(*it2))
+	      mset.insert(it2->m2);
       }
       {
-	const std::map<Memory, Machine::MemoryMemoryAffinity *>& mmas = (local_only ?
-									   it->second->mmas_in.local :
-  									   it->second->mmas_in.all);
-	for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.begin();
-	    it2 != mmas.end();
-	    ++it2)
-	  mset.insert(it2->first);
+	std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >::const_iterator it = idx->mmas_by_dst.find(m);
+	if(it != idx->mmas_by_dst.end())
+	  for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = it->second.begin();
+	      it2 != it->second.end();
+	      ++it2)
+	    if(!local_only || is_local_affinity(*it2))
+	      mset.insert(it2->m1);
       }
 #endif
     }
@@ -814,9 +821,9 @@ namespace Realm {
     void MachineImpl::get_shared_processors(Memory m, std::set<Processor>& pset,
 					    bool local_only) const
     {
+#ifdef USE_OLD_AFFINITIES
       // TODO: consider using a reader/writer lock here instead
       AutoHSLLock al(mutex);
-#ifdef USE_OLD_AFFINITIES
       for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it = proc_mem_affinities.begin();
 	  it != proc_mem_affinities.end();
 	  it++) {
@@ -824,32 +831,29 @@ namespace Realm {
 	  pset.insert((*it).p);
       }
 #else
-      const MachineNodeInfo *ni = get_nodeinfo(m);
-      if(!ni) return;
-      std::map<Memory, MachineMemInfo *>::const_iterator it = ni->mems.find(m);
-      if(it == ni->mems.end()) return;
-      const std::map<Processor, Machine::ProcessorMemoryAffinity *>& pmas = (local_only ?
-									       it->second->pmas.local :
-									       it->second->pmas.all);
-      for(std::map<Processor, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.begin();
-	  it2 != pmas.end();
-	    ++it2)
-	pset.insert(it2->first);
+      const MachineAffinityIndex *idx = get_affinity_index();
+      std::map<Memory, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_mem.find(m);
+      if(it == idx->pmas_by_mem.end()) return;
+      for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+	  it2 != it->second.end();
+	  ++it2)
+	if(!local_only || is_local_affinity(*it2))
+	  pset.insert(it2->p);
 #endif
     }
 
     bool MachineImpl::has_affinity(Processor p, Memory m, Machine::AffinityDetails *details /*= 0*/) const
     {
-      // TODO: consider using a reader/writer lock here instead
-      AutoHSLLock al(mutex);
-      for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it = proc_mem_affinities.begin();
-	  it != proc_mem_affinities.end();
-	  it++) {
-	if(it->p != p) continue;
-	if(it->m != m) continue;
+      const MachineAffinityIndex *idx = get_affinity_index();
+      std::map<Processor, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_proc.find(p);
+      if(it == idx->pmas_by_proc.end()) return false;
+      for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+	  it2 != it->second.end();
+	  ++it2) {
+	if(it2->m != m) continue;
 	if(details) {
-	  details->bandwidth = it->bandwidth;
-	  details->latency = it->latency;
+	  details->bandwidth = it2->bandwidth;
+	  details->latency = it2->latency;
 	}
 	return true;
       }
@@ -858,16 +862,16 @@ namespace Realm {
 
     bool MachineImpl::has_affinity(Memory m1, Memory m2, Machine::AffinityDetails *details /*= 0*/) const
     {
-      // TODO: consider using a reader/writer lock here instead
-      AutoHSLLock al(mutex);
-      for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it = mem_mem_affinities.begin();
-	  it != mem_mem_affinities.end();
-	  it++) {
-	if(it->m1 != m1) continue;
-	if(it->m2 != m2) continue;
+      const MachineAffinityIndex *idx = get_affinity_index();
+      std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >::const_iterator it = idx->mmas_by_src.find(m1);
+      if(it == idx->mmas_by_src.end()) return false;
+      for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = it->second.begin();
+	  it2 != it->second.end();
+	  ++it2) {
+	if(it2->m2 != m2) continue;
 	if(details) {
-	  details->bandwidth = it->bandwidth;
-	  details->latency = it->latency;
+	  details->bandwidth = it2->bandwidth;
+	  details->latency = it2->latency;
 	}
 	return true;
       }
@@ -881,10 +885,10 @@ namespace Realm {
     {
       int count = 0;
 
+#ifdef USE_OLD_AFFINITIES
       {
 	// TODO: consider using a reader/writer lock here instead
 	AutoHSLLock al(mutex);
-#ifdef USE_OLD_AFFINITIES
 	for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it = proc_mem_affinities.begin();
 	    it != proc_mem_affinities.end();
 	    it++) {
@@ -894,66 +898,46 @@ namespace Realm {
 	  result.push_back(*it);
 	  count++;
 	}
+      }
 #else
-	if(restrict_proc.exists()) {
-	  const MachineNodeInfo *np = get_nodeinfo(restrict_proc);
-	  if(!np) return 0;
-	  std::map<Processor, MachineProcInfo *>::const_iterator it = np->procs.find(restrict_proc);
-	  if(it == np->procs.end()) return 0;
-	  const MachineProcInfo *mpi = it->second;
-	  const std::map<Memory, Machine::ProcessorMemoryAffinity *>& pmas = (local_only ? mpi->pmas.local : mpi->pmas.all);
-
-	  if(restrict_memory.exists()) {
-	    std::map<Memory, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.find(restrict_memory);
-	    if(it2 != pmas.end()) {
-	      result.push_back(*(it2->second));
-	      count++;
-	    }
-	  } else {
-	    for(std::map<Memory, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.begin();
-		it2 != pmas.end();
-		++it2) {
-	      result.push_back(*(it2->second));
-	      count++;
-	    }
+      const MachineAffinityIndex *idx = get_affinity_index();
+      if(restrict_proc.exists()) {
+	std::map<Processor, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_proc.find(restrict_proc);
+	if(it == idx->pmas_by_proc.end()) return 0;
+	for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+	    it2 != it->second.end();
+	    ++it2) {
+	  if(restrict_memory.exists() && (it2->m != restrict_memory)) continue;
+	  if(local_only && !is_local_affinity(*it2)) continue;
+	  result.push_back(*it2);
+	  count++;
+	}
+      } else {
+	if(restrict_memory.exists()) {
+	  std::map<Memory, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_mem.find(restrict_memory);
+	  if(it == idx->pmas_by_mem.end()) return 0;
+	  for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+	      it2 != it->second.end();
+	      ++it2) {
+	    if(local_only && !is_local_affinity(*it2)) continue;
+	    result.push_back(*it2);
+	    count++;
 	  }
 	} else {
-	  if(restrict_memory.exists()) {
-	    const MachineNodeInfo *nm = get_nodeinfo(restrict_memory);
-	    if(!nm) return 0;
-	    std::map<Memory, MachineMemInfo *>::const_iterator it = nm->mems.find(restrict_memory);
-	    if(it == nm->mems.end()) return 0;
-	    const MachineMemInfo *mmi = it->second;
-	    const std::map<Processor, Machine::ProcessorMemoryAffinity *>& pmas = (local_only ? mmi->pmas.local : mmi->pmas.all);
-
-	    for(std::map<Processor, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.begin();
-		it2 != pmas.end();
+	  // every single affinity - still no lock needed
+	  for(std::map<Processor, std::vector<Machine::ProcessorMemoryAffinity> >::const_iterator it = idx->pmas_by_proc.begin();
+	      it != idx->pmas_by_proc.end();
+	      ++it)
+	    for(std::vector<Machine::ProcessorMemoryAffinity>::const_iterator it2 = it->second.begin();
+		it2 != it->second.end();
 		++it2) {
-	      result.push_back(*(it2->second));
+	      if(local_only && !is_local_affinity(*it2)) continue;
+	      result.push_back(*it2);
 	      count++;
 	    }
-	  } else {
-	    // lookup of every single affinity - blech
-	    for(std::map<NodeID, MachineNodeInfo *>::const_iterator it = nodeinfos.begin();
-		it != nodeinfos.end();
-		++it)
-	      for(std::map<Processor, MachineProcInfo *>::const_iterator it2 = it->second->procs.begin();
-		  it2 != it->second->procs.end();
-		  ++it2) {
-		const MachineProcInfo *mpi = it2->second;
-		const std::map<Memory, Machine::ProcessorMemoryAffinity *>& pmas = (local_only ? mpi->pmas.local : mpi->pmas.all);
-
-		for(std::map<Memory, Machine::ProcessorMemoryAffinity *>::const_iterator it2 = pmas.begin();
-		    it2 != pmas.end();
-		    ++it2) {
-		  result.push_back(*(it2->second));
-		  count++;
-		}
-	      }
-	  }
 	}
-#endif
       }
+#endif
 
       return count;
     }
@@ -977,10 +961,10 @@ namespace Realm {
 
       int count = 0;
 
+#ifdef USE_OLD_AFFINITIES
       {
 	// TODO: consider using a reader/writer lock here instead
 	AutoHSLLock al(mutex);
-#ifdef USE_OLD_AFFINITIES
 	for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it = mem_mem_affinities.begin();
 	    it != mem_mem_affinities.end();
 	    it++) {
@@ -992,70 +976,106 @@ namespace Realm {
 	  result.push_back(*it);
 	  count++;
 	}
+      }
 #else
-	if(restrict_mem1.exists()) {
-	  const MachineNodeInfo *nm1 = get_nodeinfo(restrict_mem1);
-	  if(!nm1) return 0;
-	  std::map<Memory, MachineMemInfo *>::const_iterator it = nm1->mems.find(restrict_mem1);
-	  if(it == nm1->mems.end()) return 0;
-	  const MachineMemInfo *mmi = it->second;
-	  const std::map<Memory, Machine::MemoryMemoryAffinity *>& mmas = (local_only ? mmi->mmas_out.local : mmi->mmas_out.all);
-
-	  if(restrict_mem2.exists()) {
-	    std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.find(restrict_mem2);
-	    if(it2 != mmas.end()) {
-	      result.push_back(*(it2->second));
-	      count++;
-	    }
-	  } else {
-	    for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.begin();
-		it2 != mmas.end();
-		++it2) {
-	      result.push_back(*(it2->second));
-	      count++;
-	    }
-	  }
-	} else {
-	  if(restrict_mem2.exists()) {
-	    const MachineNodeInfo *nm2 = get_nodeinfo(restrict_mem2);
-	    if(!nm2) return 0;
-	    std::map<Memory, MachineMemInfo *>::const_iterator it = nm2->mems.find(restrict_mem2);
-	    if(it == nm2->mems.end()) return 0;
-	    const MachineMemInfo *mmi = it->second;
-	    const std::map<Memory, Machine::MemoryMemoryAffinity *>& mmas = (local_only ? mmi->mmas_in.local : mmi->mmas_in.all);
-
-	    for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.begin();
-		it2 != mmas.end();
-		++it2) {
-	      result.push_back(*(it2->second));
-	      count++;
-	    }
-	  } else {
-	    // lookup of every single affinity - blech
-	    for(std::map<NodeID, MachineNodeInfo *>::const_iterator it = nodeinfos.begin();
-		it != nodeinfos.end();
-		++it)
-	      for(std::map<Memory, MachineMemInfo *>::const_iterator it2 = it->second->mems.begin();
-		  it2 != it->second->mems.end();
-		  ++it2) {
-		const MachineMemInfo *mmi = it2->second;
-		const std::map<Memory, Machine::MemoryMemoryAffinity *>& mmas = (local_only ? mmi->mmas_out.local : mmi->mmas_out.all);
-
-		for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it2 = mmas.begin();
-		    it2 != mmas.end();
-		    ++it2) {
-		  result.push_back(*(it2->second));
-		  count++;
-		}
-	      }
+      const MachineAffinityIndex *idx = get_affinity_index();
+      if(restrict_mem1.exists()) {
+	std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >::const_iterator it = idx->mmas_by_src.find(restrict_mem1);
+	if(it == idx->mmas_by_src.end()) return 0;
+	for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = it->second.begin();
+	    it2 != it->second.end();
+	    ++it2) {
+	  if(restrict_mem2.exists() && (it2->m2 != restrict_mem2)) continue;
+	  if(local_only && !is_local_affinity(*it2)) continue;
+	  result.push_back(*it2);
+	  count++;
+	}
+      } else {
+	const std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >& mmas = (restrict_mem2.exists() ?
+										      idx->mmas_by_dst :
+										      idx->mmas_by_src);
+	std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> >::const_iterator it = (restrict_mem2.exists() ?
+											     mmas.find(restrict_mem2) :
+											     mmas.begin());
+	for(; it != mmas.end(); ++it) {
+	  for(std::vector<Machine::MemoryMemoryAffinity>::const_iterator it2 = it->second.begin();
+	      it2 != it->second.end();
+	      ++it2) {
+	    if(local_only && !is_local_affinity(*it2)) continue;
+	    result.push_back(*it2);
+	    count++;
 	  }
+	  // a restricted lookup only wants the one adjacency list
+	  if(restrict_mem2.exists()) break;
 	}
-#endif
       }
+#endif
 
       return count;
     }
 
+  const MachineAffinityIndex *MachineImpl::get_affinity_index(void) const
+  {
+    // fast path - a published index is never modified, so no lock is needed
+    const MachineAffinityIndex *idx = affinity_index.load_acquire();
+    if(idx != 0)
+      return idx;
+
+    AutoHSLLock al(mutex);
+    // somebody else may have rebuilt it while we waited
+    idx = affinity_index.load();
+    if(idx != 0)
+      return idx;
+
+    MachineAffinityIndex *new_idx = new MachineAffinityIndex;
+    for(std::map<NodeID, MachineNodeInfo *>::const_iterator it = nodeinfos.begin();
+	it != nodeinfos.end();
+	++it) {
+      for(std::map<Processor, MachineProcInfo *>::const_iterator it2 = it->second->procs.begin();
+	  it2 != it->second->procs.end();
+	  ++it2) {
+	std::vector<Machine::ProcessorMemoryAffinity>& v = new_idx->pmas_by_proc[it2->first];
+	const std::map<Memory, Machine::ProcessorMemoryAffinity *>& pmas = it2->second->pmas.all;
+	v.reserve(pmas.size());
+	for(std::map<Memory, Machine::ProcessorMemoryAffinity *>::const_iterator it3 = pmas.begin();
+	    it3 != pmas.end();
+	    ++it3)
+	  v.push_back(*(it3->second));
+      }
+      for(std::map<Memory, MachineMemInfo *>::const_iterator it2 = it->second->mems.begin();
+	  it2 != it->second->mems.end();
+	  ++it2) {
+	const MachineMemInfo *mmi = it2->second;
+	if(!mmi->pmas.all.empty()) {
+	  std::vector<Machine::ProcessorMemoryAffinity>& v = new_idx->pmas_by_mem[it2->first];
+	  v.reserve(mmi->pmas.all.size());
+	  for(std::map<Processor, Machine::ProcessorMemoryAffinity *>::const_iterator it3 = mmi->pmas.all.begin();
+	      it3 != mmi->pmas.all.end();
+	      ++it3)
+	    v.push_back(*(it3->second));
+	}
+	if(!mmi->mmas_out.all.empty()) {
+	  std::vector<Machine::MemoryMemoryAffinity>& v = new_idx->mmas_by_src[it2->first];
+	  v.reserve(mmi->mmas_out.all.size());
+	  for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it3 = mmi->mmas_out.all.begin();
+	      it3 != mmi->mmas_out.all.end();
+	      ++it3)
+	    v.push_back(*(it3->second));
+	}
+	if(!mmi->mmas_in.all.empty()) {
+	  std::vector<Machine::MemoryMemoryAffinity>& v = new_idx->mmas_by_dst[it2->first];
+	  v.reserve(mmi->mmas_in.all.size());
+	  for(std::map<Memory, Machine::MemoryMemoryAffinity *>::const_iterator it3 = mmi->mmas_in.all.begin();
+	      it3 != mmi->mmas_in.all.end();
+	      ++it3)
+	    v.push_back(*(it3->second));
+	}
+      }
+    }
+    affinity_index.store_release(new_idx);
+    return new_idx;
+  }
+
   void MachineImpl::add_proc_mem_affinity(const Machine::ProcessorMemoryAffinity& pma,
 					  bool lock_held /*= false*/)
   {
@@ -1079,7 +1099,8 @@ namespace Realm {
       ptr->add_memory(pma.m);
       ptr->add_proc_mem_affinity(pma);
     }
-    invalidate_query_caches();
+    if(!defer_invalidation)
+      invalidate_query_caches();
     if(!lock_held) mutex.unlock();
   }
 
@@ -1106,7 +1127,8 @@ namespace Realm {
       ptr->add_memory(mma.m2);
       ptr->add_mem_mem_affinity(mma);
     }
-    invalidate_query_caches();
+    if(!defer_invalidation)
+      invalidate_query_caches();
     if(!lock_held) mutex.unlock();
   }
 
@@ -1122,8 +1144,23 @@ namespace Realm {
       subscribers.erase(subscriber);
     }
 
+    void MachineImpl::reclaim_retired_indices(void)
+    {
+      AutoHSLLock al(mutex);
+      for(std::vector<const MachineAffinityIndex *>::const_iterator it = retired_indices.begin();
+	  it != retired_indices.end();
+	  ++it)
+	delete *it;
+      retired_indices.clear();
+    }
+
     void MachineImpl::invalidate_query_caches()
     {
+      // called with the mutex held - readers may still be walking the old
+      //  affinity index, so it is retired rather than deleted
+      const MachineAffinityIndex *old_idx = affinity_index.exchange(0);
+      if(old_idx != 0)
+	retired_indices.push_back(old_idx);
       while (!__sync_bool_compare_and_swap(&MemoryQueryImpl::init,0,1))
         continue;
       __sync_fetch_and_add(&MemoryQueryImpl::cache_invalid_count,1);
@@ -20,6 +20,7 @@
 
 #include "realm/machine.h"
 #include "realm/activemsg.h"
+#include "realm/atomics.h"
 
 #include <vector>
 #include <set>
@@ -77,6 +78,15 @@ namespace Realm {
     std::map<Memory::Kind, std::map<Memory, MachineMemInfo *> > mem_by_kind;
   };
 
+  // an immutable snapshot of the affinity adjacency lists - each list is
+  //  sorted by the other endpoint
+  struct MachineAffinityIndex {
+    std::map<Processor, std::vector<Machine::ProcessorMemoryAffinity> > pmas_by_proc;
+    std::map<Memory, std::vector<Machine::ProcessorMemoryAffinity> > pmas_by_mem;
+    std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> > mmas_by_src;
+    std::map<Memory, std::vector<Machine::MemoryMemoryAffinity> > mmas_by_dst;
+  };
+
     class MachineImpl {
     public:
       MachineImpl(void);
@@ -127,6 +137,11 @@ namespace Realm {
       void add_subscription(Machine::MachineUpdateSubscriber *subscriber);
       void remove_subscription(Machine::MachineUpdateSubscriber *subscriber);
 
+      // frees the affinity indices retired so far - the caller must make sure
+      //  no other thread can still be reading one (e.g. at the end of
+      //  startup, before any processors are running tasks)
+      void reclaim_retired_indices(void);
+
       mutable GASNetHSL mutex;
       std::vector<Machine::ProcessorMemoryAffinity> proc_mem_affinities;
       std::vector<Machine::MemoryMemoryAffinity> mem_mem_affinities;
@@ -139,6 +154,16 @@ namespace Realm {
       MachineNodeInfo *get_nodeinfo(Processor p) const;
       MachineNodeInfo *get_nodeinfo(Memory m) const;
       void invalidate_query_caches();
+
+      // returns the current affinity index, building it (under the mutex) if
+      //  it has been invalidated - published indices are never modified, so
+      //  the affinity queries read them without taking the mutex
+      const MachineAffinityIndex *get_affinity_index(void) const;
+      mutable atomic<const MachineAffinityIndex *> affinity_index;
+      std::vector<const MachineAffinityIndex *> retired_indices;
+      // set (with the mutex held) while an announcement is being parsed, so
+      //  that the affinities it adds invalidate the caches once at the end
+      bool defer_invalidation;
     };
 
     template <typename T, typename T2>
@@ -99,8 +99,11 @@ namespace Realm {
       , usage(stringbuilder() << "realm/mem " << _me << "/usage")
       , peak_usage(stringbuilder() << "realm/mem " << _me << "/peak_usage")
       , peak_footprint(stringbuilder() << "realm/mem " << _me << "/peak_footprint")
+      , free_ranges(stringbuilder() << "realm/mem " << _me << "/free_ranges")
+      , largest_free_range(stringbuilder() << "realm/mem " << _me << "/largest_free_range")
     {
       allocator.add_range(0, _size);
+      update_allocator_gauges();
     }
 
     MemoryImpl::~MemoryImpl(void)
@@ -130,6 +133,12 @@ namespace Realm {
 #endif
     }
 
+    void MemoryImpl::update_allocator_gauges(void)
+    {
+      free_ranges = allocator.num_free_ranges();
+      largest_free_range = allocator.largest_free_range();
+    }
+
     // make bad offsets really obvious (+1 PB)
     static const off_t ZERO_SIZE_INSTANCE_OFFSET = 1ULL << ((sizeof(off_t) == 8) ? 50 : 30);
 
@@ -297,6 +306,65 @@ namespace Realm {
       return lowlevel_kind;
     }
 
+    void MemoryImpl::apply_reduction_list(off_t offset,
+					  const ReductionOpUntyped *redop,
+					  size_t count, const void *entry_buffer,
+					  bool red_fold)
+    {
+      if(count == 0) return;
+
+      const char *entries = static_cast<const char *>(entry_buffer);
+      size_t elem_size = (red_fold ? redop->sizeof_rhs : redop->sizeof_lhs);
+
+      // find the range of elements touched by the list - if the memory can
+      //  give us a pointer to all of it, the redop does the whole list
+      off_t lo, hi;
+      memcpy(&lo, entries, sizeof(off_t));
+      hi = lo;
+      for(size_t i = 1; i < count; i++) {
+	off_t elem_offset;
+	memcpy(&elem_offset, entries + (i * redop->sizeof_list_entry),
+	       sizeof(off_t));
+	if(elem_offset < lo) lo = elem_offset;
+	if(elem_offset > hi) hi = elem_offset;
+      }
+
+      // other lists may be applied to the same elements at the same time,
+      //  so use the redop's atomic (non-exclusive) form
+      void *base = get_direct_ptr(offset + lo, (hi - lo) + elem_size);
+      if(base != 0) {
+	if(red_fold)
+	  redop->fold_list_entry(base, entries, count, lo,
+				 false /*!exclusive*/);
+	else
+	  redop->apply_list_entry(base, entries, count, lo,
+				  false /*!exclusive*/);
+	return;
+      }
+
+      // otherwise read-modify-write one element at a time - this is not
+      //  atomic, so lists applied concurrently to this memory (e.g. by
+      //  several RemoteReduceListMessage handlers) take turns
+      AutoHSLLock al(reduction_list_mutex);
+      char *elem_buffer = static_cast<char *>(malloc(elem_size));
+      for(size_t i = 0; i < count; i++) {
+	const char *entry = entries + (i * redop->sizeof_list_entry);
+	off_t elem_offset;
+	memcpy(&elem_offset, entry, sizeof(off_t));
+	get_bytes(offset + elem_offset, elem_buffer, elem_size);
+	if(red_fold)
+	  redop->fold(elem_buffer,
+		      entry + ReductionOpUntyped::LIST_ENTRY_RHS_OFFSET, 1,
+		      true /*exclusive*/);
+	else
+	  redop->apply(elem_buffer,
+		       entry + ReductionOpUntyped::LIST_ENTRY_RHS_OFFSET, 1,
+		       true /*exclusive*/);
+	put_bytes(offset + elem_offset, elem_buffer, elem_size);
+      }
+      free(elem_buffer);
+    }
+
     RegionInstanceImpl *MemoryImpl::get_instance(RegionInstance i)
     {
       ID id(i);
@@ -438,6 +506,7 @@ namespace Realm {
       {
 	AutoHSLLock al(allocator_mutex);
 	ok = allocator.allocate(i, bytes, alignment, offset);
+	update_allocator_gauges();
       }
 
       if(NodeID(ID(i).instance_creator_node()) == my_node_id) {
@@ -491,6 +560,7 @@ namespace Realm {
       if(inst->metadata.inst_offset != size_t(-2)) {
 	AutoHSLLock al(allocator_mutex);
 	allocator.deallocate(inst->me);
+	update_allocator_gauges();
       }
 
       NodeID creator_node = ID(inst->me).instance_creator_node();
@@ -679,6 +749,7 @@ namespace Realm {
       free_blocks[0] = size;
       // tell new allocator about the available memory too
       allocator.add_range(0, size);
+      update_allocator_gauges();
     }
 
     GASNetMemory::~GASNetMemory(void)
@@ -743,30 +814,6 @@ namespace Realm {
       }
     }
 
-    void GASNetMemory::apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-					    size_t count, const void *entry_buffer)
-    {
-      assert(0);
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-      const char *entry = (const char *)entry_buffer;
-      unsigned ptr;
-
-      for(size_t i = 0; i < count; i++)
-      {
-	redop->get_list_pointers(&ptr, entry, 1);
-	//printf("ptr[%d] = %d\n", i, ptr);
-	off_t elem_offset = offset + ptr * redop->sizeof_lhs;
-	off_t blkid = (elem_offset / memory_stride / num_nodes);
-	off_t node = (elem_offset / memory_stride) % num_nodes;
-	off_t blkoffset = elem_offset % memory_stride;
-	assert(node == my_node_id);
-	char *tgt_ptr = ((char *)seginfos[node].addr)+(blkid * memory_stride)+blkoffset;
-	redop->apply_list_entry(tgt_ptr, entry, 1, ptr);
-	entry += redop->sizeof_list_entry;
-      }
-#endif
-    }
-
     void *GASNetMemory::get_direct_ptr(off_t offset, size_t size)
     {
       return 0;  // can't give a pointer to the caller - have to use RDMA
@@ -1008,6 +1055,48 @@ namespace Realm {
   static PartialWriteMap partial_remote_writes;
   static GASNetHSL partial_remote_writes_lock;
 
+  // counts one arriving piece (write, serdez, reduce or reduction list) of
+  //  the RDMA with the given sequence ID, acking the fence if it has already
+  //  arrived and this was the last piece
+  static void record_partial_remote_write(NodeID sender, unsigned sequence_id)
+  {
+    PartialWriteKey key;
+    key.sender = sender;
+    key.sequence_id = sequence_id;
+    AutoHSLLock al(partial_remote_writes_lock);
+    PartialWriteMap::iterator it = partial_remote_writes.find(key);
+    if(it == partial_remote_writes.end()) {
+      // first reference to this one
+      PartialWriteEntry entry;
+      entry.fence = 0;
+      entry.remaining_count = -1;
+      partial_remote_writes[key] = entry;
+#ifdef DEBUG_PWT
+      printf("PWT: %d: new entry for %d/%d: %p, %d\n",
+	     my_node_id, key.sender, key.sequence_id,
+	     entry.fence, entry.remaining_count);
+#endif
+    } else {
+      // have an existing entry (either another write or the fence)
+      PartialWriteEntry& entry = it->second;
+#ifdef DEBUG_PWT
+      printf("PWT: %d: have entry for %d/%d: %p, %d -> %d\n",
+	     my_node_id, key.sender, key.sequence_id,
+	     entry.fence,
+	     entry.remaining_count, entry.remaining_count - 1);
+#endif
+      entry.remaining_count--;
+      if(entry.remaining_count == 0) {
+	// we're the last write, and we've already got the fence, so
+	//  respond
+	ActiveMessage<RemoteWriteFenceAckMessage> amsg(sender);
+	amsg->fence = entry.fence;
+	amsg.commit();
+	partial_remote_writes.erase(it);
+      }
+    }
+  }
+
   /*static*/ void RemoteWriteMessage::handle_message(NodeID sender, const RemoteWriteMessage &args,
 						     const void *data,
 						     size_t datalen)
@@ -1052,46 +1141,8 @@ namespace Realm {
       impl->put_bytes(args.offset, data, datalen);
 
     // track the sequence ID to know when the full RDMA is done
-    if(args.sequence_id > 0) {
-      PartialWriteKey key;
-      key.sender = sender;
-      key.sequence_id = args.sequence_id;
-      partial_remote_writes_lock.lock();
-      PartialWriteMap::iterator it = partial_remote_writes.find(key);
-      if(it == partial_remote_writes.end()) {
-	// first reference to this one
-	PartialWriteEntry entry;
-	entry.fence = 0;
-	entry.remaining_count = -1;
-	partial_remote_writes[key] = entry;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: new entry for %d/%d: %p, %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence, entry.remaining_count);
-#endif
-      } else {
-	// have an existing entry (either another write or the fence)
-	PartialWriteEntry& entry = it->second;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: have entry for %d/%d: %p, %d -> %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence,
-	       entry.remaining_count, entry.remaining_count - 1);
-#endif
-	entry.remaining_count--;
-	if(entry.remaining_count == 0) {
-	  // we're the last write, and we've already got the fence, so 
-	  //  respond
-	  ActiveMessage<RemoteWriteFenceAckMessage> amsg(sender);
-	  amsg->fence = entry.fence;
-	  amsg.commit();
-	  partial_remote_writes.erase(it);
-	  partial_remote_writes_lock.unlock();
-	  return;
-	}
-      }
-      partial_remote_writes_lock.unlock();
-    }
+    if(args.sequence_id > 0)
+      record_partial_remote_write(sender, args.sequence_id);
   }
 
   ////////////////////////////////////////////////////////////////////////
@@ -1120,46 +1171,8 @@ namespace Realm {
     assert(datalen == 0);
 
     // track the sequence ID to know when the full RDMA is done
-    if(args.sequence_id > 0) {
-      PartialWriteKey key;
-      key.sender = sender;
-      key.sequence_id = args.sequence_id;
-      partial_remote_writes_lock.lock();
-      PartialWriteMap::iterator it = partial_remote_writes.find(key);
-      if(it == partial_remote_writes.end()) {
-	// first reference to this one
-	PartialWriteEntry entry;
-	entry.fence = 0;
-	entry.remaining_count = -1;
-	partial_remote_writes[key] = entry;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: new entry for %d/%d: %p, %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence, entry.remaining_count);
-#endif
-      } else {
-	// have an existing entry (either another write or the fence)
-	PartialWriteEntry& entry = it->second;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: have entry for %d/%d: %p, %d -> %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence,
-	       entry.remaining_count, entry.remaining_count - 1);
-#endif
-	entry.remaining_count--;
-	if(entry.remaining_count == 0) {
-	  // we're the last write, and we've already got the fence, so
-	  //  respond
-	  ActiveMessage<RemoteWriteFenceAckMessage> amsg(sender);
-	  amsg->fence = entry.fence;
-	  amsg.commit();
-	  partial_remote_writes.erase(it);
-	  partial_remote_writes_lock.unlock();
-	  return;
-	}
-      }
-      partial_remote_writes_lock.unlock();
-    }
+    if(args.sequence_id > 0)
+      record_partial_remote_write(sender, args.sequence_id);
   }
 
   ////////////////////////////////////////////////////////////////////////
@@ -1263,46 +1276,8 @@ namespace Realm {
     }
 
     // track the sequence ID to know when the full RDMA is done
-    if(args.sequence_id > 0) {
-      PartialWriteKey key;
-      key.sender = sender;
-      key.sequence_id = args.sequence_id;
-      partial_remote_writes_lock.lock();
-      PartialWriteMap::iterator it = partial_remote_writes.find(key);
-      if(it == partial_remote_writes.end()) {
-	// first reference to this one
-	PartialWriteEntry entry;
-	entry.fence = 0;
-	entry.remaining_count = -1;
-	partial_remote_writes[key] = entry;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: new entry for %d/%d: %p, %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence, entry.remaining_count);
-#endif
-      } else {
-	// have an existing entry (either another write or the fence)
-	PartialWriteEntry& entry = it->second;
-#ifdef DEBUG_PWT
-	printf("PWT: %d: have entry for %d/%d: %p, %d -> %d\n",
-	       my_node_id, key.sender, key.sequence_id,
-	       entry.fence,
-	       entry.remaining_count, entry.remaining_count - 1);
-#endif
-	entry.remaining_count--;
-	if(entry.remaining_count == 0) {
-	  // we're the last write, and we've already got the fence, so 
-	  //  respond
-	  ActiveMessage<RemoteWriteFenceAckMessage> amsg(sender);
-	  amsg->fence = entry.fence;
-	  amsg.commit();
-	  partial_remote_writes.erase(it);
-	  partial_remote_writes_lock.unlock();
-	  return;
-	}
-      }
-      partial_remote_writes_lock.unlock();
-    }
+    if(args.sequence_id > 0)
+      record_partial_remote_write(sender, args.sequence_id);
   }
 
   
@@ -1317,27 +1292,25 @@ namespace Realm {
   {
     MemoryImpl *impl = get_runtime()->get_memory_impl(args.mem);
     
-    log_copy.debug("received remote reduction list request: mem=" IDFMT ", offset=%zd, size=%zd, redopid=%d",
-		   args.mem.id, (ssize_t)args.offset, datalen, args.redopid);
-
-    switch(impl->kind) {
-    case MemoryImpl::MKIND_SYSMEM:
-    case MemoryImpl::MKIND_ZEROCOPY:
-    case MemoryImpl::MKIND_GPUFB:
-    default:
-      assert(0);
-
-    case MemoryImpl::MKIND_GLOBAL:
-      {
-	const ReductionOpUntyped *redop = get_runtime()->reduce_op_table.get(args.redopid, 0);
-	assert(redop != 0);
-	assert((datalen % redop->sizeof_list_entry) == 0);
-	impl->apply_reduction_list(args.offset,
-				   redop,
-				   datalen / redop->sizeof_list_entry,
-				   data);
-      }
+    log_copy.debug("received remote reduction list request: mem=" IDFMT ", offset=%zd, size=%zd, redopid=%d, fold=%d",
+		   args.mem.id, (ssize_t)args.offset, datalen, args.redopid,
+		   args.red_fold);
+
+    const ReductionOpUntyped *redop = get_runtime()->reduce_op_table.get(args.redopid, 0);
+    if(redop == 0) {
+      log_copy.fatal() << "no reduction op registered for ID " << args.redopid;
+      abort();
     }
+    assert((datalen % redop->sizeof_list_entry) == 0);
+    impl->apply_reduction_list(args.offset,
+			       redop,
+			       datalen / redop->sizeof_list_entry,
+			       data,
+			       args.red_fold);
+
+    // track the sequence ID to know when the full RDMA is done
+    if(args.sequence_id > 0)
+      record_partial_remote_write(sender, args.sequence_id);
   }
   
 
@@ -1845,16 +1818,20 @@ namespace Realm {
       }
     }
 
-    void do_remote_apply_red_list(int node, Memory mem, off_t offset,
-				  ReductionOpID redopid,
-				  const void *data, size_t datalen)
+    unsigned do_remote_apply_red_list(int node, Memory mem, off_t offset,
+				      ReductionOpID redopid, bool red_fold,
+				      const void *data, size_t datalen,
+				      unsigned sequence_id)
     {
       ActiveMessage<RemoteReduceListMessage> amsg(node, datalen);
       amsg->mem = mem;
       amsg->offset = offset;
       amsg->redopid = redopid;
+      amsg->red_fold = red_fold;
+      amsg->sequence_id = sequence_id;
       amsg.add_payload(data, datalen);
       amsg.commit();
+      return 1;
     }
 
     void do_remote_fence(Memory mem, unsigned sequence_id, unsigned num_writes,
@@ -53,8 +53,10 @@ namespace Realm {
 
     std::map<TT, Range *> allocated;  // direct lookup of allocated ranges by tag
     std::map<RT, Range *> by_first;   // direct lookup of all ranges by first
+    // free ranges ordered by (size, first) for best-fit lookup
+    std::map<std::pair<RT, RT>, Range *> free_by_size;
+    RT free_total;  // sum of the sizes of all free ranges
     Range sentinel;
-    // TODO: sized-based lookup of free ranges
 
     BasicRangeAllocator(void);
     ~BasicRangeAllocator(void);
@@ -62,6 +64,17 @@ namespace Realm {
     void add_range(RT first, RT last);
     bool allocate(TT tag, RT size, RT alignment, RT& first);
     void deallocate(TT tag);
+
+    // fragmentation statistics
+    size_t num_free_ranges(void) const;
+    RT largest_free_range(void) const;
+    RT total_free(void) const;
+
+  protected:
+    // a free range must be removed from the size index before its bounds
+    //  are changed and re-added afterwards
+    void add_free_range(Range *r);
+    void remove_free_range(Range *r);
   };
   
     class MemoryImpl {
@@ -129,11 +142,11 @@ namespace Realm {
       virtual void get_bytes(off_t offset, void *dst, size_t size) = 0;
       virtual void put_bytes(off_t offset, const void *src, size_t size) = 0;
 
+      // applies (or folds, if 'red_fold') a reduction list (see
+      //  ReductionOpUntyped) whose entry offsets are relative to 'offset'
       virtual void apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-					size_t count, const void *entry_buffer)
-      {
-	assert(0);
-      }
+					size_t count, const void *entry_buffer,
+					bool red_fold);
 
       virtual void *get_direct_ptr(off_t offset, size_t size) = 0;
       virtual int get_home_node(off_t offset, size_t size) = 0;
@@ -164,8 +177,16 @@ namespace Realm {
       GASNetHSL mutex; // protection for resizing vectors
       std::map<off_t, off_t> free_blocks;
       GASNetHSL allocator_mutex;
+      // serializes reduction lists applied without a direct pointer
+      GASNetHSL reduction_list_mutex;
       BasicRangeAllocator<size_t, RegionInstance> allocator;
       ProfilingGauges::AbsoluteGauge<size_t> usage, peak_usage, peak_footprint;
+      // fragmentation of the allocator's free space
+      ProfilingGauges::AbsoluteGauge<size_t> free_ranges, largest_free_range;
+
+    protected:
+      // call while holding allocator_mutex
+      void update_allocator_gauges(void);
     };
 
     class LocalCPUMemory : public MemoryImpl {
@@ -208,9 +229,6 @@ namespace Realm {
 
       virtual void put_bytes(off_t offset, const void *src, size_t size);
 
-      virtual void apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-					size_t count, const void *entry_buffer);
-
       virtual void *get_direct_ptr(off_t offset, size_t size);
       virtual int get_home_node(off_t offset, size_t size);
 
@@ -245,9 +263,6 @@ namespace Realm {
 
       virtual void put_bytes(off_t offset, const void *src, size_t size);
 
-      virtual void apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-                                       size_t count, const void *entry_buffer);
-
       virtual void *get_direct_ptr(off_t offset, size_t size);
       virtual int get_home_node(off_t offset, size_t size);
 
@@ -274,9 +289,6 @@ namespace Realm {
       virtual void put_bytes(off_t offset, const void *src, size_t size);
       void put_bytes(ID::IDType inst_id, off_t offset, const void *src, size_t size);
 
-      virtual void apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-                                       size_t count, const void *entry_buffer);
-
       virtual void *get_direct_ptr(off_t offset, size_t size);
       virtual int get_home_node(off_t offset, size_t size);
 
@@ -419,6 +431,8 @@ namespace Realm {
       Memory mem;
       off_t offset;
       ReductionOpID redopid;
+      bool red_fold;
+      unsigned sequence_id;
 
       static void handle_message(NodeID sender, const RemoteReduceListMessage &msg,
 				 const void *data, size_t datalen);
@@ -462,7 +476,7 @@ namespace Realm {
 				     bool make_copy = false);				     
 
     extern unsigned do_remote_apply_red_list(int node, Memory mem, off_t offset,
-					     ReductionOpID redopid,
+					     ReductionOpID redopid, bool red_fold,
 					     const void *data, size_t datalen,
 					     unsigned sequence_id);
 
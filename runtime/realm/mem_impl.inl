@@ -37,7 +37,8 @@ namespace Realm {
 
   template <typename RT, typename TT>
   inline BasicRangeAllocator<RT,TT>::BasicRangeAllocator(void)
-    : sentinel((RT)-1,0)
+    : free_total(0)
+    , sentinel((RT)-1,0)
   {
     // sentinel is the start and end of both dllists
     sentinel.prev = sentinel.next = &sentinel;
@@ -76,11 +77,49 @@ namespace Realm {
       // free block list
       newr->prev_free = prev_free; newr->next_free = prev_free->next_free;
       prev_free->next_free = newr->next_free->prev_free = newr;
+      add_free_range(newr);
       return;
     }
 
     assert(0);
   }
+
+  template <typename RT, typename TT>
+  inline void BasicRangeAllocator<RT,TT>::add_free_range(Range *r)
+  {
+    free_by_size[std::make_pair(r->last - r->first, r->first)] = r;
+    free_total += (r->last - r->first);
+  }
+
+  template <typename RT, typename TT>
+  inline void BasicRangeAllocator<RT,TT>::remove_free_range(Range *r)
+  {
+    typename std::map<std::pair<RT, RT>, Range *>::iterator it =
+      free_by_size.find(std::make_pair(r->last - r->first, r->first));
+    assert((it != free_by_size.end()) && (it->second == r));
+    free_by_size.erase(it);
+    free_total -= (r->last - r->first);
+  }
+
+  template <typename RT, typename TT>
+  inline size_t BasicRangeAllocator<RT,TT>::num_free_ranges(void) const
+  {
+    return free_by_size.size();
+  }
+
+  template <typename RT, typename TT>
+  inline RT BasicRangeAllocator<RT,TT>::largest_free_range(void) const
+  {
+    if(free_by_size.empty())
+      return 0;
+    return free_by_size.rbegin()->first.first;
+  }
+
+  template <typename RT, typename TT>
+  inline RT BasicRangeAllocator<RT,TT>::total_free(void) const
+  {
+    return free_total;
+  }
    
   template <typename RT, typename TT>
   inline bool BasicRangeAllocator<RT,TT>::allocate(TT tag, RT size, RT alignment, RT& alloc_first)
@@ -91,9 +130,13 @@ namespace Realm {
       return true;
     }
 
-    // walk free ranges and just take the first that fits
-    Range *r = sentinel.next_free;
-    while(r != &sentinel) {
+    // best fit - walk free ranges in increasing size order, starting with
+    //  the smallest that could hold the request, and take the first that
+    //  fits once alignment is accounted for
+    typename std::map<std::pair<RT, RT>, Range *>::iterator it =
+      free_by_size.lower_bound(std::make_pair(size, RT(0)));
+    while(it != free_by_size.end()) {
+      Range *r = it->second;
       RT ofs = 0;
       if(alignment) {
 	RT rem = r->first % alignment;
@@ -103,6 +146,7 @@ namespace Realm {
       // do we have enough space?
       if((r->last - r->first) >= (size + ofs)) {
 	// yes, but we may need chop things up to make the exact range we want
+	remove_free_range(r);
 	alloc_first = r->first + ofs;
 	RT alloc_last = alloc_first + size;
 
@@ -117,6 +161,7 @@ namespace Realm {
           new_prev->prev_free->next_free = new_prev;
           new_prev->next_free = r;
           r->prev_free = new_prev;
+          add_free_range(new_prev);
         }
 
 	// four cases to deal with
@@ -153,6 +198,7 @@ namespace Realm {
 	    r->prev_free->next_free = r_after;
 	    r->next_free->prev_free = r_after;
 	    r->prev_free = r->next_free = 0;
+	    add_free_range(r_after);
 
 	    allocated[tag] = r;
 	    return true;
@@ -164,7 +210,7 @@ namespace Realm {
       }
 
       // no, go to next one
-      r = r->next_free;
+      ++it;
     }
     // allocation failed
     return false;
@@ -206,10 +252,12 @@ namespace Realm {
 	// case 1 - no merging (exact match)
 	r->prev_free = prev_free; r->next_free = next_free;
 	prev_free->next_free = next_free->prev_free = r;
+	add_free_range(r);
       } else {
 	// case 2 - merge before
 	Range *old_prev = r->prev;
 	assert(r->first == old_prev->last);
+	remove_free_range(old_prev);
 	by_first.erase(r->first);
 	r->first = old_prev->first;
 	by_first[r->first] = r;
@@ -223,7 +271,7 @@ namespace Realm {
 	r->prev_free->next_free = r;
 	r->next_free = old_prev->next_free;
 	r->next_free->prev_free = r;
-
+	add_free_range(r);
 
 	delete old_prev;
       }
@@ -232,6 +280,7 @@ namespace Realm {
 	// case 3 - merge after
 	Range *old_next = r->next;
 	assert(r->last == old_next->first);
+	remove_free_range(old_next);
 	r->last = old_next->last;
 	by_first.erase(old_next->first);
 
@@ -244,6 +293,7 @@ namespace Realm {
 	r->prev_free->next_free = r;
 	r->next_free = old_next->next_free;
 	r->next_free->prev_free = r;
+	add_free_range(r);
 
 	delete old_next;
       } else {
@@ -251,12 +301,14 @@ namespace Realm {
 	
 	Range *old_prev = r->prev;
 	assert(r->first == old_prev->last);
+	remove_free_range(old_prev);
 	by_first.erase(r->first);
 	r->first = old_prev->first;
 	by_first[r->first] = r;
 
 	Range *old_next = r->next;
 	assert(r->last == old_next->first);
+	remove_free_range(old_next);
 	r->last = old_next->last;
 	by_first.erase(old_next->first);
 
@@ -266,6 +318,7 @@ namespace Realm {
 
 	r->prev_free = old_prev->prev_free; r->prev_free->next_free = r;
 	r->next_free = old_next->next_free; r->next_free->prev_free = r;
+	add_free_range(r);
 
 	delete old_prev;
 	delete old_next;
@@ -23,6 +23,8 @@
 #include "realm/runtime_impl.h"
 #include "realm/utils.h"
 
+#include <algorithm>
+
 namespace Realm {
 
   Logger log_numa("numa");
@@ -96,6 +98,10 @@ namespace Realm {
       , cfg_numa_nocpu_mem_size(-1)
       , cfg_num_numa_cpus(0)
       , cfg_pin_memory(false)
+      , cfg_touch_memory(1)
+      , cfg_bind_cpu_procs(1)
+      , cfg_measure_affinity(false)
+      , cfg_measure_size(64 << 20)
       , cfg_stack_size(2 << 20)
     {
     }
@@ -117,7 +123,11 @@ namespace Realm {
 	cp.add_option_int_units("-ll:nsize", m->cfg_numa_mem_size, 'm')
 	  .add_option_int_units("-ll:ncsize", m->cfg_numa_nocpu_mem_size, 'm')
 	  .add_option_int("-ll:ncpu", m->cfg_num_numa_cpus)
-	  .add_option_bool("-numa:pin", m->cfg_pin_memory);
+	  .add_option_bool("-numa:pin", m->cfg_pin_memory)
+	  .add_option_int("-numa:touch", m->cfg_touch_memory)
+	  .add_option_int("-numa:bindcpu", m->cfg_bind_cpu_procs)
+	  .add_option_bool("-numa:measure", m->cfg_measure_affinity)
+	  .add_option_int_units("-numa:msize", m->cfg_measure_size, 'm');
 	
 	bool ok = cp.parse_command_line(cmdline);
 	if(!ok) {
@@ -183,6 +193,7 @@ namespace Realm {
 	  ++it) {
 	const NumaNodeCpuInfo& ci = it->second;
 	log_numa.info() << "NUMA cpu node " << ci.node_id << ": " << ci.cores_available << " cores";
+	m->numa_cpu_cores[ci.node_id] = ci.cores_available;
 	if(ci.cores_available >= m->cfg_num_numa_cpus) {
 	  m->numa_cpu_counts[ci.node_id] = m->cfg_num_numa_cpus;
 	} else {
@@ -215,7 +226,42 @@ namespace Realm {
 	  assert(false);
 	}
 	it->second = base;
+
+	// fault the pool in from the cpus of its own node so that the pages
+	//  are zeroed there rather than by whoever first writes them (pinned
+	//  memory has already been faulted in by mlock)
+	if(cfg_touch_memory && !cfg_pin_memory) {
+	  int cpu_node = (numa_cpu_counts.count(it->first) > 0) ? it->first : -1;
+	  if(!numasysif_touch_mem(cpu_node, base, mem_size))
+	    log_numa.warning() << "failed to touch memory in NUMA node " << it->first
+			       << " from its own cpus";
+	}
       }
+
+      // optionally replace the distance-based guesses with measurements taken
+      //  from a thread on each cpu node against the head of each memory node
+      if(cfg_measure_affinity)
+	for(std::map<int, int>::const_iterator it = numa_cpu_counts.begin();
+	    it != numa_cpu_counts.end();
+	    ++it)
+	  for(std::map<int, void *>::const_iterator it2 = numa_mem_bases.begin();
+	      it2 != numa_mem_bases.end();
+	      ++it2) {
+	    size_t bytes = std::min(cfg_measure_size,
+				    numa_mem_sizes[it2->first]);
+	    MeasuredAffinity ma;
+	    if(numasysif_measure_mem(it->first, it2->second, bytes,
+				     ma.bandwidth, ma.latency)) {
+	      log_numa.info() << "NUMA cpu node " << it->first
+			      << " -> mem node " << it2->first
+			      << ": bw=" << ma.bandwidth << " B/ns latency="
+			      << ma.latency << " ns";
+	      measured_affinities[std::make_pair(it->first, it2->first)] = ma;
+	    } else
+	      log_numa.warning() << "failed to measure NUMA cpu node " << it->first
+				 << " -> mem node " << it2->first
+				 << " - using kernel-reported distance";
+	  }
     }
 
     // create any memories provided by this module (default == do nothing)
@@ -251,10 +297,51 @@ namespace Realm {
     {
       Module::create_processors(runtime);
 
+      // spread the -ll:cpu processors (the core module has already created
+      //  them) over the nodes that have a memory pool and cores to spare, so
+      //  that each has a local pool - any left over stay unbound
+      if(cfg_bind_cpu_procs) {
+	std::vector<int> cpu_nodes;
+	std::map<int, int> spare_cores;
+	for(std::map<int, int>::const_iterator it = numa_cpu_cores.begin();
+	    it != numa_cpu_cores.end();
+	    ++it)
+	  if((numa_mem_bases.count(it->first) > 0) &&
+	     (it->second > numa_cpu_counts[it->first])) {
+	    cpu_nodes.push_back(it->first);
+	    spare_cores[it->first] = it->second - numa_cpu_counts[it->first];
+	  }
+
+	size_t next_node = 0;
+	std::vector<ProcessorImpl *>& local_procs = runtime->nodes[my_node_id].processors;
+	for(std::vector<ProcessorImpl *>::iterator it = local_procs.begin();
+	    it != local_procs.end();
+	    ++it) {
+	  LocalCPUProcessor *cpu = dynamic_cast<LocalCPUProcessor *>(*it);
+	  if(!cpu) continue;
+	  // find the next node (in round-robin order) with a core to spare
+	  int cpu_node = -1;
+	  for(size_t i = 0; (i < cpu_nodes.size()) && (cpu_node < 0); i++) {
+	    int n = cpu_nodes[(next_node + i) % cpu_nodes.size()];
+	    if(spare_cores[n] > 0) {
+	      cpu_node = n;
+	      next_node = (next_node + i + 1) % cpu_nodes.size();
+	    }
+	  }
+	  if(cpu_node < 0) {
+	    log_numa.info() << "no NUMA node has a core to spare for " << cpu->me;
+	    continue;
+	  }
+	  spare_cores[cpu_node]--;
+	  cpu->set_numa_domain(cpu_node);
+	  log_numa.info() << "cpu proc " << cpu->me << " bound to NUMA node " << cpu_node;
+	  add_cpu_affinities(runtime, cpu->me, cpu_node);
+	}
+      }
+
       for(std::map<int, int>::const_iterator it = numa_cpu_counts.begin();
 	  it != numa_cpu_counts.end();
 	  ++it) {
-	int cpu_node = it->first;
 	for(int i = 0; i < it->second; i++) {
 	  Processor p = runtime->next_local_processor_id();
 	  ProcessorImpl *pi = new LocalNumaProcessor(p, it->first,
@@ -263,52 +350,77 @@ namespace Realm {
 						     Config::force_kernel_threads);
 	  runtime->add_processor(pi);
 
-	  // create affinities between this processor and system/reg memories
-	  // if the memory is one we created, use the kernel-reported distance
-	  // to adjust the answer
-	  std::vector<MemoryImpl *>& local_mems = runtime->nodes[my_node_id].memories;
-	  for(std::vector<MemoryImpl *>::iterator it2 = local_mems.begin();
-	      it2 != local_mems.end();
-	      ++it2) {
-	    Memory::Kind kind = (*it2)->get_kind();
-	    if((kind != Memory::SYSTEM_MEM) && (kind != Memory::REGDMA_MEM) &&
-               (kind != Memory::SOCKET_MEM) && (kind != Memory::Z_COPY_MEM))
-	      continue;
-
-	    Machine::ProcessorMemoryAffinity pma;
-	    pma.p = p;
-	    pma.m = (*it2)->me;
-
-            if (kind == Memory::SOCKET_MEM) {
-              LocalCPUMemory *cpu_mem = static_cast<LocalCPUMemory*>(*it2);
-              int mem_node = cpu_mem->numa_node;
-              assert(mem_node != -1);
-              int d = numasysif_get_distance(cpu_node, mem_node);
-	      if(d >= 0) {
-		pma.bandwidth = 150 - d;
-		pma.latency = d / 10;     // Linux uses a cost of ~10/hop
-	      } else {
-		// same as random sysmem
-		pma.bandwidth = 100;
-		pma.latency = 5;
-	      }
-            } else if(kind == Memory::SYSTEM_MEM) {
-	      // not one of our memories - use the same made-up numbers as in
-	      //  runtime_impl.cc
-              pma.bandwidth = 100;  // "large"
-              pma.latency = 5;      // "small"
-            } else if (kind == Memory::Z_COPY_MEM) {
-              pma.bandwidth = 40; // "large"
-              pma.latency = 3; // "small"
-            } else {
-              // Regdma_mem
-              pma.bandwidth = 80;   // "large"
-              pma.latency = 10;     // "small"
-            }
-	    
-	    runtime->add_proc_mem_affinity(pma);
+	  add_cpu_affinities(runtime, p, it->first);
+	}
+      }
+    }
+
+    // create affinities between this processor and system/reg memories
+    // if the memory is one we created, use the measured or kernel-reported
+    // distance to adjust the answer
+    void NumaModule::add_cpu_affinities(RuntimeImpl *runtime, Processor p,
+					int cpu_node)
+    {
+      // measured numbers are scaled so that the best pair matches the 150/1
+      //  that a local distance of 10 would have produced
+      double max_bw = 0, min_latency = 0;
+      for(std::map<std::pair<int, int>, MeasuredAffinity>::const_iterator it =
+	    measured_affinities.begin();
+	  it != measured_affinities.end();
+	  ++it) {
+	if(it->second.bandwidth > max_bw)
+	  max_bw = it->second.bandwidth;
+	if((min_latency == 0) || (it->second.latency < min_latency))
+	  min_latency = it->second.latency;
+      }
+
+      std::vector<MemoryImpl *>& local_mems = runtime->nodes[my_node_id].memories;
+      for(std::vector<MemoryImpl *>::iterator it2 = local_mems.begin();
+	  it2 != local_mems.end();
+	  ++it2) {
+	Memory::Kind kind = (*it2)->get_kind();
+	if((kind != Memory::SYSTEM_MEM) && (kind != Memory::REGDMA_MEM) &&
+	   (kind != Memory::SOCKET_MEM) && (kind != Memory::Z_COPY_MEM))
+	  continue;
+
+	Machine::ProcessorMemoryAffinity pma;
+	pma.p = p;
+	pma.m = (*it2)->me;
+
+	if (kind == Memory::SOCKET_MEM) {
+	  LocalCPUMemory *cpu_mem = static_cast<LocalCPUMemory*>(*it2);
+	  int mem_node = cpu_mem->numa_node;
+	  assert(mem_node != -1);
+	  int d = numasysif_get_distance(cpu_node, mem_node);
+	  std::map<std::pair<int, int>, MeasuredAffinity>::const_iterator
+	    ma = measured_affinities.find(std::make_pair(cpu_node, mem_node));
+	  if((ma != measured_affinities.end()) &&
+	     (max_bw > 0) && (min_latency > 0)) {
+	    pma.bandwidth = 50 + (unsigned)(100 * ma->second.bandwidth / max_bw + 0.5);
+	    pma.latency = (unsigned)(ma->second.latency / min_latency + 0.5);
+	  } else if(d >= 0) {
+	    pma.bandwidth = 150 - d;
+	    pma.latency = d / 10;     // Linux uses a cost of ~10/hop
+	  } else {
+	    // same as random sysmem
+	    pma.bandwidth = 100;
+	    pma.latency = 5;
 	  }
+	} else if(kind == Memory::SYSTEM_MEM) {
+	  // not one of our memories - use the same made-up numbers as in
+	  //  runtime_impl.cc
+	  pma.bandwidth = 100;  // "large"
+	  pma.latency = 5;      // "small"
+	} else if (kind == Memory::Z_COPY_MEM) {
+	  pma.bandwidth = 40; // "large"
+	  pma.latency = 3; // "small"
+	} else {
+	  // Regdma_mem
+	  pma.bandwidth = 80;   // "large"
+	  pma.latency = 10;     // "small"
 	}
+
+	runtime->add_proc_mem_affinity(pma);
       }
     }
     
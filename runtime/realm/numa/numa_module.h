@@ -57,18 +57,36 @@ namespace Realm {
       //  after all memories/processors/etc. have been shut down and destroyed
       virtual void cleanup(void);
 
+    protected:
+      // adds affinities between a processor whose core comes from 'cpu_node'
+      //  and the local system/NUMA memories
+      void add_cpu_affinities(RuntimeImpl *runtime, Processor p, int cpu_node);
+
     public:
       size_t cfg_numa_mem_size;
       ssize_t cfg_numa_nocpu_mem_size;
       int cfg_num_numa_cpus;
       bool cfg_pin_memory;
+      int cfg_touch_memory;
+      int cfg_bind_cpu_procs;
+      bool cfg_measure_affinity;
+      size_t cfg_measure_size;
       size_t cfg_stack_size;
 
+      // bandwidth (bytes/ns) and latency (ns) measured from a cpu node to a
+      //  memory node when -numa:measure is given
+      struct MeasuredAffinity {
+	double bandwidth;
+	double latency;
+      };
+
       // "global" variables live here too
       std::map<int, void *> numa_mem_bases;
       std::map<int, size_t> numa_mem_sizes;
       std::map<int, int> numa_cpu_counts;
+      std::map<int, int> numa_cpu_cores;
       std::map<int, MemoryImpl *> memories;
+      std::map<std::pair<int, int>, MeasuredAffinity> measured_affinities;
     };
 
     REGISTER_REALM_MODULE(NumaModule);
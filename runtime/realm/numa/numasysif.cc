@@ -36,6 +36,8 @@
 #include <sched.h>
 #include <ctype.h>
 #include <sys/mman.h>
+#include <pthread.h>
+#include <time.h>
 
 namespace {
   long get_mempolicy(int *policy, unsigned long *nmask,
@@ -387,4 +389,195 @@ namespace Realm {
 #endif
   }
 
+  // bind the calling thread to the cpus of a given NUMA node (restricted to
+  //  those in the current affinity mask)
+  bool numasysif_bind_thread(int node)
+  {
+#ifdef __linux__
+    cpu_set_t avail_cpus, node_cpus;
+    int ret = sched_getaffinity(0, sizeof(avail_cpus), &avail_cpus);
+    if(ret != 0) {
+      fprintf(stderr, "sched_getaffinity failed: %s\n", strerror(errno));
+      return false;
+    }
+    CPU_ZERO(&node_cpus);
+    int count = 0;
+    for(int i = 0; i < CPU_SETSIZE; i++)
+      if(CPU_ISSET(i, &avail_cpus)) {
+	char path[256];
+	sprintf(path, "/sys/devices/system/cpu/cpu%d/node%d", i, node);
+	if(access(path, F_OK) == 0) {
+	  CPU_SET(i, &node_cpus);
+	  count++;
+	}
+      }
+    if(count == 0)
+      return false;
+    ret = sched_setaffinity(0, sizeof(node_cpus), &node_cpus);
+    if(ret != 0) {
+      fprintf(stderr, "failed to bind thread to node %d: %s\n", node, strerror(errno));
+      return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+#ifdef __linux__
+  namespace {
+    struct TouchArgs {
+      int cpu_node;
+      void *base;
+      size_t bytes;
+      bool ok;
+    };
+
+    void *touch_thread(void *data)
+    {
+      TouchArgs *args = static_cast<TouchArgs *>(data);
+      if(args->cpu_node >= 0) {
+	args->ok = numasysif_bind_thread(args->cpu_node);
+	if(!args->ok)
+	  return 0;
+      }
+      // one write per page is enough to fault it in
+      const size_t page_size = sysconf(_SC_PAGESIZE);
+      volatile char *p = static_cast<volatile char *>(args->base);
+      for(size_t ofs = 0; ofs < args->bytes; ofs += page_size)
+	p[ofs] = 0;
+      args->ok = true;
+      return 0;
+    }
+  };
+#endif
+
+  // fault in every page of the given memory from a thread bound to the cpus of
+  //  'cpu_node' (or from an unbound thread if 'cpu_node' is negative)
+  bool numasysif_touch_mem(int cpu_node, void *base, size_t bytes)
+  {
+#ifdef __linux__
+    // use a separate thread so the caller's affinity mask is left alone
+    TouchArgs args;
+    args.cpu_node = cpu_node;
+    args.base = base;
+    args.bytes = bytes;
+    args.ok = false;
+    pthread_t thread;
+    int ret = pthread_create(&thread, 0, touch_thread, &args);
+    if(ret != 0) {
+      fprintf(stderr, "failed to create touch thread: %s\n", strerror(ret));
+      return false;
+    }
+    pthread_join(thread, 0);
+    return args.ok;
+#else
+    return false;
+#endif
+  }
+
+#ifdef __linux__
+  namespace {
+    struct MeasureArgs {
+      int cpu_node;
+      void *base;
+      size_t bytes;
+      bool ok;
+      double bandwidth, latency;
+    };
+
+    long long measure_now(void)
+    {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+    }
+
+    void *measure_thread(void *data)
+    {
+      MeasureArgs *args = static_cast<MeasureArgs *>(data);
+      args->ok = numasysif_bind_thread(args->cpu_node);
+      if(!args->ok)
+	return 0;
+
+      // fault the pages in from this thread (placement is already fixed by
+      //  the bind policy, so this only keeps page faults out of the timing)
+      memset(args->base, 0, args->bytes);
+
+      // streaming read - best of a few passes
+      const size_t words = args->bytes / sizeof(size_t);
+      volatile size_t *vp = static_cast<volatile size_t *>(args->base);
+      double best_bw = 0;
+      for(int rep = 0; rep < 3; rep++) {
+	long long t1 = measure_now();
+	size_t sum = 0;
+	for(size_t i = 0; i < words; i++)
+	  sum += vp[i];
+	long long t2 = measure_now();
+	if(sum != 0) args->ok = false;  // keeps the loop from being elided
+	double bw = (double)(words * sizeof(size_t)) / ((t2 > t1) ? (t2 - t1) : 1);
+	if(bw > best_bw) best_bw = bw;
+      }
+      args->bandwidth = best_bw;
+
+      // dependent loads through a full-period LCG permutation of cache-line
+      //  slots, which defeats the stride prefetchers
+      size_t slots = 1;
+      while((slots << 1) <= (args->bytes >> 6)) slots <<= 1;
+      const size_t stride = 64 / sizeof(void *);
+      void **ptrs = static_cast<void **>(args->base);
+      size_t cur = 0;
+      for(size_t i = 0; i < slots; i++) {
+	size_t next = (cur * 1103515245 + 12345) & (slots - 1);
+	ptrs[cur * stride] = &ptrs[next * stride];
+	cur = next;
+      }
+      size_t steps = (slots < (1 << 20)) ? slots : (1 << 20);
+      void **p = ptrs;
+      long long t1 = measure_now();
+      for(size_t i = 0; i < steps; i++)
+	p = static_cast<void **>(*(void * volatile *)p);
+      long long t2 = measure_now();
+      if(!p) args->ok = false;
+      args->latency = (double)(t2 - t1) / steps;
+
+      memset(args->base, 0, args->bytes);
+      return 0;
+    }
+  };
+#endif
+
+  // measure the streaming read bandwidth (bytes/ns) and dependent-load latency
+  //  (ns) seen by a thread bound to 'cpu_node' when accessing the given memory
+  bool numasysif_measure_mem(int cpu_node, void *base, size_t bytes,
+			     double& bandwidth, double& latency)
+  {
+#ifdef __linux__
+    if(bytes < 4096)
+      return false;
+    // use a separate thread so the caller's affinity mask is left alone
+    MeasureArgs args;
+    args.cpu_node = cpu_node;
+    args.base = base;
+    args.bytes = bytes;
+    args.ok = false;
+    args.bandwidth = 0;
+    args.latency = 0;
+    pthread_t thread;
+    int ret = pthread_create(&thread, 0, measure_thread, &args);
+    if(ret != 0) {
+      fprintf(stderr, "failed to create measurement thread: %s\n", strerror(ret));
+      return false;
+    }
+    pthread_join(thread, 0);
+    if(!args.ok)
+      return false;
+    bandwidth = args.bandwidth;
+    latency = args.latency;
+    return true;
+#else
+    return false;
+#endif
+  }
+
 };
@@ -63,6 +63,21 @@ namespace Realm {
   // may fail if the memory has already been touched
   bool numasysif_bind_mem(int node, void *base, size_t bytes, bool pin);
 
+  // bind the calling thread to the cpus of a given NUMA node (restricted to
+  //  those in the current affinity mask)
+  bool numasysif_bind_thread(int node);
+
+  // fault in every page of the given memory from a thread bound to the cpus of
+  //  'cpu_node' (or from an unbound thread if 'cpu_node' is negative) - the
+  //  contents of the memory are zeroed
+  bool numasysif_touch_mem(int cpu_node, void *base, size_t bytes);
+
+  // measure the streaming read bandwidth (bytes/ns) and dependent-load latency
+  //  (ns) seen by a thread bound to 'cpu_node' when accessing the given memory -
+  //  the contents of the memory are clobbered (and left zeroed)
+  bool numasysif_measure_mem(int cpu_node, void *base, size_t bytes,
+			     double& bandwidth, double& latency);
+
 };
 
 #endif
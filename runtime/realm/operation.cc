@@ -677,5 +677,6 @@ namespace Realm {
 						data, datalen);
   }
 
+  ActiveMessageHandlerReg<CancelOperationMessage> cancel_operation_message_handler;
 
 }; // namespace Realm
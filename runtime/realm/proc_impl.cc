@@ -571,6 +571,7 @@ namespace Realm {
     ProcessorGroup::ProcessorGroup(void)
       : ProcessorImpl(Processor::NO_PROC, Processor::PROC_GROUP),
 	members_valid(false), members_requested(false), next_free(0)
+      , next_member_queue(0)
       , ready_task_count(0)
     {
       deferred_spawn_cache.clear();
@@ -579,6 +580,14 @@ namespace Realm {
     ProcessorGroup::~ProcessorGroup(void)
     {
       deferred_spawn_cache.flush();
+      for(std::vector<TaskQueue *>::iterator it = member_queues.begin();
+	  it != member_queues.end();
+	  ++it)
+	delete *it;
+      for(std::vector<TaskDeque *>::iterator it = member_deques.begin();
+	  it != member_deques.end();
+	  ++it)
+	delete *it;
       delete ready_task_count;
     }
 
@@ -598,6 +607,23 @@ namespace Realm {
       // can only be done once
       assert(!members_valid);
 
+      // now that we exist, profile our queue depth
+      std::string gname = stringbuilder() << "realm/proc " << me << "/ready tasks";
+      ready_task_count = new ProfilingGauges::AbsoluteRangeGauge<int>(gname);
+      task_queue.set_gauge(ready_task_count);
+
+      // the member queues have to exist before members add them to their
+      //  schedulers
+      if(Config::use_work_stealing) {
+	member_queues.resize(member_list.size());
+	member_deques.resize(member_list.size());
+	for(size_t i = 0; i < member_list.size(); i++) {
+	  member_queues[i] = new TaskQueue;
+	  member_queues[i]->set_gauge(ready_task_count);
+	  member_deques[i] = new TaskDeque(this);
+	}
+      }
+
       for(std::vector<Processor>::const_iterator it = member_list.begin();
 	  it != member_list.end();
 	  it++) {
@@ -608,11 +634,6 @@ namespace Realm {
 
       members_requested = true;
       members_valid = true;
-
-      // now that we exist, profile our queue depth
-      std::string gname = stringbuilder() << "realm/proc " << me << "/ready tasks";
-      ready_task_count = new ProfilingGauges::AbsoluteRangeGauge<int>(gname);
-      task_queue.set_gauge(ready_task_count);
     }
 
     void ProcessorGroup::get_group_members(std::vector<Processor>& member_list)
@@ -627,12 +648,38 @@ namespace Realm {
 
     void ProcessorGroup::enqueue_task(Task *task)
     {
-      task_queue.enqueue_task(task);
+      if(member_queues.empty()) {
+	task_queue.enqueue_task(task);
+	return;
+      }
+
+      // a task spawned by one of our members' tasks goes into that member's
+      //  deque (no locks, and it's likely to run on the same core) - the
+      //  deque doesn't update the ready task gauge
+      if(task->priority == TaskDeque::DEQUE_PRIORITY) {
+	TaskDeque *deque = ThreadLocal::current_task_deque;
+	if(deque && (deque->group == this)) {
+	  deque->push(task);
+	  return;
+	}
+      }
+
+      // round-robin over the members' queues - idle members will steal
+      //  from the others
+      unsigned idx = next_member_queue.fetch_add(1) % member_queues.size();
+      member_queues[idx]->enqueue_task(task);
     }
 
     void ProcessorGroup::enqueue_tasks(Task::TaskList& tasks)
     {
-      task_queue.enqueue_tasks(tasks);
+      if(member_queues.empty()) {
+	task_queue.enqueue_tasks(tasks);
+	return;
+      }
+
+      // spread the tasks out individually
+      while(Task *task = tasks.pop_front(TaskQueue::PRI_NEG_INF))
+	enqueue_task(task);
     }
 
     void ProcessorGroup::add_to_group(ProcessorGroup *group)
@@ -871,8 +918,34 @@ namespace Realm {
 
   void LocalTaskProcessor::add_to_group(ProcessorGroup *group)
   {
-    // add the group's task queue to our scheduler too
-    sched->add_task_queue(&group->task_queue);
+    if(group->member_queues.empty()) {
+      // add the group's task queue to our scheduler too
+      sched->add_task_queue(&group->task_queue);
+      return;
+    }
+
+    // add all of the group's member queues, starting with our own (if we're
+    //  a direct member) and wrapping around from there so that different
+    //  members favor different victims
+    size_t num_queues = group->member_queues.size();
+    size_t home = 0;
+    for(size_t i = 0; i < group->members.size(); i++)
+      if(group->members[i] == this) {
+	home = i;
+	break;
+      }
+    for(size_t i = 0; i < num_queues; i++)
+      sched->add_task_queue(group->member_queues[(home + i) % num_queues]);
+
+    // a direct member owns the deque at its own index (if its scheduler can
+    //  own one) and steals from all the others
+    for(size_t i = 0; i < num_queues; i++) {
+      TaskDeque *deque = group->member_deques[(home + i) % num_queues];
+      bool owned = ((i == 0) && (group->members[home] == this) &&
+		    sched->add_task_deque(deque, true /*owned*/));
+      if(!owned)
+	sched->add_task_deque(deque, false /*!owned*/);
+    }
   }
 
   void LocalTaskProcessor::enqueue_task(Task *task)
@@ -1036,6 +1109,12 @@ namespace Realm {
     delete core_rsrv;
   }
 
+  void LocalCPUProcessor::set_numa_domain(int numa_node)
+  {
+    assert(core_rsrv->allocation == 0);
+    core_rsrv->params.set_numa_domain(numa_node);
+  }
+
 
   ////////////////////////////////////////////////////////////////////////
   //
@@ -176,6 +176,10 @@ namespace Realm {
       LocalCPUProcessor(Processor _me, CoreReservationSet& crs,
 			size_t _stack_size, bool _force_kthreads);
       virtual ~LocalCPUProcessor(void);
+
+      // asks for the processor's core to come from the given NUMA domain -
+      //  only valid before the core reservations are satisfied
+      void set_numa_domain(int numa_node);
     protected:
       CoreReservation *core_rsrv;
     };
@@ -255,6 +259,13 @@ namespace Realm {
       void request_group_members(void);
 
       TaskQueue task_queue; // ready tasks
+      // with work stealing, ready tasks are instead spread over one queue
+      //  per member, and each member's scheduler checks its own first
+      std::vector<TaskQueue *> member_queues;
+      atomic<unsigned> next_member_queue;
+      // priority-0 tasks made ready by a member's own task skip the queues
+      //  and go into that member's deque instead
+      std::vector<TaskDeque *> member_deques;
       ProfilingGauges::AbsoluteRangeGauge<int> *ready_task_count;
       DeferredSpawnCache deferred_spawn_cache;
     };
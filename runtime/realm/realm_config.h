@@ -36,12 +36,29 @@
 #define REALM_USE_USER_THREADS
 #endif
 
+// if set, user threads switch with a hand-written save/restore of the
+//  callee-saved registers rather than swapcontext, which also makes a
+//  signal mask syscall on every switch (x86-64 and aarch64 Linux only)
+#if defined(REALM_USE_USER_THREADS) && !defined(REALM_USE_UCONTEXT_SWITCH) && \
+    defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define REALM_USE_FAST_USER_SWITCH
+#endif
+
 // if set, uses Linux's kernel-level io_submit interface, otherwise uses
 //  POSIX AIO for async file I/O
 #ifdef __linux__
 //define REALM_USE_KERNEL_AIO
 #endif
 
+// if set, Linux's io_uring interface can be used for async file I/O - it is
+//  only used when requested with -ll:io_uring (and the kernel supports it),
+//  otherwise the interface above is used
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define REALM_USE_IO_URING
+#endif
+#endif
+
 // dynamic loading via dlfcn and a not-completely standard dladdr extension
 #ifdef USE_LIBDL
 #define REALM_USE_DLFCN
@@ -74,6 +91,11 @@ namespace Realm {
     // if true, worker threads that might have used user-level thread switching
     //  fall back to kernel threading
     extern bool force_kernel_threads;
+
+    // if true, task schedulers pick the best task by scanning the advertised
+    //  priorities of their task queues without taking locks, and processor
+    //  groups spread their ready tasks over one queue per member
+    extern bool use_work_stealing;
   };
 };
 #endif
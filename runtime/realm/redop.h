@@ -19,6 +19,8 @@
 #define REALM_REDOP_H
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
 
 namespace Realm {
 
@@ -60,13 +62,54 @@ namespace Realm {
 				bool exclusive = false) const = 0;
       virtual void init(void *rhs_ptr, size_t count) const = 0;
 
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-      virtual void apply_list_entry(void *lhs_ptr, const void *entry_ptr, size_t count,
-				    off_t ptr_offset, bool exclusive = false) const = 0;
-      virtual void fold_list_entry(void *rhs_ptr, const void *entry_ptr, size_t count,
-                                    off_t ptr_offset, bool exclusive = false) const = 0;
-      virtual void get_list_pointers(unsigned *ptrs, const void *entry_ptr, size_t count) const = 0;
-#endif
+      // a reduction list is an array of entries, sizeof_list_entry bytes
+      //  apart, each holding the byte offset of its target element followed
+      //  (at LIST_ENTRY_RHS_OFFSET) by an RHS value - the target of an entry
+      //  is at 'base' + (entry offset - base_offset)
+      static const size_t LIST_ENTRY_RHS_OFFSET = sizeof(off_t);
+
+      static size_t list_entry_size(size_t sizeof_rhs)
+      {
+	// keep the offset of every entry aligned
+	return ((LIST_ENTRY_RHS_OFFSET + sizeof_rhs + sizeof(off_t) - 1) /
+		sizeof(off_t)) * sizeof(off_t);
+      }
+
+      // the default versions apply/fold one entry at a time
+      virtual void apply_list_entry(void *lhs_base, const void *entry_ptr,
+				    size_t count, off_t base_offset,
+				    bool exclusive = false) const
+      {
+	const char *entry = static_cast<const char *>(entry_ptr);
+	for(size_t i = 0; i < count; i++) {
+	  void *lhs = list_entry_target(lhs_base, entry, base_offset);
+	  apply(lhs, entry + LIST_ENTRY_RHS_OFFSET, 1, exclusive);
+	  entry += sizeof_list_entry;
+	}
+      }
+
+      virtual void fold_list_entry(void *rhs_base, const void *entry_ptr,
+				   size_t count, off_t base_offset,
+				   bool exclusive = false) const
+      {
+	const char *entry = static_cast<const char *>(entry_ptr);
+	for(size_t i = 0; i < count; i++) {
+	  void *rhs1 = list_entry_target(rhs_base, entry, base_offset);
+	  fold(rhs1, entry + LIST_ENTRY_RHS_OFFSET, 1, exclusive);
+	  entry += sizeof_list_entry;
+	}
+      }
+
+      static void *list_entry_target(void *base, const void *entry_ptr,
+				     off_t base_offset)
+      {
+	off_t offset;
+	memcpy(&offset, entry_ptr, sizeof(off_t));
+	// integer math because 'base' may be null (entries with absolute
+	//  addresses)
+	return reinterpret_cast<void *>(reinterpret_cast<intptr_t>(base) +
+					(offset - base_offset));
+      }
 
       virtual ~ReductionOpUntyped() {}
 
@@ -81,13 +124,27 @@ namespace Realm {
   	  has_identity(_has_identity), is_foldable(_is_foldable) {}
     };
 
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-    template <class LHS, class RHS>
-    struct ReductionListEntry {
-      ptr_t ptr;
-      RHS rhs;
+    // optional bulk kernels for a reduction op - ReductionOp<REDOP> offers
+    //  every contiguous apply/fold to these first and only falls back to
+    //  calling REDOP::apply/fold on each element if they return false, so
+    //  a REDOP with a faster (e.g. vectorized) way to handle a whole range
+    //  can specialize this
+    template <class REDOP>
+    struct ReductionKernels {
+      static bool apply(typename REDOP::LHS *lhs,
+			const typename REDOP::RHS *rhs,
+			size_t count, bool exclusive)
+      {
+	return false;
+      }
+
+      static bool fold(typename REDOP::RHS *rhs1,
+		       const typename REDOP::RHS *rhs2,
+		       size_t count, bool exclusive)
+      {
+	return false;
+      }
     };
-#endif
 
     template <class REDOP>
     class ReductionOp : public ReductionOpUntyped {
@@ -96,11 +153,7 @@ namespace Realm {
       //  template-fu to figure it out
       ReductionOp(void)
 	: ReductionOpUntyped(sizeof(typename REDOP::LHS), sizeof(typename REDOP::RHS),
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-			     sizeof(ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS>),
-#else
-			     0,
-#endif
+			     list_entry_size(sizeof(typename REDOP::RHS)),
 			     true, true) {}
 
       virtual ReductionOpUntyped *clone(void) const
@@ -113,6 +166,8 @@ namespace Realm {
       {
 	typename REDOP::LHS *lhs = static_cast<typename REDOP::LHS *>(lhs_ptr);
 	const typename REDOP::RHS *rhs = static_cast<const typename REDOP::RHS *>(rhs_ptr);
+	if(ReductionKernels<REDOP>::apply(lhs, rhs, count, exclusive))
+	  return;
 	if(exclusive) {
 	  for(size_t i = 0; i < count; i++)
 	    REDOP::template apply<true>(lhs[i], rhs[i]);
@@ -126,6 +181,12 @@ namespace Realm {
 				 off_t lhs_stride, off_t rhs_stride, size_t count,
 				 bool exclusive = false) const
       {
+	// dense ranges can use the contiguous path (and its kernels)
+	if((lhs_stride == off_t(sizeof(typename REDOP::LHS))) &&
+	   (rhs_stride == off_t(sizeof(typename REDOP::RHS)))) {
+	  ReductionOp<REDOP>::apply(lhs_ptr, rhs_ptr, count, exclusive);
+	  return;
+	}
 	if(exclusive) {
 	  for(size_t i = 0; i < count; i++) {
 	    REDOP::template apply<true>(*static_cast<typename REDOP::LHS *>(lhs_ptr),
@@ -148,6 +209,8 @@ namespace Realm {
       {
 	typename REDOP::RHS *rhs1 = static_cast<typename REDOP::RHS *>(rhs1_ptr);
 	const typename REDOP::RHS *rhs2 = static_cast<const typename REDOP::RHS *>(rhs2_ptr);
+	if(ReductionKernels<REDOP>::fold(rhs1, rhs2, count, exclusive))
+	  return;
 	if(exclusive) {
 	  for(size_t i = 0; i < count; i++)
 	    REDOP::template fold<true>(rhs1[i], rhs2[i]);
@@ -161,6 +224,11 @@ namespace Realm {
 				off_t lhs_stride, off_t rhs_stride, size_t count,
 				bool exclusive = false) const
       {
+	if((lhs_stride == off_t(sizeof(typename REDOP::RHS))) &&
+	   (rhs_stride == off_t(sizeof(typename REDOP::RHS)))) {
+	  ReductionOp<REDOP>::fold(lhs_ptr, rhs_ptr, count, exclusive);
+	  return;
+	}
 	if(exclusive) {
 	  for(size_t i = 0; i < count; i++) {
 	    REDOP::template fold<true>(*static_cast<typename REDOP::RHS *>(lhs_ptr),
@@ -185,47 +253,48 @@ namespace Realm {
           *rhs_ptr++ = REDOP::identity;
       }
 
-#ifdef NEED_TO_FIX_REDUCTION_LISTS_FOR_DEPPART
-      virtual void apply_list_entry(void *lhs_ptr, const void *entry_ptr, size_t count,
-				    off_t ptr_offset, bool exclusive = false) const
+      virtual void apply_list_entry(void *lhs_base, const void *entry_ptr,
+				    size_t count, off_t base_offset,
+				    bool exclusive = false) const
       {
-	typename REDOP::LHS *lhs = (typename REDOP::LHS *)lhs_ptr;
-	const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *entry = (const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *)entry_ptr;
+	const char *entry = static_cast<const char *>(entry_ptr);
+	typename REDOP::RHS rhs;
 	if(exclusive) {
-	  for(size_t i = 0; i < count; i++)
-	    REDOP::template apply<true>(lhs[entry[i].ptr.value - ptr_offset], entry[i].rhs);
+	  for(size_t i = 0; i < count; i++) {
+	    // entries are only guaranteed to be off_t-aligned
+	    memcpy(&rhs, entry + LIST_ENTRY_RHS_OFFSET, sizeof(rhs));
+	    REDOP::template apply<true>(*static_cast<typename REDOP::LHS *>(list_entry_target(lhs_base, entry, base_offset)), rhs);
+	    entry += sizeof_list_entry;
+	  }
 	} else {
-	  for(size_t i = 0; i < count; i++)
-	    REDOP::template apply<false>(lhs[entry[i].ptr.value - ptr_offset], entry[i].rhs);
+	  for(size_t i = 0; i < count; i++) {
+	    memcpy(&rhs, entry + LIST_ENTRY_RHS_OFFSET, sizeof(rhs));
+	    REDOP::template apply<false>(*static_cast<typename REDOP::LHS *>(list_entry_target(lhs_base, entry, base_offset)), rhs);
+	    entry += sizeof_list_entry;
+	  }
 	}
       }
 
-      virtual void fold_list_entry(void *rhs_ptr, const void *entry_ptr, size_t count,
-                                    off_t ptr_offset, bool exclusive = false) const
+      virtual void fold_list_entry(void *rhs_base, const void *entry_ptr,
+				   size_t count, off_t base_offset,
+				   bool exclusive = false) const
       {
-        typename REDOP::RHS *rhs = (typename REDOP::RHS*)rhs_ptr;
-        const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *entry = (const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *)entry_ptr;
-        if (exclusive)
-        {
-          for (size_t i = 0; i < count; i++)
-            REDOP::template fold<true>(rhs[entry[i].ptr.value - ptr_offset], entry[i].rhs);
-        }
-        else
-        {
-          for (size_t i = 0; i < count; i++)
-            REDOP::template fold<false>(rhs[entry[i].ptr.value - ptr_offset], entry[i].rhs);
-        }
-      }
-
-      virtual void get_list_pointers(unsigned *ptrs, const void *entry_ptr, size_t count) const
-      {
-	const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *entry = (const ReductionListEntry<typename REDOP::LHS,typename REDOP::RHS> *)entry_ptr;
-	for(size_t i = 0; i < count; i++) {
-	  ptrs[i] = entry[i].ptr.value;
-	  //printf("%d=%d\n", i, ptrs[i]);
+	const char *entry = static_cast<const char *>(entry_ptr);
+	typename REDOP::RHS rhs;
+	if(exclusive) {
+	  for(size_t i = 0; i < count; i++) {
+	    memcpy(&rhs, entry + LIST_ENTRY_RHS_OFFSET, sizeof(rhs));
+	    REDOP::template fold<true>(*static_cast<typename REDOP::RHS *>(list_entry_target(rhs_base, entry, base_offset)), rhs);
+	    entry += sizeof_list_entry;
+	  }
+	} else {
+	  for(size_t i = 0; i < count; i++) {
+	    memcpy(&rhs, entry + LIST_ENTRY_RHS_OFFSET, sizeof(rhs));
+	    REDOP::template fold<false>(*static_cast<typename REDOP::RHS *>(list_entry_target(rhs_base, entry, base_offset)), rhs);
+	    entry += sizeof_list_entry;
+	  }
 	}
       }
-#endif
     };
 
     template <class REDOP>
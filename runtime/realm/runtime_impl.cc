@@ -53,6 +53,8 @@ static const void *ignore_gasnet_warning2 __attribute__((unused)) = (void *)_gas
 #endif
 
 #ifndef USE_GASNET
+#include "realm/shm_transport.h"
+
 /*extern*/ void *fake_gasnet_mem_base = 0;
 /*extern*/ size_t fake_gasnet_mem_size = 0;
 #endif
@@ -200,7 +202,9 @@ namespace Realm {
 	AutoHSLLock a2(e->mutex);
 	
 	// print anything with either local or remote waiters
+	EventWaiter *queue_head = e->local_waiter_queue_head();
 	if(e->current_local_waiters.empty() &&
+	   (queue_head == 0) &&
 	   e->future_local_waiters.empty() &&
 	   e->remote_waiters.empty())
 	  continue;
@@ -210,6 +214,8 @@ namespace Realm {
 	    pos;
 	    pos = pos->ew_list_link.next)
 	  clw_size++;
+	for(EventWaiter *pos = queue_head; pos; pos = pos->ew_list_link.next)
+	  clw_size++;
 	EventImpl::gen_t gen = e->generation.load();
 	os << "Event " << e->me <<": gen=" << gen
 	   << " subscr=" << e->gen_subscribed
@@ -223,6 +229,11 @@ namespace Realm {
 	  pos/*(*it)*/->print(os);
 	  os << "\n";
 	}
+	for(EventWaiter *pos = queue_head; pos; pos = pos->ew_list_link.next) {
+	  os << "  [" << (gen+1) << "] L:" << pos << " - ";
+	  pos->print(os);
+	  os << "\n";
+	}
 	for(std::map<EventImpl::gen_t, EventWaiter::EventWaiterList>::const_iterator it = e->future_local_waiters.begin();
 	    it != e->future_local_waiters.end();
 	    it++) {
@@ -706,6 +717,9 @@ namespace Realm {
     // if true, worker threads that might have used user-level thread switching
     //  fall back to kernel threading
     bool force_kernel_threads = false;
+
+    // if true, schedulers steal work from per-member processor group queues
+    bool use_work_stealing = false;
   };
 
   CoreModule::CoreModule(void)
@@ -1137,6 +1151,13 @@ namespace Realm {
 	}
       }
 
+#ifndef USE_GASNET
+      // without GASNet, multiple ranks can still be run on a single machine
+      //  (-ll:shm) - this has to happen before any threads are created
+      if(!SharedMemoryTransport::create_ranks(*argc, *argv))
+	return false;
+#endif
+
       return true;
     }
 
@@ -1185,6 +1206,7 @@ namespace Realm {
       // are hyperthreads considered to share a physical core
       bool hyperthread_sharing = true;
       bool pin_dma_threads = false;
+      bool use_io_uring = false;
 
       CommandLineParser cp;
       cp.add_option_int_units("-ll:gsize", gasnet_mem_size, 'm')
@@ -1194,6 +1216,7 @@ namespace Realm {
 	.add_option_int_units("-ll:stacksize", stack_size, 'm')
 	.add_option_int("-ll:dma", dma_worker_threads)
         .add_option_bool("-ll:pin_dma", pin_dma_threads)
+	.add_option_bool("-ll:io_uring", use_io_uring)
 	.add_option_int("-ll:amsg", active_msg_worker_threads)
 	.add_option_int("-ll:ahandlers", active_msg_handler_threads)
 	.add_option_int("-ll:dummy_rsrv_ok", dummy_reservation_ok)
@@ -1214,6 +1237,7 @@ namespace Realm {
 
       cp.add_option_int("-realm:eventloopcheck", Config::event_loop_detection_limit);
       cp.add_option_bool("-ll:force_kthreads", Config::force_kernel_threads);
+      cp.add_option_bool("-ll:steal", Config::use_work_stealing);
       cp.add_option_bool("-ll:frsrv_fallback", Config::use_fast_reservation_fallback);
       cp.add_option_int("-ll:machine_query_cache", Config::use_machine_query_cache);
 
@@ -1316,7 +1340,8 @@ namespace Realm {
 
 #ifndef USE_GASNET
       // network initialization is also responsible for setting the "zero_time"
-      //  for relative timing - no synchronization necessary in non-gasnet case
+      //  for relative timing - shared-memory ranks agree on it with a barrier
+      SharedMemoryTransport::barrier();
       Realm::Clock::set_zero_time();
 #endif
 
@@ -1499,7 +1524,7 @@ namespace Realm {
       // since we need list of local gpus to create channels
       start_dma_system(dma_worker_threads,
 		       pin_dma_threads, 100
-		       ,*core_reservations);
+		       ,*core_reservations, use_io_uring);
 
       // now that we've created all the processors/etc., we can try to come up with core
       //  allocations that satisfy everybody's requirements - this will also start up any
@@ -1775,6 +1800,10 @@ namespace Realm {
 	amsg.commit();
 	NodeAnnounceMessage::await_all_announcements();
 
+	// no processor has started yet, so nobody can still be reading one of
+	//  the affinity indices retired while announcements were coming in
+	machine->reclaim_retired_indices();
+
 #ifdef DEBUG_REALM_STARTUP
 	if(my_node_id == 0) {
 	  TimeStamp ts("received all announcements", false);
@@ -1818,14 +1847,37 @@ namespace Realm {
 
 #define DEBUG_COLLECTIVES
 
-#if defined(USE_GASNET) && defined(DEBUG_COLLECTIVES)
+#ifdef USE_GASNET
   static const int GASNET_COLL_FLAGS = GASNET_COLL_IN_MYSYNC | GASNET_COLL_OUT_MYSYNC | GASNET_COLL_LOCAL;
-  
+#endif
+
+  // gather/broadcast of small values across all nodes - GASNet provides
+  //  these directly, while non-GASNet builds use the shared-memory transport
+  //  (only called when there's more than one node)
+  static void collective_gather(NodeID root, void *dst, const void *src, size_t bytes)
+  {
+#ifdef USE_GASNET
+    gasnet_coll_gather(GASNET_TEAM_ALL, root, dst, const_cast<void *>(src), bytes, GASNET_COLL_FLAGS);
+#else
+    SharedMemoryTransport::gather(root, dst, src, bytes);
+#endif
+  }
+
+  static void collective_broadcast(NodeID root, void *data, size_t bytes)
+  {
+#ifdef USE_GASNET
+    gasnet_coll_broadcast(GASNET_TEAM_ALL, data, root, data, bytes, GASNET_COLL_FLAGS);
+#else
+    SharedMemoryTransport::broadcast(root, data, bytes);
+#endif
+  }
+
+#ifdef DEBUG_COLLECTIVES
   template <typename T>
   static void broadcast_check(const T& val, const char *name)
   {
-    T bval;
-    gasnet_coll_broadcast(GASNET_TEAM_ALL, &bval, 0, const_cast<T *>(&val), sizeof(T), GASNET_COLL_FLAGS);
+    T bval = val;
+    collective_broadcast(0, &bval, sizeof(T));
     if(val != bval) {
       log_collective.fatal() << "collective mismatch on node " << my_node_id << " for " << name << ": " << val << " != " << bval;
       assert(false);
@@ -1833,13 +1885,44 @@ namespace Realm {
   }
 #endif
 
+  // merges an event from every node on 'root' - returns the merged event
+  //  on the root and NO_EVENT elsewhere
+  static Event gather_and_merge(NodeID root, Event e)
+  {
+    if(my_node_id == root) {
+      Event *all_events = new Event[max_node_id + 1];
+      collective_gather(root, all_events, &e, sizeof(Event));
+
+      std::set<Event> event_set;
+      for(NodeID i = 0; i <= max_node_id; i++) {
+	//log_collective.info() << "ev " << i << ": " << all_events[i];
+	if(all_events[i].exists())
+	  event_set.insert(all_events[i]);
+      }
+      delete[] all_events;
+
+      return Event::merge_events(event_set);
+    } else {
+      collective_gather(root, 0, &e, sizeof(Event));
+      return Event::NO_EVENT;
+    }
+  }
+
     Event RuntimeImpl::collective_spawn(Processor target_proc, Processor::TaskFuncID task_id, 
 					const void *args, size_t arglen,
 					Event wait_on /*= Event::NO_EVENT*/, int priority /*= 0*/)
     {
       log_collective.info() << "collective spawn: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " before=" << wait_on;
 
-#ifdef USE_GASNET
+      if(max_node_id == 0) {
+	// only one node, so a collective spawn is the same as a regular spawn
+	Event finish_event = target_proc.spawn(task_id, args, arglen, wait_on, priority);
+
+	log_collective.info() << "collective spawn: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " after=" << finish_event;
+
+	return finish_event;
+      }
+
 #ifdef DEBUG_COLLECTIVES
       broadcast_check(target_proc, "target_proc");
       broadcast_check(task_id, "task_id");
@@ -1849,59 +1932,23 @@ namespace Realm {
       // root node will be whoever owns the target proc
       NodeID root = ID(target_proc).proc_owner_node();
 
-      if(my_node_id == root) {
-	// ROOT NODE
-
-	// step 1: receive wait_on from every node
-	Event *all_events = 0;
-	all_events = new Event[max_node_id + 1];
-	gasnet_coll_gather(GASNET_TEAM_ALL, root, all_events, &wait_on, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// step 2: merge all the events
-	std::set<Event> event_set;
-	for(NodeID i = 0; i <= max_node_id; i++) {
-	  //log_collective.info() << "ev " << i << ": " << all_events[i];
-	  if(all_events[i].exists())
-	    event_set.insert(all_events[i]);
-	}
-	delete[] all_events;
+      // step 1: merge everybody's wait_on on the root
+      Event merged_event = gather_and_merge(root, wait_on);
 
-	Event merged_event = Event::merge_events(event_set);
+      // step 2: the root runs the task
+      Event finish_event;
+      if(my_node_id == root) {
 	log_collective.info() << "merged precondition: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " before=" << merged_event;
 
-	// step 3: run the task
-	Event finish_event = target_proc.spawn(task_id, args, arglen, merged_event, priority);
-
-	// step 4: broadcast the finish event to everyone
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &finish_event, root, &finish_event, sizeof(Event), GASNET_COLL_FLAGS);
-
-	log_collective.info() << "collective spawn: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " after=" << finish_event;
-
-	return finish_event;
-      } else {
-	// NON-ROOT NODE
-
-	// step 1: send our wait_on to the root for merging
-	gasnet_coll_gather(GASNET_TEAM_ALL, root, 0, &wait_on, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// steps 2 and 3: twiddle thumbs
-
-	// step 4: receive finish event
-	Event finish_event;
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &finish_event, root, 0, sizeof(Event), GASNET_COLL_FLAGS);
-
-	log_collective.info() << "collective spawn: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " after=" << finish_event;
-
-	return finish_event;
+	finish_event = target_proc.spawn(task_id, args, arglen, merged_event, priority);
       }
-#else
-      // no GASNet, so a collective spawn is the same as a regular spawn
-      Event finish_event = target_proc.spawn(task_id, args, arglen, wait_on, priority);
+
+      // step 3: broadcast the finish event to everyone
+      collective_broadcast(root, &finish_event, sizeof(Event));
 
       log_collective.info() << "collective spawn: proc=" << target_proc << " func=" << task_id << " priority=" << priority << " after=" << finish_event;
 
       return finish_event;
-#endif
     }
 
     Event RuntimeImpl::collective_spawn_by_kind(Processor::Kind target_kind, Processor::TaskFuncID task_id, 
@@ -1911,54 +1958,21 @@ namespace Realm {
     {
       log_collective.info() << "collective spawn: kind=" << target_kind << " func=" << task_id << " priority=" << priority << " before=" << wait_on;
 
-#ifdef USE_GASNET
-#ifdef DEBUG_COLLECTIVES
-      broadcast_check(target_kind, "target_kind");
-      broadcast_check(task_id, "task_id");
-      broadcast_check(one_per_node, "one_per_node");
-      broadcast_check(priority, "priority");
-#endif
-
       // every node is involved in this one, so the root is arbitrary - we'll pick node 0
+      Event merged_event = wait_on;
 
-      Event merged_event;
-
-      if(my_node_id == 0) {
-	// ROOT NODE
-
-	// step 1: receive wait_on from every node
-	Event *all_events = 0;
-	all_events = new Event[max_node_id + 1];
-	gasnet_coll_gather(GASNET_TEAM_ALL, 0, all_events, &wait_on, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// step 2: merge all the events
-	std::set<Event> event_set;
-	for(NodeID i = 0; i <= max_node_id; i++) {
-	  //log_collective.info() << "ev " << i << ": " << all_events[i];
-	  if(all_events[i].exists())
-	    event_set.insert(all_events[i]);
-	}
-	delete[] all_events;
-
-	merged_event = Event::merge_events(event_set);
-
-	// step 3: broadcast the merged event back to everyone
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &merged_event, 0, &merged_event, sizeof(Event), GASNET_COLL_FLAGS);
-      } else {
-	// NON-ROOT NODE
-
-	// step 1: send our wait_on to the root for merging
-	gasnet_coll_gather(GASNET_TEAM_ALL, 0, 0, &wait_on, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// step 2: twiddle thumbs
+      if(max_node_id > 0) {
+#ifdef DEBUG_COLLECTIVES
+	broadcast_check(target_kind, "target_kind");
+	broadcast_check(task_id, "task_id");
+	broadcast_check(one_per_node, "one_per_node");
+	broadcast_check(priority, "priority");
+#endif
 
-	// step 3: receive merged wait_on event
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &merged_event, 0, 0, sizeof(Event), GASNET_COLL_FLAGS);
+	// merge everybody's wait_on on node 0 and broadcast it back
+	merged_event = gather_and_merge(0, wait_on);
+	collective_broadcast(0, &merged_event, sizeof(Event));
       }
-#else
-      // no GASNet, so our precondition is the only one
-      Event merged_event = wait_on;
-#endif
 
       // now spawn 0 or more local tasks
       std::set<Event> event_set;
@@ -1982,54 +1996,15 @@ namespace Realm {
       // local merge
       Event my_finish = Event::merge_events(event_set);
 
-#ifdef USE_GASNET
-      if(my_node_id == 0) {
-	// ROOT NODE
-
-	// step 1: receive wait_on from every node
-	Event *all_events = 0;
-	all_events = new Event[max_node_id + 1];
-	gasnet_coll_gather(GASNET_TEAM_ALL, 0, all_events, &my_finish, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// step 2: merge all the events
-	std::set<Event> event_set;
-	for(NodeID i = 0; i <= max_node_id; i++) {
-	  //log_collective.info() << "ev " << i << ": " << all_events[i];
-	  if(all_events[i].exists())
-	    event_set.insert(all_events[i]);
-	}
-	delete[] all_events;
-
-	Event merged_finish = Event::merge_events(event_set);
-
-	// step 3: broadcast the merged event back to everyone
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &merged_finish, 0, &merged_finish, sizeof(Event), GASNET_COLL_FLAGS);
-
-	log_collective.info() << "collective spawn: kind=" << target_kind << " func=" << task_id << " priority=" << priority << " after=" << merged_finish;
-
-	return merged_finish;
-      } else {
-	// NON-ROOT NODE
-
-	// step 1: send our wait_on to the root for merging
-	gasnet_coll_gather(GASNET_TEAM_ALL, 0, 0, &my_finish, sizeof(Event), GASNET_COLL_FLAGS);
-
-	// step 2: twiddle thumbs
-
-	// step 3: receive merged wait_on event
-	Event merged_finish;
-	gasnet_coll_broadcast(GASNET_TEAM_ALL, &merged_finish, 0, 0, sizeof(Event), GASNET_COLL_FLAGS);
-
-	log_collective.info() << "collective spawn: kind=" << target_kind << " func=" << task_id << " priority=" << priority << " after=" << merged_finish;
-
-	return merged_finish;
+      if(max_node_id > 0) {
+	// merge the finish events on node 0 and broadcast the result
+	my_finish = gather_and_merge(0, my_finish);
+	collective_broadcast(0, &my_finish, sizeof(Event));
       }
-#else
-      // no GASNet, so just return our locally merged event
+
       log_collective.info() << "collective spawn: kind=" << target_kind << " func=" << task_id << " priority=" << priority << " after=" << my_finish;
 
       return my_finish;
-#endif
     }
 
 #if 0
@@ -2190,10 +2165,12 @@ namespace Realm {
 	log_runtime.info("shutdown request received - terminating");
       }
 
-#ifdef USE_GASNET
       // don't start tearing things down until all processes agree
+#ifdef USE_GASNET
       gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
       gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
+#else
+      SharedMemoryTransport::barrier();
 #endif
 
       // Shutdown all the threads
@@ -2288,6 +2265,13 @@ namespace Realm {
 	free(nongasnet_regmem_base);
       if(nongasnet_reg_ib_mem_base != 0)
 	free(nongasnet_reg_ib_mem_base);
+
+      // rank 0 reports a failure of any of the other ranks
+      {
+	int shm_result = SharedMemoryTransport::finalize();
+	if((shm_result != 0) && (shutdown_result_code == 0))
+	  shutdown_result_code = shm_result;
+      }
 #endif
 
       if(!Threading::cleanup()) exit(1);
@@ -0,0 +1,914 @@
+/* Copyright 2019 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared-memory active message transport for non-GASNet builds
+
+#include "realm/shm_transport.h"
+
+#include "realm/atomics.h"
+#include "realm/cmdline.h"
+#include "realm/logging.h"
+#include "realm/threads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <new>
+
+namespace Realm {
+
+  Logger log_shm("shm");
+
+  namespace SharedMemoryTransport {
+
+    static const int MAX_RANKS = 64;
+    static const size_t MAILBOX_BYTES = 256;
+    static const size_t CACHE_LINE = 64;
+    static const int MSGID_CONTINUATION = -1;
+
+    static inline size_t round_up(size_t v, size_t align)
+    {
+      return ((v + align - 1) / align) * align;
+    }
+
+    // everything in the segment is constructed by rank 0 before the other
+    //  ranks are forked, so only lock-free (and therefore address-free)
+    //  atomics may live in here
+    struct SegmentHeader {
+      int num_ranks;
+      size_t ring_bytes;
+      atomic<int> barrier_count;
+      char pad0[CACHE_LINE];
+      atomic<int> barrier_generation;
+      char pad1[CACHE_LINE];
+      atomic<int> finished[MAX_RANKS];  // set by each rank in finalize()
+      char mailboxes[MAX_RANKS][MAILBOX_BYTES];
+    };
+
+    // one ring per (sender, receiver) pair - 'head' counts the bytes ever
+    //  written by the sender, 'tail' the bytes ever consumed by the
+    //  receiver, and each lives on its own cache line - the ring data
+    //  follows immediately
+    struct RingHeader {
+      atomic<uint64_t> head;
+      char pad0[CACHE_LINE - sizeof(atomic<uint64_t>)];
+      atomic<uint64_t> tail;
+      char pad1[CACHE_LINE - sizeof(atomic<uint64_t>)];
+    };
+
+    // a message is its args followed by its payload, carried by one or more
+    //  records - every record is padded to a multiple of 8 bytes
+    struct RecordHeader {
+      int32_t msgid;          // MSGID_CONTINUATION for all but the first
+      uint32_t arg_size;
+      uint32_t frag_bytes;    // message bytes carried by this record
+      uint32_t pad;
+      uint64_t payload_size;
+      uint64_t dstptr;
+    };
+
+    // layout of the args built by ActiveMessage<T>::commit - the user's
+    //  header follows
+    struct NewMessagePrefix : public BaseMedium {
+      unsigned short msgid;
+      unsigned short sender;
+      unsigned payload_len;
+    };
+
+    static int num_ranks = 1;
+    static size_t ring_bytes = 0;
+    static size_t max_fragment = 0;
+    static size_t ring_offset = 0;
+    static char *segment_base = 0;
+    static size_t segment_size = 0;
+    static SegmentHeader *seg_header = 0;
+
+    // rank 0 keeps track of the ranks it forked
+    static pid_t parent_pid = 0;
+    static std::vector<pid_t> child_pids;
+    static std::vector<int> child_status;
+    static GASNetHSL peer_mutex;
+
+    static inline RingHeader *ring_for(int sender, int receiver)
+    {
+      size_t stride = sizeof(RingHeader) + ring_bytes;
+      return reinterpret_cast<RingHeader *>(segment_base + ring_offset +
+					    ((sender * num_ranks) + receiver) * stride);
+    }
+
+    static void ring_copy_in(RingHeader *ring, uint64_t pos,
+			     const void *src, size_t bytes)
+    {
+      char *data = reinterpret_cast<char *>(ring + 1);
+      size_t ofs = pos % ring_bytes;
+      size_t first = std::min(bytes, ring_bytes - ofs);
+      memcpy(data + ofs, src, first);
+      if(first < bytes)
+	memcpy(data, static_cast<const char *>(src) + first, bytes - first);
+    }
+
+    static void ring_copy_out(RingHeader *ring, uint64_t pos,
+			      void *dst, size_t bytes)
+    {
+      const char *data = reinterpret_cast<const char *>(ring + 1);
+      size_t ofs = pos % ring_bytes;
+      size_t first = std::min(bytes, ring_bytes - ofs);
+      memcpy(dst, data + ofs, first);
+      if(first < bytes)
+	memcpy(static_cast<char *>(dst) + first, data, bytes - first);
+    }
+
+    static int exit_code(int status)
+    {
+      if(WIFEXITED(status))
+	return WEXITSTATUS(status);
+      if(WIFSIGNALED(status))
+	return 128 + WTERMSIG(status);
+      return 1;
+    }
+
+    // a rank that dies would otherwise leave everybody else waiting
+    //  forever - ranks that exit after finalize() are fine, and their exit
+    //  status is reported by rank 0's finalize()
+    static void check_peers(void)
+    {
+      if(my_node_id == 0) {
+	AutoHSLLock al(peer_mutex);
+	for(size_t i = 0; i < child_pids.size(); i++) {
+	  if(child_pids[i] == 0) continue;  // already reaped
+	  int status;
+	  pid_t pid = waitpid(child_pids[i], &status, WNOHANG);
+	  if(pid != child_pids[i]) continue;
+	  child_pids[i] = 0;
+	  child_status[i] = exit_code(status);
+	  if(!seg_header->finished[i + 1].load_acquire()) {
+	    log_shm.fatal() << "rank " << (i + 1) << " exited unexpectedly with status " << child_status[i];
+	    abort();
+	  }
+	}
+      } else {
+	if(getppid() != parent_pid) {
+	  log_shm.fatal() << "rank 0 has exited - rank " << my_node_id << " terminating";
+	  abort();
+	}
+      }
+    }
+
+    // spin briefly, then yield, then sleep, checking on the other ranks
+    //  every so often
+    static void idle_backoff(unsigned& idle_count)
+    {
+      idle_count++;
+      if(idle_count < 64)
+	return;
+      if(idle_count < 1024) {
+	sched_yield();
+	return;
+      }
+      if((idle_count % 1024) == 0)
+	check_peers();
+      usleep(50);
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // sending
+    //
+
+    struct PendingMessage {
+      RecordHeader hdr;
+      char *body;   // args followed by payload
+      size_t sent;
+    };
+
+    struct Endpoint {
+      GASNetHSL mutex;
+      std::deque<PendingMessage> pending;
+    };
+
+    static Endpoint *endpoints = 0;
+    static atomic<int> pending_messages(0);
+
+    // writes as much of a message (args followed by payload) as the ring
+    //  has room for, starting 'sent' bytes in - returns the new 'sent'
+    static size_t write_fragments(RingHeader *ring, const RecordHeader& msg,
+				  const char *args, const char *payload,
+				  size_t sent)
+    {
+      size_t total = msg.arg_size + msg.payload_size;
+      uint64_t head = ring->head.load();
+      uint64_t tail = ring->tail.load_acquire();
+      size_t space = ring_bytes - (head - tail);
+
+      while(sent < total) {
+	// don't bother with a record that would carry just a few bytes
+	size_t min_frag = std::min(total - sent, size_t(256));
+	if(space < (sizeof(RecordHeader) + min_frag))
+	  break;
+
+	size_t frag = std::min(total - sent,
+			       std::min(max_fragment,
+					space - sizeof(RecordHeader)));
+	RecordHeader rec = msg;
+	if(sent > 0)
+	  rec.msgid = MSGID_CONTINUATION;
+	rec.frag_bytes = frag;
+	ring_copy_in(ring, head, &rec, sizeof(rec));
+
+	// the fragment may straddle the args/payload boundary
+	uint64_t pos = head + sizeof(rec);
+	size_t done = 0;
+	if(sent < msg.arg_size) {
+	  done = std::min(frag, msg.arg_size - sent);
+	  ring_copy_in(ring, pos, args + sent, done);
+	}
+	if(done < frag)
+	  ring_copy_in(ring, pos + done,
+		       payload + (sent + done - msg.arg_size), frag - done);
+
+	size_t rec_bytes = sizeof(rec) + round_up(frag, 8);
+	head += rec_bytes;
+	space -= rec_bytes;
+	sent += frag;
+      }
+
+      ring->head.store_release(head);
+      return sent;
+    }
+
+    void send(NodeID target, int msgid,
+	      const void *args, size_t arg_size,
+	      const void *payload, size_t payload_size,
+	      int payload_mode, void *dstptr)
+    {
+      assert((target >= 0) && (target < num_ranks));
+
+      RecordHeader hdr;
+      hdr.msgid = msgid;
+      hdr.arg_size = arg_size;
+      hdr.frag_bytes = 0;
+      hdr.pad = 0;
+      hdr.payload_size = payload_size;
+      hdr.dstptr = reinterpret_cast<uintptr_t>(dstptr);
+      size_t total = arg_size + payload_size;
+
+      Endpoint& ep = endpoints[target];
+      {
+	AutoHSLLock al(ep.mutex);
+
+	// messages to a given target go out in order, so only write
+	//  directly if nothing is already waiting
+	size_t sent = 0;
+	if(ep.pending.empty())
+	  sent = write_fragments(ring_for(my_node_id, target), hdr,
+				 static_cast<const char *>(args),
+				 static_cast<const char *>(payload), 0);
+
+	if(sent < total) {
+	  PendingMessage pm;
+	  pm.hdr = hdr;
+	  pm.body = static_cast<char *>(malloc(total));
+	  assert(pm.body != 0);
+	  memcpy(pm.body, args, arg_size);
+	  if(payload_size > 0)
+	    memcpy(pm.body + arg_size, payload, payload_size);
+	  pm.sent = sent;
+	  ep.pending.push_back(pm);
+	  pending_messages.fetch_add(1);
+	}
+      }
+
+      if((payload_mode == PAYLOAD_FREE) && payload)
+	free(const_cast<void *>(payload));
+    }
+
+    static bool push_pending(void)
+    {
+      if(pending_messages.load() == 0)
+	return false;
+
+      bool progress = false;
+      for(int i = 0; i < num_ranks; i++) {
+	Endpoint& ep = endpoints[i];
+	AutoHSLLock al(ep.mutex);
+	while(!ep.pending.empty()) {
+	  PendingMessage& pm = ep.pending.front();
+	  size_t sent = write_fragments(ring_for(my_node_id, i), pm.hdr,
+					pm.body, pm.body + pm.hdr.arg_size,
+					pm.sent);
+	  if(sent > pm.sent)
+	    progress = true;
+	  pm.sent = sent;
+	  if(sent < (pm.hdr.arg_size + pm.hdr.payload_size))
+	    break;
+
+	  free(pm.body);
+	  ep.pending.pop_front();
+	  pending_messages.fetch_sub(1);
+	}
+      }
+      return progress;
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class ShmIncomingMessage
+    //
+
+    class ShmIncomingMessage : public IncomingMessage {
+    public:
+      ShmIncomingMessage(NodeID _src, int _msgid, char *_body,
+			 const void *_payload, size_t _payload_size);
+      virtual ~ShmIncomingMessage(void);
+
+      virtual void run_handler(void);
+
+      virtual int get_peer(void);
+      virtual int get_msgid(void);
+      virtual size_t get_msgsize(void);
+
+    protected:
+      NodeID src;
+      int msgid;
+      char *body;
+      const void *payload;
+      size_t payload_size;
+    };
+
+    ShmIncomingMessage::ShmIncomingMessage(NodeID _src, int _msgid, char *_body,
+					   const void *_payload, size_t _payload_size)
+      : src(_src), msgid(_msgid), body(_body)
+      , payload(_payload), payload_size(_payload_size)
+    {}
+
+    ShmIncomingMessage::~ShmIncomingMessage(void)
+    {
+      free(body);
+    }
+
+    void ShmIncomingMessage::run_handler(void)
+    {
+      assert(msgid == MSGID_NEW_ACTIVEMSG);
+      const NewMessagePrefix *prefix = reinterpret_cast<const NewMessagePrefix *>(body);
+      ActiveMessageHandlerTable::MessageHandler handler = activemsg_handler_table.lookup_message_handler(prefix->msgid);
+      (*handler)(prefix->sender, body + sizeof(NewMessagePrefix),
+		 payload, payload_size);
+    }
+
+    int ShmIncomingMessage::get_peer(void)
+    {
+      return src;
+    }
+
+    int ShmIncomingMessage::get_msgid(void)
+    {
+      return msgid;
+    }
+
+    size_t ShmIncomingMessage::get_msgsize(void)
+    {
+      return payload_size;
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class IncomingQueue
+    //
+
+    // messages are handed from the polling thread to the handler threads
+    //  in arrival order
+    class IncomingQueue {
+    public:
+      IncomingQueue(CoreReservationSet& crs);
+      ~IncomingQueue(void);
+
+      void add(IncomingMessage *msg);
+
+      void start_handler_threads(int count, size_t stack_size);
+      void shutdown(void);
+
+      void handler_thread_loop(void);
+
+    protected:
+      GASNetHSL mutex;
+      GASNetCondVar condvar;
+      IncomingMessage *head;
+      IncomingMessage **tail;
+      bool shutdown_flag;
+      CoreReservation *core_rsrv;
+      std::vector<Thread *> handler_threads;
+    };
+
+    IncomingQueue::IncomingQueue(CoreReservationSet& crs)
+      : condvar(mutex), head(0), tail(&head), shutdown_flag(false)
+    {
+      core_rsrv = new CoreReservation("shm AM handlers", crs,
+				      CoreReservationParameters());
+    }
+
+    IncomingQueue::~IncomingQueue(void)
+    {
+      while(head) {
+	IncomingMessage *next = head->next_msg;
+	delete head;
+	head = next;
+      }
+      delete core_rsrv;
+    }
+
+    void IncomingQueue::add(IncomingMessage *msg)
+    {
+      AutoHSLLock al(mutex);
+      msg->next_msg = 0;
+      *tail = msg;
+      tail = &(msg->next_msg);
+      condvar.signal();
+    }
+
+    void IncomingQueue::start_handler_threads(int count, size_t stack_size)
+    {
+      ThreadLaunchParameters tlp;
+      tlp.set_stack_size(stack_size);
+
+      for(int i = 0; i < count; i++)
+	handler_threads.push_back(Thread::create_kernel_thread<IncomingQueue,
+				                               &IncomingQueue::handler_thread_loop>(this,
+												    tlp,
+												    *core_rsrv));
+    }
+
+    void IncomingQueue::shutdown(void)
+    {
+      {
+	AutoHSLLock al(mutex);
+	shutdown_flag = true;
+	condvar.broadcast();
+      }
+
+      for(std::vector<Thread *>::iterator it = handler_threads.begin();
+	  it != handler_threads.end();
+	  it++) {
+	(*it)->join();
+	delete (*it);
+      }
+      handler_threads.clear();
+    }
+
+    void IncomingQueue::handler_thread_loop(void)
+    {
+      while(true) {
+	IncomingMessage *msg;
+	{
+	  AutoHSLLock al(mutex);
+	  while(!head && !shutdown_flag)
+	    condvar.wait();
+	  // anything already queued is handled before we exit
+	  if(!head)
+	    break;
+	  msg = head;
+	  head = msg->next_msg;
+	  if(!head)
+	    tail = &head;
+	}
+
+	msg->run_handler();
+	delete msg;
+      }
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // receiving
+    //
+
+    struct PartialMessage {
+      RecordHeader hdr;
+      char *body;
+      size_t received;
+    };
+
+    // one per sender - only touched by whoever holds 'poll_busy'
+    static PartialMessage *partials = 0;
+    static atomic<int> poll_busy(0);
+    static IncomingQueue *incoming = 0;
+
+    static void deliver(NodeID sender, const RecordHeader& hdr, char *body)
+    {
+      void *payload = body + hdr.arg_size;
+      if(hdr.dstptr != 0) {
+	// the sender named a destination in our memory - there's no RDMA
+	//  between processes, so the copy happens here instead
+	payload = reinterpret_cast<void *>(hdr.dstptr);
+	memcpy(payload, body + hdr.arg_size, hdr.payload_size);
+      }
+      incoming->add(new ShmIncomingMessage(sender, hdr.msgid, body,
+					   payload, hdr.payload_size));
+    }
+
+    static bool receive_from(NodeID sender)
+    {
+      RingHeader *ring = ring_for(sender, my_node_id);
+      uint64_t tail = ring->tail.load();
+      uint64_t head = ring->head.load_acquire();
+      if(tail == head)
+	return false;
+
+      PartialMessage& pm = partials[sender];
+      while(tail < head) {
+	RecordHeader rec;
+	ring_copy_out(ring, tail, &rec, sizeof(rec));
+	if(rec.msgid != MSGID_CONTINUATION) {
+	  assert(pm.body == 0);
+	  pm.hdr = rec;
+	  pm.received = 0;
+	  pm.body = static_cast<char *>(malloc(rec.arg_size + rec.payload_size));
+	  assert(pm.body != 0);
+	} else
+	  assert(pm.body != 0);
+
+	ring_copy_out(ring, tail + sizeof(rec), pm.body + pm.received,
+		      rec.frag_bytes);
+	pm.received += rec.frag_bytes;
+	tail += sizeof(rec) + round_up(rec.frag_bytes, 8);
+
+	if(pm.received == (pm.hdr.arg_size + pm.hdr.payload_size)) {
+	  deliver(sender, pm.hdr, pm.body);
+	  pm.body = 0;
+	}
+      }
+
+      // hand the space back to the sender
+      ring->tail.store_release(tail);
+      return true;
+    }
+
+    bool poll(void)
+    {
+      if(num_ranks <= 1)
+	return false;
+
+      // only one thread polls at a time - anybody else just moves on
+      int expected = 0;
+      if(!poll_busy.compare_exchange(expected, 1))
+	return false;
+
+      bool progress = push_pending();
+      for(NodeID i = 0; i < num_ranks; i++)
+	if(receive_from(i))
+	  progress = true;
+
+      poll_busy.store_release(0);
+      return progress;
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class PollingThread
+    //
+
+    class PollingThread {
+    public:
+      PollingThread(CoreReservationSet& crs);
+      ~PollingThread(void);
+
+      void start(void);
+      void stop(void);
+
+      void polling_loop(void);
+
+    protected:
+      atomic<int> shutdown_flag;
+      CoreReservation *core_rsrv;
+      Thread *thread;
+    };
+
+    PollingThread::PollingThread(CoreReservationSet& crs)
+      : shutdown_flag(0), thread(0)
+    {
+      core_rsrv = new CoreReservation("shm AM polling", crs,
+				      CoreReservationParameters());
+    }
+
+    PollingThread::~PollingThread(void)
+    {
+      delete core_rsrv;
+    }
+
+    void PollingThread::start(void)
+    {
+      ThreadLaunchParameters tlp;
+      thread = Thread::create_kernel_thread<PollingThread,
+					    &PollingThread::polling_loop>(this,
+									  tlp,
+									  *core_rsrv);
+    }
+
+    void PollingThread::stop(void)
+    {
+      if(!thread)
+	return;
+      shutdown_flag.store_release(1);
+      thread->join();
+      delete thread;
+      thread = 0;
+    }
+
+    void PollingThread::polling_loop(void)
+    {
+      unsigned idle_count = 0;
+      while(!shutdown_flag.load_acquire()) {
+	if(poll())
+	  idle_count = 0;
+	else
+	  idle_backoff(idle_count);
+      }
+
+      // give anything still waiting for ring space a little while to go
+      //  out - the other ranks are shutting down too, so don't wait forever
+      for(int i = 0; (i < 1000) && (pending_messages.load() > 0); i++) {
+	poll();
+	usleep(100);
+      }
+      if(pending_messages.load() > 0)
+	log_shm.warning() << pending_messages.load() << " message(s) still unsent at shutdown";
+    }
+
+    static PollingThread *poller = 0;
+
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // setup/teardown
+    //
+
+    bool create_ranks(int argc, char **argv)
+    {
+      // logging isn't configured yet, so errors go straight to stderr
+      int ranks = 1;
+      int ring_kb = 1024;
+      for(int i = 1; i < (argc - 1); i++) {
+	if(!strcmp(argv[i], "-ll:shm"))
+	  ranks = atoi(argv[i + 1]);
+	else if(!strcmp(argv[i], "-ll:shm_ring"))
+	  ring_kb = atoi(argv[i + 1]);
+      }
+
+      if(ranks <= 1)
+	return true;
+      if(ranks > MAX_RANKS) {
+	fprintf(stderr, "ERROR: -ll:shm supports at most %d ranks\n", MAX_RANKS);
+	return false;
+      }
+      if(ring_kb < 64) {
+	fprintf(stderr, "ERROR: -ll:shm_ring must be at least 64 (KB)\n");
+	return false;
+      }
+
+      num_ranks = ranks;
+      ring_bytes = size_t(ring_kb) << 10;
+      max_fragment = ring_bytes / 4;
+      ring_offset = round_up(sizeof(SegmentHeader), CACHE_LINE);
+      segment_size = ring_offset + (size_t(ranks) * ranks *
+				    (sizeof(RingHeader) + ring_bytes));
+
+      char name[64];
+      snprintf(name, sizeof(name), "/realm_shm.%d", (int)getpid());
+      int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+      if(fd < 0) {
+	fprintf(stderr, "ERROR: shm_open(%s) failed: %s\n", name, strerror(errno));
+	return false;
+      }
+      void *base = MAP_FAILED;
+      int err = 0;
+      if(ftruncate(fd, segment_size) == 0)
+	base = mmap(0, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if(base == MAP_FAILED)
+	err = errno;
+      close(fd);
+      // the name is removed right away - the mapping (inherited by the
+      //  forked ranks) stays valid, and nothing is left behind if a rank dies
+      shm_unlink(name);
+      if(base == MAP_FAILED) {
+	fprintf(stderr, "ERROR: could not map %zd bytes of shared memory: %s\n",
+		segment_size, strerror(err));
+	return false;
+      }
+      segment_base = static_cast<char *>(base);
+
+      seg_header = new(segment_base) SegmentHeader;
+      seg_header->num_ranks = ranks;
+      seg_header->ring_bytes = ring_bytes;
+      seg_header->barrier_count.store(0);
+      seg_header->barrier_generation.store(0);
+      for(int i = 0; i < MAX_RANKS; i++)
+	seg_header->finished[i].store(0);
+      for(int i = 0; i < ranks; i++)
+	for(int j = 0; j < ranks; j++) {
+	  RingHeader *ring = new(ring_for(i, j)) RingHeader;
+	  ring->head.store(0);
+	  ring->tail.store(0);
+	}
+
+      // anything buffered in stdio would otherwise be printed by every rank
+      fflush(stdout);
+      fflush(stderr);
+
+      parent_pid = getpid();
+      int rank = 0;
+      for(int i = 1; i < ranks; i++) {
+	pid_t pid = fork();
+	if(pid < 0) {
+	  fprintf(stderr, "ERROR: fork() failed: %s\n", strerror(errno));
+	  return false;
+	}
+	if(pid == 0) {
+#ifdef __linux__
+	  // don't outlive rank 0 (getppid() is checked as well, in case it
+	  //  died before we got here)
+	  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+	  rank = i;
+	  child_pids.clear();
+	  break;
+	}
+	child_pids.push_back(pid);
+      }
+      child_status.resize(child_pids.size(), 0);
+
+      my_node_id = rank;
+      max_node_id = ranks - 1;
+      return true;
+    }
+
+    bool is_active(void)
+    {
+      return (num_ranks > 1);
+    }
+
+    void init(CoreReservationSet& crs, std::vector<std::string>& cmdline)
+    {
+      // the options were acted on by create_ranks, but still have to be
+      //  consumed here
+      int dummy_ranks = 0;
+      int dummy_ring_kb = 0;
+      CommandLineParser cp;
+      cp.add_option_int("-ll:shm", dummy_ranks)
+	.add_option_int("-ll:shm_ring", dummy_ring_kb);
+      bool ok = cp.parse_command_line(cmdline);
+      assert(ok);
+
+      if(num_ranks <= 1)
+	return;
+
+      endpoints = new Endpoint[num_ranks];
+      partials = new PartialMessage[num_ranks];
+      for(int i = 0; i < num_ranks; i++)
+	partials[i].body = 0;
+
+      poller = new PollingThread(crs);
+      incoming = new IncomingQueue(crs);
+
+      log_shm.info() << "rank " << my_node_id << " of " << num_ranks
+		     << ": ring=" << ring_bytes << " segment=" << segment_size;
+    }
+
+    void start_polling_threads(void)
+    {
+      if(poller)
+	poller->start();
+    }
+
+    void start_handler_threads(int count, size_t stack_size)
+    {
+      if(incoming)
+	incoming->start_handler_threads(count, stack_size);
+    }
+
+    void stop_threads(void)
+    {
+      if(poller) {
+	poller->stop();
+	delete poller;
+	poller = 0;
+      }
+      if(incoming) {
+	incoming->shutdown();
+	delete incoming;
+	incoming = 0;
+      }
+    }
+
+    size_t max_payload_size(void)
+    {
+      return ((num_ranks > 1) ? ring_bytes : 0);
+    }
+
+    void barrier(void)
+    {
+      if(num_ranks <= 1)
+	return;
+
+      int gen = seg_header->barrier_generation.load_acquire();
+      if(seg_header->barrier_count.fetch_add_acqrel(1) == (num_ranks - 1)) {
+	// last one in resets the count and releases everybody else
+	seg_header->barrier_count.store(0);
+	seg_header->barrier_generation.store_release(gen + 1);
+      } else {
+	unsigned idle_count = 0;
+	while(seg_header->barrier_generation.load_acquire() == gen)
+	  idle_backoff(idle_count);
+      }
+    }
+
+    void gather(NodeID root, void *dst, const void *src, size_t bytes)
+    {
+      assert(bytes <= MAILBOX_BYTES);
+      memcpy(seg_header->mailboxes[my_node_id], src, bytes);
+      barrier();
+      if(my_node_id == root)
+	for(int i = 0; i < num_ranks; i++)
+	  memcpy(static_cast<char *>(dst) + (i * bytes),
+		 seg_header->mailboxes[i], bytes);
+      // nobody may reuse their mailbox until the root is done reading
+      barrier();
+    }
+
+    void broadcast(NodeID root, void *data, size_t bytes)
+    {
+      assert(bytes <= MAILBOX_BYTES);
+      if(my_node_id == root)
+	memcpy(seg_header->mailboxes[root], data, bytes);
+      barrier();
+      if(my_node_id != root)
+	memcpy(data, seg_header->mailboxes[root], bytes);
+      barrier();
+    }
+
+    int finalize(void)
+    {
+      if(num_ranks <= 1)
+	return 0;
+
+      int result = 0;
+      if(my_node_id == 0) {
+	AutoHSLLock al(peer_mutex);
+	for(size_t i = 0; i < child_pids.size(); i++) {
+	  if(child_pids[i] != 0) {
+	    int status;
+	    if(waitpid(child_pids[i], &status, 0) == child_pids[i])
+	      child_status[i] = exit_code(status);
+	    child_pids[i] = 0;
+	  }
+	  if((child_status[i] != 0) && (result == 0))
+	    result = child_status[i];
+	}
+      }
+
+      seg_header->finished[my_node_id].store_release(1);
+
+      delete[] endpoints;
+      endpoints = 0;
+      delete[] partials;
+      partials = 0;
+      munmap(segment_base, segment_size);
+      segment_base = 0;
+      seg_header = 0;
+      num_ranks = 1;
+      return result;
+    }
+
+  };
+
+}; // namespace Realm
@@ -0,0 +1,85 @@
+/* Copyright 2019 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared-memory active message transport for non-GASNet builds
+
+// when Realm is built without GASNet, '-ll:shm <n>' runs the application as
+//  <n> processes on the local machine - rank 0 creates a shared segment,
+//  forks the other ranks, and messages are passed through single-producer/
+//  single-consumer byte rings in that segment
+
+#ifndef REALM_SHM_TRANSPORT_H
+#define REALM_SHM_TRANSPORT_H
+
+#include "realm/realm_config.h"
+#include "realm/activemsg.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Realm {
+
+  class CoreReservationSet;
+
+  namespace SharedMemoryTransport {
+
+    // scans the (unparsed) command line for -ll:shm and, if more than one
+    //  rank is requested, creates the shared segment and forks the other
+    //  ranks - sets my_node_id/max_node_id in every process, and must be
+    //  called before any threads are created
+    bool create_ranks(int argc, char **argv);
+
+    // true if this process is one of several ranks
+    bool is_active(void);
+
+    // consumes the transport's command line options and creates the core
+    //  reservations for the polling/handler threads
+    void init(CoreReservationSet& crs, std::vector<std::string>& cmdline);
+
+    void start_polling_threads(void);
+    void start_handler_threads(int count, size_t stack_size);
+    void stop_threads(void);
+
+    // sends never block - if the ring to 'target' is full, the unsent
+    //  portion of the message is copied and pushed by the polling thread
+    //  once the receiver makes room
+    void send(NodeID target, int msgid,
+	      const void *args, size_t arg_size,
+	      const void *payload, size_t payload_size,
+	      int payload_mode, void *dstptr);
+
+    // pushes pending sends and receives whatever has arrived - returns
+    //  true if any progress was made
+    bool poll(void);
+
+    // largest payload that should be sent in a single message
+    size_t max_payload_size(void);
+
+    // collectives over all ranks - each rank must call these in the same
+    //  order, and gather/broadcast are limited to small (mailbox-sized) data
+    void barrier(void);
+    void gather(NodeID root, void *dst, const void *src, size_t bytes);
+    void broadcast(NodeID root, void *data, size_t bytes);
+
+    // on rank 0, waits for the other ranks to exit and returns the first
+    //  nonzero exit status - other ranks just return 0
+    int finalize(void);
+
+  };
+
+}; // namespace Realm
+
+#endif // ifndef REALM_SHM_TRANSPORT_H
@@ -123,6 +123,61 @@ namespace Realm {
     std::vector<Rect<N,T> > approx_rects;
   };
 
+  // a HierarchicalBitMap is a dense array of bits (one per point in its bounds)
+  //  recording which points are present - a second level of summary bits (one
+  //  per 64-bit word of the first level) lets scans skip over large empty
+  //  areas without touching every word
+  // points are linearized with dimension 0 varying fastest, so iteration
+  //  produces maximal runs of points along dimension 0 as rectangles
+  template <int N, typename T>
+  class HierarchicalBitMap {
+  public:
+    HierarchicalBitMap(const Rect<N,T>& _bounds);
+
+    // marks points as present - they must lie within the bounds
+    void set(const Point<N,T>& p);
+    void set_rect(const Rect<N,T>& r);
+
+    bool contains(const Point<N,T>& p) const;
+    bool contains_any(const Rect<N,T>& r) const;
+    size_t count(const Rect<N,T>& r) const;
+
+    // linear position of a point within the bounds, used as the starting
+    //  cursor for next_run
+    size_t index_of(const Point<N,T>& p) const;
+
+    // finds the first maximal run of present points along dimension 0 that
+    //  lies within 'restriction' and starts at or after linear position 'pos' -
+    //  on success, 'run' is filled in and 'pos' is moved just past the run
+    bool next_run(const Rect<N,T>& restriction, size_t& pos,
+		  Rect<N,T>& run) const;
+
+    size_t bytes_used(void) const;
+
+    // raw access to the dense bits, used to send a bitmap to another node -
+    //  set_words ORs in 'count' words starting at word 'first'
+    size_t num_words(void) const;
+    const unsigned long long *get_words(void) const;
+    void set_words(size_t first, const unsigned long long *data, size_t count);
+
+    Rect<N,T> bounds;
+
+  protected:
+    Point<N,T> point_at(size_t idx) const;
+    // advances 'p' to the start of the next dimension-0 row of 'r'
+    static bool next_row(Point<N,T>& p, const Rect<N,T>& r);
+    // scans in [from, limit), returning 'limit' if no such bit is found
+    size_t find_set(size_t from, size_t limit) const;
+    size_t find_clear(size_t from, size_t limit) const;
+    size_t count_range(size_t from, size_t limit) const;
+    void set_range(size_t from, size_t limit);
+
+    size_t strides[N];
+    size_t num_bits;
+    std::vector<unsigned long long> words;
+    std::vector<unsigned long long> summary;  // bit i set iff words[i] != 0
+  };
+
 }; // namespace Realm
 
 #include "realm/sparsity.inl"
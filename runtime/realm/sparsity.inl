@@ -84,5 +84,277 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class HierarchicalBitMap<N,T>
+
+  template <int N, typename T>
+  inline HierarchicalBitMap<N,T>::HierarchicalBitMap(const Rect<N,T>& _bounds)
+    : bounds(_bounds)
+  {
+    assert(!bounds.empty());
+    strides[0] = 1;
+    for(int i = 1; i < N; i++)
+      strides[i] = strides[i - 1] * size_t(bounds.hi[i - 1] - bounds.lo[i - 1] + 1);
+    num_bits = strides[N - 1] * size_t(bounds.hi[N - 1] - bounds.lo[N - 1] + 1);
+    words.assign((num_bits + 63) >> 6, 0);
+    summary.assign((words.size() + 63) >> 6, 0);
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::index_of(const Point<N,T>& p) const
+  {
+    size_t idx = 0;
+    for(int i = 0; i < N; i++)
+      idx += size_t(p[i] - bounds.lo[i]) * strides[i];
+    return idx;
+  }
+
+  template <int N, typename T>
+  inline Point<N,T> HierarchicalBitMap<N,T>::point_at(size_t idx) const
+  {
+    Point<N,T> p;
+    for(int i = N - 1; i > 0; i--) {
+      p[i] = bounds.lo[i] + T(idx / strides[i]);
+      idx = idx % strides[i];
+    }
+    p[0] = bounds.lo[0] + T(idx);
+    return p;
+  }
+
+  template <int N, typename T>
+  inline /*static*/ bool HierarchicalBitMap<N,T>::next_row(Point<N,T>& p,
+							   const Rect<N,T>& r)
+  {
+    for(int i = 1; i < N; i++) {
+      if(p[i] < r.hi[i]) {
+	p[i]++;
+	return true;
+      }
+      p[i] = r.lo[i];
+    }
+    return false;
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::find_set(size_t from, size_t limit) const
+  {
+    if(from >= limit) return limit;
+    size_t w = from >> 6;
+    unsigned long long bits = words[w] & (~0ULL << (from & 63));
+    while(!bits) {
+      w++;
+      if((w << 6) >= limit)
+	return limit;
+      // the next word is the common case for anything but very sparse
+      //  bitmaps, so only consult the summary bits if that's empty too
+      bits = words[w];
+      if(bits) break;
+      size_t nw = w + 1;
+      size_t s = nw >> 6;
+      if(s >= summary.size())
+	return limit;
+      unsigned long long sbits = summary[s] & (~0ULL << (nw & 63));
+      while(!sbits) {
+	s++;
+	if((s >= summary.size()) || ((s << 12) >= limit))
+	  return limit;
+	sbits = summary[s];
+      }
+      w = (s << 6) + __builtin_ctzll(sbits);
+      if((w << 6) >= limit)
+	return limit;
+      bits = words[w];
+    }
+    size_t idx = (w << 6) + __builtin_ctzll(bits);
+    return ((idx < limit) ? idx : limit);
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::find_clear(size_t from, size_t limit) const
+  {
+    while(from < limit) {
+      size_t w = from >> 6;
+      unsigned long long bits = ~words[w] & (~0ULL << (from & 63));
+      if(bits) {
+	size_t idx = (w << 6) + __builtin_ctzll(bits);
+	return ((idx < limit) ? idx : limit);
+      }
+      from = (w + 1) << 6;
+    }
+    return limit;
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::count_range(size_t from, size_t limit) const
+  {
+    size_t total = 0;
+    while(from < limit) {
+      size_t w = from >> 6;
+      size_t ofs = from & 63;
+      size_t span = std::min(64 - ofs, limit - from);
+      unsigned long long mask = ((span == 64) ?
+				   ~0ULL :
+				   (((1ULL << span) - 1) << ofs));
+      total += __builtin_popcountll(words[w] & mask);
+      from += span;
+    }
+    return total;
+  }
+
+  template <int N, typename T>
+  inline void HierarchicalBitMap<N,T>::set_range(size_t from, size_t limit)
+  {
+    while(from < limit) {
+      size_t w = from >> 6;
+      size_t ofs = from & 63;
+      size_t span = std::min(64 - ofs, limit - from);
+      unsigned long long mask = ((span == 64) ?
+				   ~0ULL :
+				   (((1ULL << span) - 1) << ofs));
+      words[w] |= mask;
+      summary[w >> 6] |= (1ULL << (w & 63));
+      from += span;
+    }
+  }
+
+  template <int N, typename T>
+  inline void HierarchicalBitMap<N,T>::set(const Point<N,T>& p)
+  {
+    assert(bounds.contains(p));
+    size_t idx = index_of(p);
+    set_range(idx, idx + 1);
+  }
+
+  template <int N, typename T>
+  inline void HierarchicalBitMap<N,T>::set_rect(const Rect<N,T>& r)
+  {
+    if(r.empty()) return;
+    assert(bounds.contains(r));
+    size_t len = size_t(r.hi[0] - r.lo[0] + 1);
+    Point<N,T> p = r.lo;
+    do {
+      size_t idx = index_of(p);
+      set_range(idx, idx + len);
+    } while(next_row(p, r));
+  }
+
+  template <int N, typename T>
+  inline bool HierarchicalBitMap<N,T>::contains(const Point<N,T>& p) const
+  {
+    if(!bounds.contains(p)) return false;
+    size_t idx = index_of(p);
+    return ((words[idx >> 6] >> (idx & 63)) & 1) != 0;
+  }
+
+  template <int N, typename T>
+  inline bool HierarchicalBitMap<N,T>::contains_any(const Rect<N,T>& r) const
+  {
+    Rect<N,T> isect = bounds.intersection(r);
+    if(isect.empty()) return false;
+    size_t len = size_t(isect.hi[0] - isect.lo[0] + 1);
+    Point<N,T> p = isect.lo;
+    do {
+      size_t idx = index_of(p);
+      if(find_set(idx, idx + len) < (idx + len))
+	return true;
+    } while(next_row(p, isect));
+    return false;
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::count(const Rect<N,T>& r) const
+  {
+    Rect<N,T> isect = bounds.intersection(r);
+    if(isect.empty()) return 0;
+    size_t len = size_t(isect.hi[0] - isect.lo[0] + 1);
+    size_t total = 0;
+    Point<N,T> p = isect.lo;
+    do {
+      size_t idx = index_of(p);
+      total += count_range(idx, idx + len);
+    } while(next_row(p, isect));
+    return total;
+  }
+
+  template <int N, typename T>
+  inline bool HierarchicalBitMap<N,T>::next_run(const Rect<N,T>& restriction,
+						size_t& pos,
+						Rect<N,T>& run) const
+  {
+    Rect<N,T> r = bounds.intersection(restriction);
+    if(r.empty()) return false;
+    while(true) {
+      size_t idx = find_set(pos, num_bits);
+      if(idx >= num_bits) return false;
+      Point<N,T> p = point_at(idx);
+
+      // if the point is outside the restriction, move the cursor to the
+      //  next place a run could start, from the outermost dimension in
+      int bad_dim = -1;
+      for(int i = N - 1; i >= 0; i--)
+	if((p[i] < r.lo[i]) || (p[i] > r.hi[i])) {
+	  bad_dim = i;
+	  break;
+	}
+      if(bad_dim >= 0) {
+	if(p[bad_dim] < r.lo[bad_dim]) {
+	  p[bad_dim] = r.lo[bad_dim];
+	} else {
+	  // past the end in this dimension - carry into the next one up
+	  if(bad_dim == (N - 1)) return false;
+	  p[bad_dim] = bounds.lo[bad_dim];
+	  p[bad_dim + 1]++;
+	}
+	for(int i = 0; i < bad_dim; i++)
+	  p[i] = bounds.lo[i];
+	pos = index_of(p);
+	continue;
+      }
+
+      size_t limit = idx + size_t(r.hi[0] - p[0]) + 1;
+      size_t end = find_clear(idx, limit);
+      run.lo = p;
+      run.hi = p;
+      run.hi[0] = p[0] + T(end - idx - 1);
+      pos = end;
+      return true;
+    }
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::bytes_used(void) const
+  {
+    return (sizeof(*this) +
+	    (words.size() + summary.size()) * sizeof(unsigned long long));
+  }
+
+  template <int N, typename T>
+  inline size_t HierarchicalBitMap<N,T>::num_words(void) const
+  {
+    return words.size();
+  }
+
+  template <int N, typename T>
+  inline const unsigned long long *HierarchicalBitMap<N,T>::get_words(void) const
+  {
+    return &words[0];
+  }
+
+  template <int N, typename T>
+  inline void HierarchicalBitMap<N,T>::set_words(size_t first,
+						 const unsigned long long *data,
+						 size_t count)
+  {
+    assert((first + count) <= words.size());
+    for(size_t i = 0; i < count; i++)
+      if(data[i] != 0) {
+	size_t w = first + i;
+	words[w] |= data[i];
+	summary[w >> 6] |= (1ULL << (w & 63));
+      }
+  }
+
+
 }; // namespace Realm
 
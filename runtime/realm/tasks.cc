@@ -313,9 +313,16 @@ namespace Realm {
   //
 
   TaskQueue::TaskQueue(void)
-    : task_count_gauge(0)
+    : top_priority(PRI_NEG_INF)
+    , task_count_gauge(0)
   {}
 
+  void TaskQueue::update_top_priority(void)
+  {
+    Task *head = ready_task_list.front();
+    top_priority.store_release(head ? head->priority : PRI_NEG_INF);
+  }
+
   void TaskQueue::add_subscription(NotificationCallback *callback,
 				   priority_t higher_than /*= PRI_NEG_INF*/)
   {
@@ -344,6 +351,8 @@ namespace Realm {
       {
 	AutoHSLLock al((*it)->mutex);
 	new_task = (*it)->ready_task_list.pop_front(task_priority+1);
+	if(new_task)
+	  (*it)->update_top_priority();
       }
       if(new_task) {
 	if((*it)->task_count_gauge)
@@ -354,6 +363,7 @@ namespace Realm {
 	  {
 	    AutoHSLLock al(task_source->mutex);
 	    task_source->ready_task_list.push_front(task);
+	    task_source->update_top_priority();
 	  }
 	  if(task_source->task_count_gauge)
 	    (*task_source->task_count_gauge) += 1;
@@ -368,6 +378,43 @@ namespace Realm {
     return task;
   }
 
+  /*static*/ Task *TaskQueue::steal_best_task(const std::vector<TaskQueue *>& queues,
+					      int& task_priority)
+  {
+    // a failed attempt means another worker took the task we were after, so
+    //  keep going as long as some queue advertises something better than
+    //  what we already have
+    while(true) {
+      TaskQueue *best = 0;
+      priority_t best_priority = task_priority;
+      for(std::vector<TaskQueue *>::const_iterator it = queues.begin();
+	  it != queues.end();
+	  it++) {
+	priority_t p = (*it)->top_priority.load_acquire();
+	if(p > best_priority) {
+	  best = *it;
+	  best_priority = p;
+	}
+      }
+      if(!best)
+	return 0;
+
+      Task *task;
+      {
+	AutoHSLLock al(best->mutex);
+	task = best->ready_task_list.pop_front(task_priority+1);
+	if(task)
+	  best->update_top_priority();
+      }
+      if(task) {
+	if(best->task_count_gauge)
+	  *(best->task_count_gauge) -= 1;
+	task_priority = task->priority;
+	return task;
+      }
+    }
+  }
+
   void TaskQueue::enqueue_task(Task *task)
   {
     priority_t notify_priority = PRI_NEG_INF;
@@ -379,6 +426,7 @@ namespace Realm {
 	if(ready_task_list.empty(task->priority))
 	  notify_priority = task->priority;
 	ready_task_list.push_back(task);
+	update_top_priority();
       }
 
       if(task_count_gauge)
@@ -427,6 +475,7 @@ namespace Realm {
 	notify_priority = PRI_NEG_INF;
       // absorb new list into ours
       ready_task_list.absorb_append(tasks);
+      update_top_priority();
     }
 
     if(task_count_gauge)
@@ -439,6 +488,140 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class TaskDeque
+  //
+
+  namespace ThreadLocal {
+    __thread TaskDeque *current_task_deque = 0;
+  };
+
+  TaskDeque::Buffer::Buffer(long long _size)
+    : size(_size)
+    , slots(new atomic<Task *>[_size])
+  {}
+
+  TaskDeque::Buffer::~Buffer(void)
+  {
+    delete[] slots;
+  }
+
+  inline Task *TaskDeque::Buffer::get(long long idx) const
+  {
+    return slots[idx & (size - 1)].load();
+  }
+
+  inline void TaskDeque::Buffer::put(long long idx, Task *task)
+  {
+    slots[idx & (size - 1)].store(task);
+  }
+
+  TaskDeque::TaskDeque(ProcessorGroup *_group)
+    : group(_group)
+    , top(0)
+    , bottom(0)
+    , buffer(new Buffer(64))
+  {}
+
+  TaskDeque::~TaskDeque(void)
+  {
+    // nobody should be able to see us any more, so no tasks can be left
+    assert(top.load() == bottom.load());
+    delete buffer.load();
+    for(std::vector<Buffer *>::iterator it = retired_buffers.begin();
+	it != retired_buffers.end();
+	++it)
+      delete *it;
+  }
+
+  void TaskDeque::push(Task *task)
+  {
+    // a cancelled task never makes it into the deque
+    if(!task->mark_ready()) {
+      task->mark_finished(false /*!successful*/);
+      return;
+    }
+
+    long long b = bottom.load();
+    long long t = top.load_acquire();
+    Buffer *buf = buffer.load();
+
+    if((b - t) >= buf->size) {
+      // full - copy the live entries into a buffer twice the size
+      Buffer *bigger = new Buffer(buf->size * 2);
+      for(long long i = t; i < b; i++)
+	bigger->put(i, buf->get(i));
+      retired_buffers.push_back(buf);
+      buffer.store_release(bigger);
+      buf = bigger;
+    }
+
+    buf->put(b, task);
+    // the release makes the task (and the buffer) visible to thieves that
+    //  observe the new bottom
+    bottom.store_release(b + 1);
+
+    // thieves that went to sleep on an empty deque need to hear about this
+    if(b == t)
+      for(size_t i = 0; i < callbacks.size(); i++)
+	callbacks[i]->item_available(DEQUE_PRIORITY);
+  }
+
+  Task *TaskDeque::pop(void)
+  {
+    long long b = bottom.load() - 1;
+    Buffer *buf = buffer.load();
+    bottom.store(b);
+    // the reservation of the bottom slot must be visible before we look at
+    //  top, or a thief and the owner can both take the last task
+    __sync_synchronize();
+    long long t = top.load();
+
+    if(t > b) {
+      // empty - undo the reservation
+      bottom.store(b + 1);
+      return 0;
+    }
+
+    Task *task = buf->get(b);
+    if(t == b) {
+      // last task - race any thieves for it
+      if(!top.compare_exchange(t, t + 1))
+	task = 0;
+      bottom.store(b + 1);
+    }
+    return task;
+  }
+
+  Task *TaskDeque::steal(void)
+  {
+    long long t = top.load_acquire();
+    // top must be read before bottom (see pop)
+    __sync_synchronize();
+    long long b = bottom.load_acquire();
+
+    if(t >= b)
+      return 0;
+
+    Buffer *buf = buffer.load_acquire();
+    Task *task = buf->get(t);
+    if(!top.compare_exchange(t, t + 1))
+      return 0;  // lost the race to the owner or another thief
+    return task;
+  }
+
+  bool TaskDeque::maybe_empty(void) const
+  {
+    return (top.load() >= bottom.load());
+  }
+
+  void TaskDeque::add_subscription(TaskQueue::NotificationCallback *callback)
+  {
+    callbacks.push_back(callback);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class ThreadedTaskScheduler::WorkCounter
@@ -584,7 +767,9 @@ namespace Realm {
   //
 
   ThreadedTaskScheduler::ThreadedTaskScheduler(void)
-    : shutdown_flag(false)
+    : own_deque(0)
+    , next_victim(0)
+    , shutdown_flag(false)
     , active_worker_count(0)
     , unassigned_worker_count(0)
     , wcu_task_queues(this)
@@ -593,6 +778,7 @@ namespace Realm {
     , cfg_max_idle_workers(1)
     , cfg_min_active_workers(1)
     , cfg_max_active_workers(1)
+    , cfg_work_stealing(Config::use_work_stealing)
   {
     // hook up the work counter updates for the resumable worker queue
     resumable_workers.add_subscription(&wcu_resume_queue);
@@ -616,6 +802,61 @@ namespace Realm {
     queue->add_subscription(&wcu_task_queues);
   }
 
+  bool ThreadedTaskScheduler::add_task_deque(TaskDeque *deque, bool owned)
+  {
+    AutoHSLLock al(lock);
+
+    if(owned) {
+      // pushes and pops are only safe from one worker at a time
+      if(own_deque || (cfg_max_active_workers != 1))
+	return false;
+      own_deque = deque;
+    } else
+      victim_deques.push_back(deque);
+
+    deque->add_subscription(&wcu_task_queues);
+    return true;
+  }
+
+  Task *ThreadedTaskScheduler::steal_best_ready_task(int& task_priority)
+  {
+    // deque tasks all have the same priority, so anything better in a
+    //  task queue goes first
+    int list_priority = std::max(task_priority,
+				 int(TaskDeque::DEQUE_PRIORITY));
+    Task *task = TaskQueue::steal_best_task(task_queues, list_priority);
+    if(task) {
+      task_priority = list_priority;
+      return task;
+    }
+
+    if(task_priority < TaskDeque::DEQUE_PRIORITY) {
+      // our own deque first (newest task, warmest in cache), then the
+      //  oldest task from somebody else's
+      if(own_deque)
+	task = own_deque->pop();
+
+      for(size_t i = 0; !task && (i < victim_deques.size()); i++) {
+	TaskDeque *victim = victim_deques[next_victim];
+	while(!victim->maybe_empty()) {
+	  task = victim->steal();
+	  if(task) break;
+	}
+	if(!task && (++next_victim == victim_deques.size()))
+	  next_victim = 0;
+      }
+
+      if(task) {
+	task_priority = TaskDeque::DEQUE_PRIORITY;
+	return task;
+      }
+    }
+
+    // finally, task queue entries between the caller's priority and the
+    //  deque priority
+    return TaskQueue::steal_best_task(task_queues, task_priority);
+  }
+
   // helper for tracking/sanity-checking worker counts
   void ThreadedTaskScheduler::update_worker_count(int active_delta,
 						  int unassigned_delta,
@@ -875,7 +1116,9 @@ namespace Realm {
 
 	// try to get a new task then
 	int task_priority = resumable_priority;
-	Task *task = TaskQueue::get_best_task(task_queues, task_priority);
+	Task *task = (cfg_work_stealing ?
+		        steal_best_ready_task(task_priority) :
+		        TaskQueue::get_best_task(task_queues, task_priority));
 
 	// did we find work to do?
 	if(task) {
@@ -894,6 +1137,9 @@ namespace Realm {
 	  //  priority here
 	  worker_priorities[Thread::self()] = task_priority;
 
+	  // tasks that become ready while this one runs go into our deque
+	  ThreadLocal::current_task_deque = own_deque;
+
 	  // release the lock while we run the task
 	  lock.unlock();
 
@@ -903,6 +1149,8 @@ namespace Realm {
 	    execute_task(task);
 	  assert(ok);  // no fault recovery yet
 
+	  ThreadLocal::current_task_deque = 0;
+
 	  lock.lock();
 
 	  worker_priorities.erase(Thread::self());
@@ -32,6 +32,7 @@
 namespace Realm {
 
     class ProcessorImpl;
+    class ProcessorGroup;
   
     // information for a task launch
     class Task : public Operation {
@@ -128,6 +129,9 @@ namespace Realm {
 
       GASNetHSL mutex;
       Task::TaskList ready_task_list;
+      // priority of the best task in ready_task_list (PRI_NEG_INF if empty) -
+      //  only written with the mutex held, but may be read without it
+      atomic<priority_t> top_priority;
       std::vector<NotificationCallback *> callbacks;
       std::vector<priority_t> callback_priorities;
       ProfilingGauges::AbsoluteRangeGauge<int> *task_count_gauge;
@@ -140,8 +144,77 @@ namespace Realm {
       static Task *get_best_task(const std::vector<TaskQueue *>& queues,
 				 int& task_priority);
 
+      // same as above, but chooses a queue using the advertised top
+      //  priorities, so only the mutex of that one queue is taken - ties go
+      //  to the queue that appears first in the list
+      static Task *steal_best_task(const std::vector<TaskQueue *>& queues,
+				   int& task_priority);
+
       void enqueue_task(Task *task);
       void enqueue_tasks(Task::TaskList& tasks);
+
+    protected:
+      // must be called with the mutex held whenever ready_task_list changes
+      void update_top_priority(void);
+    };
+
+    // a Chase-Lev work-stealing deque of ready tasks (used with -ll:steal) -
+    //  the owning worker pushes and pops at the bottom without any locks or
+    //  read-modify-writes (except to take the last task), while other
+    //  workers steal from the top with a single compare-and-swap
+    // a deque holds only tasks of priority DEQUE_PRIORITY - the scheduler
+    //  compares that with the priorities advertised by its TaskQueues
+    class TaskDeque {
+    public:
+      TaskDeque(ProcessorGroup *_group);
+      ~TaskDeque(void);
+
+      static const TaskQueue::priority_t DEQUE_PRIORITY = 0;
+
+      // the group whose members share this deque
+      ProcessorGroup *group;
+
+      // owner only - like TaskQueue::enqueue_task, a cancelled task is
+      //  finished rather than added
+      void push(Task *task);
+      Task *pop(void);
+
+      // any thread - returns 0 if the deque is empty or another thread won
+      //  the race for the top task
+      Task *steal(void);
+
+      // a racy estimate, good enough to decide whether to try stealing
+      bool maybe_empty(void) const;
+
+      // called (by the owner, without locks) when a push finds the deque
+      //  empty - subscriptions must be added before any pushes
+      void add_subscription(TaskQueue::NotificationCallback *callback);
+
+    protected:
+      // a circular buffer of tasks - a full buffer is replaced by one twice
+      //  the size, and the old one is kept (until the deque is destroyed)
+      //  because a thief may still be reading from it
+      struct Buffer {
+	Buffer(long long _size);
+	~Buffer(void);
+
+	long long size;  // power of 2
+	atomic<Task *> *slots;
+
+	Task *get(long long idx) const;
+	void put(long long idx, Task *task);
+      };
+
+      atomic<long long> top, bottom;
+      atomic<Buffer *> buffer;
+      std::vector<Buffer *> retired_buffers;  // owner only
+      std::vector<TaskQueue::NotificationCallback *> callbacks;
+    };
+
+    namespace ThreadLocal {
+      // the deque owned by the scheduler whose worker is running on this
+      //  thread, if that scheduler has one
+      extern __thread TaskDeque *current_task_deque;
     };
 
     // a task scheduler in which one or more worker threads execute tasks from one
@@ -158,6 +231,11 @@ namespace Realm {
 
       virtual void add_task_queue(TaskQueue *queue);
 
+      // work-stealing schedulers own at most one deque (which their workers
+      //  push newly-ready tasks into) and steal from any others - returns
+      //  false if this scheduler can't own a deque
+      bool add_task_deque(TaskDeque *deque, bool owned);
+
       virtual void start(void) = 0;
       virtual void shutdown(void) = 0;
 
@@ -186,8 +264,14 @@ namespace Realm {
       // gets highest priority task available from any task queue
       Task *get_best_ready_task(int& task_priority);
 
+      // same, using the work-stealing deques as well as the task queues
+      Task *steal_best_ready_task(int& task_priority);
+
       GASNetHSL lock;
       std::vector<TaskQueue *> task_queues;
+      TaskDeque *own_deque;
+      std::vector<TaskDeque *> victim_deques;
+      size_t next_victim;  // protected by 'lock'
       std::vector<Thread *> idle_workers;
       std::set<Thread *> blocked_workers;
       // threads that block while holding a scheduler lock go here instead
@@ -275,6 +359,7 @@ namespace Realm {
       int cfg_max_idle_workers;
       int cfg_min_active_workers;
       int cfg_max_active_workers;
+      bool cfg_work_stealing;  // use TaskQueue::steal_best_task
     };
 
     inline long long ThreadedTaskScheduler::WorkCounter::read_counter(void) const
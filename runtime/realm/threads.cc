@@ -39,7 +39,11 @@ typedef cpuset_t cpu_set_t;
 #endif
 
 #ifdef REALM_USE_USER_THREADS
+#ifdef REALM_USE_FAST_USER_SWITCH
+#include <sys/mman.h>
+#else
 #include <ucontext.h>
+#endif
 #ifdef __MACH__
 // MacOS has (loudly) deprecated set/get/make/swapcontext,
 //  despite there being no POSIX replacement for them...
@@ -67,6 +71,7 @@ inline void makecontext_wrap(ucontext_t *u, void (*fn)(), int args, ...) { makec
 #include <signal.h>
 #include <string>
 #include <map>
+#include <vector>
 
 #ifdef __linux__
 // needed for scanning Linux's /sys
@@ -888,16 +893,271 @@ namespace Realm {
   // class UserThread
 
 #ifdef REALM_USE_USER_THREADS
+#ifdef REALM_USE_FAST_USER_SWITCH
+  // a suspended user context is just its stack pointer - the callee-saved
+  //  registers (and floating point control state) are pushed onto the
+  //  context's own stack by realm_uswitch_swap before it changes stacks, and
+  //  popped back off when something switches to it again
+  //
+  // unlike swapcontext, the signal mask is not saved and restored, which
+  //  saves a syscall per switch - nothing in Realm changes a thread's signal
+  //  mask, so all contexts on a host thread share the same one anyway
+  struct UserContext {
+    void *sp;
+  };
+
+  extern "C" {
+    // saves the current context's stack pointer in '*save_sp' and resumes
+    //  the context whose stack pointer is 'restore_sp'
+    void realm_uswitch_swap(void **save_sp, void *restore_sp);
+    // first code run by a new context - calls the entry point stashed in
+    //  a callee-saved register by uctx_init
+    void realm_uswitch_trampoline(void);
+  }
+
+  // the routines are emitted into .text explicitly, and the section is
+  //  restored afterwards, so that whatever section the compiler was using
+  //  at this point in the file is unaffected
+#if defined(__x86_64__)
+  asm(".pushsection .text\n"
+      ".globl realm_uswitch_swap\n"
+      ".hidden realm_uswitch_swap\n"
+      ".type realm_uswitch_swap,@function\n"
+      ".p2align 4\n"
+      "realm_uswitch_swap:\n"
+      "  pushq %rbp\n"
+      "  pushq %rbx\n"
+      "  pushq %r15\n"
+      "  pushq %r14\n"
+      "  pushq %r13\n"
+      "  pushq %r12\n"
+      "  subq $8, %rsp\n"
+      "  stmxcsr (%rsp)\n"
+      "  fnstcw 4(%rsp)\n"
+      "  movq %rsp, (%rdi)\n"
+      "  movq %rsi, %rsp\n"
+      "  ldmxcsr (%rsp)\n"
+      "  fldcw 4(%rsp)\n"
+      "  addq $8, %rsp\n"
+      "  popq %r12\n"
+      "  popq %r13\n"
+      "  popq %r14\n"
+      "  popq %r15\n"
+      "  popq %rbx\n"
+      "  popq %rbp\n"
+      "  ret\n"
+      ".size realm_uswitch_swap,.-realm_uswitch_swap\n"
+      ".globl realm_uswitch_trampoline\n"
+      ".hidden realm_uswitch_trampoline\n"
+      ".type realm_uswitch_trampoline,@function\n"
+      ".p2align 4\n"
+      "realm_uswitch_trampoline:\n"
+      "  .cfi_startproc\n"
+      "  .cfi_undefined rip\n"
+      "  callq *%r12\n"
+      "  ud2\n"
+      "  .cfi_endproc\n"
+      ".size realm_uswitch_trampoline,.-realm_uswitch_trampoline\n"
+      ".popsection\n");
+
+  // saved state, from the lowest address up: mxcsr/x87 control word, r12,
+  //  r13, r14, r15, rbx, rbp, return address
+  static const size_t USWITCH_FRAME_WORDS = 8;
+#elif defined(__aarch64__)
+  // sp has to stay 16-byte aligned, so the frame is padded to 22 words
+  asm(".pushsection .text\n"
+      ".globl realm_uswitch_swap\n"
+      ".hidden realm_uswitch_swap\n"
+      ".type realm_uswitch_swap,%function\n"
+      ".p2align 4\n"
+      "realm_uswitch_swap:\n"
+      "  sub sp, sp, #176\n"
+      "  stp x19, x20, [sp, #0]\n"
+      "  stp x21, x22, [sp, #16]\n"
+      "  stp x23, x24, [sp, #32]\n"
+      "  stp x25, x26, [sp, #48]\n"
+      "  stp x27, x28, [sp, #64]\n"
+      "  stp x29, x30, [sp, #80]\n"
+      "  stp d8, d9, [sp, #96]\n"
+      "  stp d10, d11, [sp, #112]\n"
+      "  stp d12, d13, [sp, #128]\n"
+      "  stp d14, d15, [sp, #144]\n"
+      "  mrs x9, fpcr\n"
+      "  str x9, [sp, #160]\n"
+      "  mov x9, sp\n"
+      "  str x9, [x0]\n"
+      "  mov sp, x1\n"
+      "  ldr x9, [sp, #160]\n"
+      "  msr fpcr, x9\n"
+      "  ldp x19, x20, [sp, #0]\n"
+      "  ldp x21, x22, [sp, #16]\n"
+      "  ldp x23, x24, [sp, #32]\n"
+      "  ldp x25, x26, [sp, #48]\n"
+      "  ldp x27, x28, [sp, #64]\n"
+      "  ldp x29, x30, [sp, #80]\n"
+      "  ldp d8, d9, [sp, #96]\n"
+      "  ldp d10, d11, [sp, #112]\n"
+      "  ldp d12, d13, [sp, #128]\n"
+      "  ldp d14, d15, [sp, #144]\n"
+      "  add sp, sp, #176\n"
+      "  ret\n"
+      ".size realm_uswitch_swap,.-realm_uswitch_swap\n"
+      ".globl realm_uswitch_trampoline\n"
+      ".hidden realm_uswitch_trampoline\n"
+      ".type realm_uswitch_trampoline,%function\n"
+      ".p2align 4\n"
+      "realm_uswitch_trampoline:\n"
+      "  .cfi_startproc\n"
+      "  .cfi_undefined x30\n"
+      "  blr x19\n"
+      "  brk #0\n"
+      "  .cfi_endproc\n"
+      ".size realm_uswitch_trampoline,.-realm_uswitch_trampoline\n"
+      ".popsection\n");
+
+  // saved state, from the lowest address up: x19-x28, x29 (frame pointer),
+  //  x30 (return address), d8-d15, fpcr, padding
+  static const size_t USWITCH_FRAME_WORDS = 22;
+#endif
+
+  // prepares 'ctx' so that the first switch to it calls 'entry' on the
+  //  given stack - 'entry' must never return
+  static void uctx_init(UserContext *ctx, void *stack_base, size_t stack_size,
+			void (*entry)(void))
+  {
+    uintptr_t top = (reinterpret_cast<uintptr_t>(stack_base) + stack_size) & ~uintptr_t(15);
+    uintptr_t *frame = reinterpret_cast<uintptr_t *>(top) - USWITCH_FRAME_WORDS;
+    memset(frame, 0, USWITCH_FRAME_WORDS * sizeof(uintptr_t));
+    // new contexts inherit the creator's floating point control state, as
+    //  they would with getcontext/makecontext
+#if defined(__x86_64__)
+    unsigned mxcsr;
+    unsigned short fpcw;
+    asm volatile("stmxcsr %0" : "=m" (mxcsr));
+    asm volatile("fnstcw %0" : "=m" (fpcw));
+    frame[0] = mxcsr | (uintptr_t(fpcw) << 32);
+    frame[1] = reinterpret_cast<uintptr_t>(entry);  // r12
+    frame[6] = 0;  // rbp - terminates frame pointer chains
+    frame[7] = reinterpret_cast<uintptr_t>(&realm_uswitch_trampoline);
+#elif defined(__aarch64__)
+    uintptr_t fpcr;
+    asm volatile("mrs %0, fpcr" : "=r" (fpcr));
+    frame[0] = reinterpret_cast<uintptr_t>(entry);  // x19
+    frame[10] = 0;  // x29 - terminates frame pointer chains
+    frame[11] = reinterpret_cast<uintptr_t>(&realm_uswitch_trampoline);  // x30
+    frame[20] = fpcr;
+#endif
+    ctx->sp = frame;
+  }
+
+  // always succeeds - returns an int only to match swapcontext
+  static inline int uctx_swap(UserContext *save_ctx, UserContext *restore_ctx)
+  {
+    realm_uswitch_swap(&save_ctx->sp, restore_ctx->sp);
+    return 0;
+  }
+#else
+  typedef ucontext_t UserContext;
+
+  static void uctx_init(UserContext *ctx, void *stack_base, size_t stack_size,
+			void (*entry)(void))
+  {
+    CHECK_LIBC( getcontext(ctx) );
+
+    ctx->uc_link = 0; // we don't expect it to ever fall through
+    ctx->uc_stack.ss_sp = stack_base;
+    ctx->uc_stack.ss_size = stack_size;
+    ctx->uc_stack.ss_flags = 0;
+
+    // entry point takes no arguments - a user thread fishes its UserThread *
+    //  out of TLS
+    makecontext(ctx, entry, 0);
+  }
+
+  static inline int uctx_swap(UserContext *save_ctx, UserContext *restore_ctx)
+  {
+    return swapcontext(save_ctx, restore_ctx);
+  }
+#endif
+
   namespace {
+    // stacks for user threads are recycled through a process-wide pool, as
+    //  creating and destroying workers is far more common than changes in
+    //  the stack size they ask for - with the fast switch, each stack is
+    //  also mapped with an inaccessible guard page below it so that an
+    //  overflow faults rather than silently corrupting its neighbor
+    class UserStackPool {
+    public:
+      static void *alloc_stack(size_t stack_size);
+      static void free_stack(void *stack_base, size_t stack_size);
+
+    protected:
+      // a worker churn burst shouldn't pin an unbounded amount of memory
+      static const size_t MAX_POOLED_PER_SIZE = 16;
+
+      static GASNetHSL mutex;
+      static std::map<size_t, std::vector<void *> > free_stacks;
+    };
+
+    /*static*/ GASNetHSL UserStackPool::mutex;
+    /*static*/ std::map<size_t, std::vector<void *> > UserStackPool::free_stacks;
+
+    /*static*/ void *UserStackPool::alloc_stack(size_t stack_size)
+    {
+      {
+	AutoHSLLock al(mutex);
+	std::map<size_t, std::vector<void *> >::iterator it = free_stacks.find(stack_size);
+	if((it != free_stacks.end()) && !it->second.empty()) {
+	  void *stack_base = it->second.back();
+	  it->second.pop_back();
+	  return stack_base;
+	}
+      }
+
+#ifdef REALM_USE_FAST_USER_SWITCH
+      size_t page_size = sysconf(_SC_PAGESIZE);
+      size_t map_size = ((stack_size + page_size - 1) / page_size + 1) * page_size;
+      void *base = mmap(0, map_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+      if(base == MAP_FAILED)
+	return 0;
+      // the guard page is at the low end, since stacks grow down
+      CHECK_LIBC( mprotect(base, page_size, PROT_NONE) );
+      return static_cast<char *>(base) + page_size;
+#else
+      return malloc(stack_size);
+#endif
+    }
+
+    /*static*/ void UserStackPool::free_stack(void *stack_base, size_t stack_size)
+    {
+      {
+	AutoHSLLock al(mutex);
+	std::vector<void *>& stacks = free_stacks[stack_size];
+	if(stacks.size() < MAX_POOLED_PER_SIZE) {
+	  stacks.push_back(stack_base);
+	  return;
+	}
+      }
+
+#ifdef REALM_USE_FAST_USER_SWITCH
+      size_t page_size = sysconf(_SC_PAGESIZE);
+      size_t map_size = ((stack_size + page_size - 1) / page_size + 1) * page_size;
+      CHECK_LIBC( munmap(static_cast<char *>(stack_base) - page_size, map_size) );
+#else
+      free(stack_base);
+#endif
+    }
+
     int uswitch_test_check_flag = 1;
-    ucontext_t uswitch_test_ctx1, uswitch_test_ctx2;
+    UserContext uswitch_test_ctx1, uswitch_test_ctx2;
 
-    void uswitch_test_entry(int arg)
+    void uswitch_test_entry(void)
     {
-      log_thread.debug() << "uswitch test: adding: " << uswitch_test_check_flag << " " << arg;
-      __sync_fetch_and_add(&uswitch_test_check_flag, arg);
+      log_thread.debug() << "uswitch test: adding: " << uswitch_test_check_flag << " " << 66;
+      __sync_fetch_and_add(&uswitch_test_check_flag, 66);
       errno = 0;
-      int ret = swapcontext(&uswitch_test_ctx2, &uswitch_test_ctx1);
+      int ret = uctx_swap(&uswitch_test_ctx2, &uswitch_test_ctx1);
       if(ret != 0) {
 	log_thread.fatal() << "uswitch test: swap out failed: " << ret << " " << errno;
 	assert(0);
@@ -911,42 +1171,39 @@ namespace Realm {
   {
     errno = 0;
     int ret;
+#ifndef REALM_USE_FAST_USER_SWITCH
+    // catch a missing getcontext here rather than as a fatal error below
     ret = getcontext(&uswitch_test_ctx2);
     if(ret != 0) {
       log_thread.info() << "uswitch test: getcontext failed: " << ret << " " << errno;
       return false;
     }
-    void *stack_base = malloc(stack_size);
+#endif
+    void *stack_base = UserStackPool::alloc_stack(stack_size);
     if(!stack_base) {
-      log_thread.info() << "uswitch test: stack malloc failed";
+      log_thread.info() << "uswitch test: stack allocation failed";
       return false;
     }
-    uswitch_test_ctx2.uc_link = 0; // we don't expect it to ever fall through
-    uswitch_test_ctx2.uc_stack.ss_sp = stack_base;
-    uswitch_test_ctx2.uc_stack.ss_size = stack_size;
-    uswitch_test_ctx2.uc_stack.ss_flags = 0;
-    makecontext(&uswitch_test_ctx2,
-		reinterpret_cast<void(*)()>(uswitch_test_entry),
-		1, 66);
+    uctx_init(&uswitch_test_ctx2, stack_base, stack_size, uswitch_test_entry);
 
     // now try to swap and back
     errno = 0;
-    ret = swapcontext(&uswitch_test_ctx1, &uswitch_test_ctx2);
+    ret = uctx_swap(&uswitch_test_ctx1, &uswitch_test_ctx2);
     if(ret != 0) {
       log_thread.info() << "uswitch test: swap in failed: " << ret << " " << errno;
-      free(stack_base);
+      UserStackPool::free_stack(stack_base, stack_size);
       return false;
     }
 
     int val = __sync_fetch_and_add(&uswitch_test_check_flag, 0);
     if(val != 67) {
       log_thread.info() << "uswitch test: val mismatch: " << val << " != 67";
-      free(stack_base);
+      UserStackPool::free_stack(stack_base, stack_size);
       return false;
     }
 
     log_thread.debug() << "uswitch test: check succeeded";
-    free(stack_base);
+    UserStackPool::free_stack(stack_base, stack_size);
     return true;
   }
 
@@ -976,10 +1233,10 @@ namespace Realm {
     void (*entry_wrapper)(void *);
     int magic;
 #ifndef __MACH__
-    ucontext_t ctx;
+    UserContext ctx;
 #else
     // valgrind says Darwin's getcontext is writing past the end of ctx?
-    ucontext_t ctx;
+    UserContext ctx;
     int padding[512];
 #endif
     void *stack_base;
@@ -1003,11 +1260,11 @@ namespace Realm {
     assert(!running);
 
     if(stack_base != 0)
-      free(stack_base);
+      UserStackPool::free_stack(stack_base, stack_size);
   }
 
   namespace ThreadLocal {
-    __thread ucontext_t *host_context = 0;
+    __thread UserContext *host_context = 0;
     // current_user_thread is redundant with current_thread, but kept for debugging
     //  purposes for now
     __thread UserThread *current_user_thread = 0;
@@ -1069,19 +1326,12 @@ namespace Realm {
       }
     }
 
-    stack_base = malloc(stack_size);
+    stack_base = UserStackPool::alloc_stack(stack_size);
     assert(stack_base != 0);
 
-    CHECK_LIBC( getcontext(&ctx) );
-
-    ctx.uc_link = 0; // we don't expect it to ever fall through
-    ctx.uc_stack.ss_sp = stack_base;
-    ctx.uc_stack.ss_size = stack_size;
-    ctx.uc_stack.ss_flags = 0;
-
-    // grr...  entry point takes int's, which might not hold a void *
-    // we'll just fish our UserThread * out of TLS
-    makecontext(&ctx, uthread_entry, 0);
+    // entry point takes no arguments - we'll just fish our UserThread * out
+    //  of TLS
+    uctx_init(&ctx, stack_base, stack_size, uthread_entry);
 
     update_state(STATE_STARTUP);    
 
@@ -1116,14 +1366,14 @@ namespace Realm {
       assert(ThreadLocal::host_context == 0);
 
       // this holds the host's state
-      ucontext_t host_ctx;
+      UserContext host_ctx;
 
       ThreadLocal::host_context = &host_ctx;
       ThreadLocal::current_user_thread = switch_to;
       ThreadLocal::current_host_thread = ThreadLocal::current_thread;
       ThreadLocal::current_thread = switch_to;
 
-      CHECK_LIBC( swapcontext(&host_ctx, &switch_to->ctx) );
+      CHECK_LIBC( uctx_swap(&host_ctx, &switch_to->ctx) );
 
       assert(ThreadLocal::current_user_thread == 0);
       assert(ThreadLocal::host_context == &host_ctx);
@@ -1142,7 +1392,7 @@ namespace Realm {
 	ThreadLocal::current_thread = switch_to;
 
 	// a switch between two user contexts - nice and simple
-	CHECK_LIBC( swapcontext(&switch_from->ctx, &switch_to->ctx) );
+	CHECK_LIBC( uctx_swap(&switch_from->ctx, &switch_to->ctx) );
 
 	assert(switch_from->running == false);
 	switch_from->host_pthread = pthread_self();
@@ -1154,7 +1404,7 @@ namespace Realm {
 	ThreadLocal::current_thread = ThreadLocal::current_host_thread;
 	ThreadLocal::current_host_thread = 0;
 
-	CHECK_LIBC( swapcontext(&switch_from->ctx, ThreadLocal::host_context) );
+	CHECK_LIBC( uctx_swap(&switch_from->ctx, ThreadLocal::host_context) );
 
 	// if we get control back
 	assert(switch_from->running == false);
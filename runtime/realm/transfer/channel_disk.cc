@@ -311,6 +311,8 @@ namespace Realm {
             assert(0);
         }
       }
+      // one submission for the whole batch
+      aio_ctx->submit_batch();
       return nr;
     }
 
@@ -364,6 +366,8 @@ namespace Realm {
             assert(0);
         }
       }
+      // one submission for the whole batch
+      aio_ctx->submit_batch();
       return nr;
     }
 
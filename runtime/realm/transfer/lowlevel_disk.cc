@@ -84,11 +84,6 @@ namespace Realm {
 #endif
     }
 
-    void DiskMemory::apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-                        size_t count, const void *entry_buffer)
-    {
-    }
-
     void *DiskMemory::get_direct_ptr(off_t offset, size_t size)
     {
       return 0; // cannot provide a pointer for it.
@@ -183,9 +178,6 @@ namespace Realm {
 #endif
     }
 
-    void FileMemory::apply_reduction_list(off_t offset, const ReductionOpUntyped *redop,
-                                          size_t count, const void *entry_buffer) {}
-
     void *FileMemory::get_direct_ptr(off_t offset, size_t size)
     {
       return 0; // cannot provide a pointer for it;
@@ -23,6 +23,12 @@
 #include <errno.h>
 // included for file memory data transfer
 #include <unistd.h>
+#ifdef REALM_USE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
 #ifdef REALM_USE_KERNEL_AIO
 #include <linux/aio_abi.h>
 #include <sys/syscall.h>
@@ -1106,9 +1112,317 @@ namespace Realm {
       return true;
     }
 
-    AsyncFileIOContext::AsyncFileIOContext(int _max_depth)
+#ifdef REALM_USE_IO_URING
+    inline int io_uring_setup(unsigned entries, struct io_uring_params *p)
+    {
+      return syscall(__NR_io_uring_setup, entries, p);
+    }
+
+    inline int io_uring_enter(int fd, unsigned to_submit,
+			      unsigned min_complete, unsigned flags)
+    {
+      return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		     NULL, 0);
+    }
+
+    inline int io_uring_register(int fd, unsigned opcode,
+				 const void *arg, unsigned nr_args)
+    {
+      return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+
+    class IOUringFileOp;
+
+    // the submission and completion rings shared with the kernel - all
+    //  methods are called with the AsyncFileIOContext's mutex held
+    class IOUringQueue {
+    public:
+      IOUringQueue(void);
+      ~IOUringQueue(void);
+
+      // returns false if the kernel doesn't support io_uring (or won't let
+      //  us use it)
+      bool init(unsigned entries);
+
+      void register_buffer(void *base, size_t bytes);
+
+      // fills in a submission queue entry, but doesn't tell the kernel
+      void prepare(IOUringFileOp *op);
+
+      // tells the kernel about all prepared entries with a single syscall
+      void submit(void);
+
+      // handles whatever completions are in the ring - no syscall needed
+      void reap(void);
+
+    protected:
+      int ring_fd;
+      void *sq_ptr, *cq_ptr;
+      size_t sq_map_size, cq_map_size;
+      unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+      unsigned *cq_head, *cq_tail, *cq_mask;
+      struct io_uring_sqe *sqes;
+      struct io_uring_cqe *cqes;
+      unsigned sq_entries;
+      unsigned unsubmitted;
+      std::vector<struct iovec> registered;
+    };
+
+    class IOUringFileOp : public AsyncFileIOContext::AIOOperation {
+    public:
+      IOUringFileOp(IOUringQueue *_ring, bool _is_write, int _fd,
+		    size_t _offset, size_t _bytes, const void *_buffer,
+		    Request *request);
+      virtual void launch(void);
+      virtual bool check_completion(void);
+
+      // returns true if the op needs to be relaunched for the rest of its
+      //  bytes
+      bool handle_result(int res);
+
+    public:
+      IOUringQueue *ring;
+      bool is_write;
+      int fd;
+      size_t offset, bytes;
+      char *buffer;
+      int buf_index;  // registered buffer, or -1
+      struct iovec iov;
+    };
+
+    IOUringFileOp::IOUringFileOp(IOUringQueue *_ring, bool _is_write, int _fd,
+				 size_t _offset, size_t _bytes,
+				 const void *_buffer, Request *request)
+      : ring(_ring), is_write(_is_write), fd(_fd), offset(_offset)
+      , bytes(_bytes), buffer((char *)_buffer), buf_index(-1)
+    {
+      completed = false;
+      req = request;
+    }
+
+    void IOUringFileOp::launch(void)
+    {
+      log_aio.debug("%s queued: op=%p fd=%d off=%zd bytes=%zd",
+		    (is_write ? "write" : "read"), this, fd, offset, bytes);
+      ring->prepare(this);
+    }
+
+    bool IOUringFileOp::check_completion(void)
+    {
+      return completed;
+    }
+
+    bool IOUringFileOp::handle_result(int res)
+    {
+      if(res < 0) {
+	if((res == -EINTR) || (res == -EAGAIN))
+	  return true;
+	log_aio.fatal() << (is_write ? "write" : "read") << " failed: fd=" << fd
+			<< " offset=" << offset << " bytes=" << bytes
+			<< " error=" << strerror(-res);
+	assert(0);
+      }
+      // a short read at the end of a file is complete, just like with the
+      //  other AIO interfaces
+      if((res == 0) || ((size_t)res >= bytes)) {
+	log_aio.debug("%s returned: op=%p res=%d",
+		      (is_write ? "write" : "read"), this, res);
+	completed = true;
+	return false;
+      }
+      offset += res;
+      bytes -= res;
+      buffer += res;
+      return true;
+    }
+
+    IOUringQueue::IOUringQueue(void)
+      : ring_fd(-1), sq_ptr(MAP_FAILED), cq_ptr(MAP_FAILED)
+      , sq_map_size(0), cq_map_size(0), sqes((struct io_uring_sqe *)MAP_FAILED)
+      , sq_entries(0), unsubmitted(0)
+    {}
+
+    IOUringQueue::~IOUringQueue(void)
+    {
+      if(sqes != MAP_FAILED)
+	munmap(sqes, sq_entries * sizeof(struct io_uring_sqe));
+      if((cq_ptr != MAP_FAILED) && (cq_ptr != sq_ptr))
+	munmap(cq_ptr, cq_map_size);
+      if(sq_ptr != MAP_FAILED)
+	munmap(sq_ptr, sq_map_size);
+      if(ring_fd >= 0)
+	close(ring_fd);
+    }
+
+    bool IOUringQueue::init(unsigned entries)
+    {
+      struct io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      ring_fd = io_uring_setup(entries, &p);
+      if(ring_fd < 0) {
+	log_aio.info() << "io_uring unavailable (" << strerror(errno) << ")";
+	return false;
+      }
+      sq_entries = p.sq_entries;
+      sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+      // headers older than 5.4 have neither the feature flags nor the shared
+      //  ring mapping, so the SQ and CQ rings are always mapped separately
+#ifdef IORING_FEAT_SINGLE_MMAP
+      const bool single_mmap = ((p.features & IORING_FEAT_SINGLE_MMAP) != 0);
+#else
+      const bool single_mmap = false;
+#endif
+      if(single_mmap) {
+	if(cq_map_size > sq_map_size)
+	  sq_map_size = cq_map_size;
+	cq_map_size = sq_map_size;
+      }
+      sq_ptr = mmap(0, sq_map_size, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+      if(sq_ptr == MAP_FAILED) return false;
+      if(single_mmap)
+	cq_ptr = sq_ptr;
+      else {
+	cq_ptr = mmap(0, cq_map_size, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+	if(cq_ptr == MAP_FAILED) return false;
+      }
+      sqes = (struct io_uring_sqe *)mmap(0,
+					 p.sq_entries * sizeof(struct io_uring_sqe),
+					 PROT_READ | PROT_WRITE,
+					 MAP_SHARED | MAP_POPULATE,
+					 ring_fd, IORING_OFF_SQES);
+      if(sqes == MAP_FAILED) return false;
+      char *sq = (char *)sq_ptr;
+      sq_head = (unsigned *)(sq + p.sq_off.head);
+      sq_tail = (unsigned *)(sq + p.sq_off.tail);
+      sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+      sq_array = (unsigned *)(sq + p.sq_off.array);
+      char *cq = (char *)cq_ptr;
+      cq_head = (unsigned *)(cq + p.cq_off.head);
+      cq_tail = (unsigned *)(cq + p.cq_off.tail);
+      cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+      cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+      log_aio.info() << "using io_uring: entries=" << sq_entries;
+      return true;
+    }
+
+    void IOUringQueue::register_buffer(void *base, size_t bytes)
+    {
+      // the kernel limits each registered buffer to 1GB
+      const size_t max_chunk = 1 << 30;
+      std::vector<struct iovec> iovs(registered);
+      for(size_t done = 0; done < bytes; done += max_chunk) {
+	struct iovec iov;
+	iov.iov_base = (char *)base + done;
+	iov.iov_len = std::min(max_chunk, bytes - done);
+	iovs.push_back(iov);
+      }
+      if(!registered.empty())
+	io_uring_register(ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+      if(io_uring_register(ring_fd, IORING_REGISTER_BUFFERS,
+			   &iovs[0], iovs.size()) == 0) {
+	registered.swap(iovs);
+	log_aio.info() << "registered buffer: base=" << base << " bytes=" << bytes;
+      } else {
+	// usually the locked memory limit - ops will just not use fixed buffers
+	log_aio.info() << "unable to register buffer: base=" << base
+		       << " bytes=" << bytes << " (" << strerror(errno) << ")";
+	if(!registered.empty() &&
+	   (io_uring_register(ring_fd, IORING_REGISTER_BUFFERS,
+			      &registered[0], registered.size()) != 0))
+	  registered.clear();
+      }
+    }
+
+    void IOUringQueue::prepare(IOUringFileOp *op)
+    {
+      // callers never have more ops in flight than there are entries
+      unsigned tail = *sq_tail;
+      assert((tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE)) < sq_entries);
+      unsigned index = tail & *sq_mask;
+      struct io_uring_sqe *sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->fd = op->fd;
+      sqe->off = op->offset;
+      sqe->user_data = (uint64_t)op;
+
+      op->buf_index = -1;
+      for(size_t i = 0; i < registered.size(); i++) {
+	char *base = (char *)registered[i].iov_base;
+	if((op->buffer >= base) &&
+	   ((op->buffer + op->bytes) <= (base + registered[i].iov_len))) {
+	  op->buf_index = i;
+	  break;
+	}
+      }
+      if(op->buf_index >= 0) {
+	sqe->opcode = (op->is_write ? IORING_OP_WRITE_FIXED :
+		                      IORING_OP_READ_FIXED);
+	sqe->addr = (uint64_t)(op->buffer);
+	sqe->len = op->bytes;
+	sqe->buf_index = op->buf_index;
+      } else {
+	op->iov.iov_base = op->buffer;
+	op->iov.iov_len = op->bytes;
+	sqe->opcode = (op->is_write ? IORING_OP_WRITEV : IORING_OP_READV);
+	sqe->addr = (uint64_t)&(op->iov);
+	sqe->len = 1;
+      }
+
+      sq_array[index] = index;
+      __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+      unsubmitted++;
+    }
+
+    void IOUringQueue::submit(void)
+    {
+      while(unsubmitted > 0) {
+	int ret = io_uring_enter(ring_fd, unsubmitted, 0, 0);
+	if(ret < 0) {
+	  // try again on the next call to make_progress
+	  if((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY))
+	    break;
+	  log_aio.fatal() << "io_uring_enter failed: " << strerror(errno);
+	  assert(0);
+	}
+	log_aio.debug("io_uring_enter submitted %d of %d", ret, unsubmitted);
+	unsubmitted -= ret;
+      }
+    }
+
+    void IOUringQueue::reap(void)
+    {
+      unsigned head = *cq_head;
+      while(true) {
+	unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+	if(head == tail) break;
+	while(head != tail) {
+	  struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+	  IOUringFileOp *op = (IOUringFileOp *)(cqe->user_data);
+	  if(op->handle_result(cqe->res))
+	    prepare(op);
+	  head++;
+	}
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+      }
+    }
+#endif
+
+    AsyncFileIOContext::AsyncFileIOContext(int _max_depth, bool use_io_uring)
       : max_depth(_max_depth)
     {
+#ifdef REALM_USE_IO_URING
+      uring = 0;
+      if(use_io_uring) {
+	uring = new IOUringQueue;
+	if(!uring->init(max_depth)) {
+	  delete uring;
+	  uring = 0;
+	}
+      }
+#endif
 #ifdef REALM_USE_KERNEL_AIO
       aio_ctx = 0;
 #ifndef NDEBUG
@@ -1129,6 +1443,9 @@ namespace Realm {
 #endif
 	io_destroy(aio_ctx);
       assert(ret == 0);
+#endif
+#ifdef REALM_USE_IO_URING
+      delete uring;
 #endif
     }
 
@@ -1136,11 +1453,17 @@ namespace Realm {
 					   size_t bytes, const void *buffer,
                                            Request* req)
     {
+      AIOOperation *op;
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	op = new IOUringFileOp(uring, true /*write*/,
+			       fd, offset, bytes, buffer, req);
+      else
+#endif
 #ifdef REALM_USE_KERNEL_AIO
-      KernelAIOWrite *op = new KernelAIOWrite(aio_ctx,
-					      fd, offset, bytes, buffer, req);
+	op = new KernelAIOWrite(aio_ctx, fd, offset, bytes, buffer, req);
 #else
-      PosixAIOWrite *op = new PosixAIOWrite(fd, offset, bytes, buffer, req);
+	op = new PosixAIOWrite(fd, offset, bytes, buffer, req);
 #endif
       {
 	AutoHSLLock al(mutex);
@@ -1157,11 +1480,17 @@ namespace Realm {
 					  size_t bytes, void *buffer,
                                           Request* req)
     {
+      AIOOperation *op;
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	op = new IOUringFileOp(uring, false /*!write*/,
+			       fd, offset, bytes, buffer, req);
+      else
+#endif
 #ifdef REALM_USE_KERNEL_AIO
-      KernelAIORead *op = new KernelAIORead(aio_ctx,
-					    fd, offset, bytes, buffer, req);
+	op = new KernelAIORead(aio_ctx, fd, offset, bytes, buffer, req);
 #else
-      PosixAIORead *op = new PosixAIORead(fd, offset, bytes, buffer, req);
+	op = new PosixAIORead(fd, offset, bytes, buffer, req);
 #endif
       {
 	AutoHSLLock al(mutex);
@@ -1188,6 +1517,26 @@ namespace Realm {
       }
     }
 
+    void AsyncFileIOContext::submit_batch(void)
+    {
+#ifdef REALM_USE_IO_URING
+      if(uring) {
+	AutoHSLLock al(mutex);
+	uring->submit();
+      }
+#endif
+    }
+
+    void AsyncFileIOContext::register_buffer(void *base, size_t bytes)
+    {
+#ifdef REALM_USE_IO_URING
+      if(uring) {
+	AutoHSLLock al(mutex);
+	uring->register_buffer(base, bytes);
+      }
+#endif
+    }
+
     bool AsyncFileIOContext::empty(void)
     {
       AutoHSLLock al(mutex);
@@ -1221,6 +1570,10 @@ namespace Realm {
 	}
       }
 #endif
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	uring->reap();
+#endif
 
       // now actually mark events completed in oldest-first order
       while(!launched_operations.empty()) {
@@ -1246,6 +1599,12 @@ namespace Realm {
 	op->launch();
 	launched_operations.push_back(op);
       }
+
+#ifdef REALM_USE_IO_URING
+      // anything relaunched or launched above goes to the kernel together
+      if(uring)
+	uring->submit();
+#endif
     }
 
     /*static*/
@@ -2734,6 +3093,279 @@ namespace Realm {
       return fill_size;
     }
 
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class IndirectCopyRequest
+    //
+
+    // holds an indirect copy open until the write-back of its staged
+    //  temporaries is complete
+    class StagingFence : public Operation::AsyncWorkItem, public EventWaiter {
+    public:
+      StagingFence(Operation *_op) : Operation::AsyncWorkItem(_op) {}
+      virtual void request_cancellation(void) {}
+      virtual void event_triggered(bool poisoned)
+      {
+	mark_finished(!poisoned);
+      }
+      virtual void print(std::ostream& os) const { os << "StagingFence"; }
+      virtual Event get_finish_event(void) const
+      {
+	return op->get_finish_event();
+      }
+    };
+
+    IndirectCopyRequest::IndirectCopyRequest(IndirectionInfo *_info,
+					     const std::vector<CopySrcDstField>& _srcs,
+					     const std::vector<CopySrcDstField>& _dsts,
+					     bool _gather,
+					     Event _before_copy,
+					     GenEventImpl *_after_copy, EventImpl::gen_t _after_gen,
+					     int _priority,
+					     const Realm::ProfilingRequestSet &reqs)
+      : DmaRequest(_priority, _after_copy, _after_gen, reqs)
+      , info(_info)
+      , srcs(_srcs)
+      , dsts(_dsts)
+      , gather(_gather)
+      , before_copy(_before_copy)
+      , targets_staged(false)
+    {
+      assert(srcs.size() == dsts.size());
+      log_dma.info() << "dma request " << (void *)this << " created - "
+		     << (gather ? "gather" : "scatter") << " indirect=" << *info
+		     << " fields=" << srcs.size()
+		     << " before=" << before_copy << " after=" << get_finish_event();
+    }
+
+    IndirectCopyRequest::~IndirectCopyRequest(void)
+    {
+      delete info;
+    }
+
+    bool IndirectCopyRequest::check_readiness(bool just_check, DmaRequestQueue *rq)
+    {
+      if(state == STATE_INIT)
+	state = STATE_METADATA_FETCH;
+
+      // remember which queue we're going to be assigned to if we sleep
+      waiter.req = this;
+      waiter.queue = rq;
+
+      if(state == STATE_METADATA_FETCH) {
+	// the indirection covers the copy domain, the target spaces, and all
+	//  the indirectly-addressed instances
+	Event e = info->request_metadata();
+	if(!e.has_triggered()) {
+	  if(just_check) return false;
+	  log_dma.debug() << "indirection metadata - req=" << (void *)this
+			  << " ready=" << e;
+	  waiter.sleep_on_event(e);
+	  return false;
+	}
+
+	// and then the directly-addressed side of each field pair
+	const std::vector<CopySrcDstField>& direct = (gather ? dsts : srcs);
+	for(std::vector<CopySrcDstField>::const_iterator it = direct.begin();
+	    it != direct.end();
+	    ++it) {
+	  RegionInstanceImpl *impl = get_runtime()->get_instance_impl(it->inst);
+	  Event e = impl->request_metadata();
+	  if(!e.has_triggered()) {
+	    if(just_check) return false;
+	    log_dma.debug() << "request " << (void *)this << " - instance "
+			    << it->inst << " metadata invalid - sleeping on event " << e;
+	    waiter.sleep_on_event(e);
+	    return false;
+	  }
+	}
+
+	// anything we can't access directly has to be copied to/from local
+	//  temporaries, and the copy then waits for those to be filled
+	before_copy = info->stage_instances(srcs, dsts, gather, before_copy);
+
+	state = STATE_BEFORE_EVENT;
+      }
+
+      // make sure our functional precondition has occurred
+      while(state == STATE_BEFORE_EVENT) {
+	bool poisoned = false;
+	if(before_copy.has_triggered_faultaware(poisoned)) {
+	  if(poisoned) {
+	    log_dma.debug("request %p - poisoned precondition", this);
+	    handle_poisoned_precondition(before_copy);
+	    return true; // not enqueued, but never going to be
+	  } else if(!targets_staged) {
+	    // the indirection data is valid now, so we can find out which
+	    //  target points need to be staged (if any)
+	    if(just_check) return false;
+	    targets_staged = true;
+	    before_copy = info->stage_targets(srcs, dsts, gather, before_copy);
+	  } else {
+	    log_dma.debug("request %p - before event triggered", this);
+	    state = STATE_READY;
+	  }
+	} else {
+	  log_dma.debug("request %p - before event not triggered", this);
+	  if(just_check) return false;
+
+	  log_dma.debug("request %p - sleeping on before event", this);
+	  waiter.sleep_on_event(before_copy);
+	  return false;
+	}
+      }
+
+      if(state == STATE_READY) {
+	log_dma.debug("request %p ready", this);
+	if(just_check) return true;
+
+	state = STATE_QUEUED;
+	assert(rq != 0);
+	log_dma.debug("request %p enqueued", this);
+
+	// once we're enqueued, we may be deleted at any time, so no more
+	//  references
+	rq->enqueue_request(this);
+	return true;
+      }
+
+      if(state == STATE_QUEUED)
+	return true;
+
+      assert(0);
+      return false;
+    }
+
+    void IndirectCopyRequest::perform_dma(void)
+    {
+      log_dma.info() << "dma request " << (void *)this << " started - "
+		     << (gather ? "gather" : "scatter") << " indirect=" << *info
+		     << " fields=" << srcs.size();
+
+      bool ok = info->execute_copies(srcs, dsts, gather, this);
+      if(!ok) {
+	// the error has been logged - fail the copy by poisoning its event
+	XferDesFence *f = new XferDesFence(this);
+	add_async_work_item(f);
+	f->mark_finished(false /*!successful*/);
+      }
+
+      // results in temporaries are only written back if the copy succeeded,
+      //  and the copy isn't done until they have been
+      Event e = info->unstage_instances(ok);
+      if(e.exists()) {
+	StagingFence *f = new StagingFence(this);
+	add_async_work_item(f);
+	EventImpl::add_waiter(e, f);
+      }
+
+      log_dma.info() << "dma request " << (void *)this << " finished - "
+		     << (gather ? "gather" : "scatter") << " indirect=" << *info
+		     << " before=" << before_copy << " after=" << get_finish_event();
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // class ReductionListBuffer
+    //
+
+    // bound on the size of a list applied locally in one call
+    static const size_t LOCAL_LIST_ENTRIES = 4096;
+
+    ReductionListBuffer::ReductionListBuffer(Operation *_op,
+					     ReductionOpID _redop_id,
+					     bool _red_fold)
+      : op(_op), redop_id(_redop_id), red_fold(_red_fold), last_list(0)
+    {
+      redop = get_runtime()->reduce_op_table.get(redop_id, 0);
+      if(redop == 0) {
+	log_dma.fatal() << "no reduction op registered for ID " << redop_id;
+	abort();
+      }
+    }
+
+    ReductionListBuffer::~ReductionListBuffer(void)
+    {
+      // flush() must have been called
+      for(std::map<Memory, PendingList>::const_iterator it = lists.begin();
+	  it != lists.end();
+	  ++it)
+	assert(it->second.count == 0);
+    }
+
+    void ReductionListBuffer::add_entry(MemoryImpl *mem, off_t offset,
+					const void *rhs)
+    {
+      // consecutive entries usually go to the same memory
+      PendingList *pl = last_list;
+      if((pl == 0) || (pl->mem != mem)) {
+	std::map<Memory, PendingList>::iterator it = lists.find(mem->me);
+	if(it == lists.end()) {
+	  pl = &lists[mem->me];
+	  pl->mem = mem;
+	  pl->is_remote = ((mem->kind == MemoryImpl::MKIND_REMOTE) ||
+			   (mem->kind == MemoryImpl::MKIND_RDMA));
+	  if(pl->is_remote) {
+	    // remote lists are limited by what fits in a single message
+	    pl->max_entries = (get_lmb_size(ID(mem->me).memory_owner_node()) /
+			       redop->sizeof_list_entry);
+	    assert(pl->max_entries > 0);
+	    pl->sequence_id = __sync_fetch_and_add(&rdma_sequence_no, 1);
+	  } else {
+	    pl->max_entries = LOCAL_LIST_ENTRIES;
+	    pl->sequence_id = 0;
+	  }
+	  pl->count = 0;
+	  pl->rdma_count = 0;
+	  pl->entries.resize(pl->max_entries * redop->sizeof_list_entry);
+	} else
+	  pl = &it->second;
+	last_list = pl;
+      }
+
+      char *entry = &pl->entries[pl->count * redop->sizeof_list_entry];
+      memcpy(entry, &offset, sizeof(off_t));
+      memcpy(entry + ReductionOpUntyped::LIST_ENTRY_RHS_OFFSET, rhs,
+	     redop->sizeof_rhs);
+      if(++(pl->count) == pl->max_entries)
+	flush_list(*pl);
+    }
+
+    void ReductionListBuffer::flush_list(PendingList& pl)
+    {
+      if(pl.count == 0) return;
+
+      if(pl.is_remote)
+	pl.rdma_count += do_remote_apply_red_list(ID(pl.mem->me).memory_owner_node(),
+						  pl.mem->me, 0,
+						  redop_id, red_fold,
+						  &pl.entries[0],
+						  pl.count * redop->sizeof_list_entry,
+						  pl.sequence_id);
+      else
+	pl.mem->apply_reduction_list(0, redop, pl.count, &pl.entries[0],
+				     red_fold);
+      pl.count = 0;
+    }
+
+    void ReductionListBuffer::flush(void)
+    {
+      for(std::map<Memory, PendingList>::iterator it = lists.begin();
+	  it != lists.end();
+	  ++it) {
+	flush_list(it->second);
+
+	// remote reductions are done when the fence is acked
+	if(it->second.rdma_count > 0) {
+	  RemoteWriteFence *fence = new RemoteWriteFence(op);
+	  op->add_async_work_item(fence);
+	  do_remote_fence(it->first, it->second.sequence_id,
+			  it->second.rdma_count, fence);
+	  it->second.rdma_count = 0;
+	}
+      }
+    }
+
     // for now we use a single queue for all (local) dmas
     DmaRequestQueue *dma_queue = 0;
     
@@ -2791,10 +3423,25 @@ namespace Realm {
     }
 
     void start_dma_system(int count, bool pinned, int max_nr,
-                          CoreReservationSet& crs)
+                          CoreReservationSet& crs, bool use_io_uring)
     {
       //log_dma.add_stream(&std::cerr, Logger::LEVEL_DEBUG, false, false);
-      aio_context = new AsyncFileIOContext(256);
+      aio_context = new AsyncFileIOContext(256, use_io_uring);
+      // only the intermediate buffers used by multi-hop copies are
+      //  registered - registering every CPU memory would pin all of it
+      //  against the locked memory limit, and copies that go straight to
+      //  or from other memories still work, just without fixed buffers
+      {
+	const std::vector<MemoryImpl *>& ib_mems =
+	  get_runtime()->nodes[my_node_id].ib_memories;
+	for(std::vector<MemoryImpl *>::const_iterator it = ib_mems.begin();
+	    it != ib_mems.end();
+	    it++) {
+	  LocalCPUMemory *cpumem = dynamic_cast<LocalCPUMemory *>(*it);
+	  if(cpumem && (cpumem->size > 0))
+	    aio_context->register_buffer(cpumem->base, cpumem->size);
+	}
+      }
       start_channel_manager(count, pinned, max_nr, crs);
       ib_req_queue = new PendingIBQueue();
     }
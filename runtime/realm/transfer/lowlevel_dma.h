@@ -87,7 +87,8 @@ namespace Realm {
     extern void start_dma_worker_threads(int count, Realm::CoreReservationSet& crs);
     extern void stop_dma_worker_threads(void);
 
-    extern void start_dma_system(int count, bool pinned, int max_nr, Realm::CoreReservationSet& crs);
+    extern void start_dma_system(int count, bool pinned, int max_nr, Realm::CoreReservationSet& crs,
+                                 bool use_io_uring = false);
 
     extern void stop_dma_system(void);
 
@@ -247,6 +248,7 @@ namespace Realm {
 
     class TransferDomain;
     class TransferIterator;
+    class IndirectionInfo;
 
     // dma requests come in two flavors:
     // 1) CopyRequests, which are per memory pair, and
@@ -389,6 +391,81 @@ namespace Realm {
       Waiter waiter;
     };
 
+    // gather/scatter copies are performed directly by the dma threads -
+    //  instances that aren't local and cpu-accessible are staged through
+    //  temporaries in local system memory by ordinary copies
+    class IndirectCopyRequest : public DmaRequest {
+    public:
+      IndirectCopyRequest(IndirectionInfo *_info,
+			  const std::vector<CopySrcDstField>& _srcs,
+			  const std::vector<CopySrcDstField>& _dsts,
+			  bool _gather,
+			  Event _before_copy,
+			  GenEventImpl *_after_copy, EventImpl::gen_t _after_gen,
+			  int _priority,
+			  const Realm::ProfilingRequestSet &reqs);
+
+    protected:
+      // deletion performed when reference count goes to zero
+      virtual ~IndirectCopyRequest(void);
+
+    public:
+      virtual bool check_readiness(bool just_check, DmaRequestQueue *rq);
+
+      virtual void perform_dma(void);
+
+      virtual bool handler_safe(void) { return(false); }
+
+      IndirectionInfo *info;  // owned by this request
+      std::vector<CopySrcDstField> srcs, dsts;
+      bool gather;
+      Event before_copy;
+      // target temporaries are sized by the indirection data, so they are
+      //  only staged once the first 'before_copy' has triggered
+      bool targets_staged;
+      Waiter waiter;
+    };
+
+    // collects the (offset, value) pairs of a scatter-reduction into a
+    //  reduction list per target memory - lists for local memories are
+    //  applied directly, while those for remote memories are sent to the
+    //  owner node and fenced so that 'op' doesn't complete until they have
+    //  all been applied
+    class ReductionListBuffer {
+    public:
+      ReductionListBuffer(Operation *_op, ReductionOpID _redop_id,
+			  bool _red_fold);
+      ~ReductionListBuffer(void);
+
+      // 'offset' is the byte offset of the target element within 'mem'
+      void add_entry(MemoryImpl *mem, off_t offset, const void *rhs);
+
+      // applies/sends everything that's been buffered - must be called
+      //  before the buffer is destroyed
+      void flush(void);
+
+      const ReductionOpUntyped *redop;
+
+    protected:
+      struct PendingList {
+	MemoryImpl *mem;
+	bool is_remote;
+	size_t max_entries;
+	size_t count;
+	std::vector<char> entries;
+	unsigned sequence_id;
+	unsigned rdma_count;
+      };
+
+      void flush_list(PendingList& pl);
+
+      Operation *op;
+      ReductionOpID redop_id;
+      bool red_fold;
+      PendingList *last_list;
+      std::map<Memory, PendingList> lists;
+    };
+
     // each DMA "channel" implements one of these to describe (implicitly) which copies it
     //  is capable of performing and then to actually construct a MemPairCopier for copies 
     //  between a given pair of memories
@@ -416,16 +493,28 @@ namespace Realm {
     };
 
     class Request;
+#ifdef REALM_USE_IO_URING
+    class IOUringQueue;
+#endif
 
     class AsyncFileIOContext {
     public:
-      AsyncFileIOContext(int _max_depth);
+      AsyncFileIOContext(int _max_depth, bool use_io_uring = false);
       ~AsyncFileIOContext(void);
 
       void enqueue_write(int fd, size_t offset, size_t bytes, const void *buffer, Request* req = NULL);
       void enqueue_read(int fd, size_t offset, size_t bytes, void *buffer, Request* req = NULL);
       void enqueue_fence(DmaRequest *req);
 
+      // hands everything enqueued since the last call to the kernel in a
+      //  single submission (make_progress does this too)
+      void submit_batch(void);
+
+      // host memory that reads and writes will often use (i.e. the DMA
+      //  intermediate buffers) - the io_uring backend registers it with the
+      //  kernel so pages aren't pinned for every op
+      void register_buffer(void *base, size_t bytes);
+
       bool empty(void);
       long available(void);
       void make_progress(void);
@@ -446,6 +535,9 @@ namespace Realm {
       GASNetHSL mutex;
 #ifdef REALM_USE_KERNEL_AIO
       aio_context_t aio_ctx;
+#endif
+#ifdef REALM_USE_IO_URING
+      IOUringQueue *uring;  // NULL if io_uring isn't available
 #endif
     };
 };
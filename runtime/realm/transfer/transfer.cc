@@ -20,10 +20,16 @@
 #include "realm/transfer/lowlevel_dma.h"
 #include "realm/mem_impl.h"
 #include "realm/inst_layout.h"
+#include "realm/deppart/inst_helper.h"
 #ifdef USE_HDF
 #include "realm/hdf5/hdf5_access.h"
 #endif
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define REALM_SIMD_INDIRECT_COPIES
+#endif
+
 namespace Realm {
 
   extern Logger log_dma;
@@ -952,6 +958,1083 @@ namespace Realm {
     return ev;
   }
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class IndirectionInfo
+  //
+
+  IndirectionInfo::~IndirectionInfo(void)
+  {}
+
+  // an instance that an indirect copy cannot access directly (remote
+  //  memory, memory without cpu access, or a non-affine layout) is replaced
+  //  by a temporary in local system memory - the temporary keeps the field
+  //  IDs and subfield offsets of the original, so the copy's field
+  //  descriptions stay valid, and is filled and written back with ordinary
+  //  copies (i.e. through the dma channels) - temporaries for target
+  //  instances only cover the target points the copy actually touches
+  template <int N, typename T>
+  struct IndirectStaging {
+    IndirectStaging(void) : copy_in(false), copy_out(false) {}
+
+    IndexSpace<N,T> space;
+    RegionInstance temp;
+    bool copy_in, copy_out;
+    std::map<FieldID, size_t> field_sizes;
+    std::vector<CopySrcDstField> fields; // subfields used, in the original
+  };
+
+  // adds a subfield of 'inst' to 'staging' if the dma thread can't get at it
+  //  with an affine accessor - instances without the field are left alone
+  //  and are reported by the copy itself
+  template <int N, typename T>
+  static void stage_field(std::map<RegionInstance, IndirectStaging<N,T> >& staging,
+			  const IndexSpace<N,T>& space,
+			  RegionInstance inst, FieldID field_id,
+			  size_t subfield_offset, size_t size,
+			  bool copy_in, bool copy_out)
+  {
+    if(AffineAccessor<char,N,T>::is_compatible(inst, field_id))
+      return;
+    const InstanceLayout<N,T> *layout = checked_cast<const InstanceLayout<N,T> *>(inst.get_layout());
+    if(layout->fields.count(field_id) == 0)
+      return;
+
+    IndirectStaging<N,T>& s = staging[inst];
+    s.space = space;
+    s.copy_in |= copy_in;
+    s.copy_out |= copy_out;
+    size_t& field_size = s.field_sizes[field_id];
+    field_size = std::max(field_size, subfield_offset + size);
+    CopySrcDstField f;
+    f.set_field(inst, field_id, size, subfield_offset);
+    s.fields.push_back(f);
+  }
+
+  // creates the temporaries in 'mem' and issues the copies that fill them
+  template <int N, typename T>
+  static void stage_in(std::map<RegionInstance, IndirectStaging<N,T> >& staging,
+		       Memory mem, Event wait_on, std::set<Event>& events)
+  {
+    for(typename std::map<RegionInstance, IndirectStaging<N,T> >::iterator it = staging.begin();
+	it != staging.end();
+	++it) {
+      IndirectStaging<N,T>& s = it->second;
+      Event e = RegionInstance::create_instance(s.temp, mem, s.space,
+						s.field_sizes, 0 /*SOA*/,
+						ProfilingRequestSet());
+      if(s.copy_in) {
+	std::vector<CopySrcDstField> dsts(s.fields);
+	for(size_t i = 0; i < dsts.size(); i++)
+	  dsts[i].inst = s.temp;
+	e = s.space.copy(s.fields, dsts, ProfilingRequestSet(),
+			 Event::merge_events(e, wait_on));
+      }
+      events.insert(e);
+    }
+  }
+
+  template <int N, typename T>
+  static void stage_out(std::map<RegionInstance, IndirectStaging<N,T> >& staging,
+			std::set<Event>& events)
+  {
+    for(typename std::map<RegionInstance, IndirectStaging<N,T> >::iterator it = staging.begin();
+	it != staging.end();
+	++it) {
+      IndirectStaging<N,T>& s = it->second;
+      if(!s.copy_out || !s.temp.exists())
+	continue;
+      std::vector<CopySrcDstField> srcs(s.fields);
+      for(size_t i = 0; i < srcs.size(); i++)
+	srcs[i].inst = s.temp;
+      events.insert(s.space.copy(srcs, s.fields, ProfilingRequestSet()));
+    }
+  }
+
+  // the temporaries are destroyed even if a copy using them failed
+  template <int N, typename T>
+  static void destroy_staged(std::map<RegionInstance, IndirectStaging<N,T> >& staging,
+			     Event wait_on)
+  {
+    for(typename std::map<RegionInstance, IndirectStaging<N,T> >::iterator it = staging.begin();
+	it != staging.end();
+	++it)
+      if(it->second.temp.exists())
+	it->second.temp.destroy(Event::ignorefaults(wait_on));
+    staging.clear();
+  }
+
+  template <int N, typename T>
+  static RegionInstance staged_instance(const std::map<RegionInstance, IndirectStaging<N,T> >& staging,
+					RegionInstance inst)
+  {
+    typename std::map<RegionInstance, IndirectStaging<N,T> >::const_iterator it = staging.find(inst);
+    return ((it != staging.end()) ? it->second.temp : inst);
+  }
+
+  // common code for indirections that map each point in an N-dimensional
+  //  copy domain to a point (or a range of points) in one of several
+  //  N2-dimensional target spaces (each of which has a corresponding
+  //  instance) - subclasses just have to say how the targets are computed
+  template <int N, typename T, int N2, typename T2>
+  class IndirectionInfoTyped : public IndirectionInfo {
+  public:
+    IndirectionInfoTyped(const IndexSpace<N,T>& _domain,
+			 const std::vector<IndexSpace<N2,T2> >& _spaces,
+			 const std::vector<RegionInstance>& _insts,
+			 bool _ranges);
+    virtual ~IndirectionInfoTyped(void);
+
+    virtual Event request_metadata(void);
+
+    virtual Event stage_instances(std::vector<CopySrcDstField>& srcs,
+				  std::vector<CopySrcDstField>& dsts,
+				  bool gather, Event wait_on);
+
+    virtual Event stage_targets(const std::vector<CopySrcDstField>& srcs,
+				const std::vector<CopySrcDstField>& dsts,
+				bool gather, Event wait_on);
+
+    virtual bool execute_copies(const std::vector<CopySrcDstField>& srcs,
+				const std::vector<CopySrcDstField>& dsts,
+				bool gather, Operation *op);
+
+    virtual Event unstage_instances(bool write_back);
+
+    virtual void get_instances(std::vector<RegionInstance>& insts) const;
+
+  protected:
+    // temporaries live in the local system memory
+    Memory find_staging_memory(void) const;
+
+    // called once all metadata is valid, before any calls to
+    //  compute_targets/compute_ranges - returns false (after logging why)
+    //  if the indirection can't be used
+    virtual bool prepare(void) = 0;
+
+    // computes the target point for each of 'count' points in the domain
+    virtual void compute_targets(const Point<N,T> *points,
+				 Point<N2,T2> *targets, size_t count) = 0;
+
+    // computes the target range for each of 'count' points in the domain,
+    //  only used when 'ranges' is set
+    virtual void compute_ranges(const Point<N,T> *points,
+				Rect<N2,T2> *ranges, size_t count) = 0;
+
+    // returns the index of the target space containing 'p', checking 'hint'
+    //  first, or spaces.size() if no space contains it
+    size_t find_space(const Point<N2,T2>& p, size_t hint) const;
+
+    // state for moving a batch of elements of every field
+    struct FieldAccessors {
+      std::vector<AffineAccessor<char,N,T> > direct;
+      std::vector<std::vector<AffineAccessor<char,N2,T2> > > indirect;
+      // a scatter with a reduction op turns each point into a reduction
+      //  list entry for the memory holding its target - the indirect
+      //  accessors for those fields produce offsets within the target
+      //  memory instead of pointers, so the targets don't have to be local
+      std::vector<ReductionListBuffer *> red_lists;
+      std::vector<std::vector<MemoryImpl *> > red_mems;
+    };
+
+    bool copy_batch(const std::vector<CopySrcDstField>& srcs, bool gather,
+		    FieldAccessors& accs, const Point<N,T> *points,
+		    const Point<N2,T2> *targets, size_t count,
+		    size_t& last_space);
+
+    IndexSpace<N,T> domain;
+    std::vector<IndexSpace<N2,T2> > spaces;
+    std::vector<RegionInstance> insts;
+    // range indirections pair the k-th point of the domain with the k-th
+    //  point of the concatenation of the ranges computed for the domain
+    bool ranges;
+    // domain points whose target is in none of the spaces are skipped
+    bool oor_possible;
+    // the field holding the indirection data, if any (it covers the domain)
+    RegionInstance ind_inst;
+    FieldID ind_field_id;
+    size_t ind_subfield_offset;
+    size_t ind_size;
+    // temporaries for instances that can't be accessed directly
+    std::map<RegionInstance, IndirectStaging<N,T> > domain_staging;
+    std::map<RegionInstance, IndirectStaging<N2,T2> > target_staging;
+    std::set<Event> staging_events;
+  };
+
+  template <int N, typename T, int N2, typename T2>
+  IndirectionInfoTyped<N,T,N2,T2>::IndirectionInfoTyped(const IndexSpace<N,T>& _domain,
+							const std::vector<IndexSpace<N2,T2> >& _spaces,
+							const std::vector<RegionInstance>& _insts,
+							bool _ranges)
+    : domain(_domain)
+    , spaces(_spaces)
+    , insts(_insts)
+    , ranges(_ranges)
+    , oor_possible(false)
+    , ind_inst(RegionInstance::NO_INST)
+    , ind_field_id(0)
+    , ind_subfield_offset(0)
+    , ind_size(0)
+  {
+    assert(spaces.size() == insts.size());
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  IndirectionInfoTyped<N,T,N2,T2>::~IndirectionInfoTyped(void)
+  {
+    // only non-empty if the copy never ran (e.g. a poisoned precondition)
+    Event done = Event::merge_events_ignorefaults(staging_events);
+    destroy_staged(domain_staging, done);
+    destroy_staged(target_staging, done);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  Event IndirectionInfoTyped<N,T,N2,T2>::request_metadata(void)
+  {
+    std::set<Event> events;
+
+    if(!domain.is_valid())
+      events.insert(domain.make_valid());
+
+    for(size_t i = 0; i < spaces.size(); i++)
+      if(!spaces[i].is_valid())
+	events.insert(spaces[i].make_valid());
+
+    std::vector<RegionInstance> all_insts;
+    get_instances(all_insts);
+    for(std::vector<RegionInstance>::const_iterator it = all_insts.begin();
+	it != all_insts.end();
+	++it) {
+      RegionInstanceImpl *impl = get_runtime()->get_instance_impl(*it);
+      if(!impl->metadata.is_valid())
+	events.insert(impl->request_metadata());
+    }
+
+    return Event::merge_events(events);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoTyped<N,T,N2,T2>::get_instances(std::vector<RegionInstance>& _insts) const
+  {
+    _insts.insert(_insts.end(), insts.begin(), insts.end());
+    if(ind_inst.exists())
+      _insts.push_back(ind_inst);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  Event IndirectionInfoTyped<N,T,N2,T2>::stage_instances(std::vector<CopySrcDstField>& srcs,
+							 std::vector<CopySrcDstField>& dsts,
+							 bool gather, Event wait_on)
+  {
+    assert(domain_staging.empty() && target_staging.empty());
+
+    // the direct side is only read by a scatter and only written by a
+    //  gather, which writes every point of the domain
+    for(size_t i = 0; i < srcs.size(); i++) {
+      const CopySrcDstField& direct = (gather ? dsts[i] : srcs[i]);
+      stage_field(domain_staging, domain, direct.inst, direct.field_id,
+		  direct.subfield_offset, direct.size, !gather, gather);
+    }
+    if(ind_inst.exists())
+      stage_field(domain_staging, domain, ind_inst, ind_field_id,
+		  ind_subfield_offset, ind_size, true, false);
+
+    if(domain_staging.empty())
+      return wait_on;
+
+    Memory mem = find_staging_memory();
+    if(!mem.exists()) {
+      // nothing to stage through - the copy will report the instances it
+      //  can't access
+      domain_staging.clear();
+      return wait_on;
+    }
+
+    log_dma.info() << "indirect copy: staging " << domain_staging.size()
+		   << " domain instances through " << mem;
+    stage_in(domain_staging, mem, wait_on, staging_events);
+
+    for(size_t i = 0; i < srcs.size(); i++) {
+      CopySrcDstField& direct = (gather ? dsts[i] : srcs[i]);
+      direct.inst = staged_instance(domain_staging, direct.inst);
+    }
+    if(ind_inst.exists())
+      ind_inst = staged_instance(domain_staging, ind_inst);
+
+    // the copy itself still needs the precondition if nothing was copied in
+    staging_events.insert(wait_on);
+    return Event::merge_events(staging_events);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  Event IndirectionInfoTyped<N,T,N2,T2>::stage_targets(const std::vector<CopySrcDstField>& srcs,
+						       const std::vector<CopySrcDstField>& dsts,
+						       bool gather, Event wait_on)
+  {
+    assert(target_staging.empty());
+
+    // scatter-reductions go through reduction lists instead, so only plain
+    //  fields of target instances without an affine accessor are staged
+    std::vector<bool> staged(insts.size(), false);
+    bool any_staged = false;
+    for(size_t i = 0; i < srcs.size(); i++) {
+      const CopySrcDstField& indirect = (gather ? srcs[i] : dsts[i]);
+      if(indirect.redop_id != 0)
+	continue;
+      for(size_t j = 0; j < insts.size(); j++)
+	if(!staged[j] &&
+	   !AffineAccessor<char,N2,T2>::is_compatible(insts[j], indirect.field_id))
+	  staged[j] = any_staged = true;
+    }
+    if(!any_staged)
+      return wait_on;
+
+    Memory mem = find_staging_memory();
+    if(!mem.exists() || !prepare())
+      return wait_on;
+
+    // only the target points the copy touches are staged - a gather reads
+    //  exactly those, and a scatter writes every one of them, so its
+    //  temporaries need not be filled first
+    std::vector<std::vector<Point<N2,T2> > > touched(insts.size());
+    const size_t BATCH_SIZE = 256;
+    Point<N,T> points[BATCH_SIZE];
+    Point<N2,T2> targets[BATCH_SIZE];
+    Rect<N2,T2> range_rects[BATCH_SIZE];
+    size_t last_space = 0;
+    IndexSpaceIterator<N,T> isi(domain);
+    PointInRectIterator<N,T> pir;
+    if(isi.valid)
+      pir.reset(isi.rect);
+    while(isi.valid) {
+      size_t count = 0;
+      while(isi.valid && (count < BATCH_SIZE)) {
+	points[count++] = pir.p;
+	pir.step();
+	if(!pir.valid) {
+	  isi.step();
+	  if(isi.valid)
+	    pir.reset(isi.rect);
+	}
+      }
+      if(ranges) {
+	compute_ranges(points, range_rects, count);
+	for(size_t i = 0; i < count; i++)
+	  for(PointInRectIterator<N2,T2> rpir(range_rects[i]); rpir.valid; rpir.step()) {
+	    size_t j = find_space(rpir.p, last_space);
+	    if(j == spaces.size())
+	      continue;  // reported by the copy
+	    last_space = j;
+	    if(staged[j])
+	      touched[j].push_back(rpir.p);
+	  }
+      } else {
+	compute_targets(points, targets, count);
+	for(size_t i = 0; i < count; i++) {
+	  size_t j = find_space(targets[i], last_space);
+	  if(j == spaces.size())
+	    continue;
+	  last_space = j;
+	  if(staged[j])
+	    touched[j].push_back(targets[i]);
+	}
+      }
+    }
+
+    for(size_t i = 0; i < srcs.size(); i++) {
+      const CopySrcDstField& indirect = (gather ? srcs[i] : dsts[i]);
+      if(indirect.redop_id != 0)
+	continue;
+      for(size_t j = 0; j < insts.size(); j++)
+	if(staged[j])
+	  stage_field(target_staging, IndexSpace<N2,T2>(touched[j]),
+		      insts[j], indirect.field_id,
+		      indirect.subfield_offset, indirect.size, gather, !gather);
+    }
+    if(target_staging.empty())
+      return wait_on;
+
+    log_dma.info() << "indirect copy: staging " << target_staging.size()
+		   << " target instances through " << mem;
+    std::set<Event> events;
+    stage_in(target_staging, mem, wait_on, events);
+    staging_events.insert(events.begin(), events.end());
+
+    for(size_t j = 0; j < insts.size(); j++)
+      insts[j] = staged_instance(target_staging, insts[j]);
+
+    events.insert(wait_on);
+    return Event::merge_events(events);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  Memory IndirectionInfoTyped<N,T,N2,T2>::find_staging_memory(void) const
+  {
+    return Machine::MemoryQuery(Machine::get_machine())
+      .local_address_space()
+      .only_kind(Memory::SYSTEM_MEM)
+      .first();
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  Event IndirectionInfoTyped<N,T,N2,T2>::unstage_instances(bool write_back)
+  {
+    if(domain_staging.empty() && target_staging.empty())
+      return Event::NO_EVENT;
+
+    std::set<Event> events;
+    if(write_back) {
+      stage_out(domain_staging, events);
+      stage_out(target_staging, events);
+    }
+    Event done = Event::merge_events(events);
+    destroy_staged(domain_staging, done);
+    destroy_staged(target_staging, done);
+    staging_events.clear();
+    return done;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  size_t IndirectionInfoTyped<N,T,N2,T2>::find_space(const Point<N2,T2>& p,
+						     size_t hint) const
+  {
+    // consecutive points usually land in the same space
+    if((hint < spaces.size()) && spaces[hint].contains(p))
+      return hint;
+
+    for(size_t i = 0; i < spaces.size(); i++)
+      if((i != hint) && spaces[i].contains(p))
+	return i;
+
+    return spaces.size();
+  }
+
+#ifdef REALM_SIMD_INDIRECT_COPIES
+  // the hardware gathers and scatters take a base pointer and a vector of
+  //  64-bit indices, so a null base turns the element pointers themselves
+  //  into the indices - they're only used when the direct side of a batch
+  //  is contiguous (i.e. a dense domain and a SOA direct instance), which
+  //  turns each vector of elements into a single load or store on that side
+
+  __attribute__((target("avx2")))
+  static void gather_contig_avx2_4(char *dst, char * const *srcs, size_t count)
+  {
+    size_t i = 0;
+    for(; (i + 4) <= count; i += 4) {
+      __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcs + i));
+      __m128i v = _mm256_i64gather_epi32(static_cast<const int *>(0), idx, 1);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i * 4)), v);
+    }
+    for(; i < count; i++)
+      memcpy(dst + (i * 4), srcs[i], 4);
+  }
+
+  __attribute__((target("avx2")))
+  static void gather_contig_avx2_8(char *dst, char * const *srcs, size_t count)
+  {
+    size_t i = 0;
+    for(; (i + 4) <= count; i += 4) {
+      __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcs + i));
+      __m256i v = _mm256_i64gather_epi64(static_cast<const long long *>(0), idx, 1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + (i * 8)), v);
+    }
+    for(; i < count; i++)
+      memcpy(dst + (i * 8), srcs[i], 8);
+  }
+
+  // lanes of a scatter are written in order, so a target hit twice in one
+  //  vector ends up with the later value, as it would with scalar stores
+  __attribute__((target("avx512f")))
+  static void scatter_contig_avx512_4(char * const *dsts, const char *src, size_t count)
+  {
+    size_t i = 0;
+    for(; (i + 8) <= count; i += 8) {
+      __m512i idx = _mm512_loadu_si512(dsts + i);
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + (i * 4)));
+      _mm512_i64scatter_epi32(0, idx, v, 1);
+    }
+    for(; i < count; i++)
+      memcpy(dsts[i], src + (i * 4), 4);
+  }
+
+  __attribute__((target("avx512f")))
+  static void scatter_contig_avx512_8(char * const *dsts, const char *src, size_t count)
+  {
+    size_t i = 0;
+    for(; (i + 8) <= count; i += 8) {
+      __m512i idx = _mm512_loadu_si512(dsts + i);
+      __m512i v = _mm512_loadu_si512(src + (i * 8));
+      _mm512_i64scatter_epi64(0, idx, v, 1);
+    }
+    for(; i < count; i++)
+      memcpy(dsts[i], src + (i * 8), 8);
+  }
+
+  static bool is_contiguous(char * const *ptrs, size_t count, size_t bytes)
+  {
+    for(size_t i = 1; i < count; i++)
+      if(ptrs[i] != (ptrs[0] + (i * bytes)))
+	return false;
+    return true;
+  }
+
+  // returns true if the elements were moved with vector gathers/scatters
+  static bool copy_elements_simd(char * const *dsts, char * const *srcs,
+				 size_t count, size_t bytes, bool gather)
+  {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    static const bool has_avx512 = __builtin_cpu_supports("avx512f");
+
+    if((bytes != 4) && (bytes != 8))
+      return false;
+    if(gather) {
+      if(!has_avx2 || !is_contiguous(dsts, count, bytes))
+	return false;
+      if(bytes == 4)
+	gather_contig_avx2_4(dsts[0], srcs, count);
+      else
+	gather_contig_avx2_8(dsts[0], srcs, count);
+    } else {
+      if(!has_avx512 || !is_contiguous(srcs, count, bytes))
+	return false;
+      if(bytes == 4)
+	scatter_contig_avx512_4(dsts, srcs[0], count);
+      else
+	scatter_contig_avx512_8(dsts, srcs[0], count);
+    }
+    return true;
+  }
+#endif
+
+  // moves 'count' elements of BYTES bytes each - a constant size lets the
+  //  compiler turn the memcpy into a single load/store for common sizes
+  template <size_t BYTES>
+  static void copy_elements(char * const *dsts, char * const *srcs, size_t count)
+  {
+    for(size_t i = 0; i < count; i++)
+      memcpy(dsts[i], srcs[i], BYTES);
+  }
+
+  // 'gather' says which side is addressed indirectly ('srcs' for a gather,
+  //  'dsts' for a scatter)
+  static void copy_elements(char * const *dsts, char * const *srcs,
+			    size_t count, size_t bytes, bool gather)
+  {
+#ifdef REALM_SIMD_INDIRECT_COPIES
+    if(copy_elements_simd(dsts, srcs, count, bytes, gather))
+      return;
+#endif
+    switch(bytes) {
+    case 1: copy_elements<1>(dsts, srcs, count); break;
+    case 2: copy_elements<2>(dsts, srcs, count); break;
+    case 4: copy_elements<4>(dsts, srcs, count); break;
+    case 8: copy_elements<8>(dsts, srcs, count); break;
+    case 16: copy_elements<16>(dsts, srcs, count); break;
+    default:
+      {
+	for(size_t i = 0; i < count; i++)
+	  memcpy(dsts[i], srcs[i], bytes);
+	break;
+      }
+    }
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  bool IndirectionInfoTyped<N,T,N2,T2>::copy_batch(const std::vector<CopySrcDstField>& srcs,
+						   bool gather,
+						   FieldAccessors& accs,
+						   const Point<N,T> *points,
+						   const Point<N2,T2> *targets,
+						   size_t count,
+						   size_t& last_space)
+  {
+    const size_t BATCH_SIZE = 256;
+    assert(count <= BATCH_SIZE);
+    size_t space_idx[BATCH_SIZE];
+    char *direct_ptrs[BATCH_SIZE];
+    char *indirect_ptrs[BATCH_SIZE];
+
+    bool skipped = false;
+    for(size_t i = 0; i < count; i++) {
+      space_idx[i] = find_space(targets[i], last_space);
+      if(space_idx[i] == spaces.size()) {
+	if(oor_possible) {
+	  skipped = true;
+	  continue;
+	}
+	log_dma.error() << "indirect copy: target point " << targets[i]
+			<< " (for " << points[i]
+			<< ") not contained in any target space";
+	return false;
+      }
+      last_space = space_idx[i];
+    }
+
+    for(size_t f = 0; f < srcs.size(); f++) {
+      if(accs.red_lists[f] != 0) {
+	for(size_t i = 0; i < count; i++) {
+	  if(skipped && (space_idx[i] == spaces.size()))
+	    continue;
+	  off_t offset = reinterpret_cast<intptr_t>(accs.indirect[f][space_idx[i]].ptr(targets[i]));
+	  accs.red_lists[f]->add_entry(accs.red_mems[f][space_idx[i]], offset,
+				       accs.direct[f].ptr(points[i]));
+	}
+	continue;
+      }
+      size_t moved = 0;
+      for(size_t i = 0; i < count; i++) {
+	if(skipped && (space_idx[i] == spaces.size()))
+	  continue;
+	direct_ptrs[moved] = accs.direct[f].ptr(points[i]);
+	indirect_ptrs[moved] = accs.indirect[f][space_idx[i]].ptr(targets[i]);
+	moved++;
+      }
+      if(moved == 0)
+	continue;
+      if(gather)
+	copy_elements(direct_ptrs, indirect_ptrs, moved, srcs[f].size, true);
+      else
+	copy_elements(indirect_ptrs, direct_ptrs, moved, srcs[f].size, false);
+    }
+    return true;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  bool IndirectionInfoTyped<N,T,N2,T2>::execute_copies(const std::vector<CopySrcDstField>& srcs,
+						       const std::vector<CopySrcDstField>& dsts,
+						       bool gather, Operation *op)
+  {
+    const size_t BATCH_SIZE = 256;
+
+    if(!prepare())
+      return false;
+
+    // the direct side of each field pair is addressed with the domain's
+    //  points, while the indirect side needs an accessor for each target
+    //  instance
+    size_t num_fields = srcs.size();
+    FieldAccessors accs;
+    accs.direct.resize(num_fields);
+    accs.indirect.resize(num_fields);
+    accs.red_lists.resize(num_fields, 0);
+    accs.red_mems.resize(num_fields);
+    bool ok = true;
+    for(size_t i = 0; ok && (i < num_fields); i++) {
+      const CopySrcDstField& direct = (gather ? dsts[i] : srcs[i]);
+      const CopySrcDstField& indirect = (gather ? srcs[i] : dsts[i]);
+      assert(direct.redop_id == 0);
+      if(indirect.redop_id != 0) {
+	assert(!gather);
+	accs.red_lists[i] = new ReductionListBuffer(op, indirect.redop_id,
+						    indirect.red_fold);
+	assert(srcs[i].size == accs.red_lists[i]->redop->sizeof_rhs);
+      } else
+	assert(srcs[i].size == dsts[i].size);
+
+      if(!AffineAccessor<char,N,T>::is_compatible(direct.inst, direct.field_id)) {
+	log_dma.error() << "indirect copy: instance " << direct.inst
+			<< " field " << direct.field_id << " is not locally accessible";
+	ok = false;
+	break;
+      }
+      accs.direct[i].reset(direct.inst, direct.field_id, direct.subfield_offset);
+
+      accs.indirect[i].resize(insts.size());
+      if(accs.red_lists[i] != 0) {
+	accs.red_mems[i].resize(insts.size());
+	for(size_t j = 0; j < insts.size(); j++) {
+	  RegionInstanceImpl *impl = get_runtime()->get_instance_impl(insts[j]);
+	  accs.red_mems[i][j] = get_runtime()->get_memory_impl(insts[j].get_location());
+	  const InstanceLayout<N2,T2> *layout = checked_cast<const InstanceLayout<N2,T2> *>(impl->metadata.layout);
+	  std::map<FieldID, InstanceLayoutGeneric::FieldLayout>::const_iterator it = layout->fields.find(indirect.field_id);
+	  const InstancePieceList<N2,T2> *ipl = ((it != layout->fields.end()) ?
+						   &layout->piece_lists[it->second.list_idx] :
+						   0);
+	  if(ipl && ipl->pieces.empty()) {
+	    // nothing can land in an empty instance
+	    accs.indirect[i][j].base = 0;
+	    continue;
+	  }
+	  if(!ipl || (ipl->pieces.size() != 1) ||
+	     (ipl->pieces[0]->layout_type != InstanceLayoutPiece<N2,T2>::AffineLayoutType)) {
+	    log_dma.error() << "indirect copy: instance " << insts[j]
+			    << " field " << indirect.field_id
+			    << " does not have an affine layout for a scatter-reduction";
+	    ok = false;
+	    break;
+	  }
+	  const AffineLayoutPiece<N2,T2> *alp = static_cast<const AffineLayoutPiece<N2,T2> *>(ipl->pieces[0]);
+	  accs.indirect[i][j].base = (impl->metadata.inst_offset + alp->offset +
+				      it->second.rel_offset +
+				      indirect.subfield_offset);
+	  accs.indirect[i][j].strides = alp->strides;
+	}
+	continue;
+      }
+      for(size_t j = 0; j < insts.size(); j++) {
+	if(!AffineAccessor<char,N2,T2>::is_compatible(insts[j], indirect.field_id)) {
+	  log_dma.error() << "indirect copy: instance " << insts[j]
+			  << " field " << indirect.field_id << " is not locally accessible";
+	  ok = false;
+	  break;
+	}
+	accs.indirect[i][j].reset(insts[j], indirect.field_id,
+				  indirect.subfield_offset);
+      }
+    }
+
+    Point<N,T> points[BATCH_SIZE];
+    Point<N2,T2> targets[BATCH_SIZE];
+    size_t last_space = 0;
+    IndexSpaceIterator<N,T> isi(domain);
+    PointInRectIterator<N,T> pir;
+    if(isi.valid)
+      pir.reset(isi.rect);
+
+    if(ok && !ranges) {
+      while(isi.valid) {
+	// gather up the next batch of domain points
+	size_t count = 0;
+	while(isi.valid && (count < BATCH_SIZE)) {
+	  points[count++] = pir.p;
+	  pir.step();
+	  if(!pir.valid) {
+	    isi.step();
+	    if(isi.valid)
+	      pir.reset(isi.rect);
+	  }
+	}
+
+	compute_targets(points, targets, count);
+	if(!copy_batch(srcs, gather, accs, points, targets, count, last_space)) {
+	  ok = false;
+	  break;
+	}
+      }
+    }
+
+    if(ok && ranges) {
+      // the ranges are computed for the domain points in order by a second
+      //  iterator, and their points are then paired with the domain points
+      Point<N,T> range_points[BATCH_SIZE];
+      Rect<N2,T2> range_rects[BATCH_SIZE];
+      size_t num_ranges = 0, next_range = 0;
+      IndexSpaceIterator<N,T> range_isi(domain);
+      PointInRectIterator<N,T> range_pir;
+      if(range_isi.valid)
+	range_pir.reset(range_isi.rect);
+      PointInRectIterator<N2,T2> target_pir;
+      bool target_valid = false;
+      while(true) {
+	size_t count = 0;
+	while(count < BATCH_SIZE) {
+	  // find the next target point, computing more ranges as needed
+	  while(!target_valid) {
+	    if(next_range == num_ranges) {
+	      num_ranges = next_range = 0;
+	      while(range_isi.valid && (num_ranges < BATCH_SIZE)) {
+		range_points[num_ranges++] = range_pir.p;
+		range_pir.step();
+		if(!range_pir.valid) {
+		  range_isi.step();
+		  if(range_isi.valid)
+		    range_pir.reset(range_isi.rect);
+		}
+	      }
+	      if(num_ranges == 0)
+		break;
+	      compute_ranges(range_points, range_rects, num_ranges);
+	    }
+	    const Rect<N2,T2>& r = range_rects[next_range++];
+	    if(!r.empty()) {
+	      target_pir.reset(r);
+	      target_valid = true;
+	    }
+	  }
+	  if(!target_valid)
+	    break;
+	  if(!isi.valid) {
+	    log_dma.error() << "indirect copy: ranges cover more than the "
+			    << domain.volume() << " points of the copy domain";
+	    ok = false;
+	    break;
+	  }
+	  points[count] = pir.p;
+	  targets[count] = target_pir.p;
+	  count++;
+	  pir.step();
+	  if(!pir.valid) {
+	    isi.step();
+	    if(isi.valid)
+	      pir.reset(isi.rect);
+	  }
+	  target_valid = target_pir.step();
+	}
+	if(!ok || (count == 0))
+	  break;
+	if(!copy_batch(srcs, gather, accs, points, targets, count, last_space)) {
+	  ok = false;
+	  break;
+	}
+      }
+      if(ok && isi.valid) {
+	log_dma.error() << "indirect copy: ranges cover less than the "
+			<< domain.volume() << " points of the copy domain";
+	ok = false;
+      }
+    }
+
+    for(size_t f = 0; f < num_fields; f++)
+      if(accs.red_lists[f] != 0) {
+	// entries for the points before an error are still applied, just as
+	//  the elements of an ordinary gather/scatter are still moved
+	accs.red_lists[f]->flush();
+	delete accs.red_lists[f];
+      }
+    return ok;
+  }
+
+  // an unstructured indirection reads the target point (or range) for each
+  //  domain point from a field of an instance covering the domain
+  template <int N, typename T, int N2, typename T2>
+  class IndirectionInfoUnstructured : public IndirectionInfoTyped<N,T,N2,T2> {
+  public:
+    IndirectionInfoUnstructured(const IndexSpace<N,T>& _domain,
+				const typename CopyIndirection<N,T>::template Unstructured<N2,T2>& ind);
+
+    virtual void print(std::ostream& os) const;
+
+  protected:
+    virtual bool prepare(void);
+
+    virtual void compute_targets(const Point<N,T> *points,
+				 Point<N2,T2> *targets, size_t count);
+
+    virtual void compute_ranges(const Point<N,T> *points,
+				Rect<N2,T2> *ranges, size_t count);
+
+    AffineAccessor<Point<N2,T2>,N,T> point_acc;
+    AffineAccessor<Rect<N2,T2>,N,T> range_acc;
+  };
+
+  template <int N, typename T, int N2, typename T2>
+  IndirectionInfoUnstructured<N,T,N2,T2>::IndirectionInfoUnstructured(const IndexSpace<N,T>& _domain,
+								      const typename CopyIndirection<N,T>::template Unstructured<N2,T2>& ind)
+    : IndirectionInfoTyped<N,T,N2,T2>(_domain, ind.spaces, ind.insts,
+				      ind.is_ranges)
+  {
+    this->ind_inst = ind.inst;
+    this->ind_field_id = ind.field_id;
+    this->ind_subfield_offset = ind.subfield_offset;
+    this->ind_size = (ind.is_ranges ? sizeof(Rect<N2,T2>) : sizeof(Point<N2,T2>));
+    this->oor_possible = ind.oor_possible;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoUnstructured<N,T,N2,T2>::print(std::ostream& os) const
+  {
+    os << "unstructured(" << this->ind_inst << "[" << this->ind_field_id << "+"
+       << this->ind_subfield_offset << "]" << (this->ranges ? " ranges" : "")
+       << (this->oor_possible ? " oor" : "")
+       << " -> " << this->insts.size() << " spaces)";
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  bool IndirectionInfoUnstructured<N,T,N2,T2>::prepare(void)
+  {
+    if(this->ranges && this->oor_possible) {
+      log_dma.error() << "indirect copy: out-of-range targets can only be "
+		      << "skipped for point indirections";
+      return false;
+    }
+    if(!AffineAccessor<char,N,T>::is_compatible(this->ind_inst, this->ind_field_id)) {
+      log_dma.error() << "indirect copy: indirection instance " << this->ind_inst
+		      << " field " << this->ind_field_id << " is not locally accessible";
+      return false;
+    }
+    if(this->ranges)
+      range_acc.reset(this->ind_inst, this->ind_field_id, this->ind_subfield_offset);
+    else
+      point_acc.reset(this->ind_inst, this->ind_field_id, this->ind_subfield_offset);
+    return true;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoUnstructured<N,T,N2,T2>::compute_targets(const Point<N,T> *points,
+							       Point<N2,T2> *targets,
+							       size_t count)
+  {
+    for(size_t i = 0; i < count; i++)
+      targets[i] = point_acc.read(points[i]);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoUnstructured<N,T,N2,T2>::compute_ranges(const Point<N,T> *points,
+							      Rect<N2,T2> *ranges,
+							      size_t count)
+  {
+    for(size_t i = 0; i < count; i++)
+      ranges[i] = range_acc.read(points[i]);
+  }
+
+  // an affine indirection computes the target range for each domain point
+  //  from the point itself - when both offsets are the same, each range is
+  //  a single point and the indirection maps points to points
+  template <int N, typename T, int N2, typename T2>
+  class IndirectionInfoAffine : public IndirectionInfoTyped<N,T,N2,T2> {
+  public:
+    IndirectionInfoAffine(const IndexSpace<N,T>& _domain,
+			  const typename CopyIndirection<N,T>::template Affine<N2,T2>& ind);
+
+    virtual void print(std::ostream& os) const;
+
+  protected:
+    virtual bool prepare(void);
+
+    virtual void compute_targets(const Point<N,T> *points,
+				 Point<N2,T2> *targets, size_t count);
+
+    virtual void compute_ranges(const Point<N,T> *points,
+				Rect<N2,T2> *ranges, size_t count);
+
+    Matrix<N2,N,T2> transform;
+    Point<N2,T2> offset_lo, offset_hi;
+    Point<N2,T2> divisor;
+  };
+
+  template <int N, typename T, int N2, typename T2>
+  IndirectionInfoAffine<N,T,N2,T2>::IndirectionInfoAffine(const IndexSpace<N,T>& _domain,
+							  const typename CopyIndirection<N,T>::template Affine<N2,T2>& ind)
+    : IndirectionInfoTyped<N,T,N2,T2>(_domain, ind.spaces, ind.insts,
+				      (ind.offset_lo != ind.offset_hi))
+    , transform(ind.transform)
+    , offset_lo(ind.offset_lo)
+    , offset_hi(ind.offset_hi)
+    , divisor(ind.divisor)
+  {}
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoAffine<N,T,N2,T2>::print(std::ostream& os) const
+  {
+    os << "affine(" << offset_lo << ".." << offset_hi << " / " << divisor
+       << " -> " << this->insts.size() << " spaces)";
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  bool IndirectionInfoAffine<N,T,N2,T2>::prepare(void)
+  {
+    for(int i = 0; i < N2; i++)
+      if(divisor[i] <= 0) {
+	log_dma.error() << "indirect copy: affine indirection divisor "
+			<< divisor << " must be positive";
+	return false;
+      }
+    return true;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoAffine<N,T,N2,T2>::compute_targets(const Point<N,T> *points,
+							 Point<N2,T2> *targets,
+							 size_t count)
+  {
+    for(size_t i = 0; i < count; i++)
+      targets[i] = (transform * points[i] + offset_lo) / divisor;
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  void IndirectionInfoAffine<N,T,N2,T2>::compute_ranges(const Point<N,T> *points,
+							Rect<N2,T2> *ranges,
+							size_t count)
+  {
+    for(size_t i = 0; i < count; i++) {
+      Point<N2,T2> p = transform * points[i];
+      ranges[i] = Rect<N2,T2>((p + offset_lo) / divisor,
+			      (p + offset_hi) / divisor);
+    }
+  }
+
+  template <int N, typename T>
+  template <int N2, typename T2>
+  CopyIndirection<N,T>::Unstructured<N2,T2>::Unstructured(void)
+    : field_id(0)
+    , inst(RegionInstance::NO_INST)
+    , is_ranges(false)
+    , subfield_offset(0)
+    , oor_possible(false)
+  {}
+
+  template <int N, typename T>
+  template <int N2, typename T2>
+  IndirectionInfo *CopyIndirection<N,T>::Unstructured<N2,T2>::create_info(const IndexSpace<N,T>& is) const
+  {
+    return new IndirectionInfoUnstructured<N,T,N2,T2>(is, *this);
+  }
+
+  template <int N, typename T>
+  template <int N2, typename T2>
+  IndirectionInfo *CopyIndirection<N,T>::Affine<N2,T2>::create_info(const IndexSpace<N,T>& is) const
+  {
+    return new IndirectionInfoAffine<N,T,N2,T2>(is, *this);
+  }
+
+  // a gather or scatter plan covers all the field pairs that use the same
+  //  indirection in the same direction
+  class TransferPlanIndirect : public TransferPlan {
+  public:
+    TransferPlanIndirect(IndirectionInfo *_info, bool _gather);
+    virtual ~TransferPlanIndirect(void);
+
+    void add_field(const CopySrcDstField& src, const CopySrcDstField& dst);
+
+    virtual Event execute_plan(const TransferDomain *td,
+			       const ProfilingRequestSet& requests,
+			       Event wait_on, int priority);
+
+  protected:
+    IndirectionInfo *info;
+    bool gather;
+    std::vector<CopySrcDstField> srcs, dsts;
+  };
+
+  TransferPlanIndirect::TransferPlanIndirect(IndirectionInfo *_info,
+					     bool _gather)
+    : info(_info)
+    , gather(_gather)
+  {}
+
+  TransferPlanIndirect::~TransferPlanIndirect(void)
+  {
+    delete info;
+  }
+
+  void TransferPlanIndirect::add_field(const CopySrcDstField& src,
+				       const CopySrcDstField& dst)
+  {
+    srcs.push_back(src);
+    dsts.push_back(dst);
+  }
+
+  Event TransferPlanIndirect::execute_plan(const TransferDomain *td,
+					   const ProfilingRequestSet& requests,
+					   Event wait_on, int priority)
+  {
+    GenEventImpl *finish_event = GenEventImpl::create_genevent();
+    Event ev = finish_event->current_event();
+    IndirectCopyRequest *r = new IndirectCopyRequest(info, srcs, dsts, gather,
+						     wait_on,
+						     finish_event,
+						     ID(ev).event_generation(),
+						     priority, requests);
+    // the request owns the indirection info now
+    info = 0;
+
+    // all instances are accessed directly, so the request must run here
+    get_runtime()->optable.add_local_operation(ev, r);
+    r->check_readiness(false, dma_queue);
+
+    return ev;
+  }
+
   template <int N, typename T>
   Event IndexSpace<N,T>::copy(const std::vector<CopySrcDstField>& srcs,
 			      const std::vector<CopySrcDstField>& dsts,
@@ -961,11 +2044,28 @@ namespace Realm {
   {
     TransferDomain *td = TransferDomain::construct(*this);
     std::vector<TransferPlan *> plans;
+    // indirect plans are keyed by (indirect_index, is_gather)
+    std::map<std::pair<int, bool>, TransferPlanIndirect *> indirect_plans;
     assert(srcs.size() == dsts.size());
     for(size_t i = 0; i < srcs.size(); i++) {
       assert(srcs[i].size == dsts[i].size);
-      assert(srcs[i].indirect_index == -1);
-      assert(dsts[i].indirect_index == -1);
+
+      // gathers and scatters are handled separately from everything else
+      if((srcs[i].indirect_index != -1) || (dsts[i].indirect_index != -1)) {
+	// no support for indirection on both sides yet
+	assert((srcs[i].indirect_index == -1) || (dsts[i].indirect_index == -1));
+	bool gather = (srcs[i].indirect_index != -1);
+	int idx = (gather ? srcs[i].indirect_index : dsts[i].indirect_index);
+	assert((idx >= 0) && (size_t(idx) < indirects.size()));
+	TransferPlanIndirect *&p = indirect_plans[std::make_pair(idx, gather)];
+	if(!p) {
+	  p = new TransferPlanIndirect(indirects[idx]->create_info(*this),
+				       gather);
+	  plans.push_back(p);
+	}
+	p->add_field(srcs[i], dsts[i]);
+	continue;
+      }
 
       // if the source field id is -1 and dst has no redop, we can use old fill
       if(srcs[i].field_id == FieldID(-1)) {
@@ -1031,5 +2131,12 @@ namespace Realm {
   template class TransferIteratorIndexSpace<N,T>; \
   template class TransferDomainIndexSpace<N,T>;
   FOREACH_NT(DOIT)
+#undef DOIT
+
+#define DOIT2(N,T,N2,T2) \
+  template class CopyIndirection<N,T>::Unstructured<N2,T2>; \
+  template class CopyIndirection<N,T>::Affine<N2,T2>;
+  FOREACH_NTNT(DOIT2)
+#undef DOIT2
 
 }; // namespace Realm
@@ -28,6 +28,8 @@
 
 namespace Realm {
 
+  class Operation;
+
   // the data transfer engine has too much code to have it all be templated on the
   //  type of IndexSpace that is driving the transfer, so we need a widget that
   //  can hold an arbitrary IndexSpace and dispatch based on its type
@@ -151,6 +153,64 @@ namespace Realm {
     return Serialization::PolymorphicSerdezHelper<TransferDomain>::deserialize_new(deserializer);
   }
 
+  // an IndirectionInfo is the type-erased form of a CopyIndirection that
+  //  the transfer engine uses to perform gather/scatter copies - it maps
+  //  each point in the copy domain to a point in one of the indirectly
+  //  addressed instances
+  class IndirectionInfo {
+  public:
+    virtual ~IndirectionInfo(void);
+
+    // must be called (and waited on) before the copy can be performed
+    virtual Event request_metadata(void) = 0;
+
+    // called once metadata is valid - any instance covering the copy
+    //  domain (including the one holding the indirection data) that the
+    //  copy can't access directly (remote, not cpu-accessible, or not
+    //  affine) is replaced in 'srcs'/'dsts' and in the indirection by a
+    //  local temporary filled by ordinary copies after 'wait_on', and the
+    //  copy must wait on the returned event instead
+    virtual Event stage_instances(std::vector<CopySrcDstField>& srcs,
+				  std::vector<CopySrcDstField>& dsts,
+				  bool gather, Event wait_on) = 0;
+
+    // called once the event returned by stage_instances has triggered (so
+    //  the indirection data can be read) - does the same for the target
+    //  instances, but each temporary only covers the target points the
+    //  copy touches
+    virtual Event stage_targets(const std::vector<CopySrcDstField>& srcs,
+				const std::vector<CopySrcDstField>& dsts,
+				bool gather, Event wait_on) = 0;
+
+    // performs the copy for each (src,dst) pair of fields - one side of
+    //  every pair is addressed through this indirection (the source for a
+    //  gather, the destination for a scatter) and the other side is an
+    //  ordinary field of an instance covering the copy domain
+    // the targets of a scatter with a reduction op are applied as reduction
+    //  lists (remote ones add fences to 'op')
+    // returns false (after logging the problem) if the copy could not be
+    //  completed, e.g. for a target point outside every target space
+    virtual bool execute_copies(const std::vector<CopySrcDstField>& srcs,
+				const std::vector<CopySrcDstField>& dsts,
+				bool gather, Operation *op) = 0;
+
+    // writes staged temporaries back to the original instances (if
+    //  'write_back' is set) and destroys them - returns the event for
+    //  the write-back copies, or NO_EVENT if nothing was staged
+    virtual Event unstage_instances(bool write_back) = 0;
+
+    // adds all instances used by the indirection (including the one holding
+    //  the indirection data, if any) to 'insts'
+    virtual void get_instances(std::vector<RegionInstance>& insts) const = 0;
+
+    virtual void print(std::ostream& os) const = 0;
+  };
+
+  inline std::ostream& operator<<(std::ostream& os, const IndirectionInfo& ii)
+  {
+    ii.print(os); return os;
+  }
+
   class TransferPlan {
   protected:
     // subclasses constructed in plan_* calls below
@@ -587,7 +587,8 @@ REALM_SRC 	+= $(LG_RT_DIR)/realm/hdf5/hdf5_module.cc \
 		   $(LG_RT_DIR)/realm/hdf5/hdf5_internal.cc \
 		   $(LG_RT_DIR)/realm/hdf5/hdf5_access.cc
 endif
-REALM_SRC 	+= $(LG_RT_DIR)/realm/activemsg.cc
+REALM_SRC 	+= $(LG_RT_DIR)/realm/activemsg.cc \
+		   $(LG_RT_DIR)/realm/shm_transport.cc
 GPU_RUNTIME_SRC +=
 
 REALM_SRC 	+= $(LG_RT_DIR)/realm/logging.cc \
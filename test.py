@@ -75,6 +75,8 @@ if platform.system() != 'Darwin':
     legion_cxx_tests += [
         # FIXME: Fails non-deterministically on Mac OS: https://github.com/StanfordLegion/legion/issues/213
         ['test/attach_file_mini/attach_file_mini', []],
+        # Persistent traces need the build id of the executable
+        ['test/trace_cache/trace_cache', []],
     ]
 
 legion_gasnet_cxx_tests = [
@@ -23,7 +23,6 @@
 using namespace std;
 using namespace Legion;
 using namespace Legion::Mapping;
-using namespace LegionRuntime::Arrays;
 
 enum
 {
@@ -89,7 +88,7 @@ static void parse_arguments(char** argv, int argc, unsigned &num_tasks,
                             unsigned &num_partitions, unsigned &num_slices,
                             unsigned &tree_depth, unsigned &num_fields,
                             unsigned &dims, unsigned &blast, unsigned &slide,
-                            bool &alternate, bool &alternate_loop,
+                            unsigned &fan_in, bool &alternate, bool &alternate_loop,
                             bool &single_launch, bool &block,
                             bool &cache_mapping, bool &tracing,
                             vector<int> &pattern)
@@ -107,6 +106,7 @@ static void parse_arguments(char** argv, int argc, unsigned &num_tasks,
     else if (strcmp(argv[i], "-D") == 0) dims = atoi(argv[++i]);
     else if (strcmp(argv[i], "-B") == 0) blast = atoi(argv[++i]);
     else if (strcmp(argv[i], "-L") == 0) slide = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-W") == 0) fan_in = atoi(argv[++i]);
     else if (strcmp(argv[i], "-a") == 0) alternate = true;
     else if (strcmp(argv[i], "-A") == 0) alternate_loop = true;
     else if (strcmp(argv[i], "-s") == 0) single_launch = true;
@@ -245,6 +245,7 @@ PerfMapper::PerfMapper(MapperRuntime *rt, Machine machine, Processor local,
   unsigned dims = 1;
   unsigned blast = 1;
   unsigned slide = 0;
+  unsigned fan_in = 1;
   bool alternate = false;
   bool alternate_loop = false;
   bool single_launch = false;
@@ -257,7 +258,7 @@ PerfMapper::PerfMapper(MapperRuntime *rt, Machine machine, Processor local,
 
   parse_arguments(argv, argc, num_tasks, num_loops, num_regions,
       num_partitions, num_slices, tree_depth, num_fields, dims, blast, slide,
-      alternate, alternate_loop, single_launch, block, cache_mapping,
+      fan_in, alternate, alternate_loop, single_launch, block, cache_mapping,
       tracing, pattern);
 
   if (tracing && !cache_mapping)
@@ -588,37 +589,30 @@ void create_index_partitions(Context ctx, Runtime *runtime, IndexSpace is,
 {
   if (depth == max_depth) return;
   IndexPartition ip;
-  Rect<DIM> rect = runtime->get_index_space_domain(ctx, is).get_rect<DIM>();
+  Rect<DIM> rect = runtime->get_index_space_domain(ctx, is);
   size_t num_elmts = rect.volume();
   assert(num_elmts > 0);
   size_t block_size = num_elmts / fanout;
   assert(block_size > 0);
   if (alternate && (pattern[part_color % pattern.size()] & WO) == 0)
   {
-    Point<DIM> colors;
-    colors.x[0] = fanout - 1;
-    for (unsigned idx = 1; idx < DIM; ++idx) colors.x[idx] = 0;
+    Point<DIM> colors = Point<DIM>::ZEROES();
+    colors[0] = fanout - 1;
 
-    Domain color_space =
-      Domain::from_rect<DIM>(Rect<DIM>(Point<DIM>::ZEROES(), colors));
+    Domain color_space = Rect<DIM>(Point<DIM>::ZEROES(), colors);
     DomainPointColoring coloring;
     Point<DIM> start = rect.lo;
-    Point<DIM> block;
-    block.x[0] = block_size;
-    for (unsigned idx = 1; idx < DIM; ++idx) block.x[idx] = 0;
-    Point<DIM> one;
-    one.x[0] = 1;
-    for (unsigned idx = 1; idx < DIM; ++idx) one.x[idx] = 0;
+    Point<DIM> block = Point<DIM>::ZEROES();
+    block[0] = block_size;
+    Point<DIM> one = Point<DIM>::ZEROES();
+    one[0] = 1;
     for (int i = 0; i < fanout; ++i)
     {
       Point<DIM> end = start + block;
-      Point<DIM> color;
-      color.x[0] = i;
-      for (unsigned idx = 1; idx < DIM; ++idx) color.x[idx] = 0;
-      coloring[DomainPoint::from_point<DIM>(color)] =
-        Domain::from_rect<DIM>(Rect<DIM>(
-              Point<DIM>::max(start, rect.lo),
-              Point<DIM>::min(rect.hi, end)));
+      Point<DIM> color = Point<DIM>::ZEROES();
+      color[0] = i;
+      coloring[DomainPoint(color)] =
+        Domain(Rect<DIM>(start, end).intersection(rect));
       start = end - one;
     }
     ip = runtime->create_index_partition(ctx, is, color_space, coloring,
@@ -626,20 +620,17 @@ void create_index_partitions(Context ctx, Runtime *runtime, IndexSpace is,
   }
   else
   {
-    Point<DIM> block;
-    block.x[0] = num_elmts / fanout;
-    for (unsigned idx = 1; idx < DIM; ++idx) block.x[idx] = 1;
-    Blockify<DIM> blockify(block, rect.lo);
-    ip = runtime->create_index_partition(ctx, is, blockify, part_color);
+    Point<DIM> block = Point<DIM>::ONES();
+    block[0] = num_elmts / fanout;
+    ip = runtime->create_partition_by_blockify(ctx, is, DomainPoint(block),
+        DomainPoint(rect.lo), part_color);
   }
 
   for (int i = 0; i < fanout; ++i)
   {
-    Point<DIM> color;
-    color.x[0] = i;
-    for (unsigned idx = 1; idx < DIM; ++idx) color.x[idx] = 0;
-    IndexSpace sis = runtime->get_index_subspace(ctx, ip,
-        DomainPoint::from_point<DIM>(color));
+    Point<DIM> color = Point<DIM>::ZEROES();
+    color[0] = i;
+    IndexSpace sis = runtime->get_index_subspace(ctx, ip, DomainPoint(color));
     create_index_partitions<DIM>(ctx, runtime, sis, fanout, part_color,
         alternate, depth + 1, max_depth, pattern);
   }
@@ -675,6 +666,7 @@ void top_level_task(const Task *task,
   unsigned dims = 1;
   unsigned blast = 1;
   unsigned slide = 0;
+  unsigned fan_in = 1;
   bool alternate = false;
   bool alternate_loop = false;
   bool single_launch = false;
@@ -689,7 +681,7 @@ void top_level_task(const Task *task,
     int argc = command_args.argc;
     parse_arguments(argv, argc, num_tasks, num_loops, num_regions,
         num_partitions, num_slices, tree_depth, num_fields, dims, blast, slide,
-        alternate, alternate_loop, single_launch, block, cache_mapping,
+        fan_in, alternate, alternate_loop, single_launch, block, cache_mapping,
         tracing, pattern);
     if (num_regions == 0) num_partitions = 1;
     if (num_regions > 0 && num_partitions > 0 && tree_depth == 0)
@@ -732,6 +724,17 @@ void top_level_task(const Task *task,
       fprintf(stderr, "ERROR: Tracing cannot be used in the blocking mode.\n");
       exit(-1);
     }
+    if (fan_in == 0)
+    {
+      fprintf(stderr, "ERROR: Fan-in width should be greater than 0.\n");
+      exit(-1);
+    }
+    if (fan_in > 1 && !alternate && !alternate_loop)
+    {
+      fprintf(stderr,
+          "ERROR: Fan-in only applies to the ro and rd steps of a pattern.\n");
+      exit(-1);
+    }
   }
 
   if (tracing && alternate_loop && num_loops % pattern.size() != 0)
@@ -772,6 +775,7 @@ void top_level_task(const Task *task,
   printf("* Dimensionality        :       %5u *\n", dims);
   printf("* Blast Factor          :       %5u *\n", blast);
   printf("* Sliding Factor        :       %5u *\n", slide);
+  printf("* Fan-in Width          :       %5u *\n", fan_in);
   printf("***************************************\n");
 
   Domain launch_domain;
@@ -780,22 +784,22 @@ void top_level_task(const Task *task,
     case 1 :
       {
         launch_domain =
-          Domain::from_rect<1>(Rect<1>(make_point(0),
-                                       make_point(num_tasks - 1)));
+          Domain(Rect<1>(Point<1>(0),
+                         Point<1>(num_tasks - 1)));
         break;
       }
     case 2 :
       {
         launch_domain =
-          Domain::from_rect<2>(Rect<2>(make_point(0, 0),
-                                       make_point(num_tasks - 1, 0)));
+          Domain(Rect<2>(Point<2>(0, 0),
+                         Point<2>(num_tasks - 1, 0)));
         break;
       }
     case 3 :
       {
         launch_domain =
-          Domain::from_rect<3>(Rect<3>(make_point(0, 0, 0),
-                                       make_point(num_tasks - 1, 0, 0)));
+          Domain(Rect<3>(Point<3>(0, 0, 0),
+                         Point<3>(num_tasks - 1, 0, 0)));
         break;
       }
     default:
@@ -824,22 +828,22 @@ void top_level_task(const Task *task,
       case 1 :
         {
           region_domain =
-            Domain::from_rect<1>(Rect<1>(make_point(1),
-                                         make_point(num_elmts)));
+            Domain(Rect<1>(Point<1>(1),
+                           Point<1>(num_elmts)));
           break;
         }
       case 2 :
         {
           region_domain =
-            Domain::from_rect<2>(Rect<2>(make_point(1, 1),
-                                         make_point(num_elmts, 1)));
+            Domain(Rect<2>(Point<2>(1, 1),
+                           Point<2>(num_elmts, 1)));
           break;
         }
       case 3 :
         {
           region_domain =
-            Domain::from_rect<3>(Rect<3>(make_point(1, 1, 1),
-                                         make_point(num_elmts, 1, 1)));
+            Domain(Rect<3>(Point<3>(1, 1, 1),
+                           Point<3>(num_elmts, 1, 1)));
           break;
         }
       default:
@@ -920,36 +924,113 @@ void top_level_task(const Task *task,
       for (unsigned j = 0; j < bounds; ++j)
       {
         unsigned p = j % num_partitions;
-        for (unsigned i = 0; i < num_tasks; ++i)
+        // Read-only and reduction steps are repeated to build up a wide
+        // fan-in of non-interfering users in front of the next writer
+        int kind = alternate ? pattern[j] :
+          (alternate_loop ? pattern[l % pattern.size()] : RW);
+        unsigned repeat = (kind == RO || kind == RD) ? fan_in : 1;
+        for (unsigned w = 0; w < repeat; ++w)
         {
-          TaskLauncher launcher(DO_NOTHING_TASK_ID, TaskArgument());
-          if (block && l == 0 && p == 0) launcher.add_wait_barrier(next_barrier);
-          DomainPoint dp;
-          dp.dim = dims;
-          dp.point_data[0] = i;
-          for (unsigned k = 1; k < dims; ++k) dp.point_data[k] = 0;
-          for (unsigned r = 0; r < num_regions; ++r)
+          for (unsigned i = 0; i < num_tasks; ++i)
           {
-            LogicalPartition lp = lps[r][p];
-            LogicalRegion lr;
-            for (unsigned d = 0; d < tree_depth; ++d)
+            TaskLauncher launcher(DO_NOTHING_TASK_ID, TaskArgument());
+            if (block && l == 0 && p == 0) launcher.add_wait_barrier(next_barrier);
+            DomainPoint dp;
+            dp.dim = dims;
+            dp.point_data[0] = i;
+            for (unsigned k = 1; k < dims; ++k) dp.point_data[k] = 0;
+            for (unsigned r = 0; r < num_regions; ++r)
             {
-              lr = runtime->get_logical_subregion_by_color(ctx, lp, dp);
-              if (d + 1 < tree_depth)
-                lp = runtime->get_logical_partition_by_color(ctx, lr, p);
-            }
+              LogicalPartition lp = lps[r][p];
+              LogicalRegion lr;
+              for (unsigned d = 0; d < tree_depth; ++d)
+              {
+                lr = runtime->get_logical_subregion_by_color(ctx, lp, dp);
+                if (d + 1 < tree_depth)
+                  lp = runtime->get_logical_partition_by_color(ctx, lr, p);
+              }
 
+              if ((alternate && pattern[j] == RD) ||
+                  (alternate_loop && pattern[l % pattern.size()] == RD))
+              {
+                unsigned offset = slide * p;
+                RegionRequirement req(lr, REDUCE_ID, SIMULTANEOUS, lrs[r]);
+                for (unsigned k = 0; k < num_fields; ++k)
+                {
+                  req.tag = l / (alternate_loop ? pattern.size() : 1);
+                  req.add_field(100 + k + offset);
+                }
+                launcher.add_region_requirement(req);
+              }
+              else
+              {
+                FieldID fid = 100;
+                unsigned fid_block = num_fields / blast;
+                unsigned offset = slide * p;
+                for (unsigned b = 0; b < blast; ++b)
+                {
+                  PrivilegeMode priv = READ_WRITE;
+                  if (alternate)
+                  {
+                    if (pattern[j] == RO) priv = READ_ONLY;
+                    else if (pattern[j] == WO) priv = WRITE_ONLY;
+                  }
+                  else if (alternate_loop)
+                  {
+                    if (pattern[l % pattern.size()] == RO) priv = READ_ONLY;
+                    else if (pattern[l % pattern.size()] == WO) priv = WRITE_ONLY;
+                  }
+                  RegionRequirement req(lr, priv, EXCLUSIVE, lrs[r]);
+                  req.tag = l / (alternate_loop ? pattern.size() : 1);
+                  for (unsigned k = 0; k < fid_block; ++k)
+                  {
+                    req.add_field(fid + k + offset);
+                  }
+                  launcher.add_region_requirement(req);
+                  fid += fid_block;
+                }
+              }
+            }
+            runtime->execute_task(ctx, launcher);
+          }
+        }
+      }
+      if (tracing && (!alternate_loop || (l + 1) % pattern.size() == 0))
+        runtime->end_trace(ctx, 0);
+    }
+  }
+  else
+  {
+    for (unsigned l = 0; l < num_loops; ++l)
+    {
+      if (tracing && (!alternate_loop || l % pattern.size() == 0))
+        runtime->begin_trace(ctx, 0);
+      unsigned bounds = alternate ? pattern.size() : num_partitions;
+      for (unsigned j = 0; j < bounds; ++j)
+      {
+        unsigned p = j % num_partitions;
+        int kind = alternate ? pattern[j] :
+          (alternate_loop ? pattern[l % pattern.size()] : RW);
+        unsigned repeat = (kind == RO || kind == RD) ? fan_in : 1;
+        for (unsigned w = 0; w < repeat; ++w)
+        {
+          IndexTaskLauncher launcher(DO_NOTHING_TASK_ID, launch_domain,
+                                     TaskArgument(), ArgumentMap());
+          if (block && l == 0 && p == 0) launcher.add_wait_barrier(next_barrier);
+          for (unsigned r = 0; r < num_regions; ++r)
+          {
             if ((alternate && pattern[j] == RD) ||
                 (alternate_loop && pattern[l % pattern.size()] == RD))
             {
               unsigned offset = slide * p;
-              RegionRequirement req(lr, REDUCE_ID, SIMULTANEOUS, lrs[r]);
+                RegionRequirement req(lps[r][p], pid, REDUCE_ID, SIMULTANEOUS,
+                    lrs[r]);
               for (unsigned k = 0; k < num_fields; ++k)
               {
                 req.tag = l / (alternate_loop ? pattern.size() : 1);
                 req.add_field(100 + k + offset);
               }
-              launcher.add_region_requirement(req);
+                launcher.add_region_requirement(req);
             }
             else
             {
@@ -969,7 +1050,8 @@ void top_level_task(const Task *task,
                   if (pattern[l % pattern.size()] == RO) priv = READ_ONLY;
                   else if (pattern[l % pattern.size()] == WO) priv = WRITE_ONLY;
                 }
-                RegionRequirement req(lr, priv, EXCLUSIVE, lrs[r]);
+                RegionRequirement req(lps[r][p], pid, priv, EXCLUSIVE,
+                    lrs[r]);
                 req.tag = l / (alternate_loop ? pattern.size() : 1);
                 for (unsigned k = 0; k < fid_block; ++k)
                 {
@@ -980,72 +1062,8 @@ void top_level_task(const Task *task,
               }
             }
           }
-          runtime->execute_task(ctx, launcher);
-        }
-      }
-      if (tracing && (!alternate_loop || (l + 1) % pattern.size() == 0))
-        runtime->end_trace(ctx, 0);
-    }
-  }
-  else
-  {
-    for (unsigned l = 0; l < num_loops; ++l)
-    {
-      if (tracing && (!alternate_loop || l % pattern.size() == 0))
-        runtime->begin_trace(ctx, 0);
-      unsigned bounds = alternate ? pattern.size() : num_partitions;
-      for (unsigned j = 0; j < bounds; ++j)
-      {
-        unsigned p = j % num_partitions;
-        IndexTaskLauncher launcher(DO_NOTHING_TASK_ID, launch_domain,
-                                   TaskArgument(), ArgumentMap());
-        if (block && l == 0 && p == 0) launcher.add_wait_barrier(next_barrier);
-        for (unsigned r = 0; r < num_regions; ++r)
-        {
-          if ((alternate && pattern[j] == RD) ||
-              (alternate_loop && pattern[l % pattern.size()] == RD))
-          {
-            unsigned offset = slide * p;
-              RegionRequirement req(lps[r][p], pid, REDUCE_ID, SIMULTANEOUS,
-                  lrs[r]);
-            for (unsigned k = 0; k < num_fields; ++k)
-            {
-              req.tag = l / (alternate_loop ? pattern.size() : 1);
-              req.add_field(100 + k + offset);
-            }
-              launcher.add_region_requirement(req);
-          }
-          else
-          {
-            FieldID fid = 100;
-            unsigned fid_block = num_fields / blast;
-            unsigned offset = slide * p;
-            for (unsigned b = 0; b < blast; ++b)
-            {
-              PrivilegeMode priv = READ_WRITE;
-              if (alternate)
-              {
-                if (pattern[j] == RO) priv = READ_ONLY;
-                else if (pattern[j] == WO) priv = WRITE_ONLY;
-              }
-              else if (alternate_loop)
-              {
-                if (pattern[l % pattern.size()] == RO) priv = READ_ONLY;
-                else if (pattern[l % pattern.size()] == WO) priv = WRITE_ONLY;
-              }
-              RegionRequirement req(lps[r][p], pid, priv, EXCLUSIVE,
-                  lrs[r]);
-              req.tag = l / (alternate_loop ? pattern.size() : 1);
-              for (unsigned k = 0; k < fid_block; ++k)
-              {
-                req.add_field(fid + k + offset);
-              }
-              launcher.add_region_requirement(req);
-              fid += fid_block;
-            }
-          }
+          runtime->execute_index_space(ctx, launcher);
         }
-        runtime->execute_index_space(ctx, launcher);
       }
       if (tracing && (!alternate_loop || (l + 1) % pattern.size() == 0))
         runtime->end_trace(ctx, 0);
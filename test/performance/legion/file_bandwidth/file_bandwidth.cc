@@ -0,0 +1,171 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the bandwidth of copies to and from files attached with
+//  attach_file (the same path as test/attach_file_mini, but with large
+//  regions and timing) - run with and without -ll:io_uring to compare
+//  the io_uring backend against the default AIO path
+// only the copies are timed - execution fences order the timing
+//  measurements after the attach and before the detach of the file
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_SRC,
+  FID_DST,
+};
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  size_t size_in_mb = 64;
+  int num_reps = 4;
+  const char *file_name = "file_bandwidth.dat";
+  {
+    const InputArgs &command_args = Runtime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++) {
+      if (!strcmp(command_args.argv[i], "-s"))
+        size_in_mb = atoll(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-r"))
+        num_reps = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-f"))
+        file_name = command_args.argv[++i];
+    }
+  }
+  const coord_t num_elements = (size_in_mb << 20) / sizeof(double);
+  const double bytes = num_elements * sizeof(double);
+
+  Rect<1> rect(0, num_elements - 1);
+  IndexSpace is = runtime->create_index_space(ctx, rect);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(double), FID_SRC);
+    allocator.allocate_field(sizeof(double), FID_DST);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  LogicalRegion lr_file = runtime->create_logical_region(ctx, is, fs);
+
+  // initialize the source field
+  {
+    InlineLauncher launcher(RegionRequirement(lr, WRITE_DISCARD, EXCLUSIVE, lr)
+                            .add_field(FID_SRC));
+    PhysicalRegion pr = runtime->map_region(ctx, launcher);
+    pr.wait_until_valid();
+    const FieldAccessor<WRITE_DISCARD,double,1> acc(pr, FID_SRC);
+    for (PointInRectIterator<1> pir(rect); pir(); pir++)
+      acc[*pir] = (double)(*pir)[0];
+    runtime->unmap_region(ctx, pr);
+  }
+
+  std::vector<FieldID> file_fields(1, FID_SRC);
+  printf("file: %s  size: %zu MB  reps: %d\n", file_name, size_in_mb,
+         num_reps);
+  for (int rep = 0; rep < num_reps; rep++) {
+    double t_write, t_read;
+    // write: region -> file
+    {
+      AttachLauncher launcher(EXTERNAL_POSIX_FILE, lr_file, lr_file);
+      launcher.attach_file(file_name, file_fields,
+                           (rep == 0) ? LEGION_FILE_CREATE :
+                                        LEGION_FILE_READ_WRITE);
+      PhysicalRegion pr = runtime->attach_external_resource(ctx, launcher);
+      runtime->issue_execution_fence(ctx);
+      Future f_start = runtime->get_current_time_in_microseconds(ctx);
+      CopyLauncher copy;
+      copy.add_copy_requirements(
+          RegionRequirement(lr, READ_ONLY, EXCLUSIVE, lr).add_field(FID_SRC),
+          RegionRequirement(lr_file, READ_WRITE, EXCLUSIVE, lr_file)
+            .add_field(FID_SRC));
+      runtime->issue_copy_operation(ctx, copy);
+      runtime->issue_execution_fence(ctx);
+      Future f_stop = runtime->get_current_time_in_microseconds(ctx);
+      t_write = (f_stop.get_result<long long>() -
+                 f_start.get_result<long long>());
+      runtime->detach_external_resource(ctx, pr).get_void_result();
+    }
+    // read: file -> region
+    {
+      AttachLauncher launcher(EXTERNAL_POSIX_FILE, lr_file, lr_file);
+      launcher.attach_file(file_name, file_fields, LEGION_FILE_READ_ONLY);
+      PhysicalRegion pr = runtime->attach_external_resource(ctx, launcher);
+      runtime->issue_execution_fence(ctx);
+      Future f_start = runtime->get_current_time_in_microseconds(ctx);
+      CopyLauncher copy;
+      copy.add_copy_requirements(
+          RegionRequirement(lr_file, READ_ONLY, EXCLUSIVE, lr_file)
+            .add_field(FID_SRC),
+          RegionRequirement(lr, WRITE_DISCARD, EXCLUSIVE, lr)
+            .add_field(FID_DST));
+      runtime->issue_copy_operation(ctx, copy);
+      runtime->issue_execution_fence(ctx);
+      Future f_stop = runtime->get_current_time_in_microseconds(ctx);
+      t_read = (f_stop.get_result<long long>() -
+                f_start.get_result<long long>());
+      runtime->detach_external_resource(ctx, pr).get_void_result();
+    }
+    printf("rep %d: write %8.1f MB/s  read %8.1f MB/s\n", rep,
+           bytes / t_write, bytes / t_read);
+  }
+
+  // check what came back from the file
+  {
+    InlineLauncher launcher(RegionRequirement(lr, READ_ONLY, EXCLUSIVE, lr)
+                            .add_field(FID_DST));
+    PhysicalRegion pr = runtime->map_region(ctx, launcher);
+    pr.wait_until_valid();
+    const FieldAccessor<READ_ONLY,double,1> acc(pr, FID_DST);
+    size_t errors = 0;
+    for (PointInRectIterator<1> pir(rect); pir(); pir++)
+      if (acc[*pir] != (double)(*pir)[0])
+        errors++;
+    runtime->unmap_region(ctx, pr);
+    if (errors > 0) {
+      printf("FAILED: %zu mismatched elements\n", errors);
+      assert(false);
+    }
+  }
+
+  runtime->destroy_logical_region(ctx, lr_file);
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, is);
+  unlink(file_name);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  return Runtime::start(argc, argv);
+}
@@ -0,0 +1,137 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of reading back the results of index launches of
+//  increasing size - every point task returns a value computed from its
+//  point, and the results of each launch are read once with a bulk
+//  FutureMap::get_all_results and once with a get_result per point
+// - the launch domain is 2-D (-w points wide) to check that bulk results
+//  come back in DomainPointIterator order
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  POINT_TASK_ID,
+};
+
+static long long point_value(const DomainPoint &point)
+{
+  return 1000003LL * point[1] + point[0];
+}
+
+long long point_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, Runtime *runtime)
+{
+  return point_value(task->index_point);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  int min_points = 1024;
+  int max_points = 65536;
+  int width = 64;
+  {
+    const InputArgs &command_args = Runtime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++) {
+      if (!strcmp(command_args.argv[i], "-min"))
+        min_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-max"))
+        max_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-w"))
+        width = atoi(command_args.argv[++i]);
+    }
+  }
+  assert(width > 0);
+  assert(min_points >= width);
+
+  printf("points: %d to %d  width: %d\n", min_points, max_points, width);
+  for (int num_points = min_points; num_points <= max_points; num_points *= 2) {
+    Rect<2> launch_bounds(Point<2>(0, 0),
+                          Point<2>(width - 1, num_points / width - 1));
+    IndexSpace launch_is = runtime->create_index_space(ctx, launch_bounds);
+    const size_t volume = launch_bounds.volume();
+
+    double t_bulk = 0, t_point = 0;
+    {
+      IndexTaskLauncher launcher(POINT_TASK_ID, launch_is,
+                                 TaskArgument(), ArgumentMap());
+      FutureMap fm = runtime->execute_index_space(ctx, launcher);
+      fm.wait_all_results(true/*silence warnings*/);
+      double t_start = Realm::Clock::current_time_in_microseconds();
+      std::vector<long long> results(volume);
+      fm.get_all_results_typed(&results.front(), true/*silence warnings*/);
+      t_bulk = Realm::Clock::current_time_in_microseconds() - t_start;
+      size_t index = 0;
+      for (Domain::DomainPointIterator itr(launch_bounds); itr; itr++, index++)
+        if (results[index] != point_value(itr.p)) {
+          printf("FAILED: bulk result %zd is %lld, expected %lld\n",
+                 index, results[index], point_value(itr.p));
+          assert(false);
+        }
+    }
+    {
+      IndexTaskLauncher launcher(POINT_TASK_ID, launch_is,
+                                 TaskArgument(), ArgumentMap());
+      FutureMap fm = runtime->execute_index_space(ctx, launcher);
+      fm.wait_all_results(true/*silence warnings*/);
+      double t_start = Realm::Clock::current_time_in_microseconds();
+      for (Domain::DomainPointIterator itr(launch_bounds); itr; itr++) {
+        const long long result =
+          fm.get_result<long long>(itr.p, true/*silence warnings*/);
+        if (result != point_value(itr.p)) {
+          printf("FAILED: result is %lld, expected %lld\n",
+                 result, point_value(itr.p));
+          assert(false);
+        }
+      }
+      t_point = Realm::Clock::current_time_in_microseconds() - t_start;
+    }
+    printf("%8zd points: get_all_results %9.3f ms  get_result %9.3f ms\n",
+           volume, t_bulk * 1e-3, t_point * 1e-3);
+    runtime->destroy_index_space(ctx, launch_is);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  {
+    TaskVariantRegistrar registrar(POINT_TASK_ID, "point");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<long long, point_task>(registrar,
+                                                            "point");
+  }
+
+  return Runtime::start(argc, argv);
+}
@@ -0,0 +1,120 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the latency of reduction futures for index launches of
+//  increasing size - every point task returns its point, and the time
+//  from launching the index space until the reduced future is ready is
+//  reported for each launch size from -min up to -max points (doubling)
+// - pass -det to request deterministic reductions instead, which buffer
+//  every point's value until the whole launch is done
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  POINT_TASK_ID,
+};
+
+long long point_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, Runtime *runtime)
+{
+  return task->index_point[0];
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  int min_points = 1024;
+  int max_points = 131072;
+  int num_iterations = 5;
+  bool deterministic = false;
+  {
+    const InputArgs &command_args = Runtime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++) {
+      if (!strcmp(command_args.argv[i], "-min"))
+        min_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-max"))
+        max_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-i"))
+        num_iterations = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-det"))
+        deterministic = true;
+    }
+  }
+  assert(min_points > 0);
+  assert(num_iterations > 0);
+
+  printf("points: %d to %d  iterations: %d  deterministic: %s\n",
+         min_points, max_points, num_iterations,
+         deterministic ? "yes" : "no");
+  for (int num_points = min_points; num_points <= max_points; num_points *= 2) {
+    Rect<1> launch_bounds(0, num_points - 1);
+    IndexSpace launch_is = runtime->create_index_space(ctx, launch_bounds);
+    const long long expected = (long long)num_points * (num_points - 1) / 2;
+    double best = 0, total = 0;
+    for (int iteration = 0; iteration < num_iterations; iteration++) {
+      double t_start = Realm::Clock::current_time_in_microseconds();
+      IndexTaskLauncher launcher(POINT_TASK_ID, launch_is,
+                                 TaskArgument(), ArgumentMap());
+      Future f = runtime->execute_index_space(ctx, launcher,
+                                              LEGION_REDOP_SUM_INT64,
+                                              deterministic);
+      const long long sum = f.get_result<long long>();
+      double t_stop = Realm::Clock::current_time_in_microseconds();
+      if (sum != expected) {
+        printf("FAILED: %d points reduced to %lld, expected %lld\n",
+               num_points, sum, expected);
+        assert(false);
+      }
+      const double elapsed = t_stop - t_start;
+      if ((iteration == 0) || (elapsed < best))
+        best = elapsed;
+      total += elapsed;
+    }
+    printf("%8d points: best %9.3f ms  average %9.3f ms  (%6.2f us per point)\n",
+           num_points, best * 1e-3, total * 1e-3 / num_iterations,
+           best / num_points);
+    runtime->destroy_index_space(ctx, launch_is);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  {
+    TaskVariantRegistrar registrar(POINT_TASK_ID, "point");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<long long, point_task>(registrar,
+                                                            "point");
+  }
+
+  return Runtime::start(argc, argv);
+}
@@ -0,0 +1,201 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of physical analysis for index launches with many
+//  points that all use the same physical instance - on a single node the
+//  default mapper maps every point onto one instance of the root region,
+//  so each point task registers another user with that instance's views
+// - with -w each iteration starts with a task that holds the whole region
+//  for that many milliseconds, so all of the point tasks are mapped (and
+//  their users stay live on the instance) before any of them can run
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "legion.h"
+
+using namespace Legion;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  HOLD_TASK_ID,
+  WRITE_TASK_ID,
+  READ_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VAL,
+};
+
+void hold_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, Runtime *runtime)
+{
+  const int hold_ms = *(const int*)task->args;
+  usleep(hold_ms * 1000);
+}
+
+void write_task(const Task *task,
+                const std::vector<PhysicalRegion> &regions,
+                Context ctx, Runtime *runtime)
+{
+  const int iteration = *(const int*)task->args;
+  const FieldAccessor<READ_WRITE,int,1> acc(regions[0], FID_VAL);
+  Rect<1> rect = runtime->get_index_space_domain(ctx,
+                  task->regions[0].region.get_index_space());
+  for (PointInRectIterator<1> pir(rect); pir(); pir++)
+    acc[*pir] = acc[*pir] + iteration;
+}
+
+int read_task(const Task *task,
+              const std::vector<PhysicalRegion> &regions,
+              Context ctx, Runtime *runtime)
+{
+  const FieldAccessor<READ_ONLY,int,1> acc(regions[0], FID_VAL);
+  Rect<1> rect = runtime->get_index_space_domain(ctx,
+                  task->regions[0].region.get_index_space());
+  int sum = 0;
+  for (PointInRectIterator<1> pir(rect); pir(); pir++)
+    sum += acc[*pir];
+  return sum;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  int num_points = 10000;
+  int num_elements = 1;
+  int num_iterations = 5;
+  int hold_ms = 0;
+  {
+    const InputArgs &command_args = Runtime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++) {
+      if (!strcmp(command_args.argv[i], "-p"))
+        num_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-e"))
+        num_elements = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-i"))
+        num_iterations = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i], "-w"))
+        hold_ms = atoi(command_args.argv[++i]);
+    }
+  }
+  assert(num_points > 0);
+  assert(num_elements > 0);
+
+  Rect<1> rect(0, num_points * num_elements - 1);
+  IndexSpace is = runtime->create_index_space(ctx, rect);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int), FID_VAL);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  runtime->fill_field(ctx, lr, lr, FID_VAL, 0);
+
+  Rect<1> launch_bounds(0, num_points - 1);
+  IndexSpace color_is = runtime->create_index_space(ctx, launch_bounds);
+  IndexPartition ip = runtime->create_equal_partition(ctx, is, color_is);
+  LogicalPartition lp = runtime->get_logical_partition(ctx, lr, ip);
+
+  printf("points: %d  elements per point: %d  iterations: %d  hold: %d ms\n",
+         num_points, num_elements, num_iterations, hold_ms);
+  // the first iteration also includes creating the instance
+  for (int iteration = 1; iteration <= num_iterations; iteration++) {
+    double t_start = Realm::Clock::current_time_in_microseconds();
+    if (hold_ms > 0) {
+      TaskLauncher launcher(HOLD_TASK_ID,
+                            TaskArgument(&hold_ms, sizeof(hold_ms)));
+      launcher.add_region_requirement(
+          RegionRequirement(lr, READ_WRITE, EXCLUSIVE, lr).add_field(FID_VAL));
+      runtime->execute_task(ctx, launcher);
+    }
+    {
+      IndexTaskLauncher launcher(WRITE_TASK_ID, launch_bounds,
+                                 TaskArgument(&iteration, sizeof(iteration)),
+                                 ArgumentMap());
+      launcher.add_region_requirement(
+          RegionRequirement(lp, 0/*projection ID*/, READ_WRITE, EXCLUSIVE, lr)
+            .add_field(FID_VAL));
+      runtime->execute_index_space(ctx, launcher);
+    }
+    FutureMap fm;
+    {
+      IndexTaskLauncher launcher(READ_TASK_ID, launch_bounds,
+                                 TaskArgument(), ArgumentMap());
+      launcher.add_region_requirement(
+          RegionRequirement(lp, 0/*projection ID*/, READ_ONLY, EXCLUSIVE, lr)
+            .add_field(FID_VAL));
+      fm = runtime->execute_index_space(ctx, launcher);
+    }
+    fm.wait_all_results();
+    double t_stop = Realm::Clock::current_time_in_microseconds();
+    // every element has had 1 + 2 + ... + iteration added to it
+    const int expected = num_elements * iteration * (iteration + 1) / 2;
+    for (int p = 0; p < num_points; p++) {
+      const int sum = fm.get_result<int>(Point<1>(p));
+      if (sum != expected) {
+        printf("FAILED: point %d has %d, expected %d\n", p, sum, expected);
+        assert(false);
+      }
+    }
+    // don't charge the hold time to the point tasks
+    const double elapsed = (t_stop - t_start) - 1e3 * hold_ms;
+    printf("iteration %d: %8.3f ms  (%6.2f us per point task)\n", iteration,
+           elapsed * 1e-3, elapsed / (2 * num_points));
+  }
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_is);
+  runtime->destroy_index_space(ctx, is);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+
+  {
+    TaskVariantRegistrar registrar(HOLD_TASK_ID, "hold");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<hold_task>(registrar, "hold");
+  }
+
+  {
+    TaskVariantRegistrar registrar(WRITE_TASK_ID, "write");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<write_task>(registrar, "write");
+  }
+
+  {
+    TaskVariantRegistrar registrar(READ_TASK_ID, "read");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<int, read_task>(registrar, "read");
+  }
+
+  return Runtime::start(argc, argv);
+}
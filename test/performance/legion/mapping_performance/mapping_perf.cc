@@ -0,0 +1,275 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the latency of the mapper runtime instance lookup calls
+// (find_physical_instance and find_or_create_physical_instance) as
+// the number of live instances in a memory grows.
+
+#include "legion.h"
+#include "default_mapper.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Legion;
+using namespace Legion::Mapping;
+
+enum
+{
+  TOP_LEVEL_TASK_ID,
+  INIT_TASK_ID,
+  PROBE_TASK_ID,
+};
+
+enum
+{
+  FID_VAL = 100,
+};
+
+struct PerfConfig {
+  unsigned num_instances;
+  unsigned num_steps;
+  unsigned num_lookups;
+  unsigned region_size;
+  bool same_tree;
+};
+
+static void parse_arguments(char **argv, int argc, PerfConfig &config)
+{
+  config.num_instances = 1024;
+  config.num_steps = 8;
+  config.num_lookups = 1000;
+  config.region_size = 16;
+  config.same_tree = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-n") == 0) config.num_instances = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-steps") == 0) config.num_steps = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-l") == 0) config.num_lookups = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-size") == 0) config.region_size = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-t") == 0) config.same_tree = true;
+  }
+  if (config.num_steps == 0)
+    config.num_steps = 1;
+}
+
+//------------------------------------------------------------------------------
+// Mapper
+//------------------------------------------------------------------------------
+
+class MappingPerfMapper : public DefaultMapper
+{
+  public:
+    MappingPerfMapper(MapperRuntime *rt, Machine machine, Processor local,
+                      const char *mapper_name);
+  public:
+    virtual void map_task(const MapperContext  ctx,
+                          const Task&          task,
+                          const MapTaskInput&  input,
+                                MapTaskOutput& output);
+  private:
+    unsigned num_lookups;
+};
+
+MappingPerfMapper::MappingPerfMapper(MapperRuntime *rt, Machine machine,
+                                     Processor local, const char *mapper_name)
+  : DefaultMapper(rt, machine, local, mapper_name)
+{
+  PerfConfig config;
+  const InputArgs &command_args = Runtime::get_input_args();
+  parse_arguments(command_args.argv, command_args.argc, config);
+  num_lookups = config.num_lookups;
+}
+
+void MappingPerfMapper::map_task(const MapperContext  ctx,
+                                 const Task&          task,
+                                 const MapTaskInput&  input,
+                                       MapTaskOutput& output)
+{
+  if (task.task_id == PROBE_TASK_ID)
+  {
+    const RegionRequirement &req = task.regions[0];
+    Memory target_memory = Machine::MemoryQuery(machine)
+      .has_affinity_to(task.target_proc)
+      .only_kind(Memory::SYSTEM_MEM).first();
+    std::vector<FieldID> fields(req.instance_fields.begin(),
+                                req.instance_fields.end());
+    LayoutConstraintSet constraints;
+    constraints.add_constraint(MemoryConstraint(target_memory.kind()))
+      .add_constraint(FieldConstraint(fields, false, false));
+    std::vector<LogicalRegion> regions(1, req.region);
+    const unsigned num_instances = *(const unsigned*)task.args;
+
+    // Time lookups that succeed against the instance made by the init task
+    unsigned hits = 0;
+    long long start = Realm::Clock::current_time_in_microseconds();
+    for (unsigned idx = 0; idx < num_lookups; idx++)
+    {
+      PhysicalInstance result;
+      if (runtime->find_physical_instance(ctx, target_memory, constraints,
+                                    regions, result, false/*acquire*/))
+        hits++;
+    }
+    long long stop = Realm::Clock::current_time_in_microseconds();
+    const double find_latency = double(stop - start) / num_lookups;
+
+    // Time lookups that have to consider every candidate and then fail
+    LayoutConstraintSet missing = constraints;
+    std::vector<FieldID> missing_fields(1, FID_VAL + 1);
+    missing.field_constraint = FieldConstraint(missing_fields, false, false);
+    start = Realm::Clock::current_time_in_microseconds();
+    for (unsigned idx = 0; idx < num_lookups; idx++)
+    {
+      PhysicalInstance result;
+      runtime->find_physical_instance(ctx, target_memory, missing,
+                                regions, result, false/*acquire*/);
+    }
+    stop = Realm::Clock::current_time_in_microseconds();
+    const double miss_latency = double(stop - start) / num_lookups;
+
+    printf("instances: %8u  find hit: %8.3f us  find miss: %8.3f us  "
+           "(hits %u/%u)\n", num_instances, find_latency, miss_latency,
+           hits, num_lookups);
+  }
+  DefaultMapper::map_task(ctx, task, input, output);
+}
+
+static void register_mappers(Machine machine, Runtime *runtime,
+                             const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+  {
+    MappingPerfMapper *mapper = new MappingPerfMapper(
+        runtime->get_mapper_runtime(), machine, *it, "mapping_perf_mapper");
+    runtime->replace_default_mapper(mapper, *it);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Tasks
+//------------------------------------------------------------------------------
+
+void init_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, Runtime *runtime)
+{
+}
+
+void probe_task(const Task *task,
+                const std::vector<PhysicalRegion> &regions,
+                Context ctx, Runtime *runtime)
+{
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  PerfConfig config;
+  const InputArgs &command_args = Runtime::get_input_args();
+  parse_arguments(command_args.argv, command_args.argc, config);
+
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(double), FID_VAL);
+    allocator.allocate_field(sizeof(double), FID_VAL + 1);
+  }
+
+  // Either every instance lives in its own region tree or they are
+  // all made for disjoint subregions of a single region tree
+  std::vector<LogicalRegion> subregions, parents;
+  if (config.same_tree)
+  {
+    IndexSpace big_is = runtime->create_index_space(ctx,
+        Rect<1>(0, config.num_instances * config.region_size - 1));
+    IndexSpace color_is = runtime->create_index_space(ctx,
+        Rect<1>(0, config.num_instances - 1));
+    IndexPartition ip = runtime->create_equal_partition(ctx, big_is, color_is);
+    LogicalRegion root = runtime->create_logical_region(ctx, big_is, fs);
+    LogicalPartition lp = runtime->get_logical_partition(ctx, root, ip);
+    for (unsigned idx = 0; idx < config.num_instances; idx++)
+    {
+      const DomainPoint color = Point<1>(idx);
+      subregions.push_back(
+          runtime->get_logical_subregion_by_color(ctx, lp, color));
+      parents.push_back(root);
+    }
+  }
+  else
+  {
+    IndexSpace is = runtime->create_index_space(ctx,
+        Rect<1>(0, config.region_size - 1));
+    for (unsigned idx = 0; idx < config.num_instances; idx++)
+    {
+      subregions.push_back(runtime->create_logical_region(ctx, is, fs));
+      parents.push_back(subregions.back());
+    }
+  }
+
+  const unsigned step = (config.num_instances + config.num_steps - 1) /
+                          config.num_steps;
+  unsigned created = 0;
+  while (created < config.num_instances)
+  {
+    const unsigned stop = std::min(created + step, config.num_instances);
+    // Make an instance for each of the new regions
+    for ( ; created < stop; created++)
+    {
+      TaskLauncher launcher(INIT_TASK_ID, TaskArgument());
+      launcher.add_region_requirement(
+          RegionRequirement(subregions[created], WRITE_DISCARD, EXCLUSIVE,
+                            parents[created]));
+      launcher.add_field(0/*idx*/, FID_VAL);
+      runtime->execute_task(ctx, launcher);
+    }
+    // Then probe the most recently created instance
+    TaskLauncher launcher(PROBE_TASK_ID, TaskArgument(&created,
+                                                      sizeof(created)));
+    launcher.add_region_requirement(
+        RegionRequirement(subregions[created - 1], READ_ONLY, EXCLUSIVE,
+                          parents[created - 1]));
+    launcher.add_field(0/*idx*/, FID_VAL);
+    runtime->execute_task(ctx, launcher).get_void_result();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+  {
+    TaskVariantRegistrar registrar(INIT_TASK_ID, "init");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<init_task>(registrar, "init");
+  }
+  {
+    TaskVariantRegistrar registrar(PROBE_TASK_ID, "probe");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<probe_task>(registrar, "probe");
+  }
+  Runtime::add_registration_callback(register_mappers);
+
+  return Runtime::start(argc, argv);
+}
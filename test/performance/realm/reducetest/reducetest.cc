@@ -19,10 +19,13 @@
 #include <cassert>
 #include <cstring>
 #include <set>
+#include <map>
 #include <time.h>
 
 #include <realm.h>
 #include <legion/accessor.h>
+#include <legion/legion_config.h>
+#include <legion/legion_redop.h>
 
 using namespace Realm;
 using namespace LegionRuntime::Accessor;
@@ -37,11 +40,19 @@ enum {
   HIST_BATCH_REDFOLD_TASK  = Processor::TASK_ID_FIRST_AVAILABLE+3, 
   HIST_BATCH_REDLIST_TASK  = Processor::TASK_ID_FIRST_AVAILABLE+4,
   HIST_BATCH_REDSINGLE_TASK  = Processor::TASK_ID_FIRST_AVAILABLE+5,
+  HIST_BATCH_REDFOLD_BUILTIN_TASK  = Processor::TASK_ID_FIRST_AVAILABLE+6,
 };
 
 // reduction op IDs
 enum {
   REDOP_BUCKET_ADD = 1,
+  REDOP_BUCKET_ADD_BUILTIN = 2,
+};
+
+// fields of a reduction list instance
+enum {
+  LIST_FID_PTR = 0,
+  LIST_FID_VALUE = 1,
 };
 
 Logger log_app("appl");
@@ -102,6 +113,16 @@ struct InputArgs {
 
 typedef unsigned BucketType;
 typedef ReductionAdd<BucketType, int> BucketReduction;
+// the same reduction using Legion's built-in operator (and its bulk kernels)
+typedef Legion::SumReduction<uint32_t> BuiltinBucketReduction;
+
+template <class REDOP> struct RedopID;
+template <> struct RedopID<BucketReduction> {
+  static const ReductionOpID id = REDOP_BUCKET_ADD;
+};
+template <> struct RedopID<BuiltinBucketReduction> {
+  static const ReductionOpID id = REDOP_BUCKET_ADD_BUILTIN;
+};
 
 template <class T>
 struct HistBatchArgs {
@@ -163,16 +184,62 @@ static Memory farthest_memory(Processor p)
   return m;
 }
 
+static unsigned myrand(unsigned long long ival,
+		       unsigned seed1, unsigned seed2);
+
+// reads the whole histogram back through a copy into an instance in the
+//  given (local) memory
+static void read_histogram(const HistBatchArgs<BucketType>& hbargs, Memory m,
+			   std::vector<BucketType>& hist)
+{
+  RegionInstance tmpinst;
+  RegionInstance::create_instance(tmpinst, m, hbargs.region,
+				  std::vector<size_t>(1, sizeof(BucketType)),
+				  0, // SOA
+				  ProfilingRequestSet()).wait();
+  assert(tmpinst.exists());
+
+  std::vector<CopySrcDstField> src(1);
+  src[0].set_field(hbargs.inst, 0, sizeof(BucketType));
+  std::vector<CopySrcDstField> dst(1);
+  dst[0].set_field(tmpinst, 0, sizeof(BucketType));
+  hbargs.region.copy(src, dst, ProfilingRequestSet()).wait();
+
+  AffineAccessor<BucketType, 1, coord_t> acc(tmpinst, 0);
+  hist.resize(hbargs.buckets);
+  for(unsigned i = 0; i < hbargs.buckets; i++)
+    hist[i] = acc[i];
+
+  tmpinst.destroy();
+}
+
+static bool compare_histograms(const char *name, const char *ref_name,
+			       const std::vector<BucketType>& hist,
+			       const std::vector<BucketType>& ref)
+{
+  size_t mismatches = 0;
+  for(size_t i = 0; i < ref.size(); i++)
+    if(hist[i] != ref[i]) {
+      if(mismatches++ < 10)
+	log_app.error() << name << " bucket " << i << " = " << hist[i]
+			<< ", " << ref_name << " = " << ref[i];
+    }
+  if(mismatches > 0)
+    log_app.error() << name << ": " << mismatches << " buckets differ from "
+		    << ref_name;
+  return (mismatches == 0);
+}
+
 static void run_case(const char *name, int task_id,
 		     HistBatchArgs<BucketType>& hbargs, int num_batches,
 		     bool use_lock)
 {
   // clear histogram
-  if(0) {
-    RegionAccessor<AccessorType::Generic,BucketType> ria = hbargs.inst.get_accessor().typeify<BucketType>();
-
-    for(unsigned i = 0; i < hbargs.buckets; i++)
-      ria.write(ptr_t(i), 0);
+  {
+    std::vector<CopySrcDstField> fld(1);
+    fld[0].set_field(hbargs.inst, 0, sizeof(BucketType));
+    const BucketType zero = 0;
+    hbargs.region.fill(fld, ProfilingRequestSet(), &zero, sizeof(zero)).wait();
   }
 
   log_app.info("starting %s histogramming...\n", name);
@@ -275,14 +342,46 @@ void top_level_task(const void *args, size_t arglen,
   hbargs.seed1 = seed1;
   hbargs.seed2 = seed2;
 
-  if(do_slow)
+  // every variant has to produce the histogram a sequential count does
+  std::vector<BucketType> expected(buckets, 0);
+  for(unsigned long long i = 0;
+      i < (unsigned long long)num_batches * batch_size;
+      i++)
+    expected[myrand(i, seed1, seed2) % buckets]++;
+
+  Memory check_mem = closest_memory(p);
+  std::vector<BucketType> hist, redfold_hist;
+  bool ok = true;
+
+  if(do_slow) {
     run_case("original", HIST_BATCH_TASK, hbargs, num_batches, true);
+    read_histogram(hbargs, check_mem, hist);
+    ok &= compare_histograms("original", "expected", hist, expected);
+  }
   run_case("redfold", HIST_BATCH_REDFOLD_TASK, hbargs, num_batches, false);
+  read_histogram(hbargs, check_mem, redfold_hist);
+  ok &= compare_histograms("redfold", "expected", redfold_hist, expected);
+  run_case("redfold_builtin", HIST_BATCH_REDFOLD_BUILTIN_TASK, hbargs,
+	   num_batches, false);
+  read_histogram(hbargs, check_mem, hist);
+  ok &= compare_histograms("redfold_builtin", "expected", hist, expected);
   run_case("localize", HIST_BATCH_LOCALIZE_TASK, hbargs, num_batches, true);
+  read_histogram(hbargs, check_mem, hist);
+  ok &= compare_histograms("localize", "expected", hist, expected);
+  // the list path (including remote lists when batches run on other nodes)
+  //  must agree with the fold path bucket for bucket
   run_case("redlist", HIST_BATCH_REDLIST_TASK, hbargs, num_batches, false);
+  read_histogram(hbargs, check_mem, hist);
+  ok &= compare_histograms("redlist", "redfold", hist, redfold_hist);
   if(do_slow)
     run_case("redsingle", HIST_BATCH_REDSINGLE_TASK, hbargs, num_batches, false);
 
+  if(!ok) {
+    log_app.error() << "histograms do not match";
+    exit(1);
+  }
+  printf("all histograms match\n");
+
 #if 0
   {
     RegionInstanceAccessor<BucketType,AccessorGeneric> ria = hist_inst.get_accessor();
@@ -422,7 +521,7 @@ void hist_batch_redfold_task(const void *args, size_t arglen,
   Memory m = closest_memory(p);
   RegionInstance redinst = RegionInstance::NO_INST;
   RegionInstance::create_instance(redinst, m, hbargs->region,
-				  typename std::vector<size_t>(1, sizeof(BucketReduction::RHS)),
+				  typename std::vector<size_t>(1, sizeof(typename REDOP::RHS)),
 				  0, // SOA
 				  ProfilingRequestSet()).wait();
   assert(redinst.exists());
@@ -431,10 +530,11 @@ void hist_batch_redfold_task(const void *args, size_t arglen,
   std::vector<CopySrcDstField> fld(1);
   fld[0].inst = redinst;
   fld[0].field_id = 0;
-  fld[0].size = sizeof(BucketReduction::RHS);
+  fld[0].size = sizeof(typename REDOP::RHS);
+  const typename REDOP::RHS identity = REDOP::identity;
   hbargs->region.fill(fld,
 		      ProfilingRequestSet(),
-		      &BucketReduction::identity, fld[0].size).wait();
+		      &identity, fld[0].size).wait();
 
   // get a reduction accessor for the instance
   RegionAccessor<AccessorType::ReductionFold<REDOP>, BucketType> ria = redinst.get_accessor().typeify<BucketType>().convert<AccessorType::ReductionFold<REDOP> >();
@@ -450,7 +550,7 @@ void hist_batch_redfold_task(const void *args, size_t arglen,
   std::vector<CopySrcDstField> src(1);
   src[0].inst = redinst;
   src[0].field_id = 0;
-  src[0].size = sizeof(BucketReduction::RHS);
+  src[0].size = sizeof(typename REDOP::RHS);
   std::vector<CopySrcDstField> dst(1);
   dst[0].inst = hbargs->inst;
   dst[0].field_id = 0;
@@ -458,7 +558,7 @@ void hist_batch_redfold_task(const void *args, size_t arglen,
   Event done = hbargs->region.copy(src, dst, 
 				   ProfilingRequestSet(),
 				   Event::NO_EVENT,
-				   REDOP_BUCKET_ADD, false /*!fold*/);
+				   RedopID<REDOP>::id, false /*!fold*/);
 
   redinst.destroy(done);
 
@@ -469,31 +569,56 @@ template <class REDOP>
 void hist_batch_redlist_task(const void *args, size_t arglen, 
                              const void *userdata, size_t userlen, Processor p)
 {
-#if 0
   const HistBatchArgs<BucketType> *hbargs = (const HistBatchArgs<BucketType> *)args;
 
-  // create a reduction list instance
+  // create a reduction list instance - one (bucket, value) entry per
+  //  element of the batch
   Memory m = closest_memory(p);
-  RegionInstance<BucketType> redinst = RegionInstance::NO_INST;
-  while (!redinst.exists())
-    redinst = hbargs->region.create_instance(m, REDOP_BUCKET_ADD, hbargs->count, hbargs->inst);
-  assert(redinst.exists());
+  IndexSpace<1, coord_t> list_space = Rect<1, coord_t>(0, hbargs->count - 1);
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[LIST_FID_PTR] = sizeof(Point<1, coord_t>);
+  field_sizes[LIST_FID_VALUE] = sizeof(typename REDOP::RHS);
+  RegionInstance listinst = RegionInstance::NO_INST;
+  RegionInstance::create_instance(listinst, m, list_space,
+				  field_sizes,
+				  0, // SOA
+				  ProfilingRequestSet()).wait();
+  assert(listinst.exists());
 
-  // get a reduction accessor for the instance
-  RegionInstanceAccessor<BucketType,AccessorReductionList> ria = redinst.get_accessor().convert<AccessorReductionList>();
+  {
+    AffineAccessor<Point<1, coord_t>, 1, coord_t> ptrs(listinst, LIST_FID_PTR);
+    AffineAccessor<typename REDOP::RHS, 1, coord_t> vals(listinst, LIST_FID_VALUE);
 
-  for(unsigned i = 0; i < hbargs->count; i++) {
-    unsigned rval = myrand(hbargs->start + i, hbargs->seed1, hbargs->seed2);
-    unsigned bucket = rval % hbargs->buckets;
+    for(unsigned i = 0; i < hbargs->count; i++) {
+      unsigned rval = myrand(hbargs->start + i, hbargs->seed1, hbargs->seed2);
+      unsigned bucket = rval % hbargs->buckets;
 
-    ria.reduce<REDOP>(ptr_t<BucketType>(bucket), 1);
+      ptrs[i] = Point<1, coord_t>(bucket);
+      vals[i] = 1;
+    }
   }
 
-  // now copy the reduction instance back to the original one
-  redinst.copy_to(hbargs->inst).wait();
+  // now scatter-reduce the list into the original instance
+  typename CopyIndirection<1, coord_t>::template Unstructured<1, coord_t> indirect;
+  indirect.field_id = LIST_FID_PTR;
+  indirect.inst = listinst;
+  indirect.is_ranges = false;
+  indirect.subfield_offset = 0;
+  indirect.spaces.push_back(hbargs->region);
+  indirect.insts.push_back(hbargs->inst);
 
-  hbargs->region.destroy_instance(redinst);
-#endif
+  std::vector<CopySrcDstField> src(1);
+  src[0].set_field(listinst, LIST_FID_VALUE, sizeof(typename REDOP::RHS));
+  std::vector<CopySrcDstField> dst(1);
+  dst[0].set_indirect(0, 0, sizeof(typename REDOP::RHS))
+    .set_redop(RedopID<REDOP>::id, false /*!fold*/);
+  std::vector<const typename CopyIndirection<1, coord_t>::Base *> indirects(1, &indirect);
+  Event done = list_space.copy(src, dst, indirects,
+			       ProfilingRequestSet());
+
+  listinst.destroy(done);
+
+  done.wait();
 }
   
 template <class REDOP>
@@ -540,7 +665,9 @@ int main(int argc, char **argv)
   r.register_task(HIST_BATCH_REDFOLD_TASK, hist_batch_redfold_task<BucketReduction>);
   r.register_task(HIST_BATCH_REDLIST_TASK, hist_batch_redlist_task<BucketReduction>);
   r.register_task(HIST_BATCH_REDSINGLE_TASK, hist_batch_redsingle_task<BucketReduction>);
+  r.register_task(HIST_BATCH_REDFOLD_BUILTIN_TASK, hist_batch_redfold_task<BuiltinBucketReduction>);
   r.register_reduction(REDOP_BUCKET_ADD, ReductionOpUntyped::create_reduction_op<BucketReduction>());
+  r.register_reduction(REDOP_BUCKET_ADD_BUILTIN, ReductionOpUntyped::create_reduction_op<BuiltinBucketReduction>());
 
   // Set the input args
   get_input_args().argv = argv;
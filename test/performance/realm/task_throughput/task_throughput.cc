@@ -36,6 +36,7 @@ namespace TestConfig {
   bool skip_launch_procs = false;
   bool use_posttriger_barrier = false;
   bool group_procs = false;
+  bool work_stealing = false;  // only used to label the summary
 };
 
 // TASK IDs
@@ -251,6 +252,7 @@ void top_level_task(const void *args, size_t arglen,
   std::map<AddressSpace, std::vector<Processor> > all_procs;
   std::map<AddressSpace, std::vector<Processor> > loc_procs;
   int total_procs = 0;
+  int total_cpus = 0;
   {
     std::set<Event> events;
     Machine::ProcessorQuery pq(Machine::get_machine());
@@ -258,8 +260,10 @@ void top_level_task(const void *args, size_t arglen,
       Processor p = *it;
       AddressSpace a = p.address_space();
       all_procs[a].push_back(p);
-      if(p.kind() == Processor::LOC_PROC)
+      if(p.kind() == Processor::LOC_PROC) {
 	loc_procs[a].push_back(p);
+	total_cpus++;
+      }
       total_procs++;
 
       Memory m = Machine::MemoryQuery(Machine::get_machine())
@@ -321,22 +325,42 @@ void top_level_task(const void *args, size_t arglen,
   }    
 
   // spawn launcher tasks in each address space
+  double t_start = Clock::current_time();
+  long long total_tasks = 0;
   for(std::map<AddressSpace, std::vector<Processor> >::const_iterator it = all_procs.begin();
       it != all_procs.end();
       ++it) {
     const std::vector<Processor>& lp = loc_procs[it->first];
     assert(lp.size() >= (size_t)(TestConfig::launching_processors));
+
+    // each launcher targets the same set of processors (see task_launcher)
+    int targets = (TestConfig::remote_tasks ? total_procs : (int)(it->second.size()));
+    if(TestConfig::skip_launch_procs) targets--;
+    if(TestConfig::group_procs && (targets > 0)) targets = 1;
+
     for(int i = 0; i < TestConfig::launching_processors; i++) {
       Processor p = lp[i];
       
       // no need to grab the finish event - we wait indirectly via the barrier
       p.spawn(TASK_LAUNCHER, args_data, args_size);
+      total_tasks += (long long)targets * TestConfig::tasks_per_processor;
     }
   }
   free(args_data);
 
   // all done - wait for everything to finish via the finish_barrier
   launch_args.finish_barrier.wait();
+  double t_end = Clock::current_time();
+
+  // overall rate (including launch overhead), normalized by cpu count so
+  //  that runs with different -ll:cpu values (and schedulers) can be compared
+  double rate = total_tasks / (t_end - t_start);
+  log_app.print() << "total: scheduler=" << (TestConfig::work_stealing ? "steal" : "default")
+		  << " cpus=" << total_cpus
+		  << " tasks=" << total_tasks
+		  << " time=" << (t_end - t_start)
+		  << " rate=" << rate << " tasks/s"
+		  << " per_cpu=" << (rate / (total_cpus ? total_cpus : 1)) << " tasks/s";
 }
 
 int main(int argc, char **argv)
@@ -355,7 +379,8 @@ int main(int argc, char **argv)
     .add_option_bool("-noself", TestConfig::skip_launch_procs)
     .add_option_bool("-post", TestConfig::use_posttriger_barrier)
     .add_option_bool("-prof", TestConfig::with_profiling)
-    .add_option_bool("-group", TestConfig::group_procs);
+    .add_option_bool("-group", TestConfig::group_procs)
+    .add_option_bool("-ll:steal", TestConfig::work_stealing);
   ok = cp.parse_command_line(argc, (const char **)argv);
   assert(ok);
 
@@ -2106,6 +2106,147 @@ int RandomTest<N1,T1,N2,T2,FT>::check_partitioning(void)
   return 0;
 }
 
+// a random coloring of a 1-D space produces heavily fragmented by-field
+//  subspaces - this measures the memory used by their sparsity maps and the
+//  speed of iterating over them (1-D maps always keep their rect lists, as
+//  a bitmap would produce the same runs more slowly)
+class ColoringTest : public TestInterface {
+public:
+  int num_points, num_colors, num_reps;
+
+  IndexSpace<1> is_points;
+  RegionInstance ri_colors;
+  std::vector<FieldDataDescriptor<IndexSpace<1>, int> > fd_colors;
+  std::vector<IndexSpace<1> > ss_by_color;
+
+  enum PRNGStreams {
+    COLOR_STREAM,
+  };
+
+  ColoringTest(int argc, const char *argv[])
+    : num_points(1 << 20), num_colors(16), num_reps(10)
+  {
+#define INT_ARG(s, v) if(!strcmp(argv[i], s)) { v = atoi(argv[++i]); continue; }
+    for(int i = 1; i < argc; i++) {
+      INT_ARG("-p", num_points);
+      INT_ARG("-c", num_colors);
+      INT_ARG("-r", num_reps);
+    }
+#undef INT_ARG
+  }
+
+  int random_color(int idx)
+  {
+    return Philox_2x32<>::rand_int(random_seed, idx, COLOR_STREAM, num_colors);
+  }
+
+  virtual void print_info(void)
+  {
+    printf("Realm dependent partitioning test - coloring: %d points, %d colors\n",
+	   num_points, num_colors);
+  }
+
+  virtual Event initialize_data(const std::vector<Memory>& memories,
+				const std::vector<Processor>& procs)
+  {
+    is_points = Rect<1>(0, num_points - 1);
+
+    std::vector<size_t> field_sizes(1, sizeof(int));
+    RegionInstance::create_instance(ri_colors, memories[0], is_points,
+				    field_sizes, 0 /*SOA*/,
+				    ProfilingRequestSet()).wait();
+
+    AffineAccessor<int,1> a_color(ri_colors, 0);
+    for(int i = 0; i < num_points; i++)
+      a_color.write(Point<1>(i), random_color(i));
+
+    fd_colors.resize(1);
+    fd_colors[0].index_space = is_points;
+    fd_colors[0].inst = ri_colors;
+    fd_colors[0].field_offset = 0;
+
+    return Event::NO_EVENT;
+  }
+
+  virtual Event perform_partitioning(void)
+  {
+    std::vector<int> colors(num_colors);
+    for(int i = 0; i < num_colors; i++)
+      colors[i] = i;
+
+    return is_points.create_subspaces_by_field(fd_colors, colors, ss_by_color,
+					       ProfilingRequestSet());
+  }
+
+  virtual int perform_dynamic_checks(void)
+  {
+    // sparsity map storage
+    size_t total_entries = 0, total_bytes = 0;
+    for(int i = 0; i < num_colors; i++) {
+      if(!ss_by_color[i].sparsity.exists()) continue;
+      SparsityMapPublicImpl<1,int> *impl = ss_by_color[i].sparsity.impl();
+      const std::vector<SparsityMapEntry<1,int> >& entries = impl->get_entries();
+      total_entries += entries.size();
+      for(std::vector<SparsityMapEntry<1,int> >::const_iterator it = entries.begin();
+	  it != entries.end();
+	  it++)
+	total_bytes += (it->bitmap ?
+			  it->bitmap->bytes_used() :
+			  sizeof(SparsityMapEntry<1,int>));
+    }
+    log_app.print() << "sparsity storage: entries=" << total_entries
+		    << " bytes=" << total_bytes
+		    << " (" << (double(total_bytes) / num_points) << " bytes/point)";
+
+    // iteration speed
+    size_t total_points = 0;
+    long long t_start = Clock::current_time_in_nanoseconds();
+    for(int r = 0; r < num_reps; r++)
+      for(int i = 0; i < num_colors; i++)
+	for(IndexSpaceIterator<1> it(ss_by_color[i]); it.valid; it.step())
+	  total_points += it.rect.volume();
+    long long t_stop = Clock::current_time_in_nanoseconds();
+    log_app.print() << "iteration: reps=" << num_reps
+		    << " time=" << (1e-9 * (t_stop - t_start)) << " s"
+		    << " rate=" << (double(t_stop - t_start) / total_points) << " ns/point";
+
+    if(total_points != (size_t(num_reps) * num_points)) {
+      log_app.error() << "iteration covered " << total_points << " points, expected "
+		      << (size_t(num_reps) * num_points);
+      return 1;
+    }
+    return 0;
+  }
+
+  virtual int check_partitioning(void)
+  {
+    int errors = 0;
+
+    std::vector<size_t> counts(num_colors, 0);
+    for(int i = 0; i < num_points; i++) {
+      int c = random_color(i);
+      counts[c]++;
+      for(int j = 0; j < num_colors; j++)
+	if(ss_by_color[j].contains(Point<1>(i)) != (j == c)) {
+	  if(errors < 10)
+	    log_app.error() << "point " << i << " (color " << c << ") "
+			    << ((j == c) ? "missing from" : "present in")
+			    << " subspace " << j;
+	  errors++;
+	}
+    }
+
+    for(int j = 0; j < num_colors; j++)
+      if(ss_by_color[j].volume() != counts[j]) {
+	log_app.error() << "subspace " << j << " volume mismatch: "
+			<< ss_by_color[j].volume() << " != " << counts[j];
+	errors++;
+      }
+
+    return errors;
+  }
+};
+
 void top_level_task(const void *args, size_t arglen,
 		    const void *userdata, size_t userlen, Processor p)
 {
@@ -2233,6 +2374,11 @@ int main(int argc, char **argv)
       break;
     }
 
+    if(!strcmp(argv[i], "coloring")) {
+      testcfg = new ColoringTest(argc-i, const_cast<const char **>(argv+i));
+      break;
+    }
+
     if(!strcmp(argv[i], "random")) {
       testcfg = new RandomTest<1,int,2,int,int>(argc-i, const_cast<const char **>(argv+i));
       break;
@@ -0,0 +1,241 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// benchmark for image/preimage/by-field operations whose field data lives
+//  in a single large instance - run with -dp:workers N to let the
+//  partitioning engine split the instance across workers (-dp:chunk 0
+//  disables the split for comparison)
+//
+// the "mesh" is a set of cells, each of which points at a node in a parent
+//  space that is sparse (every other block of nodes), so every pointer must
+//  be tested against a parent with many rectangles
+int num_cells = 1 << 20;
+int num_nodes = 1 << 18;
+int block_size = 8;
+int num_pieces = 8;
+int num_iterations = 3;
+bool do_check = true;
+
+// sets 'value' for every point of 'is' in 'members'
+static void mark_members(IndexSpace<1> is, std::vector<unsigned char>& members,
+			 unsigned char value)
+{
+  for(IndexSpaceIterator<1> it(is); it.valid; it.step())
+    for(int i = it.rect.lo[0]; i <= it.rect.hi[0]; i++)
+      members[i] = value;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Memory m = Machine::MemoryQuery(Machine::get_machine())
+    .only_kind(Memory::SYSTEM_MEM)
+    .has_affinity_to(p)
+    .first();
+  assert(m.exists());
+
+  // sparse node space: keep every other block of nodes
+  std::vector<Rect<1> > node_rects;
+  for(int b = 0; b < num_nodes; b += 2 * block_size)
+    node_rects.push_back(Rect<1>(b, std::min(b + block_size, num_nodes) - 1));
+  IndexSpace<1> is_nodes(node_rects);
+  IndexSpace<1> is_cells(Rect<1>(0, num_cells - 1));
+
+  log_app.print() << "image benchmark: cells=" << num_cells
+		  << " nodes=" << num_nodes
+		  << " node_rects=" << node_rects.size()
+		  << " pieces=" << num_pieces;
+
+  // one instance holds the node pointer and the piece color of every cell
+  std::vector<size_t> field_sizes;
+  field_sizes.push_back(sizeof(Point<1>));
+  field_sizes.push_back(sizeof(int));
+  RegionInstance ri_cells;
+  RegionInstance::create_instance(ri_cells, m, is_cells, field_sizes,
+				  0 /*SOA*/,
+				  Realm::ProfilingRequestSet()).wait();
+
+  // pointers are random, so roughly half of them land outside the sparse
+  //  node space and must be filtered out
+  {
+    AffineAccessor<Point<1>,1> a_ptr(ri_cells, 0 /* offset */);
+    AffineAccessor<int,1> a_color(ri_cells, sizeof(Point<1>) /* offset */);
+    unsigned short seed[3] = { 1, 2, 3 };
+    for(int i = 0; i < num_cells; i++) {
+      a_ptr[i] = Point<1>(nrand48(seed) % num_nodes);
+      a_color[i] = nrand48(seed) % num_pieces;
+    }
+  }
+
+  std::vector<FieldDataDescriptor<IndexSpace<1>, Point<1> > > ptr_field_data(1);
+  ptr_field_data[0].index_space = is_cells;
+  ptr_field_data[0].inst = ri_cells;
+  ptr_field_data[0].field_offset = 0;
+  std::vector<FieldDataDescriptor<IndexSpace<1>, int> > color_field_data(1);
+  color_field_data[0].index_space = is_cells;
+  color_field_data[0].inst = ri_cells;
+  color_field_data[0].field_offset = sizeof(Point<1>);
+
+  std::vector<int> colors;
+  for(int i = 0; i < num_pieces; i++)
+    colors.push_back(i);
+
+  std::vector<IndexSpace<1> > ss_cells_eq, ss_cells_byfield, ss_cells_preimage;
+  std::vector<IndexSpace<1> > ss_nodes_eq, ss_nodes_image;
+  is_cells.create_equal_subspaces(num_pieces, 1, ss_cells_eq,
+				  Realm::ProfilingRequestSet()).wait();
+  is_nodes.create_equal_subspaces(num_pieces, 1, ss_nodes_eq,
+				  Realm::ProfilingRequestSet()).wait();
+
+  for(int iter = 0; iter < num_iterations; iter++) {
+    for(size_t i = 0; i < ss_cells_byfield.size(); i++) {
+      ss_cells_byfield[i].destroy();
+      ss_cells_preimage[i].destroy();
+      ss_nodes_image[i].destroy();
+    }
+    ss_cells_byfield.clear();
+    ss_cells_preimage.clear();
+    ss_nodes_image.clear();
+
+    long long t1 = Clock::current_time_in_nanoseconds();
+    is_cells.create_subspaces_by_field(color_field_data, colors,
+				       ss_cells_byfield,
+				       Realm::ProfilingRequestSet()).wait();
+    long long t2 = Clock::current_time_in_nanoseconds();
+    is_nodes.create_subspaces_by_image(ptr_field_data, ss_cells_eq,
+				       ss_nodes_image,
+				       Realm::ProfilingRequestSet()).wait();
+    long long t3 = Clock::current_time_in_nanoseconds();
+    is_cells.create_subspaces_by_preimage(ptr_field_data, ss_nodes_eq,
+					  ss_cells_preimage,
+					  Realm::ProfilingRequestSet()).wait();
+    long long t4 = Clock::current_time_in_nanoseconds();
+
+    log_app.print() << "iteration " << iter
+		    << ": by_field=" << (1e-6 * (t2 - t1)) << " ms"
+		    << " image=" << (1e-6 * (t3 - t2)) << " ms"
+		    << " preimage=" << (1e-6 * (t4 - t3)) << " ms";
+  }
+
+  if(do_check) {
+    AffineAccessor<Point<1>,1> a_ptr(ri_cells, 0 /* offset */);
+    AffineAccessor<int,1> a_color(ri_cells, sizeof(Point<1>) /* offset */);
+    // membership is gathered by iterating each subspace once, since a
+    //  contains() per point on a sparse space is far too slow at this size
+    std::vector<unsigned char> in_nodes(num_nodes, 0);
+    mark_members(is_nodes, in_nodes, 1);
+    std::vector<unsigned char> node_piece(num_nodes, 0);
+    std::vector<unsigned char> cell_field(num_cells, 0), cell_preimage(num_cells, 0);
+    for(int j = 0; j < num_pieces; j++) {
+      mark_members(ss_nodes_eq[j], node_piece, j);
+      mark_members(ss_cells_byfield[j], cell_field, j + 1);
+      mark_members(ss_cells_preimage[j], cell_preimage, j + 1);
+    }
+    size_t errors = 0;
+    std::vector<std::vector<unsigned char> > exp_image(num_pieces,
+						       std::vector<unsigned char>(num_nodes, 0));
+    for(int j = 0; j < num_pieces; j++)
+      for(IndexSpaceIterator<1> it(ss_cells_eq[j]); it.valid; it.step())
+	for(int i = it.rect.lo[0]; i <= it.rect.hi[0]; i++)
+	  if(in_nodes[a_ptr[i][0]])
+	    exp_image[j][a_ptr[i][0]] = 1;
+    for(int i = 0; i < num_cells; i++) {
+      int ptr = a_ptr[i][0];
+      int exp_preimage = in_nodes[ptr] ? (node_piece[ptr] + 1) : 0;
+      if((cell_field[i] != (a_color[i] + 1)) || (cell_preimage[i] != exp_preimage)) {
+	if(errors++ < 10)
+	  log_app.error() << "mismatch: cell=" << i << " color=" << a_color[i]
+			  << " ptr=" << ptr << " by_field=" << int(cell_field[i])
+			  << " preimage=" << int(cell_preimage[i]);
+      }
+    }
+    for(int j = 0; j < num_pieces; j++) {
+      std::vector<unsigned char> act_image(num_nodes, 0);
+      mark_members(ss_nodes_image[j], act_image, 1);
+      if(act_image != exp_image[j]) {
+	if(errors++ < 10)
+	  log_app.error() << "mismatch: image " << j << " = " << ss_nodes_image[j];
+      }
+    }
+    if(errors > 0) {
+      log_app.error() << errors << " errors";
+      exit(1);
+    }
+    log_app.print() << "check passed";
+  }
+
+  for(int i = 0; i < num_pieces; i++) {
+    ss_cells_byfield[i].destroy();
+    ss_cells_preimage[i].destroy();
+    ss_nodes_image[i].destroy();
+    ss_cells_eq[i].destroy();
+    ss_nodes_eq[i].destroy();
+  }
+  ri_cells.destroy();
+  is_nodes.destroy();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-c")) {
+      num_cells = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-n")) {
+      num_nodes = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-b")) {
+      block_size = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-p")) {
+      num_pieces = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-nocheck")) {
+      do_check = false;
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single task - everybody gets the same finish event
+  Event e = rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // request shutdown once that task is complete
+  rt.shutdown(e);
+
+  // now sleep this thread until that shutdown actually happens
+  rt.wait_for_shutdown();
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include "realm.h"
+#include "realm/id.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  ALLOC_RESULT_TASK,
+};
+
+// stress test for the memory allocator - fills a memory to a target
+//  occupancy with instances of random sizes and then repeatedly replaces
+//  a randomly chosen live instance with a new one of a different size,
+//  reporting the allocation rate and how many allocations failed due to
+//  fragmentation of the free space
+int num_iterations = 10000;
+double fill_fraction = 0.75;
+size_t min_elements = 64;
+size_t max_elements = 65536;
+unsigned random_seed = 12345;
+
+void alloc_result_task(const void *args, size_t arglen,
+		       const void *userdata, size_t userlen, Processor p)
+{
+  // nothing to do - failures are observed through the poisoned ready event
+}
+
+static size_t random_elements(void)
+{
+  // log-uniform distribution so there's a mix of small and large instances
+  double lo = log(double(min_elements));
+  double hi = log(double(max_elements));
+  double x = lo + (hi - lo) * drand48();
+  return size_t(exp(x));
+}
+
+static RegionInstance create_random_instance(Memory m, Processor p,
+					     size_t& bytes, bool& failed)
+{
+  size_t elements = random_elements();
+  Rect<1> bounds(0, elements - 1);
+  std::vector<size_t> field_sizes(1, 8);
+  bytes = elements * 8;
+
+  // ask for the allocation result so that failures are reported rather
+  //  than fatal
+  ProfilingRequestSet prs;
+  prs.add_request(p, ALLOC_RESULT_TASK)
+    .add_measurement<ProfilingMeasurements::InstanceAllocResult>();
+
+  RegionInstance inst;
+  Event e = RegionInstance::create_instance(inst, m, bounds, field_sizes,
+					    0 /*SOA*/, prs);
+  failed = false;
+  e.wait_faultaware(failed);
+  return inst;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Memory m = Machine::MemoryQuery(Machine::get_machine()).only_kind(Memory::SYSTEM_MEM).best_affinity_to(p).first();
+  assert(m.exists());
+  size_t capacity = m.capacity();
+
+  log_app.print() << "allocator churn: mem=" << m << " capacity=" << capacity
+		  << " fill=" << fill_fraction << " iterations=" << num_iterations
+		  << " sizes=[" << min_elements << "," << max_elements << "]";
+
+  srand48(random_seed);
+
+  std::vector<RegionInstance> live;
+  std::vector<size_t> live_bytes;
+  size_t total_bytes = 0;
+
+  // phase 1: fill up to the target occupancy
+  while(total_bytes < fill_fraction * capacity) {
+    size_t bytes;
+    bool failed;
+    RegionInstance inst = create_random_instance(m, p, bytes, failed);
+    if(failed) {
+      inst.destroy();
+      break;
+    }
+    live.push_back(inst);
+    live_bytes.push_back(bytes);
+    total_bytes += bytes;
+  }
+  log_app.print() << "initial fill: instances=" << live.size() << " bytes=" << total_bytes;
+
+  // phase 2: replace random instances
+  int failures = 0;
+  double t_start = Clock::current_time();
+  for(int i = 0; i < num_iterations; i++) {
+    if(!live.empty()) {
+      size_t idx = lrand48() % live.size();
+      live[idx].destroy();
+      total_bytes -= live_bytes[idx];
+      live[idx] = live.back();
+      live_bytes[idx] = live_bytes.back();
+      live.pop_back();
+      live_bytes.pop_back();
+    }
+
+    // keep allocating until we're back at the target occupancy
+    while(total_bytes < fill_fraction * capacity) {
+      size_t bytes;
+      bool failed;
+      RegionInstance inst = create_random_instance(m, p, bytes, failed);
+      if(failed) {
+	failures++;
+	inst.destroy();
+	break;
+      }
+      live.push_back(inst);
+      live_bytes.push_back(bytes);
+      total_bytes += bytes;
+    }
+  }
+  double t_end = Clock::current_time();
+
+  log_app.print() << "churn: " << num_iterations << " iterations in "
+		  << (t_end - t_start) << " s ("
+		  << (1e6 * (t_end - t_start) / num_iterations) << " us/iter), "
+		  << failures << " failed allocations, final instances=" << live.size()
+		  << " bytes=" << total_bytes;
+
+  for(size_t i = 0; i < live.size(); i++)
+    live[i].destroy();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-f")) {
+      fill_fraction = atof(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-min")) {
+      min_elements = strtoull(argv[++i], 0, 10);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-max")) {
+      max_elements = strtoull(argv[++i], 0, 10);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-seed")) {
+      random_seed = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(ALLOC_RESULT_TASK, alloc_result_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single task - everybody gets the same finish event
+  Event e = rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // request shutdown once that task is complete
+  rt.shutdown(e);
+
+  // now sleep this thread until that shutdown actually happens
+  rt.wait_for_shutdown();
+  
+  return 0;
+}
@@ -0,0 +1,213 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <set>
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// microbenchmark for the machine model queries that mappers issue on every
+//  mapping call - reports the average cost of each kind of query, walking
+//  every processor/memory pair in the machine
+int num_iterations = 1000;
+
+// the different ways of asking about processor/memory affinity must agree
+//  with each other (and with the full affinity list) before their
+//  timings mean anything
+static bool check_affinity_queries(Machine machine,
+				   const std::vector<Processor>& procs,
+				   const std::vector<Memory>& mems)
+{
+  size_t errors = 0;
+
+  std::vector<Machine::ProcessorMemoryAffinity> all_affinities;
+  machine.get_proc_mem_affinity(all_affinities, Processor::NO_PROC,
+				Memory::NO_MEMORY, false /*!local_only*/);
+
+  for(size_t j = 0; j < procs.size(); j++) {
+    std::set<Memory> visible;
+    machine.get_visible_memories(procs[j], visible);
+
+    for(size_t k = 0; k < mems.size(); k++) {
+      Machine::AffinityDetails details;
+      bool has = machine.has_affinity(procs[j], mems[k], &details);
+
+      std::vector<Machine::ProcessorMemoryAffinity> affinity;
+      int count = machine.get_proc_mem_affinity(affinity, procs[j], mems[k],
+						false /*!local_only*/);
+
+      const Machine::ProcessorMemoryAffinity *listed = 0;
+      for(size_t i = 0; i < all_affinities.size(); i++)
+	if((all_affinities[i].p == procs[j]) && (all_affinities[i].m == mems[k])) {
+	  listed = &all_affinities[i];
+	  break;
+	}
+
+      bool ok = ((count == (has ? 1 : 0)) &&
+		 (int(affinity.size()) == count) &&
+		 ((visible.count(mems[k]) != 0) == has) &&
+		 ((listed != 0) == has));
+      if(ok && has)
+	ok = ((affinity[0].bandwidth == details.bandwidth) &&
+	      (affinity[0].latency == details.latency) &&
+	      (listed->bandwidth == details.bandwidth) &&
+	      (listed->latency == details.latency));
+      if(!ok && (++errors < 10))
+	log_app.error() << "affinity mismatch: proc=" << procs[j]
+			<< " mem=" << mems[k] << " has_affinity=" << has
+			<< " get_proc_mem_affinity=" << count
+			<< " visible=" << visible.count(mems[k])
+			<< " listed=" << (listed != 0);
+    }
+  }
+
+  return (errors == 0);
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  Machine machine = Machine::get_machine();
+
+  std::vector<Processor> procs;
+  for(Machine::ProcessorQuery::iterator it = Machine::ProcessorQuery(machine).begin(); it; ++it)
+    procs.push_back(*it);
+  std::vector<Memory> mems;
+  for(Machine::MemoryQuery::iterator it = Machine::MemoryQuery(machine).begin(); it; ++it)
+    mems.push_back(*it);
+
+  if(!check_affinity_queries(machine, procs, mems)) {
+    log_app.error() << "machine affinity queries disagree";
+    exit(1);
+  }
+
+  log_app.print() << "machine query benchmark: procs=" << procs.size()
+		  << " mems=" << mems.size() << " iterations=" << num_iterations;
+
+  // has_affinity on every proc/mem pair
+  {
+    size_t queries = 0, hits = 0;
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_iterations; i++)
+      for(size_t j = 0; j < procs.size(); j++)
+	for(size_t k = 0; k < mems.size(); k++) {
+	  Machine::AffinityDetails details;
+	  if(machine.has_affinity(procs[j], mems[k], &details))
+	    hits++;
+	  queries++;
+	}
+    long long t2 = Clock::current_time_in_nanoseconds();
+    log_app.print() << "has_affinity: " << (double(t2 - t1) / queries)
+		    << " ns/query (" << hits << "/" << queries << " hits)";
+  }
+
+  // get_proc_mem_affinity restricted to a single pair, as the default
+  //  mapper does when picking a target memory
+  {
+    size_t queries = 0, hits = 0;
+    std::vector<Machine::ProcessorMemoryAffinity> affinity;
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_iterations; i++)
+      for(size_t j = 0; j < procs.size(); j++)
+	for(size_t k = 0; k < mems.size(); k++) {
+	  affinity.clear();
+	  hits += machine.get_proc_mem_affinity(affinity, procs[j], mems[k],
+						false /*!local_only*/);
+	  queries++;
+	}
+    long long t2 = Clock::current_time_in_nanoseconds();
+    log_app.print() << "get_proc_mem_affinity: " << (double(t2 - t1) / queries)
+		    << " ns/query (" << hits << "/" << queries << " hits)";
+  }
+
+  // get_visible_memories per processor
+  {
+    size_t queries = 0, found = 0;
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_iterations; i++)
+      for(size_t j = 0; j < procs.size(); j++) {
+	std::set<Memory> visible;
+	machine.get_visible_memories(procs[j], visible);
+	found += visible.size();
+	queries++;
+      }
+    long long t2 = Clock::current_time_in_nanoseconds();
+    log_app.print() << "get_visible_memories: " << (double(t2 - t1) / queries)
+		    << " ns/query (" << found << " results)";
+  }
+
+  // memory queries with an affinity predicate
+  {
+    size_t queries = 0, found = 0;
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_iterations; i++)
+      for(size_t j = 0; j < procs.size(); j++) {
+	Machine::MemoryQuery mq(machine);
+	mq.has_affinity_to(procs[j]);
+	for(Machine::MemoryQuery::iterator it = mq.begin(); it; ++it)
+	  found++;
+	queries++;
+      }
+    long long t2 = Clock::current_time_in_nanoseconds();
+    log_app.print() << "MemoryQuery::has_affinity_to: " << (double(t2 - t1) / queries)
+		    << " ns/query (" << found << " results)";
+  }
+
+  // processor queries with a kind restriction and an affinity predicate
+  {
+    size_t queries = 0, found = 0;
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_iterations; i++)
+      for(size_t k = 0; k < mems.size(); k++) {
+	Machine::ProcessorQuery pq(machine);
+	pq.only_kind(Processor::LOC_PROC).has_affinity_to(mems[k]);
+	for(Machine::ProcessorQuery::iterator it = pq.begin(); it; ++it)
+	  found++;
+	queries++;
+      }
+    long long t2 = Clock::current_time_in_nanoseconds();
+    log_app.print() << "ProcessorQuery::has_affinity_to: " << (double(t2 - t1) / queries)
+		    << " ns/query (" << found << " results)";
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single task - everybody gets the same finish event
+  Event e = rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // request shutdown once that task is complete
+  rt.shutdown(e);
+
+  // now sleep this thread until that shutdown actually happens
+  rt.wait_for_shutdown();
+
+  return 0;
+}
@@ -25,6 +25,10 @@ enum {
   FID_DATA2,
 };
 
+// size and repetition count for the bandwidth measurement
+int bw_elements = 1 << 20;
+int bw_reps = 10;
+
 struct SpeedTestArgs {
   Memory mem;
   RegionInstance inst;
@@ -44,8 +48,63 @@ void dump_field(RegionInstance inst, FieldID fid, IndexSpace<N,T> is)
     }
 }
 
+// copies all of 'fields' from 'src' to 'dst'
+template <int N, typename T>
+void copy_fields(IndexSpace<N,T> is, const std::map<FieldID, size_t>& fields,
+		 RegionInstance src, RegionInstance dst)
+{
+  if(src == dst) return;
+  std::vector<CopySrcDstField> srcs, dsts;
+  for(std::map<FieldID, size_t>::const_iterator it = fields.begin();
+      it != fields.end();
+      ++it) {
+    srcs.push_back(CopySrcDstField());
+    srcs.back().set_field(src, it->first, it->second);
+    dsts.push_back(CopySrcDstField());
+    dsts.back().set_field(dst, it->first, it->second);
+  }
+  is.copy(srcs, dsts, ProfilingRequestSet()).wait();
+}
+
+// the tests fill and check instances in system memory, but the indirect
+//  copies can be pointed at copies of them in 'work_mem' instead - a memory
+//  the dma threads can't access directly makes the copies stage everything
+//  through temporaries
+template <int N, typename T>
+struct TestInstance {
+  IndexSpace<N,T> is;
+  std::map<FieldID, size_t> fields;
+  RegionInstance check, work;
+
+  void create(Memory m, Memory work_mem, IndexSpace<N,T> _is,
+	      const std::map<FieldID, size_t>& _fields)
+  {
+    is = _is;
+    fields = _fields;
+    RegionInstance::create_instance(check, m, is, fields,
+				    0 /*SOA*/, ProfilingRequestSet()).wait();
+    if(work_mem.exists())
+      RegionInstance::create_instance(work, work_mem, is, fields,
+				      0 /*SOA*/, ProfilingRequestSet()).wait();
+    else
+      work = check;
+  }
+
+  void destroy(void)
+  {
+    if(work != check)
+      work.destroy();
+    check.destroy();
+  }
+
+  // after the test changes 'check'
+  void to_work(void) { copy_fields(is, fields, check, work); }
+  // after an indirect copy changes 'work'
+  void from_work(void) { copy_fields(is, fields, work, check); }
+};
+
 template <int N, typename T, int N2, typename T2, typename DT>
-bool scatter_gather_test(Memory m, T size1, T2 size2)
+bool scatter_gather_test(Memory m, Memory work_mem, T size1, T2 size2, int reps)
 {
   Rect<N,T> r1;
   Rect<N2,T2> r2;
@@ -56,24 +115,34 @@ bool scatter_gather_test(Memory m, T size1, T2 size2)
   IndexSpace<N,T> is1(r1);
   IndexSpace<N2,T2> is2(r2);
 
-  RegionInstance inst1, inst2a, inst2b;
+  // the indirect side is split into two target spaces (each backed by its
+  //  own instance) along the first dimension
+  Rect<N2,T2> r2a(r2), r2b(r2);
+  r2a.hi[0] = size2 / 2 - 1;
+  r2b.lo[0] = size2 / 2;
+  IndexSpace<N2,T2> is2a(r2a), is2b(r2b);
+
+  TestInstance<N,T> ti1;
+  TestInstance<N2,T2> ti2a, ti2b;
 
   std::map<FieldID, size_t> fields1;
   fields1[FID_PTR1] = sizeof(Point<N2,T2>);
   fields1[FID_DATA1] = sizeof(DT);
   fields1[FID_DATA2] = sizeof(DT);
-  RegionInstance::create_instance(inst1, m, is1, fields1,
-				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  ti1.create(m, work_mem, is1, fields1);
 
   std::map<FieldID, size_t> fields2;
   fields2[FID_DATA1] = sizeof(DT);
   fields2[FID_DATA2] = sizeof(DT);
-  RegionInstance::create_instance(inst2a, m, is2, fields2,
-				  0 /*SOA*/, ProfilingRequestSet()).wait();
-  RegionInstance::create_instance(inst2b, m, is2, fields2,
-				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  ti2a.create(m, work_mem, is2a, fields2);
+  ti2b.create(m, work_mem, is2b, fields2);
+
+  RegionInstance inst1 = ti1.check;
+  RegionInstance inst2a = ti2a.check;
+  RegionInstance inst2b = ti2b.check;
 
-  // fill the new instance
+  // fill the new instances - the pointer field walks is2 repeatedly (so
+  //  some targets are hit more than once when is1 is larger)
   {
     AffineAccessor<Point<N2, T2>, N, T> acc_ptr1(inst1, FID_PTR1);
     AffineAccessor<DT, N, T> acc_data1(inst1, FID_DATA1);
@@ -98,48 +167,455 @@ bool scatter_gather_test(Memory m, T size1, T2 size2)
 	pit2.reset(it2.rect);
       }
     }
+
+    RegionInstance insts2[2] = { inst2a, inst2b };
+    IndexSpace<N2,T2> spaces2[2] = { is2a, is2b };
+    for(int i = 0; i < 2; i++) {
+      AffineAccessor<DT, N2, T2> acc_data(insts2[i], FID_DATA1);
+      for(IndexSpaceIterator<N2,T2> it(spaces2[i]); it.valid; it.step())
+	for(PointInRectIterator<N2,T2> pit(it.rect); pit.valid; pit.step())
+	  acc_data[pit.p] = 1000 + (count++);
+    }
   }
+  ti1.to_work();
+  ti2a.to_work();
+  ti2b.to_work();
 
-  dump_field<N, T, Point<N2, T2> >(inst1, FID_PTR1, is1);
-  dump_field<N, T, DT >(inst1, FID_DATA1, is1);
+  if(size1 <= 16) {
+    dump_field<N, T, Point<N2, T2> >(inst1, FID_PTR1, is1);
+    dump_field<N, T, DT >(inst1, FID_DATA1, is1);
+  }
+
+  typename CopyIndirection<N,T>::template Unstructured<N2,T2> indirect;
+  indirect.field_id = FID_PTR1;
+  indirect.inst = ti1.work;
+  indirect.is_ranges = false;
+  indirect.subfield_offset = 0;
+  indirect.spaces.push_back(is2a);
+  indirect.spaces.push_back(is2b);
+  indirect.insts.push_back(ti2a.work);
+  indirect.insts.push_back(ti2b.work);
+  std::vector<const typename CopyIndirection<N,T>::Base *> indirects(1, &indirect);
+
+  size_t errors = 0;
 
+  // gather: inst1.DATA2[p] = inst2{a,b}.DATA1[ptr[p]]
   {
-    // affine copy within inst1
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_indirect(0, FID_DATA1, sizeof(DT));
+    dsts[0].set_field(ti1.work, FID_DATA2, sizeof(DT));
+
+    is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    ti1.from_work();
+
+    AffineAccessor<Point<N2, T2>, N, T> acc_ptr1(inst1, FID_PTR1);
+    AffineAccessor<DT, N, T> acc_data2(inst1, FID_DATA2);
+    AffineAccessor<DT, N2, T2> acc_a(inst2a, FID_DATA1);
+    AffineAccessor<DT, N2, T2> acc_b(inst2b, FID_DATA1);
+    for(IndexSpaceIterator<N,T> it(is1); it.valid; it.step())
+      for(PointInRectIterator<N,T> pit(it.rect); pit.valid; pit.step()) {
+	Point<N2,T2> tgt = acc_ptr1[pit.p];
+	DT exp = (is2a.contains(tgt) ? acc_a[tgt] : acc_b[tgt]);
+	DT act = acc_data2[pit.p];
+	if(exp != act) {
+	  if(++errors < 10)
+	    log_app.error() << "gather mismatch: " << pit.p << " (" << tgt
+			    << "): exp=" << exp << " act=" << act;
+	}
+      }
+  }
+
+  // scatter: inst2{a,b}.DATA2[ptr[p]] = inst1.DATA1[p] - targets hit more
+  //  than once may hold the value from any of the writers
+  {
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_field(ti1.work, FID_DATA1, sizeof(DT));
+    dsts[0].set_indirect(0, FID_DATA2, sizeof(DT));
+
+    is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    ti2a.from_work();
+    ti2b.from_work();
+
+    AffineAccessor<Point<N2, T2>, N, T> acc_ptr1(inst1, FID_PTR1);
+    AffineAccessor<DT, N, T> acc_data1(inst1, FID_DATA1);
+    AffineAccessor<DT, N2, T2> acc_a(inst2a, FID_DATA2);
+    AffineAccessor<DT, N2, T2> acc_b(inst2b, FID_DATA2);
+    std::map<Point<N2,T2>, std::set<DT> > expected;
+    for(IndexSpaceIterator<N,T> it(is1); it.valid; it.step())
+      for(PointInRectIterator<N,T> pit(it.rect); pit.valid; pit.step())
+	expected[acc_ptr1[pit.p]].insert(acc_data1[pit.p]);
+    for(typename std::map<Point<N2,T2>, std::set<DT> >::const_iterator it = expected.begin();
+	it != expected.end();
+	++it) {
+      DT act = (is2a.contains(it->first) ? acc_a[it->first] : acc_b[it->first]);
+      if(it->second.count(act) == 0) {
+	if(++errors < 10)
+	  log_app.error() << "scatter mismatch: " << it->first << ": act=" << act;
+      }
+    }
+  }
+
+  // bandwidth: time repeated gathers and scatters of the data field
+  if(reps > 0) {
+    size_t bytes = is1.volume() * sizeof(DT) * reps;
+
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_indirect(0, FID_DATA1, sizeof(DT));
+    dsts[0].set_field(ti1.work, FID_DATA2, sizeof(DT));
+    double t_start = Clock::current_time();
+    for(int i = 0; i < reps; i++)
+      is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    double t_gather = Clock::current_time() - t_start;
+
+    srcs.assign(1, CopySrcDstField());
+    dsts.assign(1, CopySrcDstField());
+    srcs[0].set_field(ti1.work, FID_DATA1, sizeof(DT));
+    dsts[0].set_indirect(0, FID_DATA2, sizeof(DT));
+    t_start = Clock::current_time();
+    for(int i = 0; i < reps; i++)
+      is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    double t_scatter = Clock::current_time() - t_start;
+
+    log_app.print() << "gather: " << bytes << " bytes in " << t_gather
+		    << " s = " << (1e-9 * bytes / t_gather) << " GB/s";
+    log_app.print() << "scatter: " << bytes << " bytes in " << t_scatter
+		    << " s = " << (1e-9 * bytes / t_scatter) << " GB/s";
+  }
+
+  ti1.destroy();
+  ti2a.destroy();
+  ti2b.destroy();
+
+  return (errors == 0);
+}
+
+// affine indirections within a single instance: a reversal of the domain
+//  (gather and scatter) and a divisor that maps pairs of points to one
+template <int N, typename T, typename DT>
+bool affine_test(Memory m, Memory work_mem, T size1)
+{
+  Rect<N,T> r1;
+  for(int i = 0; i < N; i++) r1.lo[i] = 0;
+  for(int i = 0; i < N; i++) r1.hi[i] = size1 - 1;
+  IndexSpace<N,T> is1(r1);
+
+  TestInstance<N,T> ti1;
+  std::map<FieldID, size_t> fields1;
+  fields1[FID_DATA1] = sizeof(DT);
+  fields1[FID_DATA2] = sizeof(DT);
+  ti1.create(m, work_mem, is1, fields1);
+  RegionInstance inst1 = ti1.check;
+
+  {
+    AffineAccessor<DT, N, T> acc_data1(inst1, FID_DATA1);
+    DT count = 0;
+    for(PointInRectIterator<N,T> pit(r1); pit.valid; pit.step())
+      acc_data1[pit.p] = count++;
+  }
+
+  size_t errors = 0;
+  for(int pass = 0; pass < 3; pass++) {
+    {
+      AffineAccessor<DT, N, T> acc_data2(inst1, FID_DATA2);
+      for(PointInRectIterator<N,T> pit(r1); pit.valid; pit.step())
+	acc_data2[pit.p] = -1;
+    }
+    ti1.to_work();
+
+    // pass 0: gather reversed, pass 1: scatter reversed, pass 2: gather
+    //  with a divisor of 2
+    bool gather = (pass != 1);
     Matrix<N, N, T> xform;
     for(int i = 0; i < N; i++)
       for(int j = 0; j < N; j++)
-	xform.rows[i][j] = (i == j) ? -1 : 0;
-    Point<N, T> offset(r1.hi);
+	xform.rows[i][j] = (i == j) ? ((pass == 2) ? 1 : -1) : 0;
     typename CopyIndirection<N,T>::template Affine<N,T> indirect;
     indirect.transform = xform;
-    indirect.offset_lo = offset;
-    indirect.offset_hi = offset;
-    for(int i = 0; i < N; i++) indirect.divisor[i] = 1;
-    indirect.spaces.push_back(is2);
-    indirect.insts.push_back(inst2a);
-
-    std::vector<CopySrcDstField> srcs, dsts;
-    srcs.resize(1);
-    dsts.resize(1);
-#ifdef ACTUALLY_TEST_GATHER
-    srcs[0].set_indirect(0, FID_DATA1, sizeof(DT));
-#else
-    srcs[0].set_field(inst1, FID_DATA1, sizeof(DT));
-#endif
-    //srcs[0].template set_fill<DT>(2.5);
-    dsts[0].set_field(inst1, FID_DATA2, sizeof(DT));
-
-    is1.copy(srcs, dsts, 
+    if(pass == 2) {
+      for(int i = 0; i < N; i++) indirect.offset_lo[i] = 0;
+      for(int i = 0; i < N; i++) indirect.divisor[i] = 2;
+    } else {
+      indirect.offset_lo = r1.hi;
+      for(int i = 0; i < N; i++) indirect.divisor[i] = 1;
+    }
+    indirect.offset_hi = indirect.offset_lo;
+    indirect.spaces.push_back(is1);
+    indirect.insts.push_back(ti1.work);
+
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    if(gather) {
+      srcs[0].set_indirect(0, FID_DATA1, sizeof(DT));
+      dsts[0].set_field(ti1.work, FID_DATA2, sizeof(DT));
+    } else {
+      srcs[0].set_field(ti1.work, FID_DATA1, sizeof(DT));
+      dsts[0].set_indirect(0, FID_DATA2, sizeof(DT));
+    }
+    is1.copy(srcs, dsts,
 	     std::vector<const typename CopyIndirection<N,T>::Base *>(1, &indirect),
 	     ProfilingRequestSet()).wait();
+    ti1.from_work();
+
+    if(size1 <= 16)
+      dump_field<N, T, DT >(inst1, FID_DATA2, is1);
+
+    AffineAccessor<DT, N, T> acc_data1(inst1, FID_DATA1);
+    AffineAccessor<DT, N, T> acc_data2(inst1, FID_DATA2);
+    for(PointInRectIterator<N,T> pit(r1); pit.valid; pit.step()) {
+      Point<N,T> p = pit.p;
+      Point<N,T> q = ((pass == 2) ? (p / indirect.divisor) : (r1.hi - p));
+      // a gather reads DATA1[q] into DATA2[p], a scatter writes DATA1[q]
+      //  (the reversal is its own inverse) to DATA2[p]
+      DT exp = acc_data1[q];
+      DT act = acc_data2[p];
+      if(exp != act) {
+	if(++errors < 10)
+	  log_app.error() << "affine mismatch (pass " << pass << "): " << p
+			  << ": exp=" << exp << " act=" << act;
+      }
+    }
+  }
+
+  ti1.destroy();
+
+  return (errors == 0);
+}
+
+// range indirections: each even domain point k holds a two-point range
+//  of targets and each odd point an empty one, so the range points pair up
+//  with the domain points in order (k with the range's first point, k+1
+//  with its second)
+template <typename DT>
+bool range_test(Memory m, Memory work_mem, int size1, int size2)
+{
+  assert(((size1 % 2) == 0) && (size2 > 2));
+  IndexSpace<1> is1(Rect<1>(0, size1 - 1));
+  IndexSpace<1> is2a(Rect<1>(0, size2 / 2 - 1));
+  IndexSpace<1> is2b(Rect<1>(size2 / 2, size2 - 1));
+
+  TestInstance<1,int> ti1, ti2a, ti2b;
+  std::map<FieldID, size_t> fields1;
+  fields1[FID_PTR1] = sizeof(Rect<1>);
+  fields1[FID_DATA1] = sizeof(DT);
+  fields1[FID_DATA2] = sizeof(DT);
+  ti1.create(m, work_mem, is1, fields1);
+  std::map<FieldID, size_t> fields2;
+  fields2[FID_DATA1] = sizeof(DT);
+  fields2[FID_DATA2] = sizeof(DT);
+  ti2a.create(m, work_mem, is2a, fields2);
+  ti2b.create(m, work_mem, is2b, fields2);
+
+  // target paired with domain point k (ranges may straddle the two spaces)
+  std::vector<int> target(size1);
+  {
+    AffineAccessor<Rect<1>, 1, int> acc_rng(ti1.check, FID_PTR1);
+    AffineAccessor<DT, 1, int> acc_data1(ti1.check, FID_DATA1);
+    for(int k = 0; k < size1; k++) {
+      acc_data1[k] = k;
+      if((k % 2) == 0) {
+	int lo = (k * 7) % (size2 - 1);
+	acc_rng[k] = Rect<1>(lo, lo + 1);
+	target[k] = lo;
+	target[k + 1] = lo + 1;
+      } else
+	acc_rng[k] = Rect<1>(1, 0);
+    }
+    AffineAccessor<DT, 1, int> acc_a(ti2a.check, FID_DATA1);
+    AffineAccessor<DT, 1, int> acc_b(ti2b.check, FID_DATA1);
+    for(int i = 0; i < size2; i++)
+      if(is2a.contains(i))
+	acc_a[i] = 1000 + i;
+      else
+	acc_b[i] = 1000 + i;
+  }
+  ti1.to_work();
+  ti2a.to_work();
+  ti2b.to_work();
+
+  typename CopyIndirection<1,int>::Unstructured<1,int> indirect;
+  indirect.field_id = FID_PTR1;
+  indirect.inst = ti1.work;
+  indirect.is_ranges = true;
+  indirect.subfield_offset = 0;
+  indirect.spaces.push_back(is2a);
+  indirect.spaces.push_back(is2b);
+  indirect.insts.push_back(ti2a.work);
+  indirect.insts.push_back(ti2b.work);
+  std::vector<const CopyIndirection<1,int>::Base *> indirects(1, &indirect);
+
+  size_t errors = 0;
+
+  // gather
+  {
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_indirect(0, FID_DATA1, sizeof(DT));
+    dsts[0].set_field(ti1.work, FID_DATA2, sizeof(DT));
+    is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    ti1.from_work();
+
+    AffineAccessor<DT, 1, int> acc_data2(ti1.check, FID_DATA2);
+    for(int k = 0; k < size1; k++)
+      if(acc_data2[k] != DT(1000 + target[k])) {
+	if(++errors < 10)
+	  log_app.error() << "range gather mismatch: " << k << " (" << target[k]
+			  << "): exp=" << (1000 + target[k]) << " act=" << acc_data2[k];
+      }
+  }
+
+  // scatter - targets hit more than once may hold any of the writers' values
+  {
+    std::vector<CopySrcDstField> srcs(1), dsts(1);
+    srcs[0].set_field(ti1.work, FID_DATA1, sizeof(DT));
+    dsts[0].set_indirect(0, FID_DATA2, sizeof(DT));
+    is1.copy(srcs, dsts, indirects, ProfilingRequestSet()).wait();
+    ti2a.from_work();
+    ti2b.from_work();
+
+    std::map<int, std::set<DT> > expected;
+    for(int k = 0; k < size1; k++)
+      expected[target[k]].insert(k);
+    AffineAccessor<DT, 1, int> acc_a(ti2a.check, FID_DATA2);
+    AffineAccessor<DT, 1, int> acc_b(ti2b.check, FID_DATA2);
+    for(typename std::map<int, std::set<DT> >::const_iterator it = expected.begin();
+	it != expected.end();
+	++it) {
+      DT act = (is2a.contains(it->first) ? acc_a[it->first] : acc_b[it->first]);
+      if(it->second.count(act) == 0) {
+	if(++errors < 10)
+	  log_app.error() << "range scatter mismatch: " << it->first << ": act=" << act;
+      }
+    }
+  }
+
+  ti1.destroy();
+  ti2a.destroy();
+  ti2b.destroy();
+
+  return (errors == 0);
+}
+
+enum { REDOP_ADD = 1 };
+
+class ReductionOpIntAdd {
+public:
+  typedef int LHS;
+  typedef int RHS;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { __sync_fetch_and_add(&lhs, rhs); }
+
+  static const RHS identity;
+
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { __sync_fetch_and_add(&rhs1, rhs2); }
+};
+
+const ReductionOpIntAdd::RHS ReductionOpIntAdd::identity = 0;
+
+// scatter-reduce: every domain point adds its value to its target, and
+//  targets hit more than once must see all the contributions - with
+//  'skip_upper' only the lower half is a target space and the points aimed
+//  at the upper half must be skipped
+bool scatter_reduce_test(Memory m, Memory work_mem, int size1, int size2,
+			 bool skip_upper = false)
+{
+  IndexSpace<1> is1(Rect<1>(0, size1 - 1));
+  IndexSpace<1> is2a(Rect<1>(0, size2 / 2 - 1));
+  IndexSpace<1> is2b(Rect<1>(size2 / 2, size2 - 1));
+
+  TestInstance<1,int> ti1, ti2a, ti2b;
+  std::map<FieldID, size_t> fields1;
+  fields1[FID_PTR1] = sizeof(Point<1>);
+  fields1[FID_DATA1] = sizeof(int);
+  ti1.create(m, work_mem, is1, fields1);
+  std::map<FieldID, size_t> fields2;
+  fields2[FID_DATA1] = sizeof(int);
+  ti2a.create(m, work_mem, is2a, fields2);
+  ti2b.create(m, work_mem, is2b, fields2);
+
+  std::vector<int> expected(size2);
+  {
+    AffineAccessor<Point<1>, 1, int> acc_ptr1(ti1.check, FID_PTR1);
+    AffineAccessor<int, 1, int> acc_data1(ti1.check, FID_DATA1);
+    AffineAccessor<int, 1, int> acc_a(ti2a.check, FID_DATA1);
+    AffineAccessor<int, 1, int> acc_b(ti2b.check, FID_DATA1);
+    for(int i = 0; i < size2; i++) {
+      expected[i] = 100 * i;
+      if(is2a.contains(i))
+	acc_a[i] = expected[i];
+      else
+	acc_b[i] = expected[i];
+    }
+    for(int k = 0; k < size1; k++) {
+      int tgt = (k * 5) % size2;
+      acc_ptr1[k] = tgt;
+      acc_data1[k] = k + 1;
+      if(!skip_upper || is2a.contains(tgt))
+	expected[tgt] += k + 1;
+    }
+  }
+  ti1.to_work();
+  ti2a.to_work();
+  ti2b.to_work();
+
+  CopyIndirection<1,int>::Unstructured<1,int> indirect;
+  indirect.field_id = FID_PTR1;
+  indirect.inst = ti1.work;
+  indirect.is_ranges = false;
+  indirect.subfield_offset = 0;
+  indirect.oor_possible = skip_upper;
+  indirect.spaces.push_back(is2a);
+  indirect.insts.push_back(ti2a.work);
+  if(!skip_upper) {
+    indirect.spaces.push_back(is2b);
+    indirect.insts.push_back(ti2b.work);
   }
 
-  dump_field<N, T, DT >(inst1, FID_DATA2, is1);
+  std::vector<CopySrcDstField> srcs(1), dsts(1);
+  srcs[0].set_field(ti1.work, FID_DATA1, sizeof(int));
+  dsts[0].set_indirect(0, FID_DATA1, sizeof(int));
+  dsts[0].set_redop(REDOP_ADD, false /*!fold*/);
+  is1.copy(srcs, dsts,
+	   std::vector<const CopyIndirection<1,int>::Base *>(1, &indirect),
+	   ProfilingRequestSet()).wait();
+  ti2a.from_work();
+  ti2b.from_work();
+
+  size_t errors = 0;
+  AffineAccessor<int, 1, int> acc_a(ti2a.check, FID_DATA1);
+  AffineAccessor<int, 1, int> acc_b(ti2b.check, FID_DATA1);
+  for(int i = 0; i < size2; i++) {
+    int act = (is2a.contains(i) ? acc_a[i] : acc_b[i]);
+    if(act != expected[i]) {
+      if(++errors < 10)
+	log_app.error() << "scatter-reduce mismatch: " << i << ": exp="
+			<< expected[i] << " act=" << act;
+    }
+  }
+
+  ti1.destroy();
+  ti2a.destroy();
+  ti2b.destroy();
 
-  inst1.destroy();
-  inst2a.destroy();
-  inst2b.destroy();
+  return (errors == 0);
+}
 
+// runs all the checked tests with the given work memory
+bool run_tests(Memory m, Memory work_mem)
+{
+  if(!scatter_gather_test<1, int, 1, int, float>(m, work_mem, 10, 8, 0))
+    return false;
+  if(!scatter_gather_test<2, int, 1, int, double>(m, work_mem, 12, 50, 0))
+    return false;
+  if(!affine_test<1, int, float>(m, work_mem, 10))
+    return false;
+  if(!affine_test<2, int, double>(m, work_mem, 9))
+    return false;
+  if(!range_test<float>(m, work_mem, 20, 12))
+    return false;
+  if(!scatter_reduce_test(m, work_mem, 1000, 64))
+    return false;
+  if(!scatter_reduce_test(m, work_mem, 1000, 64, true /*skip_upper*/))
+    return false;
   return true;
 }
 
@@ -154,27 +630,73 @@ void top_level_task(const void *args, size_t arglen,
   Memory m = Machine::MemoryQuery(Machine::get_machine()).only_kind(Memory::SYSTEM_MEM).first();
   assert(m.exists());
 
-  scatter_gather_test<1, int, 1, int, float>(m, 10, 8);
+  bool ok = run_tests(m, Memory::NO_MEMORY);
+
+  // a memory without direct cpu access (e.g. the disk memory added by
+  //  main) exercises the staging of inaccessible instances
+  Memory staged_mem = Machine::MemoryQuery(Machine::get_machine())
+    .only_kind(Memory::DISK_MEM)
+    .first();
+  if(ok) {
+    if(staged_mem.exists()) {
+      log_app.print() << "repeating checks with instances in " << staged_mem;
+      ok = run_tests(m, staged_mem);
+    } else
+      log_app.warning() << "no disk memory - staging not tested";
+  }
+
+  if(ok)
+    ok = scatter_gather_test<1, int, 1, int, double>(m, Memory::NO_MEMORY,
+						    bw_elements,
+						    bw_elements / 2, bw_reps);
+
+  if(!ok) {
+    log_app.error() << "scatter/gather test failed";
+    exit(1);
+  }
+
+  log_app.print() << "scatter/gather test passed";
 }
 
 int main(int argc, char **argv)
 {
   Runtime rt;
 
+  // ask for a small disk memory for the staging tests unless the command
+  //  line already has one
+  std::vector<char *> args(argv, argv + argc);
+  bool has_dsize = false;
+  for(int i = 1; i < argc; i++)
+    if(!strcmp(argv[i], "-ll:dsize"))
+      has_dsize = true;
+  char dsize_flag[] = "-ll:dsize", dsize_value[] = "16";
+  if(!has_dsize) {
+    args.push_back(dsize_flag);
+    args.push_back(dsize_value);
+  }
+  args.push_back(0);
+  argc = args.size() - 1;
+  argv = &args[0];
+
   rt.init(&argc, &argv);
 
-#if 0
   for(int i = 1; i < argc; i++) {
     if(!strcmp(argv[i], "-b")) {
-      buffer_size = strtoll(argv[++i], 0, 10);
+      bw_elements = strtol(argv[++i], 0, 10);
       continue;
     }
 
+    if(!strcmp(argv[i], "-r")) {
+      bw_reps = strtol(argv[++i], 0, 10);
+      continue;
+    }
   }
-#endif
 
   rt.register_task(TOP_LEVEL_TASK, top_level_task);
 
+  rt.register_reduction(REDOP_ADD,
+			ReductionOpUntyped::create_reduction_op<ReductionOpIntAdd>());
+
   // select a processor to run the top level task on
   Processor p = Machine::ProcessorQuery(Machine::get_machine())
     .only_kind(Processor::LOC_PROC)
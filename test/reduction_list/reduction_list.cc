@@ -0,0 +1,228 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks reduction list instances: a mapper asks for list instances for
+// every reduction, tasks scatter values into them with a list accessor
+// the way particles deposit onto a grid, and the sums that end up in the
+// region once the lists are applied must match the ones computed here.
+// Tasks reduce both to the whole region and to the pieces of a partition
+// so lists get applied to all of their target and to subsets of it.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "legion.h"
+#include "default_mapper.h"
+
+using namespace Legion;
+using namespace Legion::Mapping;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  DEPOSIT_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VAL,
+};
+
+typedef SumReduction<int64_t> SumOp;
+
+static const int NUM_CELLS = 64;
+static const int NUM_PIECES = 4;
+static const int NUM_DEPOSITS = 100;
+
+class ListMapper : public DefaultMapper {
+public:
+  ListMapper(MapperRuntime *rt, Machine machine, Processor local)
+    : DefaultMapper(rt, machine, local) { }
+protected:
+  virtual void default_policy_select_constraints(MapperContext ctx,
+                     LayoutConstraintSet &constraints, Memory target_memory,
+                     const RegionRequirement &req)
+  {
+    if (req.privilege == REDUCE)
+      // Exactly enough entries for one deposit task
+      constraints.add_constraint(SpecializedConstraint(
+                          REDUCTION_LIST_SPECIALIZE, req.redop,
+                          false/*no access*/, NUM_DEPOSITS))
+        .add_constraint(MemoryConstraint(target_memory.kind()));
+    else
+      DefaultMapper::default_policy_select_constraints(ctx, constraints,
+                                                       target_memory, req);
+  }
+};
+
+void mapper_registration(Machine machine, Runtime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+    rt->replace_default_mapper(
+        new ListMapper(rt->get_mapper_runtime(), machine, *it), *it);
+}
+
+// The cell that deposit 'k' of a piece lands on, always inside 'rect'
+static int deposit_cell(const Rect<1> &rect, int piece, int k)
+{
+  const int cells = rect.hi[0] - rect.lo[0] + 1;
+  return rect.lo[0] + ((piece * 7 + k * 13) % cells);
+}
+
+bool deposit_task(const Task *task,
+                  const std::vector<PhysicalRegion> &regions,
+                  Context ctx, Runtime *runtime)
+{
+  const int piece = task->index_point[0];
+  const Rect<1> rect = runtime->get_index_space_domain(ctx,
+                  task->regions[0].region.get_index_space());
+  const ListReductionAccessor<SumOp,1> acc(regions[0], FID_VAL,
+                                           SumOp::REDOP_ID);
+  if (acc.capacity() != NUM_DEPOSITS)
+  {
+    printf("ERROR: list has %zd entries instead of %d\n", acc.capacity(),
+           NUM_DEPOSITS);
+    return false;
+  }
+  for (int k = 0; k < NUM_DEPOSITS; k++)
+    if (!acc.reduce(deposit_cell(rect, piece, k), piece + 1))
+    {
+      printf("ERROR: list was full after %d deposits\n", k);
+      return false;
+    }
+  // The list is full now so this one must be refused
+  if (acc.reduce(rect.lo, 1000))
+  {
+    printf("ERROR: deposit into a full list was accepted\n");
+    return false;
+  }
+  return true;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  const Rect<1> cells(0, NUM_CELLS - 1);
+  IndexSpace is = runtime->create_index_space(ctx, cells);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int64_t), FID_VAL);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  const Rect<1> colors(0, NUM_PIECES - 1);
+  IndexSpace color_is = runtime->create_index_space(ctx, colors);
+  IndexPartition ip = runtime->create_equal_partition(ctx, is, color_is);
+  LogicalPartition lp = runtime->get_logical_partition(ctx, lr, ip);
+  runtime->fill_field<int64_t>(ctx, lr, lr, FID_VAL, 0);
+
+  std::vector<int64_t> expected(NUM_CELLS, 0);
+  std::vector<Future> results;
+  // Every piece deposits anywhere in the region
+  {
+    IndexTaskLauncher launcher(DEPOSIT_TASK_ID, color_is,
+                               TaskArgument(), ArgumentMap());
+    launcher.add_region_requirement(
+        RegionRequirement(lr, 0/*projection*/, SumOp::REDOP_ID,
+                          EXCLUSIVE, lr));
+    launcher.add_field(0, FID_VAL);
+    FutureMap fm = runtime->execute_index_space(ctx, launcher);
+    for (int piece = 0; piece < NUM_PIECES; piece++)
+    {
+      results.push_back(fm.get_future(piece));
+      for (int k = 0; k < NUM_DEPOSITS; k++)
+        expected[deposit_cell(cells, piece, k)] += piece + 1;
+    }
+  }
+  // Then every piece deposits into its own subregion
+  {
+    IndexTaskLauncher launcher(DEPOSIT_TASK_ID, color_is,
+                               TaskArgument(), ArgumentMap());
+    launcher.add_region_requirement(
+        RegionRequirement(lp, 0/*projection*/, SumOp::REDOP_ID,
+                          EXCLUSIVE, lr));
+    launcher.add_field(0, FID_VAL);
+    FutureMap fm = runtime->execute_index_space(ctx, launcher);
+    for (int piece = 0; piece < NUM_PIECES; piece++)
+    {
+      results.push_back(fm.get_future(piece));
+      const Rect<1> rect = runtime->get_index_space_domain(ctx,
+          runtime->get_index_subspace(ctx, ip, piece));
+      for (int k = 0; k < NUM_DEPOSITS; k++)
+        expected[deposit_cell(rect, piece, k)] += piece + 1;
+    }
+  }
+
+  bool ok = true;
+  for (unsigned idx = 0; idx < results.size(); idx++)
+    if (!results[idx].get_result<bool>())
+      ok = false;
+  // Read the last piece on its own first so the lists get applied to
+  // just that piece before they get applied to the rest of the region
+  std::vector<LogicalRegion> targets;
+  targets.push_back(
+      runtime->get_logical_subregion_by_color(ctx, lp, NUM_PIECES - 1));
+  targets.push_back(lr);
+  for (unsigned idx = 0; idx < targets.size(); idx++)
+  {
+    InlineLauncher launcher(
+        RegionRequirement(targets[idx], READ_ONLY, EXCLUSIVE, lr));
+    launcher.add_field(FID_VAL);
+    PhysicalRegion pr = runtime->map_region(ctx, launcher);
+    pr.wait_until_valid();
+    const FieldAccessor<READ_ONLY,int64_t,1> acc(pr, FID_VAL);
+    const Rect<1> rect = runtime->get_index_space_domain(ctx,
+                            targets[idx].get_index_space());
+    for (PointInRectIterator<1> pir(rect); pir(); pir++)
+      if (acc[*pir] != expected[(*pir)[0]])
+      {
+        printf("ERROR: cell %lld is %lld instead of %lld\n", (*pir)[0],
+               (long long)acc[*pir], (long long)expected[(*pir)[0]]);
+        ok = false;
+        break;
+      }
+    runtime->unmap_region(ctx, pr);
+  }
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_is);
+  runtime->destroy_index_space(ctx, is);
+
+  if (ok)
+    printf("SUCCESS\n");
+  else
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+  {
+    TaskVariantRegistrar registrar(DEPOSIT_TASK_ID, "deposit");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<bool,deposit_task>(registrar,
+                                                          "deposit");
+  }
+  Runtime::add_registration_callback(mapper_registration);
+  return Runtime::start(argc, argv);
+}
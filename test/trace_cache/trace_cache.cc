@@ -0,0 +1,316 @@
+/* Copyright 2019 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks the templates saved with -lg:trace_cache: a first run records
+// them, a second run of the same program replays them without mapping
+// the traced tasks again, and runs that find a corrupted file or the
+// templates of a trace that issued different operations record again.
+// Each run is a separate process started by the test itself.
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "legion.h"
+#include "default_mapper.h"
+
+using namespace Legion;
+using namespace Legion::Mapping;
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  INC_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VAL,
+};
+
+enum TraceIDs {
+  TRACE_ID = 1,
+};
+
+static const int NUM_ELEMENTS = 256;
+static const int NUM_PIECES = 4;
+static const int NUM_ITERATIONS = 10;
+
+// set in the environment of the runs started by the test
+static const char *PHASE_VAR = "TRACE_CACHE_PHASE";
+static const char *COUNT_VAR = "TRACE_CACHE_COUNT";
+
+static int map_task_calls = 0;
+
+class CountingMapper : public DefaultMapper {
+public:
+  CountingMapper(MapperRuntime *rt, Machine machine, Processor local)
+    : DefaultMapper(rt, machine, local) { }
+public:
+  virtual void map_task(const MapperContext ctx,
+                        const Task& task,
+                        const MapTaskInput& input,
+                              MapTaskOutput& output)
+  {
+    if (task.task_id == INC_TASK_ID)
+      __sync_fetch_and_add(&map_task_calls, 1);
+    DefaultMapper::map_task(ctx, task, input, output);
+  }
+  virtual void memoize_operation(const MapperContext ctx,
+                                 const Mappable& mappable,
+                                 const MemoizeInput& input,
+                                       MemoizeOutput& output)
+  {
+    output.memoize = true;
+  }
+};
+
+void mapper_registration(Machine machine, Runtime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+    rt->replace_default_mapper(
+        new CountingMapper(rt->get_mapper_runtime(), machine, *it), *it);
+}
+
+void inc_task(const Task *task,
+              const std::vector<PhysicalRegion> &regions,
+              Context ctx, Runtime *runtime)
+{
+  const FieldAccessor<READ_WRITE,int,1> acc(regions[0], FID_VAL);
+  Rect<1> rect = runtime->get_index_space_domain(ctx,
+                  task->regions[0].region.get_index_space());
+  for (PointInRectIterator<1> pir(rect); pir(); pir++)
+    acc[*pir] = acc[*pir] + 1;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  // A stale run issues one more launch in the trace than the others
+  const char *phase = getenv(PHASE_VAR);
+  const int launches = (strcmp(phase, "stale") == 0) ? 2 : 1;
+
+  IndexSpace is = runtime->create_index_space(ctx,
+                    Rect<1>(0, NUM_ELEMENTS - 1));
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int), FID_VAL);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  IndexSpace color_is = runtime->create_index_space(ctx,
+                          Rect<1>(0, NUM_PIECES - 1));
+  IndexPartition ip = runtime->create_equal_partition(ctx, is, color_is);
+  LogicalPartition lp = runtime->get_logical_partition(ctx, lr, ip);
+  runtime->fill_field<int>(ctx, lr, lr, FID_VAL, 0);
+
+  for (int iter = 0; iter < NUM_ITERATIONS; iter++)
+  {
+    runtime->begin_trace(ctx, TRACE_ID);
+    for (int idx = 0; idx < launches; idx++)
+    {
+      IndexTaskLauncher launcher(INC_TASK_ID, color_is,
+                                 TaskArgument(), ArgumentMap());
+      launcher.add_region_requirement(
+          RegionRequirement(lp, 0/*projection*/, READ_WRITE, EXCLUSIVE, lr));
+      launcher.add_field(0, FID_VAL);
+      runtime->execute_index_space(ctx, launcher);
+    }
+    runtime->end_trace(ctx, TRACE_ID);
+  }
+
+  bool ok = true;
+  {
+    InlineLauncher launcher(RegionRequirement(lr, READ_ONLY, EXCLUSIVE, lr));
+    launcher.add_field(FID_VAL);
+    PhysicalRegion pr = runtime->map_region(ctx, launcher);
+    pr.wait_until_valid();
+    const FieldAccessor<READ_ONLY,int,1> acc(pr, FID_VAL);
+    for (int idx = 0; idx < NUM_ELEMENTS; idx++)
+      if (acc[idx] != (launches * NUM_ITERATIONS))
+      {
+        printf("ERROR: element %d is %d instead of %d\n", idx, acc[idx],
+               launches * NUM_ITERATIONS);
+        ok = false;
+        break;
+      }
+    runtime->unmap_region(ctx, pr);
+  }
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, color_is);
+  runtime->destroy_index_space(ctx, is);
+
+  // The inline mapping waited for every traced task so all of
+  // them have been mapped or replayed by now
+  FILE *f = fopen(getenv(COUNT_VAR), "w");
+  assert(f != NULL);
+  fprintf(f, "%d\n", ok ? map_task_calls : -1);
+  fclose(f);
+}
+
+static int run_legion(int argc, char **argv)
+{
+  Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  {
+    TaskVariantRegistrar registrar(TOP_LEVEL_TASK_ID, "top_level");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(registrar, "top_level");
+  }
+  {
+    TaskVariantRegistrar registrar(INC_TASK_ID, "inc");
+    registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    registrar.set_leaf();
+    Runtime::preregister_task_variant<inc_task>(registrar, "inc");
+  }
+  Runtime::add_registration_callback(mapper_registration);
+  return Runtime::start(argc, argv);
+}
+
+// Runs this program again with the cache directory and returns the
+// number of times the traced tasks were mapped, or -1 on failure
+static int run_phase(const char *phase, const std::string &cache_dir,
+                     int argc, char **argv)
+{
+  const std::string count_file = cache_dir + "/map_count";
+  remove(count_file.c_str());
+  printf("running the %s phase\n", phase);
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0)
+    return -1;
+  if (pid == 0)
+  {
+    // Every run gets the same arguments since they are part of the
+    // key of the persistent templates
+    std::vector<char*> args(argv, argv + argc);
+    args.push_back(const_cast<char*>("-lg:trace_cache"));
+    args.push_back(const_cast<char*>(cache_dir.c_str()));
+    args.push_back(NULL);
+    setenv(PHASE_VAR, phase, 1);
+    setenv(COUNT_VAR, count_file.c_str(), 1);
+    execv("/proc/self/exe", &args[0]);
+    _exit(1);
+  }
+  int status;
+  if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) ||
+      (WEXITSTATUS(status) != 0))
+    return -1;
+  FILE *f = fopen(count_file.c_str(), "r");
+  if (f == NULL)
+    return -1;
+  int count = -1;
+  if (fscanf(f, "%d", &count) != 1)
+    count = -1;
+  fclose(f);
+  printf("%s phase mapped the traced tasks %d times\n", phase, count);
+  return count;
+}
+
+static std::vector<std::string> find_cache_files(const std::string &dir)
+{
+  std::vector<std::string> files;
+  DIR *d = opendir(dir.c_str());
+  if (d == NULL)
+    return files;
+  while (struct dirent *entry = readdir(d))
+  {
+    const size_t len = strlen(entry->d_name);
+    if ((len > 4) && (strcmp(entry->d_name + len - 4, ".lgt") == 0))
+      files.push_back(dir + "/" + entry->d_name);
+  }
+  closedir(d);
+  return files;
+}
+
+static void remove_directory(const std::string &dir)
+{
+  DIR *d = opendir(dir.c_str());
+  if (d == NULL)
+    return;
+  while (struct dirent *entry = readdir(d))
+    if (entry->d_name[0] != '.')
+      remove((dir + "/" + entry->d_name).c_str());
+  closedir(d);
+  rmdir(dir.c_str());
+}
+
+#define CHECK(cond, msg)                                        \
+  do {                                                          \
+    if (!(cond)) {                                              \
+      printf("ERROR: %s\n", msg);                               \
+      remove_directory(cache_dir);                              \
+      return 1;                                                 \
+    }                                                           \
+  } while (0)
+
+int main(int argc, char **argv)
+{
+  if (getenv(PHASE_VAR) != NULL)
+    return run_legion(argc, argv);
+
+  char dir_template[] = "/tmp/trace_cache_XXXXXX";
+  if (mkdtemp(dir_template) == NULL)
+  {
+    printf("ERROR: unable to create a cache directory\n");
+    return 1;
+  }
+  const std::string cache_dir = dir_template;
+
+  // Nothing cached, the templates are recorded and saved
+  const int recorded = run_phase("record", cache_dir, argc, argv);
+  CHECK(recorded > 0, "record phase failed");
+  const std::vector<std::string> files = find_cache_files(cache_dir);
+  CHECK(!files.empty(), "no templates were saved");
+
+  // The saved templates are replayed after the first iteration
+  const int replayed = run_phase("replay", cache_dir, argc, argv);
+  CHECK(replayed > 0, "replay phase failed");
+  CHECK(replayed < recorded, "saved templates were not replayed");
+
+  // A corrupted file is ignored and the templates are recorded again
+  for (unsigned idx = 0; idx < files.size(); idx++)
+  {
+    FILE *f = fopen(files[idx].c_str(), "r+b");
+    CHECK(f != NULL, "unable to open a saved template file");
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, size / 2, SEEK_SET);
+    const int c = fgetc(f);
+    fseek(f, size / 2, SEEK_SET);
+    fputc(c ^ 0xff, f);
+    fclose(f);
+  }
+  const int corrupted = run_phase("corrupt", cache_dir, argc, argv);
+  CHECK(corrupted == recorded, "a corrupted template file was used");
+
+  // The templates of a trace that issued different operations are not
+  // replayed: the stale run overwrites the file with its own templates
+  const int stale = run_phase("stale", cache_dir, argc, argv);
+  CHECK(stale > 0, "stale phase failed");
+  const int rerecorded = run_phase("record", cache_dir, argc, argv);
+  CHECK(rerecorded == recorded, "stale templates were used");
+
+  remove_directory(cache_dir);
+  printf("SUCCESS\n");
+  return 0;
+}
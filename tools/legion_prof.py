@@ -113,6 +113,17 @@ dep_part_kinds = {
     14 : 'Create Association',
 }
 
+# Make sure this is up to date with TraceTemplateKind in legion_types.h
+trace_template_kinds = [
+    'Hits',
+    'Recurrent Replays',
+    'Misses',
+    'Recorded',
+    'Recorded Transitions',
+    'Discarded',
+    'Evicted',
+]
+
 # Micro-seconds per pixel
 US_PER_PIXEL = 100
 # Pixels per level of the picture
@@ -529,6 +540,12 @@ class Processor(object):
         call.proc = self
         self.tasks.append(call)
 
+    def add_lock_wait(self, wait):
+        # lock waits happen inside of other tasks so they only show up
+        # in the timeline and never count towards the utilization
+        wait.proc = self
+        self.tasks.append(wait)
+
     def trim_time_range(self, start, stop):
         trimmed_tasks = list()
         for task in self.tasks:
@@ -541,6 +558,8 @@ class Processor(object):
             self.time_points.append(TimePoint(task.start, task, True))
             self.time_points.append(TimePoint(task.stop, task, False))
 
+            if isinstance(task, LockWait):
+                continue
             self.util_time_points.append(TimePoint(task.start, task, True))
             self.util_time_points.append(TimePoint(task.stop, task, False))
             if isinstance(task, HasWaiters):
@@ -1847,6 +1866,40 @@ class RuntimeCallKind(StatObject):
     def __repr__(self):
         return self.name
 
+class LockSite(object):
+    def __init__(self, site_id, name):
+        self.site_id = site_id
+        self.name = name
+        self.color = None
+        self.acquires = 0
+        self.exclusive = 0
+        self.contended = 0
+        self.total_wait = 0
+        self.total_hold = 0
+        # histograms of wait and hold times with bucket b holding
+        # times in nanoseconds from 2^b up to 2^(b+1)
+        self.histograms = ({}, {})
+
+    def assign_color(self, color):
+        assert self.color is None
+        self.color = color
+
+    def percentile(self, kind, fraction):
+        histogram = self.histograms[kind]
+        total = sum(itervalues(histogram))
+        if total == 0:
+            return 0
+        seen = 0
+        for bucket in sorted(histogram):
+            seen += histogram[bucket]
+            if seen >= fraction * total:
+                # report the upper bound of the bucket in us
+                return (1 << (bucket + 1)) / 1000.0
+        assert False
+
+    def __repr__(self):
+        return self.name
+
 class Field(StatObject):
     def __init__(self, unique_id, field_id, size, name):
         StatObject.__init__(self)
@@ -2051,6 +2104,52 @@ class RuntimeCall(Base, TimeRange, HasNoDependencies):
     def __repr__(self):
         return 'Runtime Call '+str(self.kind)
 
+class LockWait(Base, TimeRange, HasNoDependencies):
+    def __init__(self, site, start, stop):
+        Base.__init__(self)
+        TimeRange.__init__(self, None, None, start, stop)
+        HasNoDependencies.__init__(self)
+        self.site = site
+
+    def get_color(self):
+        assert self.site.color is not None
+        return self.site.color
+
+    def emit_tsv(self, tsv_file, base_level, max_levels, level):
+        tsv_line = data_tsv_str(level = base_level + (max_levels - level),
+                                start = self.start,
+                                end = self.stop,
+                                color = self.get_color(),
+                                opacity = "0.5",
+                                title = repr(self),
+                                initiation = None,
+                                _in = None,
+                                out = None,
+                                children = None,
+                                parents = None,
+                                prof_uid = self.prof_uid)
+
+        tsv_file.write(tsv_line)
+
+    # the task waiting on the lock is already accounted for on the processor
+    def total_time(self):
+        return 0
+
+    def active_time(self):
+        return 0
+
+    def application_time(self):
+        return 0
+
+    def meta_time(self):
+        return 0
+
+    def mapper_time(self):
+        return 0
+
+    def __repr__(self):
+        return 'Lock Wait '+str(self.site)
+
 class LFSR(object):
     def __init__(self, size):
         self.register = ''
@@ -2187,6 +2286,9 @@ class State(object):
         self.mapper_calls = {}
         self.runtime_call_kinds = {}
         self.runtime_calls = {}
+        self.message_channels = []
+        self.trace_templates = {}
+        self.lock_sites = {}
         self.instances = {}
         self.index_spaces = {}
         self.partitions = {}
@@ -2208,6 +2310,11 @@ class State(object):
             "OperationInstance": self.log_operation,
             "MultiTask": self.log_multi,
             "SliceOwner": self.log_slice_owner,
+            "TraceTemplateInfo": self.log_trace_template,
+            "LockSiteDesc": self.log_lock_site_desc,
+            "LockStatsInfo": self.log_lock_stats,
+            "LockHistInfo": self.log_lock_histogram,
+            "LockWaitInfo": self.log_lock_wait_info,
             "TaskWaitInfo": self.log_task_wait_info,
             "MetaWaitInfo": self.log_meta_wait_info,
             "TaskInfo": self.log_task_info,
@@ -2236,7 +2343,8 @@ class State(object):
             "LogicalRegionDesc": self.log_logical_region_desc,
             "PhysicalInstRegionDesc": self.log_physical_inst_region_desc,
             "PhysicalInstLayoutDesc": self.log_physical_inst_layout_desc,
-            "MaxDimDesc": self.log_max_dim
+            "MaxDimDesc": self.log_max_dim,
+            "MessageChannelDesc": self.log_message_channel_desc
             #"UserInfo": self.log_user_info
         }
 
@@ -2440,6 +2548,11 @@ class State(object):
         op = self.find_op(op_id)
         op.owner = parent
 
+    def log_trace_template(self, op_id, trace_id, kind):
+        if trace_id not in self.trace_templates:
+            self.trace_templates[trace_id] = [0] * len(trace_template_kinds)
+        self.trace_templates[trace_id][kind] += 1
+
     def log_meta_desc(self, kind, name):
         if kind not in self.meta_variants:
             self.meta_variants[kind] = Variant(kind, name)
@@ -2472,6 +2585,11 @@ class State(object):
         if kind not in self.op_kinds:
             self.op_kinds[kind] = name
 
+    def log_message_channel_desc(self, source, target, kind, messages,
+                                 active_messages, bytes, name):
+        self.message_channels.append((source, target, kind, name, messages,
+                                      active_messages, bytes))
+
     def log_message_desc(self, kind, name):
         if kind not in self.message_kinds:
             self.message_kinds[kind] = MessageKind(kind, name) 
@@ -2517,6 +2635,35 @@ class State(object):
         proc = self.find_processor(proc_id)
         proc.add_runtime_call(call)
 
+    def find_lock_site(self, site_id):
+        if site_id not in self.lock_sites:
+            self.lock_sites[site_id] = LockSite(site_id, None)
+        return self.lock_sites[site_id]
+
+    def log_lock_site_desc(self, site_id, name):
+        self.find_lock_site(site_id).name = name
+
+    def log_lock_stats(self, site_id, acquires, exclusive, contended,
+                       total_wait, total_hold):
+        site = self.find_lock_site(site_id)
+        site.acquires += acquires
+        site.exclusive += exclusive
+        site.contended += contended
+        site.total_wait += total_wait
+        site.total_hold += total_hold
+
+    def log_lock_histogram(self, site_id, kind, bucket, count):
+        histogram = self.find_lock_site(site_id).histograms[kind]
+        histogram[bucket] = histogram.get(bucket, 0) + count
+
+    def log_lock_wait_info(self, site_id, proc_id, start, stop):
+        assert start <= stop
+        if stop > self.last_time:
+            self.last_time = stop
+        wait = LockWait(self.find_lock_site(site_id), start, stop)
+        proc = self.find_processor(proc_id)
+        proc.add_lock_wait(wait)
+
     def log_proftask_info(self, proc_id, op_id, start, stop):
         # we don't have a unique op_id for the profiling task itself, so we don't 
         # add to self.operations
@@ -2803,6 +2950,79 @@ class State(object):
             channel.print_stats(verbose)
         print
 
+    def print_message_channel_stats(self, verbose):
+        if not self.message_channels:
+            return
+        print('****************************************************')
+        print('   VIRTUAL CHANNEL STATS')
+        print('****************************************************')
+        totals = {}
+        for (source, target, kind, name, messages, active_messages, bytes) \
+                in self.message_channels:
+            if verbose:
+                print('  Node %d -> Node %d %s Channel' % (source, target, name))
+                print('       Messages:        %d' % messages)
+                print('       Active Messages: %d' % active_messages)
+                print('       Bytes:           %d' % bytes)
+            if kind not in totals:
+                totals[kind] = [name, 0, 0, 0]
+            totals[kind][1] += messages
+            totals[kind][2] += active_messages
+            totals[kind][3] += bytes
+        for kind in sorted(totals):
+            name, messages, active_messages, bytes = totals[kind]
+            print('  %s Channel' % name)
+            print('       Messages:        %d' % messages)
+            print('       Active Messages: %d (%.2f messages each)' % \
+                    (active_messages, float(messages) / max(active_messages, 1)))
+            print('       Bytes:           %d' % bytes)
+        print
+
+    def print_trace_template_stats(self, verbose):
+        if not self.trace_templates:
+            return
+        print('****************************************************')
+        print('   TRACE TEMPLATE STATS')
+        print('****************************************************')
+        for trace_id in sorted(self.trace_templates):
+            counts = self.trace_templates[trace_id]
+            replays = counts[0] + counts[1]
+            print('  Trace %d' % trace_id)
+            for kind, name in enumerate(trace_template_kinds):
+                print('       %-22s %d' % (name + ':', counts[kind]))
+            print('       Hit Rate:              %.2f%%' % \
+                    (100.0 * replays / max(replays + counts[2], 1)))
+        print
+
+    def print_lock_stats(self, verbose):
+        if not self.lock_sites:
+            return
+        print('****************************************************')
+        print('   LOCK CONTENTION STATS')
+        print('****************************************************')
+        for site in sorted(itervalues(self.lock_sites),
+                           key=lambda s: s.total_wait, reverse=True):
+            if site.acquires == 0:
+                continue
+            if not verbose and site.contended == 0:
+                continue
+            print('  Lock %s' % site.name)
+            print('       Acquires:              %d (%d exclusive)' % \
+                    (site.acquires, site.exclusive))
+            print('       Contended:             %d (%.2f%%)' % \
+                    (site.contended, 100.0 * site.contended / site.acquires))
+            print('       Total Wait:            %.3f us' % \
+                    (site.total_wait / 1000.0))
+            print('       Average Wait:          %.3f us' % \
+                    (site.total_wait / 1000.0 / site.acquires))
+            print('       Average Hold:          %.3f us' % \
+                    (site.total_hold / 1000.0 / site.acquires))
+            print('       Wait p50/p99:          < %.3f us / < %.3f us' % \
+                    (site.percentile(0, 0.5), site.percentile(0, 0.99)))
+            print('       Hold p50/p99:          < %.3f us / < %.3f us' % \
+                    (site.percentile(1, 0.5), site.percentile(1, 0.99)))
+        print
+
     def print_task_stats(self, verbose):
         print('****************************************************')
         print('   TASK STATS')
@@ -2815,13 +3035,17 @@ class State(object):
         self.print_processor_stats(verbose)
         self.print_memory_stats(verbose)
         self.print_channel_stats(verbose)
+        self.print_message_channel_stats(verbose)
+        self.print_trace_template_stats(verbose)
+        self.print_lock_stats(verbose)
         self.print_task_stats(verbose)
 
     def assign_colors(self):
         # Subtract out some colors for which we have special colors
         num_colors = len(self.variants) + len(self.meta_variants) + \
                      len(self.op_kinds) + len(self.message_kinds) + \
-                     len(self.mapper_call_kinds) + len(self.runtime_call_kinds)
+                     len(self.mapper_call_kinds) + len(self.runtime_call_kinds) + \
+                     len(self.lock_sites)
         # Use a LFSR to randomize these colors
         lsfr = LFSR(num_colors)
         num_colors = lsfr.get_max_value()
@@ -2851,7 +3075,8 @@ class State(object):
         # Assign all the message kinds different colors
         for kinds in (self.message_kinds,
                       self.mapper_call_kinds,
-                      self.runtime_call_kinds):
+                      self.runtime_call_kinds,
+                      self.lock_sites):
             for kind in itervalues(kinds):
                 kind.assign_color(color_helper(lsfr.get_next(), num_colors))
 
@@ -93,6 +93,7 @@ class LegionProfASCIIDeserializer(LegionDeserializer):
         "MemDesc": re.compile(prefix + r'Prof Mem Desc (?P<mem_id>[a-f0-9]+) (?P<kind>[0-9]+) (?P<capacity>[0-9]+)'),
         "ProcMDesc": re.compile(prefix + r'Prof Mem Proc Affinity Desc (?P<proc_id>[a-f0-9]+) (?P<mem_id>[a-f0-9]+)'),
         "MaxDimDesc": re.compile(prefix + r'Max Dim Desc (?P<max_dim>[0-9]+)'),
+        "MessageChannelDesc": re.compile(prefix + r'Prof Message Channel Desc (?P<source>[0-9]+) (?P<target>[0-9]+) (?P<kind>[0-9]+) (?P<messages>[0-9]+) (?P<active_messages>[0-9]+) (?P<bytes>[0-9]+) (?P<name>[a-zA-Z0-9_ ]+)'),
         "IndexSpacePointDesc": re.compile(prefix + r'Index Space Point Desc (?P<unique_id>[0-9]+) (?P<dim>[0-9]+) (?P<rem>.*)'),
         "IndexSpaceRectDesc": re.compile(prefix + r'Index Space Rect Desc (?P<unique_id>[0-9]+) (?P<dim>[0-9]+) (?P<rem>.*)'),
         "IndexSpaceEmptyDesc": re.compile(prefix + r'Index Space Empty Desc (?P<unique_id>[0-9]+)'),
@@ -110,6 +111,11 @@ class LegionProfASCIIDeserializer(LegionDeserializer):
         "OperationInstance": re.compile(prefix + r'Prof Operation (?P<op_id>[0-9]+) (?P<kind>[0-9]+)'),
         "MultiTask": re.compile(prefix + r'Prof Multi (?P<op_id>[0-9]+) (?P<task_id>[0-9]+)'),
         "SliceOwner": re.compile(prefix + r'Prof Slice Owner (?P<parent_id>[0-9]+) (?P<op_id>[0-9]+)'),
+        "TraceTemplateInfo": re.compile(prefix + r'Prof Trace Template (?P<op_id>[0-9]+) (?P<trace_id>[0-9]+) (?P<kind>[0-9]+)'),
+        "LockSiteDesc": re.compile(prefix + r'Prof Lock Site Desc (?P<site_id>[0-9]+) (?P<name>\S+)'),
+        "LockStatsInfo": re.compile(prefix + r'Prof Lock Stats (?P<site_id>[0-9]+) (?P<acquires>[0-9]+) (?P<exclusive>[0-9]+) (?P<contended>[0-9]+) (?P<total_wait>[0-9]+) (?P<total_hold>[0-9]+)'),
+        "LockHistInfo": re.compile(prefix + r'Prof Lock Histogram (?P<site_id>[0-9]+) (?P<kind>[0-9]+) (?P<bucket>[0-9]+) (?P<count>[0-9]+)'),
+        "LockWaitInfo": re.compile(prefix + r'Prof Lock Wait Info (?P<site_id>[0-9]+) (?P<proc_id>[a-f0-9]+) (?P<start>[0-9]+) (?P<stop>[0-9]+)'),
         "TaskWaitInfo": re.compile(prefix + r'Prof Task Wait Info (?P<op_id>[0-9]+) (?P<task_id>[0-9]+) (?P<variant_id>[0-9]+) (?P<wait_start>[0-9]+) (?P<wait_ready>[0-9]+) (?P<wait_end>[0-9]+)'),
         "MetaWaitInfo": re.compile(prefix + r'Prof Meta Wait Info (?P<op_id>[0-9]+) (?P<lg_id>[0-9]+) (?P<wait_start>[0-9]+) (?P<wait_ready>[0-9]+) (?P<wait_end>[0-9]+)'),
         "TaskInfo": re.compile(prefix + r'Prof Task Info (?P<op_id>[0-9]+) (?P<task_id>[0-9]+) (?P<variant_id>[0-9]+) (?P<proc_id>[a-f0-9]+) (?P<create>[0-9]+) (?P<ready>[0-9]+) (?P<start>[0-9]+) (?P<stop>[0-9]+)'),
@@ -132,11 +138,25 @@ class LegionProfASCIIDeserializer(LegionDeserializer):
         "parent_id": long_type,
         "size": long_type,
         "capacity": long_type,
+        "source": int,
+        "target": int,
+        "messages": long_type,
+        "active_messages": long_type,
+        "bytes": long_type,
         "variant_id": int,
         "lg_id": int,
         "uid": int,
         "overwrite": int,
         "task_id": int,
+        "trace_id": int,
+        "site_id": int,
+        "bucket": int,
+        "acquires": long_type,
+        "exclusive": long_type,
+        "contended": long_type,
+        "total_wait": long_type,
+        "total_hold": long_type,
+        "count": long_type,
         "kind": int,
         "opkind": int,
         "part_op": int,
@@ -247,6 +267,7 @@ class LegionProfBinaryDeserializer(LegionDeserializer):
         "UniqueID":           "Q", # unsigned long long
         "IDType":             "Q", # unsigned long long
         "TaskID":             "I", # unsigned int
+        "TraceID":            "I", # unsigned int
         "bool":               "?", # bool
         "VariantID":          "I", # unsigned int
         "unsigned":           "I", # unsigned int
@@ -9018,6 +9018,107 @@ barrier_wait_pat        = re.compile(
 replay_op_pat    = re.compile(
     prefix+"Replay Operation (?P<uid>[0-9]+)")
 
+# Binary logs written with -lg:spy_logfile (see runtime/legion/legion_spy.cc)
+binary_log_header = b'FileType: BinaryLegionSpy v: 1.0\n'
+binary_conv_pat = re.compile(b'%[-+ #0-9.]*[hlz]*([diouxXcs])')
+
+class BinaryLogFile(object):
+    """Iterates over the text lines encoded in a binary Legion Spy log.
+
+    The records are decoded by the legion_spy_convert tool if it has been
+    built (next to this script, or named by $LEGION_SPY_CONVERT), and by
+    the much slower Python decoder below otherwise."""
+    def __init__(self, file_name):
+        self.file_name = file_name
+        self.proc = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        if self.proc is not None:
+            self.proc.stdout.close()
+            if self.proc.wait() != 0:
+                print('ERROR: legion_spy_convert failed on '+self.file_name)
+                sys.exit(1)
+            self.proc = None
+        return False
+
+    def __iter__(self):
+        converter = os.environ.get('LEGION_SPY_CONVERT',
+            os.path.join(os.path.dirname(os.path.realpath(__file__)),
+                         'legion_spy_convert'))
+        if os.path.isfile(converter) and os.access(converter, os.X_OK):
+            self.proc = subprocess.Popen([converter, self.file_name],
+                    stdout=subprocess.PIPE, universal_newlines=True)
+            return iter(self.proc.stdout)
+        print('WARNING: legion_spy_convert not found, decoding %s in Python' %
+                self.file_name)
+        return self.decode()
+
+    @staticmethod
+    def read_varint(data, offset):
+        value = 0
+        shift = 0
+        while True:
+            b = bytearray(data[offset:offset+1])[0]
+            offset += 1
+            value |= (b & 0x7f) << shift
+            if (b & 0x80) == 0:
+                return value,offset
+            shift += 7
+
+    def decode(self):
+        with open(self.file_name, 'rb') as log:
+            data = log.read()
+        offset = len(binary_log_header)
+        eol = data.index(b'\n', offset)
+        node = int(data[offset:eol].split()[1])
+        offset = eol + 1
+        formats = dict()
+        while offset < len(data):
+            kind = data[offset:offset+1]
+            offset += 1
+            if kind == b'F':
+                fid,length = struct.unpack_from('=II', data, offset)
+                offset += 8
+                fmt = data[offset:offset+length]
+                offset += length
+                # Python formatting has no length modifiers
+                convs = [m.group(1) for m in binary_conv_pat.finditer(fmt)]
+                fmt = binary_conv_pat.sub(lambda m: m.group(0).translate(None,
+                    b'hlz').replace(b'u', b'd'), fmt).decode('utf-8')
+                formats[fid] = (fmt, convs)
+            elif kind == b'C':
+                thread,length = struct.unpack_from('=QI', data, offset)
+                offset += 12
+                end = offset + length
+                prefix = '[%d - %x] {3}{legion_spy}: ' % (node, thread)
+                while offset < end:
+                    fid,offset = self.read_varint(data, offset)
+                    fmt,convs = formats[fid]
+                    args = list()
+                    for conv in convs:
+                        value,offset = self.read_varint(data, offset)
+                        if conv == b's':
+                            args.append(data[offset:offset+value].decode('utf-8'))
+                            offset += value
+                        elif conv in (b'd', b'i', b'c'):
+                            args.append((value >> 1) ^ -(value & 1))
+                        else:
+                            args.append(value)
+                    yield prefix + (fmt % tuple(args)) + '\n'
+            else:
+                print('ERROR: Malformed binary log file '+self.file_name)
+                sys.exit(1)
+
+def open_log_file(file_name):
+    with open(file_name, 'rb') as log:
+        header = log.read(len(binary_log_header))
+    if header == binary_log_header:
+        return BinaryLogFile(file_name)
+    return open(file_name, 'r')
+
 def parse_legion_spy_line(line, state):
     # Quick test to see if the line is even worth considering
     m = prefix_pat.match(line)
@@ -9901,7 +10002,7 @@ class State(object):
     def parse_log_file(self, file_name):
         print('Reading log file %s...' % file_name)
         try:
-            log = open(file_name, 'r')
+            log = open_log_file(file_name)
         except:
             print('ERROR: Unable to find file '+file_name)
             print('Legion Spy will now exit')
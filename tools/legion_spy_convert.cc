@@ -0,0 +1,283 @@
+/* Copyright 2019 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Converts binary Legion Spy logs (written with -lg:spy_logfile) back into
+//  the text lines that -lg:spy would have printed, so they can be fed to
+//  legion_spy.py (which runs this tool itself when it finds a binary log)
+//
+// build with: c++ -O2 -o legion_spy_convert legion_spy_convert.cc
+// usage: legion_spy_convert <binary log>...   (text goes to stdout)
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+// these must match the encoding in runtime/legion/legion_spy.cc
+enum ArgKind {
+  ARG_SIGNED,
+  ARG_CHAR,
+  ARG_UNSIGNED,
+  ARG_STRING,
+};
+
+struct FormatPiece {
+  std::string text;   // literal text, followed by a conversion if 'spec' set
+  std::string spec;   // printf conversion for the decoded argument
+  ArgKind kind;
+};
+
+struct Format {
+  std::vector<FormatPiece> pieces;
+  std::string tail;
+};
+
+static void parse_format(const char *fmt, size_t len, Format& format)
+{
+  std::string text;
+  size_t i = 0;
+  while(i < len) {
+    if(fmt[i] != '%') {
+      text.push_back(fmt[i++]);
+      continue;
+    }
+    if((i + 1 < len) && (fmt[i+1] == '%')) {
+      text.push_back('%');
+      i += 2;
+      continue;
+    }
+    size_t start = i++;
+    while((i < len) && (strchr("-+ #0123456789.", fmt[i]) != 0))
+      i++;
+    // keep the '%' and any flags/width/precision, drop the length modifier
+    std::string flags(fmt + start, i - start);
+    while((i < len) && ((fmt[i] == 'l') || (fmt[i] == 'h') || (fmt[i] == 'z')))
+      i++;
+    if(i >= len) {
+      fprintf(stderr, "truncated conversion in format: %.*s\n", (int)len, fmt);
+      exit(1);
+    }
+    FormatPiece piece;
+    piece.text = text;
+    text.clear();
+    switch(fmt[i]) {
+    case 'd': case 'i':
+      piece.spec = flags + "lld";
+      piece.kind = ARG_SIGNED;
+      break;
+    case 'c':
+      piece.spec = flags + "c";
+      piece.kind = ARG_CHAR;
+      break;
+    case 'u': case 'x': case 'X': case 'o':
+      piece.spec = flags + "ll" + fmt[i];
+      piece.kind = ARG_UNSIGNED;
+      break;
+    case 's':
+      piece.spec = flags + "s";
+      piece.kind = ARG_STRING;
+      break;
+    default:
+      fprintf(stderr, "unsupported conversion '%c' in format: %.*s\n",
+	      fmt[i], (int)len, fmt);
+      exit(1);
+    }
+    format.pieces.push_back(piece);
+    i++;
+  }
+  format.tail = text;
+}
+
+static inline unsigned long long decode_varint(const unsigned char *& ptr,
+					       const unsigned char *end)
+{
+  unsigned long long value = 0;
+  int shift = 0;
+  while(true) {
+    if(ptr >= end) {
+      fprintf(stderr, "record extends past the end of its chunk\n");
+      exit(1);
+    }
+    unsigned char b = *ptr++;
+    value |= (unsigned long long)(b & 0x7f) << shift;
+    if(!(b & 0x80)) break;
+    shift += 7;
+  }
+  return value;
+}
+
+static int convert_file(const char *filename, FILE *out)
+{
+  int fd = open(filename, O_RDONLY);
+  if(fd < 0) {
+    fprintf(stderr, "unable to open %s\n", filename);
+    return 1;
+  }
+  struct stat st;
+  if((fstat(fd, &st) < 0) || (st.st_size == 0)) {
+    fprintf(stderr, "unable to stat %s\n", filename);
+    close(fd);
+    return 1;
+  }
+  size_t size = st.st_size;
+  void *base = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(base == MAP_FAILED) {
+    fprintf(stderr, "unable to map %s\n", filename);
+    return 1;
+  }
+  madvise(base, size, MADV_SEQUENTIAL);
+  const unsigned char *ptr = (const unsigned char *)base;
+  const unsigned char *end = ptr + size;
+
+  // two lines of text: file type and the node that wrote the log
+  int node = 0;
+  {
+    const char *header = "FileType: BinaryLegionSpy v: 1.0\n";
+    size_t hlen = strlen(header);
+    if((size < hlen) || memcmp(ptr, header, hlen)) {
+      fprintf(stderr, "%s is not a binary Legion Spy log\n", filename);
+      munmap(base, size);
+      return 1;
+    }
+    ptr += hlen;
+    const unsigned char *eol = (const unsigned char *)memchr(ptr, '\n', end - ptr);
+    if(!eol || (sscanf((const char *)ptr, "Node: %d", &node) != 1)) {
+      fprintf(stderr, "%s has a malformed header\n", filename);
+      munmap(base, size);
+      return 1;
+    }
+    ptr = eol + 1;
+  }
+
+  std::vector<Format> formats;
+  std::string line;
+  char prefix[64];
+  char value[64];
+  while(ptr < end) {
+    char type = *ptr++;
+    if(type == 'F') {
+      unsigned id, len;
+      if((end - ptr) < 8) break;
+      memcpy(&id, ptr, 4);
+      memcpy(&len, ptr + 4, 4);
+      ptr += 8;
+      if((size_t)(end - ptr) < len) break;
+      if(id >= formats.size())
+	formats.resize(id + 1);
+      parse_format((const char *)ptr, len, formats[id]);
+      ptr += len;
+    } else if(type == 'C') {
+      unsigned long long thread;
+      unsigned len;
+      if((end - ptr) < 12) break;
+      memcpy(&thread, ptr, 8);
+      memcpy(&len, ptr + 8, 4);
+      ptr += 12;
+      if((size_t)(end - ptr) < len) break;
+      const unsigned char *rec = ptr;
+      const unsigned char *rec_end = ptr + len;
+      ptr = rec_end;
+      // same prefix as Realm's logger uses for the text log
+      int plen = snprintf(prefix, sizeof(prefix), "[%d - %llx] {3}{legion_spy}: ",
+			  node, thread);
+      while(rec < rec_end) {
+	unsigned long long id = decode_varint(rec, rec_end);
+	if(id >= formats.size()) {
+	  fprintf(stderr, "record uses undefined format %llu\n", id);
+	  exit(1);
+	}
+	const Format& format = formats[id];
+	line.assign(prefix, plen);
+	for(std::vector<FormatPiece>::const_iterator it = format.pieces.begin();
+	    it != format.pieces.end();
+	    it++) {
+	  line.append(it->text);
+	  unsigned long long v;
+	  int vlen = 0;
+	  switch(it->kind) {
+	  case ARG_SIGNED:
+	    v = decode_varint(rec, rec_end);
+	    vlen = snprintf(value, sizeof(value), it->spec.c_str(),
+			    (long long)((v >> 1) ^ -(long long)(v & 1)));
+	    line.append(value, vlen);
+	    break;
+	  case ARG_CHAR:
+	    v = decode_varint(rec, rec_end);
+	    vlen = snprintf(value, sizeof(value), it->spec.c_str(),
+			    (int)((v >> 1) ^ -(long long)(v & 1)));
+	    line.append(value, vlen);
+	    break;
+	  case ARG_UNSIGNED:
+	    v = decode_varint(rec, rec_end);
+	    vlen = snprintf(value, sizeof(value), it->spec.c_str(), v);
+	    line.append(value, vlen);
+	    break;
+	  case ARG_STRING:
+	    v = decode_varint(rec, rec_end);
+	    if((unsigned long long)(rec_end - rec) < v) {
+	      fprintf(stderr, "string extends past the end of its chunk\n");
+	      exit(1);
+	    }
+	    if(it->spec == "%s")
+	      line.append((const char *)rec, v);
+	    else {
+	      std::string s((const char *)rec, v);
+	      std::vector<char> buffer(v + 64);
+	      vlen = snprintf(&buffer[0], buffer.size(),
+			      it->spec.c_str(), s.c_str());
+	      line.append(&buffer[0], vlen);
+	    }
+	    rec += v;
+	    break;
+	  }
+	}
+	line.append(format.tail);
+	line.push_back('\n');
+	fwrite(line.data(), 1, line.size(), out);
+      }
+    } else {
+      fprintf(stderr, "%s: unknown block type '%c' at offset %zd\n",
+	      filename, type, (ptr - 1) - (const unsigned char *)base);
+      munmap(base, size);
+      return 1;
+    }
+  }
+  if(ptr < end)
+    fprintf(stderr, "%s: truncated block at end of file\n", filename);
+  munmap(base, size);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s <binary legion spy log>...\n", argv[0]);
+    return 1;
+  }
+  static char outbuf[1 << 20];
+  setvbuf(stdout, outbuf, _IOFBF, sizeof(outbuf));
+  int result = 0;
+  for(int i = 1; i < argc; i++)
+    if(convert_file(argv[i], stdout) != 0)
+      result = 1;
+  fflush(stdout);
+  return result;
+}
@@ -80,6 +80,7 @@ callbacks = {
     "ProcMDesc": noop,
     "MemDesc": noop,
     "MaxDimDesc": noop,
+    "MessageChannelDesc": noop,
     "IndexSpacePointDesc": noop,
     "IndexSpaceRectDesc": noop,
     "IndexSpaceEmptyDesc": noop,
@@ -97,6 +98,11 @@ callbacks = {
     "OperationInstance": noop,
     "MultiTask": noop,
     "SliceOwner": noop,
+    "TraceTemplateInfo": noop,
+    "LockSiteDesc": noop,
+    "LockStatsInfo": noop,
+    "LockHistInfo": noop,
+    "LockWaitInfo": noop,
     "TaskWaitInfo": noop,
     "MetaWaitInfo": noop,
     "TaskInfo": log_task_info,